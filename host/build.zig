@@ -28,6 +28,18 @@ pub fn build(b: *std.Build) void {
         },
     });
 
+    // The firmware's log sites, which the host formats LOG packets with
+    const log_sites = std.Build.Module.CreateOptions{
+        .root_source_file = .{ .cwd_relative = "../src/error/log_sites.def" },
+    };
+    protocol_module.addAnonymousImport("log_sites", log_sites);
+
+    // The firmware's trace events, which name records in a trace dump
+    const trace_events = std.Build.Module.CreateOptions{
+        .root_source_file = .{ .cwd_relative = "../src/debug/trace_events.def" },
+    };
+    protocol_module.addAnonymousImport("trace_events", trace_events);
+
     const exe = b.addExecutable(.{
         .name = "deskthang",
         .root_source_file = .{ .cwd_relative = "src/main.zig" },
@@ -77,11 +89,28 @@ pub fn build(b: *std.Build) void {
         .optimize = optimize,
     });
 
+    unit_tests.root_module.addImport("protocol", protocol_module);
+    unit_tests.root_module.addImport("command", command_module);
+
     const run_unit_tests = b.addRunArtifact(unit_tests);
 
+    // Protocol tests, including the log and trace decoders against the
+    // firmware's tables
+    const protocol_tests = b.addTest(.{
+        .root_source_file = .{ .cwd_relative = "src/protocol/protocol.zig" },
+        .target = target,
+        .optimize = optimize,
+    });
+    protocol_tests.root_module.addImport("command", command_module);
+    protocol_tests.root_module.addAnonymousImport("log_sites", log_sites);
+    protocol_tests.root_module.addAnonymousImport("trace_events", trace_events);
+
+    const run_protocol_tests = b.addRunArtifact(protocol_tests);
+
     // Similar to creating the run step earlier, this exposes a `test` step to
     // the `zig build --help` menu, providing a way for the user to request
     // running the unit tests.
     const test_step = b.step("test", "Run unit tests");
     test_step.dependOn(&run_unit_tests.step);
+    test_step.dependOn(&run_protocol_tests.step);
 }
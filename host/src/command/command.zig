@@ -1 +1,5 @@
 pub const image = @import("image.zig");
+pub const region = @import("region.zig");
+pub const delta = @import("delta.zig");
+pub const palette = @import("palette.zig");
+pub const round = @import("round.zig");
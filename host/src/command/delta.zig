@@ -0,0 +1,244 @@
+const std = @import("std");
+const ImageSize = @import("image.zig").ImageSize;
+
+// Frame delta encoding: the new frame as skip/copy runs against the frame
+// the device already shows. Each op is a little-endian u16; bit 15 clear
+// skips `count` unchanged pixels, bit 15 set copies the `count` RGB565
+// pixels that follow. Must match src/codec/delta.h.
+
+pub const OP_SIZE: usize = 2;
+pub const OP_COPY: u16 = 0x8000;
+pub const MAX_RUN: usize = 0x7FFF;
+
+// Pixels per block for the raw fallback: a block whose runs would cost more
+// than copying it whole is copied whole
+pub const BLOCK_PIXELS: usize = 128;
+
+const Run = struct {
+    copy: bool,
+    count: usize,
+};
+
+pub const Stats = struct {
+    encoded_bytes: usize,
+    changed_pixels: usize,
+    raw_blocks: usize, // Blocks that fell back to a plain copy
+
+    /// Raw frame bytes per encoded byte
+    pub fn ratio(self: Stats) f32 {
+        if (self.encoded_bytes == 0) return 0;
+        return @as(f32, @floatFromInt(ImageSize.total_bytes)) / @as(f32, @floatFromInt(self.encoded_bytes));
+    }
+};
+
+pub const Delta = struct {
+    stream: []u8,
+    stats: Stats,
+};
+
+fn pixelChanged(previous: []const u8, current: []const u8, pixel: usize) bool {
+    const offset = pixel * ImageSize.bytes_per_pixel;
+    return previous[offset] != current[offset] or previous[offset + 1] != current[offset + 1];
+}
+
+fn runCost(run: Run) usize {
+    const ops = (run.count + MAX_RUN - 1) / MAX_RUN;
+    const pixels = if (run.copy) run.count * ImageSize.bytes_per_pixel else 0;
+    return ops * OP_SIZE + pixels;
+}
+
+/// Append a run, folding it into the previous one when they are the same kind
+fn appendRun(runs: *std.ArrayList(Run), run: Run) !void {
+    if (runs.items.len > 0 and runs.items[runs.items.len - 1].copy == run.copy) {
+        runs.items[runs.items.len - 1].count += run.count;
+    } else {
+        try runs.append(run);
+    }
+}
+
+/// Runs for one block. A skip too short to pay for its own op and the copy
+/// op after it is folded into the copy.
+fn encodeBlock(previous: []const u8, current: []const u8, start: usize, block: *std.ArrayList(Run)) !void {
+    block.clearRetainingCapacity();
+
+    var pixel = start;
+    const end = start + BLOCK_PIXELS;
+    while (pixel < end) {
+        const changed = pixelChanged(previous, current, pixel);
+        var count: usize = 1;
+        while (pixel + count < end and pixelChanged(previous, current, pixel + count) == changed) count += 1;
+        try appendRun(block, Run{ .copy = changed, .count = count });
+        pixel += count;
+    }
+
+    // A skip of two pixels or fewer costs as much as copying through it.
+    // Interior ones join their neighbours; ones at the block edges join the
+    // copy beside them so copies coalesce across blocks.
+    var i: usize = 0;
+    while (i < block.items.len and block.items.len > 1) {
+        const run = block.items[i];
+        if (run.copy or run.count * ImageSize.bytes_per_pixel > 2 * OP_SIZE) {
+            i += 1;
+        } else if (i == 0) {
+            block.items[1].count += run.count;
+            _ = block.orderedRemove(0);
+        } else if (i + 1 == block.items.len) {
+            block.items[i - 1].count += run.count;
+            _ = block.orderedRemove(i);
+        } else {
+            block.items[i - 1].count += run.count + block.items[i + 1].count;
+            _ = block.orderedRemove(i + 1);
+            _ = block.orderedRemove(i);
+        }
+    }
+}
+
+/// Encode current as runs against previous. Blocks whose runs cost more
+/// than their raw pixels are sent raw, so the stream never exceeds the frame
+/// by more than the op headers.
+pub fn encode(allocator: std.mem.Allocator, previous: []const u8, current: []const u8) !Delta {
+    if (previous.len != ImageSize.total_bytes or current.len != ImageSize.total_bytes) {
+        return error.InvalidInputSize;
+    }
+
+    var runs = std.ArrayList(Run).init(allocator);
+    defer runs.deinit();
+    var block = std.ArrayList(Run).init(allocator);
+    defer block.deinit();
+
+    var stats = Stats{ .encoded_bytes = 0, .changed_pixels = 0, .raw_blocks = 0 };
+
+    var start: usize = 0;
+    while (start < ImageSize.pixels) : (start += BLOCK_PIXELS) {
+        try encodeBlock(previous, current, start, &block);
+
+        var cost: usize = 0;
+        for (block.items) |run| cost += runCost(run);
+
+        const raw = Run{ .copy = true, .count = BLOCK_PIXELS };
+        if (cost > runCost(raw)) {
+            try appendRun(&runs, raw);
+            stats.raw_blocks += 1;
+        } else {
+            for (block.items) |run| try appendRun(&runs, run);
+        }
+    }
+
+    var size: usize = 0;
+    for (runs.items) |run| size += runCost(run);
+
+    const stream = try allocator.alloc(u8, size);
+    errdefer allocator.free(stream);
+
+    var offset: usize = 0;
+    var pixel: usize = 0;
+    for (runs.items) |run| {
+        var left = run.count;
+        while (left > 0) {
+            const count = @min(left, MAX_RUN);
+            const op: u16 = @as(u16, @intCast(count)) | if (run.copy) OP_COPY else 0;
+            std.mem.writeInt(u16, stream[offset..][0..2], op, .little);
+            offset += OP_SIZE;
+
+            if (run.copy) {
+                const bytes = count * ImageSize.bytes_per_pixel;
+                @memcpy(stream[offset..][0..bytes], current[pixel * ImageSize.bytes_per_pixel ..][0..bytes]);
+                offset += bytes;
+            }
+            pixel += count;
+            left -= count;
+        }
+    }
+
+    var p: usize = 0;
+    while (p < ImageSize.pixels) : (p += 1) {
+        if (pixelChanged(previous, current, p)) stats.changed_pixels += 1;
+    }
+    stats.encoded_bytes = stream.len;
+
+    return Delta{ .stream = stream, .stats = stats };
+}
+
+/// Apply a delta stream to a frame, as the device does
+pub fn apply(frame: []u8, stream: []const u8) !void {
+    var offset: usize = 0;
+    var pixel: usize = 0;
+    while (offset < stream.len) {
+        if (offset + OP_SIZE > stream.len) return error.InvalidInputSize;
+        const op = std.mem.readInt(u16, stream[offset..][0..2], .little);
+        offset += OP_SIZE;
+
+        const count: usize = op & @as(u16, MAX_RUN);
+        if (count == 0 or pixel + count > ImageSize.pixels) return error.InvalidInputSize;
+
+        if (op & OP_COPY != 0) {
+            const bytes = count * ImageSize.bytes_per_pixel;
+            if (offset + bytes > stream.len) return error.InvalidInputSize;
+            @memcpy(frame[pixel * ImageSize.bytes_per_pixel ..][0..bytes], stream[offset..][0..bytes]);
+            offset += bytes;
+        }
+        pixel += count;
+    }
+    if (pixel != ImageSize.pixels) return error.InvalidInputSize;
+}
+
+fn testFrames(allocator: std.mem.Allocator) !struct { previous: []u8, current: []u8 } {
+    const previous = try allocator.alloc(u8, ImageSize.total_bytes);
+    const current = try allocator.alloc(u8, ImageSize.total_bytes);
+    for (previous, 0..) |*byte, i| byte.* = @truncate(i * 7);
+    @memcpy(current, previous);
+    return .{ .previous = previous, .current = current };
+}
+
+test "unchanged frame is two skip ops" {
+    const allocator = std.testing.allocator;
+    const frames = try testFrames(allocator);
+    defer allocator.free(frames.previous);
+    defer allocator.free(frames.current);
+
+    const delta = try encode(allocator, frames.previous, frames.current);
+    defer allocator.free(delta.stream);
+    try std.testing.expectEqual(@as(usize, 2 * OP_SIZE), delta.stream.len);
+    try std.testing.expectEqual(@as(usize, 0), delta.stats.changed_pixels);
+}
+
+test "sparse changes round trip and compress" {
+    const allocator = std.testing.allocator;
+    const frames = try testFrames(allocator);
+    defer allocator.free(frames.previous);
+    defer allocator.free(frames.current);
+
+    // A few percent of pixels, in short bursts
+    var pixel: usize = 500;
+    while (pixel < ImageSize.pixels) : (pixel += 1777) {
+        var i: usize = 0;
+        while (i < 20 and pixel + i < ImageSize.pixels) : (i += 1) {
+            frames.current[(pixel + i) * 2] ^= 0xFF;
+        }
+    }
+
+    const delta = try encode(allocator, frames.previous, frames.current);
+    defer allocator.free(delta.stream);
+    try std.testing.expect(delta.stats.ratio() > 20);
+
+    try apply(frames.previous, delta.stream);
+    try std.testing.expectEqualSlices(u8, frames.current, frames.previous);
+}
+
+test "noisy frame costs no more than raw" {
+    const allocator = std.testing.allocator;
+    const frames = try testFrames(allocator);
+    defer allocator.free(frames.previous);
+    defer allocator.free(frames.current);
+
+    // Every other pixel changed: one op per pixel would double the frame
+    var pixel: usize = 0;
+    while (pixel < ImageSize.pixels) : (pixel += 2) frames.current[pixel * 2 + 1] ^= 0x01;
+
+    const delta = try encode(allocator, frames.previous, frames.current);
+    defer allocator.free(delta.stream);
+    try std.testing.expect(delta.stream.len <= ImageSize.total_bytes + 2 * OP_SIZE);
+
+    try apply(frames.previous, delta.stream);
+    try std.testing.expectEqualSlices(u8, frames.current, frames.previous);
+}
@@ -131,3 +131,446 @@ pub const ImageError = error{
     InvalidInputSize,
     FileNotFound,
 };
+
+// QOI-style compression for RGB565 frames. Must match src/codec/qoi.h: ops
+// predict from the previous pixel or a 64-entry index of recent pixels, with
+// channel arithmetic wrapping at the channel width.
+pub const Qoi = struct {
+    pub const op_index: u8 = 0x00; // 00iiiiii
+    pub const op_diff: u8 = 0x40; // 01rrggbb, each -2..1
+    pub const op_luma: u8 = 0x80; // 10gggggg rrrrbbbb, g -32..31, r/b (dg >> 1) + -8..7
+    pub const op_run: u8 = 0xC0; // 11rrrrrr, 1..62 repeats
+    pub const op_rgb: u8 = 0xFE; // Literal pixel, little-endian
+    pub const max_run: u8 = 62;
+    pub const index_size: usize = 64;
+
+    fn red(pixel: u16) i32 {
+        return pixel >> 11;
+    }
+
+    fn green(pixel: u16) i32 {
+        return (pixel >> 5) & 0x3F;
+    }
+
+    fn blue(pixel: u16) i32 {
+        return pixel & 0x1F;
+    }
+
+    fn pack(r: i32, g: i32, b: i32) u16 {
+        return @intCast(((r & 0x1F) << 11) | ((g & 0x3F) << 5) | (b & 0x1F));
+    }
+
+    fn hash(pixel: u16) usize {
+        return @intCast(@mod(red(pixel) * 3 + green(pixel) * 5 + blue(pixel) * 7, 64));
+    }
+
+    /// Sign-extend a channel difference wrapped to bits
+    fn wrap(diff: i32, comptime bits: u5) i32 {
+        const mask: i32 = (1 << bits) - 1;
+        const wrapped = diff & mask;
+        return if (wrapped >= (1 << (bits - 1))) wrapped - (1 << bits) else wrapped;
+    }
+};
+
+/// Compress an RGB565 frame. The result can be larger than the frame for
+/// noisy images; callers compare and send whichever is smaller.
+pub fn encodeQOI(allocator: std.mem.Allocator, rgb565: []const u8) ![]u8 {
+    if (rgb565.len % ImageSize.bytes_per_pixel != 0) {
+        return error.InvalidInputSize;
+    }
+
+    var out = try std.ArrayList(u8).initCapacity(allocator, rgb565.len / 2);
+    errdefer out.deinit();
+
+    var index = [_]u16{0} ** Qoi.index_size;
+    var prev: u16 = 0;
+    var run: u8 = 0;
+    const pixels = rgb565.len / ImageSize.bytes_per_pixel;
+
+    var i: usize = 0;
+    while (i < pixels) : (i += 1) {
+        const pixel = std.mem.readInt(u16, rgb565[i * 2 ..][0..2], .little);
+
+        if (pixel == prev) {
+            run += 1;
+            if (run < Qoi.max_run and i + 1 < pixels) continue;
+        }
+        if (run > 0) {
+            try out.append(Qoi.op_run | (run - 1));
+            run = 0;
+            if (pixel == prev) continue;
+        }
+
+        const slot = Qoi.hash(pixel);
+        if (index[slot] == pixel) {
+            try out.append(Qoi.op_index | @as(u8, @intCast(slot)));
+            prev = pixel;
+            continue;
+        }
+        index[slot] = pixel;
+
+        const dr = Qoi.wrap(Qoi.red(pixel) - Qoi.red(prev), 5);
+        const dg = Qoi.wrap(Qoi.green(pixel) - Qoi.green(prev), 6);
+        const db = Qoi.wrap(Qoi.blue(pixel) - Qoi.blue(prev), 5);
+        const dr_dg = dr - (dg >> 1);
+        const db_dg = db - (dg >> 1);
+
+        if (dr >= -2 and dr <= 1 and dg >= -2 and dg <= 1 and db >= -2 and db <= 1) {
+            try out.append(Qoi.op_diff | @as(u8, @intCast(((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2))));
+        } else if (dr_dg >= -8 and dr_dg <= 7 and db_dg >= -8 and db_dg <= 7) {
+            try out.append(Qoi.op_luma | @as(u8, @intCast(dg + 32)));
+            try out.append(@intCast(((dr_dg + 8) << 4) | (db_dg + 8)));
+        } else {
+            try out.appendSlice(&[_]u8{ Qoi.op_rgb, @truncate(pixel), @truncate(pixel >> 8) });
+        }
+        prev = pixel;
+    }
+
+    return out.toOwnedSlice();
+}
+
+/// Decode a QOI stream into a frame of frame.len bytes, as the device does
+pub fn decodeQOI(stream: []const u8, frame: []u8) !void {
+    var index = [_]u16{0} ** Qoi.index_size;
+    var prev: u16 = 0;
+    var pos: usize = 0;
+    var i: usize = 0;
+
+    while (i < stream.len) {
+        const tag = stream[i];
+        var pixel: u16 = undefined;
+        var count: usize = 1;
+
+        if (tag == Qoi.op_rgb) {
+            if (i + 3 > stream.len) return error.InvalidInputSize;
+            pixel = std.mem.readInt(u16, stream[i + 1 ..][0..2], .little);
+            i += 3;
+        } else if (tag == 0xFF) {
+            return error.DecodingError;
+        } else switch (tag & 0xC0) {
+            Qoi.op_index => {
+                pixel = index[tag];
+                i += 1;
+            },
+            Qoi.op_diff => {
+                pixel = Qoi.pack(
+                    Qoi.red(prev) + ((tag >> 4) & 3) - 2,
+                    Qoi.green(prev) + ((tag >> 2) & 3) - 2,
+                    Qoi.blue(prev) + (tag & 3) - 2,
+                );
+                i += 1;
+            },
+            Qoi.op_luma => {
+                if (i + 2 > stream.len) return error.InvalidInputSize;
+                const dg: i32 = @as(i32, tag & 0x3F) - 32;
+                const half = dg >> 1;
+                const rb = stream[i + 1];
+                pixel = Qoi.pack(
+                    Qoi.red(prev) + half + (rb >> 4) - 8,
+                    Qoi.green(prev) + dg,
+                    Qoi.blue(prev) + half + (rb & 0x0F) - 8,
+                );
+                i += 2;
+            },
+            else => {
+                pixel = prev;
+                count = (tag & 0x3F) + 1;
+                i += 1;
+            },
+        }
+
+        index[Qoi.hash(pixel)] = pixel;
+        prev = pixel;
+        if (pos + count * 2 > frame.len) return error.InvalidInputSize;
+        while (count > 0) : (count -= 1) {
+            std.mem.writeInt(u16, frame[pos..][0..2], pixel, .little);
+            pos += 2;
+        }
+    }
+    if (pos != frame.len) return error.InvalidInputSize;
+}
+
+test "QOI round trips a dashboard frame and compresses it" {
+    const allocator = std.testing.allocator;
+    const frame = try allocator.alloc(u8, ImageSize.total_bytes);
+    defer allocator.free(frame);
+
+    var seed: u32 = 7;
+    for (0..ImageSize.pixels) |i| {
+        const x = i % ImageSize.width;
+        const y = i / ImageSize.width;
+        var pixel: u16 = 0x0841;
+        if (y >= 60 and y < 120) {
+            pixel = @intCast(((x / 8) << 11) | ((y - 60) << 5) | (x / 8));
+        } else if (y >= 150 and y < 170 and x < 40) {
+            seed = seed *% 1103515245 +% 12345;
+            pixel = @truncate(seed >> 16);
+        }
+        std.mem.writeInt(u16, frame[i * 2 ..][0..2], pixel, .little);
+    }
+
+    const stream = try encodeQOI(allocator, frame);
+    defer allocator.free(stream);
+    try std.testing.expect(stream.len < ImageSize.total_bytes / 4);
+
+    const decoded = try allocator.alloc(u8, ImageSize.total_bytes);
+    defer allocator.free(decoded);
+    try decodeQOI(stream, decoded);
+    try std.testing.expectEqualSlices(u8, frame, decoded);
+}
+
+test "QOI ops match the firmware decoder" {
+    // Same stream as test_each_op_decodes in test/protocol/test_transfer_qoi.c
+    const pixels = [_]u16{ 0x1234, 0x1234, 0x1234, 0x1A55, 0x439A };
+    var frame: [pixels.len * 2]u8 = undefined;
+    for (pixels, 0..) |pixel, i| std.mem.writeInt(u16, frame[i * 2 ..][0..2], pixel, .little);
+
+    const stream = try encodeQOI(std.testing.allocator, &frame);
+    defer std.testing.allocator.free(stream);
+    try std.testing.expectEqualSlices(u8, &[_]u8{ Qoi.op_rgb, 0x34, 0x12, Qoi.op_run | 1, Qoi.op_diff | 0x3F, Qoi.op_luma | 42, 0x88 }, stream);
+}
+
+// BC1/DXT1-style block compression at 4 bits per pixel. Must match
+// src/codec/bc1.h: 4x4 blocks, left to right and top to bottom, each two
+// RGB565 endpoints (u16 LE) and 16 2-bit indices (u32 LE, row by row).
+pub const Bc1 = struct {
+    pub const block_dim: usize = 4;
+    pub const block_size: usize = 8;
+    pub const blocks_per_row: usize = ImageSize.width / block_dim;
+    pub const block_rows: usize = ImageSize.height / block_dim;
+    pub const encoded_size: usize = blocks_per_row * block_rows * block_size;
+
+    // Encoder threads at most; a frame is only 60 block rows
+    const max_threads: usize = 8;
+
+    const Vec = @Vector(16, f32);
+
+    /// Per-channel weighted mix, rounded the same way as the firmware
+    fn mix(a: u16, b: u16, wa: u32, wb: u32) u16 {
+        const total = wa + wb;
+        const r = ((@as(u32, a >> 11) * wa + @as(u32, b >> 11) * wb) + total / 2) / total;
+        const g = ((@as(u32, (a >> 5) & 0x3F) * wa + @as(u32, (b >> 5) & 0x3F) * wb) + total / 2) / total;
+        const bl = ((@as(u32, a & 0x1F) * wa + @as(u32, b & 0x1F) * wb) + total / 2) / total;
+        return @intCast((r << 11) | (g << 5) | bl);
+    }
+
+    pub fn palette(color0: u16, color1: u16) [4]u16 {
+        if (color0 > color1) {
+            return .{ color0, color1, mix(color0, color1, 2, 1), mix(color0, color1, 1, 2) };
+        }
+        return .{ color0, color1, mix(color0, color1, 1, 1), 0 };
+    }
+
+    // Channels are compared on a common 8-bit scale
+    fn channels(pixel: u16) [3]f32 {
+        return .{
+            @floatFromInt(@as(u32, pixel >> 11) * 8),
+            @floatFromInt(@as(u32, (pixel >> 5) & 0x3F) * 4),
+            @floatFromInt(@as(u32, pixel & 0x1F) * 8),
+        };
+    }
+
+    fn quantize(value: f32, comptime scale: f32, comptime max: f32) u16 {
+        return @intFromFloat(std.math.clamp(@round(value / scale), 0, max));
+    }
+
+    fn pack(rgb: [3]f32) u16 {
+        return (quantize(rgb[0], 8, 31) << 11) | (quantize(rgb[1], 4, 63) << 5) | quantize(rgb[2], 8, 31);
+    }
+
+    /// Endpoints at the extremes of the block's principal axis, indices by
+    /// nearest palette entry. All 16 pixels are handled as one vector per
+    /// channel.
+    fn encodeBlock(rgb565: []const u8, bx: usize, by: usize, out: *[block_size]u8) void {
+        var lanes: [3][16]f32 = undefined;
+        for (0..16) |i| {
+            const x = bx * block_dim + i % block_dim;
+            const y = by * block_dim + i / block_dim;
+            const offset = (y * ImageSize.width + x) * ImageSize.bytes_per_pixel;
+            const rgb = channels(std.mem.readInt(u16, rgb565[offset..][0..2], .little));
+            for (0..3) |c| lanes[c][i] = rgb[c];
+        }
+        const v = [3]Vec{ lanes[0], lanes[1], lanes[2] };
+
+        var mean: [3]f32 = undefined;
+        var centered: [3]Vec = undefined;
+        for (0..3) |c| {
+            mean[c] = @reduce(.Add, v[c]) / 16;
+            centered[c] = v[c] - @as(Vec, @splat(mean[c]));
+        }
+
+        // Principal axis by a few rounds of power iteration on the covariance
+        var cov: [3][3]f32 = undefined;
+        for (0..3) |i| {
+            for (0..3) |j| cov[i][j] = @reduce(.Add, centered[i] * centered[j]);
+        }
+        var axis = [3]f32{ 1, 1, 1 };
+        var flat = false;
+        for (0..4) |_| {
+            var next: [3]f32 = undefined;
+            for (0..3) |i| next[i] = cov[i][0] * axis[0] + cov[i][1] * axis[1] + cov[i][2] * axis[2];
+            const norm = @sqrt(next[0] * next[0] + next[1] * next[1] + next[2] * next[2]);
+            if (norm < 1e-6) {
+                flat = true;
+                break;
+            }
+            for (0..3) |i| axis[i] = next[i] / norm;
+        }
+
+        var color0 = pack(mean);
+        var color1 = color0;
+        if (!flat) {
+            const t = centered[0] * @as(Vec, @splat(axis[0])) +
+                centered[1] * @as(Vec, @splat(axis[1])) +
+                centered[2] * @as(Vec, @splat(axis[2]));
+            const t_max = @reduce(.Max, t);
+            const t_min = @reduce(.Min, t);
+            var high: [3]f32 = undefined;
+            var low: [3]f32 = undefined;
+            for (0..3) |c| {
+                high[c] = mean[c] + axis[c] * t_max;
+                low[c] = mean[c] + axis[c] * t_min;
+            }
+            color0 = pack(high);
+            color1 = pack(low);
+        }
+
+        // Four-colour mode needs color0 > color1; equal endpoints just use index 0
+        if (color0 < color1) std.mem.swap(u16, &color0, &color1);
+        const colors = palette(color0, color1);
+
+        var best_error: Vec = @splat(std.math.inf(f32));
+        var best: @Vector(16, u32) = @splat(0);
+        const entries: usize = if (color0 > color1) 4 else 1;
+        for (0..entries) |p| {
+            const rgb = channels(colors[p]);
+            var err: Vec = @splat(0);
+            for (0..3) |c| {
+                const d = v[c] - @as(Vec, @splat(rgb[c]));
+                err += d * d;
+            }
+            const closer = err < best_error;
+            best_error = @select(f32, closer, err, best_error);
+            best = @select(u32, closer, @as(@Vector(16, u32), @splat(@intCast(p))), best);
+        }
+
+        var indices: u32 = 0;
+        const best_array: [16]u32 = best;
+        for (best_array, 0..) |index, i| indices |= index << @intCast(2 * i);
+
+        std.mem.writeInt(u16, out[0..2], color0, .little);
+        std.mem.writeInt(u16, out[2..4], color1, .little);
+        std.mem.writeInt(u32, out[4..8], indices, .little);
+    }
+
+    fn encodeRows(rgb565: []const u8, out: []u8, first: usize, last: usize) void {
+        for (first..last) |by| {
+            for (0..blocks_per_row) |bx| {
+                const offset = (by * blocks_per_row + bx) * block_size;
+                encodeBlock(rgb565, bx, by, out[offset..][0..block_size]);
+            }
+        }
+    }
+};
+
+/// Compress an RGB565 frame to exactly a quarter of its size. Block rows are
+/// split across up to Bc1.max_threads threads.
+pub fn encodeBC1(allocator: std.mem.Allocator, rgb565: []const u8) ![]u8 {
+    if (rgb565.len != ImageSize.total_bytes) {
+        return error.InvalidInputSize;
+    }
+
+    const out = try allocator.alloc(u8, Bc1.encoded_size);
+    errdefer allocator.free(out);
+
+    const cpus = std.Thread.getCpuCount() catch 1;
+    const workers = std.math.clamp(cpus, 1, Bc1.max_threads);
+    const rows_per_worker = (Bc1.block_rows + workers - 1) / workers;
+
+    var threads: [Bc1.max_threads]?std.Thread = [_]?std.Thread{null} ** Bc1.max_threads;
+    for (1..workers) |w| {
+        const first = w * rows_per_worker;
+        if (first >= Bc1.block_rows) break;
+        const last = @min(first + rows_per_worker, Bc1.block_rows);
+        // If a thread can't be had, do its rows here instead
+        threads[w] = std.Thread.spawn(.{}, Bc1.encodeRows, .{ rgb565, out, first, last }) catch blk: {
+            Bc1.encodeRows(rgb565, out, first, last);
+            break :blk null;
+        };
+    }
+    Bc1.encodeRows(rgb565, out, 0, @min(rows_per_worker, Bc1.block_rows));
+
+    for (threads) |thread| {
+        if (thread) |t| t.join();
+    }
+    return out;
+}
+
+/// Expand a BC1 stream into an RGB565 frame, as the device does
+pub fn decodeBC1(stream: []const u8, frame: []u8) !void {
+    if (stream.len != Bc1.encoded_size or frame.len != ImageSize.total_bytes) {
+        return error.InvalidInputSize;
+    }
+
+    for (0..Bc1.block_rows) |by| {
+        for (0..Bc1.blocks_per_row) |bx| {
+            const block = stream[(by * Bc1.blocks_per_row + bx) * Bc1.block_size ..][0..Bc1.block_size];
+            const colors = Bc1.palette(
+                std.mem.readInt(u16, block[0..2], .little),
+                std.mem.readInt(u16, block[2..4], .little),
+            );
+            var indices = std.mem.readInt(u32, block[4..8], .little);
+            for (0..16) |i| {
+                const x = bx * Bc1.block_dim + i % Bc1.block_dim;
+                const y = by * Bc1.block_dim + i / Bc1.block_dim;
+                const offset = (y * ImageSize.width + x) * ImageSize.bytes_per_pixel;
+                std.mem.writeInt(u16, frame[offset..][0..2], colors[indices & 3], .little);
+                indices >>= 2;
+            }
+        }
+    }
+}
+
+test "BC1 palette matches the firmware decoder" {
+    // Same values as test_four_colour_block in test/protocol/test_transfer_bc1.c
+    const colors = Bc1.palette(0xFFFF, 0x0000);
+    try std.testing.expectEqual(@as(u16, (21 << 11) | (42 << 5) | 21), colors[2]);
+    try std.testing.expectEqual(@as(u16, (10 << 11) | (21 << 5) | 10), colors[3]);
+}
+
+test "BC1 is a quarter size and close on smooth images" {
+    const allocator = std.testing.allocator;
+    const frame = try allocator.alloc(u8, ImageSize.total_bytes);
+    defer allocator.free(frame);
+    for (0..ImageSize.pixels) |i| {
+        const x = i % ImageSize.width;
+        const y = i / ImageSize.width;
+        const pixel: u16 = @intCast(((x * 31 / 239) << 11) | ((y * 63 / 239) << 5) | ((x + y) * 31 / 478));
+        std.mem.writeInt(u16, frame[i * 2 ..][0..2], pixel, .little);
+    }
+
+    const stream = try encodeBC1(allocator, frame);
+    defer allocator.free(stream);
+    try std.testing.expectEqual(ImageSize.total_bytes / 4, stream.len);
+
+    // Threaded output is identical to a single pass
+    const single = try allocator.alloc(u8, Bc1.encoded_size);
+    defer allocator.free(single);
+    Bc1.encodeRows(frame, single, 0, Bc1.block_rows);
+    try std.testing.expectEqualSlices(u8, single, stream);
+
+    const decoded = try allocator.alloc(u8, ImageSize.total_bytes);
+    defer allocator.free(decoded);
+    try decodeBC1(stream, decoded);
+
+    var total_error: u64 = 0;
+    for (0..ImageSize.pixels) |i| {
+        const a = std.mem.readInt(u16, frame[i * 2 ..][0..2], .little);
+        const b = std.mem.readInt(u16, decoded[i * 2 ..][0..2], .little);
+        total_error += @abs(@as(i32, a >> 11) - @as(i32, b >> 11));
+        total_error += @abs(@as(i32, (a >> 5) & 0x3F) - @as(i32, (b >> 5) & 0x3F));
+        total_error += @abs(@as(i32, a & 0x1F) - @as(i32, b & 0x1F));
+    }
+    // Under one step per channel on average
+    try std.testing.expect(total_error < ImageSize.pixels * 3);
+}
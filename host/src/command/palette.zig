@@ -0,0 +1,436 @@
+const std = @import("std");
+const ImageSize = @import("image.zig").ImageSize;
+
+// Indexed-colour frames: a palette of up to 256 RGB565 colours and one
+// 2, 4 or 8-bit index per pixel. On the wire:
+//   bits (u8), colors - 1 (u8), colors u16 LE entries, packed indices
+// Indices are packed from the low bits of each byte up. The device keeps
+// the indices after the transfer, so a palette-only update recolours the
+// screen for a few hundred bytes. Must match src/codec/palette.h.
+
+pub const HEADER_SIZE: usize = 2;
+pub const ENTRY_SIZE: usize = 2;
+pub const MAX_COLORS: usize = 256;
+
+// Where the last indexed stream sent to the device is kept between runs
+pub const cache_path = ".deskthang_last_indexed";
+
+const color_space: usize = 1 << 16;
+const no_index: u16 = 0xFFFF;
+
+pub const Indexed = struct {
+    palette: []u16,
+    indices: []u8, // One per pixel, unpacked
+
+    pub fn deinit(self: Indexed, allocator: std.mem.Allocator) void {
+        allocator.free(self.palette);
+        allocator.free(self.indices);
+    }
+
+    /// Smallest depth the device accepts that holds every palette entry
+    pub fn bits(self: Indexed) u8 {
+        if (self.palette.len <= 4) return 2;
+        if (self.palette.len <= 16) return 4;
+        return 8;
+    }
+
+    /// Bytes the frame costs on the wire
+    pub fn streamSize(self: Indexed) usize {
+        return HEADER_SIZE + self.palette.len * ENTRY_SIZE + self.indices.len * self.bits() / 8;
+    }
+};
+
+fn pixelAt(frame: []const u8, pixel: usize) u16 {
+    return std.mem.readInt(u16, frame[pixel * 2 ..][0..2], .little);
+}
+
+/// The frame's own colours in order of first appearance, or null if it has
+/// more than MAX_COLORS of them. Lossless.
+pub fn exact(allocator: std.mem.Allocator, frame: []const u8) !?Indexed {
+    const lookup = try allocator.alloc(u16, color_space);
+    defer allocator.free(lookup);
+    @memset(lookup, no_index);
+
+    var palette = std.ArrayList(u16).init(allocator);
+    errdefer palette.deinit();
+    const indices = try allocator.alloc(u8, ImageSize.pixels);
+    errdefer allocator.free(indices);
+
+    for (indices, 0..) |*index, pixel| {
+        const color = pixelAt(frame, pixel);
+        if (lookup[color] == no_index) {
+            if (palette.items.len == MAX_COLORS) {
+                palette.deinit();
+                allocator.free(indices);
+                return null;
+            }
+            lookup[color] = @intCast(palette.items.len);
+            try palette.append(color);
+        }
+        index.* = @intCast(lookup[color]);
+    }
+
+    return Indexed{ .palette = try palette.toOwnedSlice(), .indices = indices };
+}
+
+// Median cut works on the distinct colours of the frame, weighted by how
+// many pixels use them
+const Weighted = struct {
+    color: u16,
+    count: u32,
+};
+
+const Channel = enum { red, green, blue };
+
+// Channel value on a common 6-bit scale
+fn channel(color: u16, which: Channel) u8 {
+    return switch (which) {
+        .red => @intCast((color >> 11) << 1),
+        .green => @intCast((color >> 5) & 0x3F),
+        .blue => @intCast((color & 0x1F) << 1),
+    };
+}
+
+const Box = struct {
+    start: usize,
+    end: usize,
+
+    fn range(self: Box, colors: []const Weighted, which: Channel) u8 {
+        var low: u8 = 0xFF;
+        var high: u8 = 0;
+        for (colors[self.start..self.end]) |entry| {
+            low = @min(low, channel(entry.color, which));
+            high = @max(high, channel(entry.color, which));
+        }
+        return high - low;
+    }
+
+    fn widest(self: Box, colors: []const Weighted) struct { which: Channel, range: u8 } {
+        var best = Channel.red;
+        var best_range: u8 = 0;
+        for ([_]Channel{ .red, .green, .blue }) |which| {
+            const r = self.range(colors, which);
+            if (r > best_range) {
+                best = which;
+                best_range = r;
+            }
+        }
+        return .{ .which = best, .range = best_range };
+    }
+
+    /// Pixel-weighted mean colour
+    fn mean(self: Box, colors: []const Weighted) u16 {
+        var r: u64 = 0;
+        var g: u64 = 0;
+        var b: u64 = 0;
+        var total: u64 = 0;
+        for (colors[self.start..self.end]) |entry| {
+            r += @as(u64, entry.color >> 11) * entry.count;
+            g += @as(u64, (entry.color >> 5) & 0x3F) * entry.count;
+            b += @as(u64, entry.color & 0x1F) * entry.count;
+            total += entry.count;
+        }
+        return @intCast(((r + total / 2) / total) << 11 | ((g + total / 2) / total) << 5 | ((b + total / 2) / total));
+    }
+};
+
+fn lessOnChannel(which: Channel, a: Weighted, b: Weighted) bool {
+    return channel(a.color, which) < channel(b.color, which);
+}
+
+/// Reduce the frame to at most max_colors colours by median cut. Frames that
+/// already fit come back exact.
+pub fn quantize(allocator: std.mem.Allocator, frame: []const u8, max_colors: usize) !Indexed {
+    std.debug.assert(max_colors >= 1 and max_colors <= MAX_COLORS);
+
+    const histogram = try allocator.alloc(u32, color_space);
+    defer allocator.free(histogram);
+    @memset(histogram, 0);
+    for (0..ImageSize.pixels) |pixel| histogram[pixelAt(frame, pixel)] += 1;
+
+    var distinct = std.ArrayList(Weighted).init(allocator);
+    defer distinct.deinit();
+    for (histogram, 0..) |count, color| {
+        if (count > 0) try distinct.append(.{ .color = @intCast(color), .count = count });
+    }
+    const colors = distinct.items;
+
+    var boxes = std.ArrayList(Box).init(allocator);
+    defer boxes.deinit();
+    try boxes.append(.{ .start = 0, .end = colors.len });
+
+    // Split the box with the widest channel at its pixel median until there
+    // are enough boxes or none can be split
+    while (boxes.items.len < max_colors) {
+        var split: ?usize = null;
+        var split_range: u8 = 0;
+        for (boxes.items, 0..) |box, i| {
+            if (box.end - box.start < 2) continue;
+            const r = box.widest(colors).range;
+            if (r > split_range) {
+                split = i;
+                split_range = r;
+            }
+        }
+        const i = split orelse break;
+        const box = boxes.items[i];
+        const which = box.widest(colors).which;
+        std.mem.sort(Weighted, colors[box.start..box.end], which, lessOnChannel);
+
+        var half: u64 = 0;
+        for (colors[box.start..box.end]) |entry| half += entry.count;
+        half /= 2;
+
+        // Both halves keep at least one colour
+        var median = box.start + 1;
+        var below: u64 = colors[box.start].count;
+        while (median < box.end - 1 and below < half) : (median += 1) {
+            below += colors[median].count;
+        }
+
+        boxes.items[i].end = median;
+        try boxes.append(.{ .start = median, .end = box.end });
+    }
+
+    const palette = try allocator.alloc(u16, boxes.items.len);
+    errdefer allocator.free(palette);
+    const lookup = try allocator.alloc(u8, color_space);
+    defer allocator.free(lookup);
+    for (boxes.items, 0..) |box, i| {
+        palette[i] = box.mean(colors);
+        for (colors[box.start..box.end]) |entry| lookup[entry.color] = @intCast(i);
+    }
+
+    const indices = try allocator.alloc(u8, ImageSize.pixels);
+    for (indices, 0..) |*index, pixel| index.* = lookup[pixelAt(frame, pixel)];
+    return Indexed{ .palette = palette, .indices = indices };
+}
+
+/// Wire stream for an indexed frame
+pub fn encode(allocator: std.mem.Allocator, indexed: Indexed) ![]u8 {
+    const bits = indexed.bits();
+    const per_byte = 8 / bits;
+    const stream = try allocator.alloc(u8, indexed.streamSize());
+
+    stream[0] = bits;
+    stream[1] = @intCast(indexed.palette.len - 1);
+    var offset: usize = HEADER_SIZE;
+    for (indexed.palette) |color| {
+        std.mem.writeInt(u16, stream[offset..][0..2], color, .little);
+        offset += ENTRY_SIZE;
+    }
+
+    var pixel: usize = 0;
+    while (pixel < indexed.indices.len) : (pixel += per_byte) {
+        var packed_byte: u8 = 0;
+        for (0..per_byte) |i| {
+            packed_byte |= indexed.indices[pixel + i] << @intCast(i * bits);
+        }
+        stream[offset] = packed_byte;
+        offset += 1;
+    }
+    return stream;
+}
+
+/// Inverse of encode, as the device does it
+pub fn decode(allocator: std.mem.Allocator, stream: []const u8) !Indexed {
+    if (stream.len < HEADER_SIZE) return error.InvalidStream;
+    const bits = stream[0];
+    const colors = @as(usize, stream[1]) + 1;
+    if ((bits != 2 and bits != 4 and bits != 8) or colors > (@as(usize, 1) << @intCast(bits))) {
+        return error.InvalidStream;
+    }
+    const palette_end = HEADER_SIZE + colors * ENTRY_SIZE;
+    if (stream.len != palette_end + ImageSize.pixels * bits / 8) return error.InvalidStream;
+
+    const palette = try allocator.alloc(u16, colors);
+    errdefer allocator.free(palette);
+    for (palette, 0..) |*color, i| {
+        color.* = std.mem.readInt(u16, stream[HEADER_SIZE + i * ENTRY_SIZE ..][0..2], .little);
+    }
+
+    const indices = try allocator.alloc(u8, ImageSize.pixels);
+    const per_byte = 8 / bits;
+    const mask: u8 = @intCast((@as(u16, 1) << @intCast(bits)) - 1);
+    for (indices, 0..) |*index, pixel| {
+        const shift: u3 = @intCast((pixel % per_byte) * bits);
+        index.* = (stream[palette_end + pixel / per_byte] >> shift) & mask;
+    }
+    return Indexed{ .palette = palette, .indices = indices };
+}
+
+/// RGB565 frame the indexed frame shows
+pub fn render(indexed: Indexed, frame: []u8) void {
+    for (indexed.indices, 0..) |index, pixel| {
+        std.mem.writeInt(u16, frame[pixel * 2 ..][0..2], indexed.palette[index], .little);
+    }
+}
+
+/// A palette-only update: count entries replacing the device's from first
+pub const Recolor = struct {
+    first: u8,
+    entries: []const u16,
+
+    /// Command arguments: first, count - 1, then the entries LE
+    pub fn args(self: Recolor, out: []u8) []u8 {
+        out[0] = self.first;
+        out[1] = @intCast(self.entries.len - 1);
+        for (self.entries, 0..) |color, i| {
+            std.mem.writeInt(u16, out[HEADER_SIZE + i * ENTRY_SIZE ..][0..2], color, .little);
+        }
+        return out[0 .. HEADER_SIZE + self.entries.len * ENTRY_SIZE];
+    }
+};
+
+/// If frame is last with only its palette changed, the smallest run of
+/// entries that turns one into the other; last.palette is updated to match.
+/// Null when some index would need two colours, or nothing changed.
+pub fn recolor(last: Indexed, frame: []const u8) ?Recolor {
+    var assigned = std.StaticBitSet(MAX_COLORS).initEmpty();
+    var palette: [MAX_COLORS]u16 = undefined;
+    @memcpy(palette[0..last.palette.len], last.palette);
+
+    for (last.indices, 0..) |index, pixel| {
+        const color = pixelAt(frame, pixel);
+        if (assigned.isSet(index)) {
+            if (palette[index] != color) return null;
+        } else {
+            palette[index] = color;
+            assigned.set(index);
+        }
+    }
+
+    var first: ?usize = null;
+    var end: usize = 0;
+    for (last.palette, 0..) |color, i| {
+        if (palette[i] != color) {
+            if (first == null) first = i;
+            end = i + 1;
+        }
+    }
+    const start = first orelse return null;
+    @memcpy(last.palette[start..end], palette[start..end]);
+    return Recolor{ .first = @intCast(start), .entries = last.palette[start..end] };
+}
+
+/// Last indexed stream sent to the device, or null if the panel shows
+/// something else
+pub fn loadLast(allocator: std.mem.Allocator) ?Indexed {
+    const stream = std.fs.cwd().readFileAlloc(allocator, cache_path, HEADER_SIZE + MAX_COLORS * ENTRY_SIZE + ImageSize.pixels + 1) catch return null;
+    defer allocator.free(stream);
+    return decode(allocator, stream) catch null;
+}
+
+pub fn saveLast(stream: []const u8) !void {
+    try std.fs.cwd().writeFile(.{ .sub_path = cache_path, .data = stream });
+}
+
+pub fn forgetLast() void {
+    std.fs.cwd().deleteFile(cache_path) catch {};
+}
+
+fn testFrame(allocator: std.mem.Allocator, colors: u16) ![]u8 {
+    const frame = try allocator.alloc(u8, ImageSize.total_bytes);
+    for (0..ImageSize.pixels) |pixel| {
+        const x = pixel % ImageSize.width;
+        const color: u16 = @intCast(x * colors / ImageSize.width * 0x0841);
+        std.mem.writeInt(u16, frame[pixel * 2 ..][0..2], color, .little);
+    }
+    return frame;
+}
+
+test "few-colour frame round trips exactly at the smallest depth" {
+    const allocator = std.testing.allocator;
+    const frame = try testFrame(allocator, 12);
+    defer allocator.free(frame);
+
+    const indexed = (try exact(allocator, frame)).?;
+    defer indexed.deinit(allocator);
+    try std.testing.expectEqual(@as(u8, 4), indexed.bits());
+
+    const stream = try encode(allocator, indexed);
+    defer allocator.free(stream);
+    try std.testing.expectEqual(HEADER_SIZE + 12 * ENTRY_SIZE + ImageSize.pixels / 2, stream.len);
+
+    const decoded = try decode(allocator, stream);
+    defer decoded.deinit(allocator);
+    const shown = try allocator.alloc(u8, ImageSize.total_bytes);
+    defer allocator.free(shown);
+    render(decoded, shown);
+    try std.testing.expectEqualSlices(u8, frame, shown);
+}
+
+test "too many colours for an exact palette" {
+    const allocator = std.testing.allocator;
+    const frame = try allocator.alloc(u8, ImageSize.total_bytes);
+    defer allocator.free(frame);
+    for (0..ImageSize.pixels) |pixel| {
+        std.mem.writeInt(u16, frame[pixel * 2 ..][0..2], @intCast(pixel % 1000), .little);
+    }
+    try std.testing.expect((try exact(allocator, frame)) == null);
+
+    const indexed = try quantize(allocator, frame, 16);
+    defer indexed.deinit(allocator);
+    try std.testing.expectEqual(@as(usize, 16), indexed.palette.len);
+}
+
+test "median cut separates distinct clusters" {
+    const allocator = std.testing.allocator;
+    const frame = try allocator.alloc(u8, ImageSize.total_bytes);
+    defer allocator.free(frame);
+
+    // Four clusters of near-identical colours
+    const centres = [_]u16{ 0xF800, 0x07E0, 0x001F, 0xFFFF };
+    for (0..ImageSize.pixels) |pixel| {
+        const centre = centres[pixel % centres.len];
+        const jitter: u16 = @intCast(pixel / centres.len % 2);
+        std.mem.writeInt(u16, frame[pixel * 2 ..][0..2], centre ^ jitter, .little);
+    }
+
+    const indexed = try quantize(allocator, frame, 4);
+    defer indexed.deinit(allocator);
+    for (0..centres.len) |pixel| {
+        const got = indexed.palette[indexed.indices[pixel]];
+        try std.testing.expect(got & 0xFFFE == centres[pixel] & 0xFFFE);
+    }
+}
+
+test "palette-only change is found" {
+    const allocator = std.testing.allocator;
+    const frame = try testFrame(allocator, 12);
+    defer allocator.free(frame);
+    const last = (try exact(allocator, frame)).?;
+    defer last.deinit(allocator);
+
+    // Swap the colour of entries 3 and 5
+    const third = last.palette[3];
+    const fifth = last.palette[5];
+    for (0..ImageSize.pixels) |pixel| {
+        const color = pixelAt(frame, pixel);
+        const swapped = if (color == third) fifth else if (color == fifth) third else color;
+        std.mem.writeInt(u16, frame[pixel * 2 ..][0..2], swapped, .little);
+    }
+
+    const update = recolor(last, frame).?;
+    try std.testing.expectEqual(@as(u8, 3), update.first);
+    try std.testing.expectEqual(@as(usize, 3), update.entries.len);
+
+    const shown = try allocator.alloc(u8, ImageSize.total_bytes);
+    defer allocator.free(shown);
+    render(last, shown);
+    try std.testing.expectEqualSlices(u8, frame, shown);
+}
+
+test "moved pixels are not a recolour" {
+    const allocator = std.testing.allocator;
+    const frame = try testFrame(allocator, 12);
+    defer allocator.free(frame);
+    const last = (try exact(allocator, frame)).?;
+    defer last.deinit(allocator);
+
+    try std.testing.expect(recolor(last, frame) == null);
+
+    // One pixel takes another entry's colour
+    std.mem.writeInt(u16, frame[0..2], last.palette[7], .little);
+    try std.testing.expect(recolor(last, frame) == null);
+}
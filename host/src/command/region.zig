@@ -0,0 +1,336 @@
+const std = @import("std");
+const ImageSize = @import("image.zig").ImageSize;
+
+// Region updates: diff a frame against the one last sent and ship only the
+// rectangles that changed. Each region goes over the wire as an 8-byte
+// header (x, y, width, height as LE u16) followed by its RGB565 rows.
+
+pub const HEADER_SIZE: usize = 8;
+pub const MAX_REGIONS: usize = 64; // Must match TRANSFER_REGION_MAX_COUNT on the device
+pub const TILE_SIZE: usize = 8; // Dirty detection granularity in pixels
+
+// Where the last frame sent to the device is kept between runs
+pub const cache_path = ".deskthang_last_frame";
+
+const tiles_x = ImageSize.width / TILE_SIZE;
+const tiles_y = ImageSize.height / TILE_SIZE;
+
+pub const Rect = struct {
+    x: u16,
+    y: u16,
+    width: u16,
+    height: u16,
+
+    pub const full = Rect{ .x = 0, .y = 0, .width = ImageSize.width, .height = ImageSize.height };
+
+    /// Bytes this rectangle costs on the wire, header included
+    pub fn cost(self: Rect) usize {
+        return HEADER_SIZE + @as(usize, self.width) * self.height * ImageSize.bytes_per_pixel;
+    }
+
+    pub fn merge(a: Rect, b: Rect) Rect {
+        const x0 = @min(a.x, b.x);
+        const y0 = @min(a.y, b.y);
+        const x1 = @max(a.x + a.width, b.x + b.width);
+        const y1 = @max(a.y + a.height, b.y + b.height);
+        return Rect{ .x = x0, .y = y0, .width = x1 - x0, .height = y1 - y0 };
+    }
+};
+
+/// Bytes a set of regions costs on the wire
+pub fn totalCost(rects: []const Rect) usize {
+    var total: usize = 0;
+    for (rects) |rect| total += rect.cost();
+    return total;
+}
+
+fn pixelChanged(previous: []const u8, current: []const u8, x: usize, y: usize) bool {
+    const offset = (y * ImageSize.width + x) * ImageSize.bytes_per_pixel;
+    return previous[offset] != current[offset] or previous[offset + 1] != current[offset + 1];
+}
+
+fn tileDirty(previous: []const u8, current: []const u8, tx: usize, ty: usize) bool {
+    var y = ty * TILE_SIZE;
+    while (y < (ty + 1) * TILE_SIZE) : (y += 1) {
+        const start = (y * ImageSize.width + tx * TILE_SIZE) * ImageSize.bytes_per_pixel;
+        const end = start + TILE_SIZE * ImageSize.bytes_per_pixel;
+        if (!std.mem.eql(u8, previous[start..end], current[start..end])) return true;
+    }
+    return false;
+}
+
+/// Shrink a rectangle to the bounding box of the pixels that changed in it
+fn tighten(previous: []const u8, current: []const u8, rect: Rect) Rect {
+    var x0: usize = rect.x + rect.width;
+    var y0: usize = rect.y + rect.height;
+    var x1: usize = rect.x;
+    var y1: usize = rect.y;
+
+    var y: usize = rect.y;
+    while (y < rect.y + rect.height) : (y += 1) {
+        var x: usize = rect.x;
+        while (x < rect.x + rect.width) : (x += 1) {
+            if (pixelChanged(previous, current, x, y)) {
+                x0 = @min(x0, x);
+                y0 = @min(y0, y);
+                x1 = @max(x1, x + 1);
+                y1 = @max(y1, y + 1);
+            }
+        }
+    }
+    return Rect{ .x = @intCast(x0), .y = @intCast(y0), .width = @intCast(x1 - x0), .height = @intCast(y1 - y0) };
+}
+
+/// Merge the pair whose union costs the least extra. Returns false when no
+/// merge pays for itself and the count is already within limit.
+fn mergeCheapestPair(rects: *std.ArrayList(Rect), limit: usize) bool {
+    var best_i: usize = 0;
+    var best_j: usize = 0;
+    var best_extra: isize = std.math.maxInt(isize);
+
+    for (rects.items, 0..) |a, i| {
+        for (rects.items[i + 1 ..], i + 1..) |b, j| {
+            const extra = @as(isize, @intCast(Rect.merge(a, b).cost())) -
+                @as(isize, @intCast(a.cost() + b.cost()));
+            if (extra < best_extra) {
+                best_extra = extra;
+                best_i = i;
+                best_j = j;
+            }
+        }
+    }
+
+    if (best_extra > 0 and rects.items.len <= limit) return false;
+
+    rects.items[best_i] = Rect.merge(rects.items[best_i], rects.items[best_j]);
+    _ = rects.swapRemove(best_j);
+    return true;
+}
+
+/// Rectangles covering every pixel that differs between two RGB565 frames.
+/// Dirty tiles are grown into rectangles, tightened to the changed pixels,
+/// then merged wherever that saves header bytes or the count is over
+/// MAX_REGIONS. Empty when the frames match; a single full-frame rectangle
+/// when the regions would cost more than the frame itself.
+pub fn diff(allocator: std.mem.Allocator, previous: []const u8, current: []const u8) ![]Rect {
+    if (previous.len != ImageSize.total_bytes or current.len != ImageSize.total_bytes) {
+        return error.InvalidInputSize;
+    }
+
+    var rects = std.ArrayList(Rect).init(allocator);
+    errdefer rects.deinit();
+
+    // Runs of dirty tiles per tile row; a run with the same span as one
+    // ending on the row above extends it downwards
+    var open = std.ArrayList(usize).init(allocator);
+    defer open.deinit();
+
+    var ty: usize = 0;
+    while (ty < tiles_y) : (ty += 1) {
+        var still_open = std.ArrayList(usize).init(allocator);
+        defer still_open.deinit();
+
+        var tx: usize = 0;
+        while (tx < tiles_x) {
+            if (!tileDirty(previous, current, tx, ty)) {
+                tx += 1;
+                continue;
+            }
+            const run_start = tx;
+            while (tx < tiles_x and tileDirty(previous, current, tx, ty)) tx += 1;
+
+            const x: u16 = @intCast(run_start * TILE_SIZE);
+            const width: u16 = @intCast((tx - run_start) * TILE_SIZE);
+
+            var extended = false;
+            for (open.items) |index| {
+                const rect = &rects.items[index];
+                if (rect.x == x and rect.width == width) {
+                    rect.height += TILE_SIZE;
+                    try still_open.append(index);
+                    extended = true;
+                    break;
+                }
+            }
+            if (!extended) {
+                try rects.append(Rect{ .x = x, .y = @intCast(ty * TILE_SIZE), .width = width, .height = TILE_SIZE });
+                try still_open.append(rects.items.len - 1);
+            }
+        }
+
+        open.clearRetainingCapacity();
+        try open.appendSlice(still_open.items);
+    }
+
+    for (rects.items) |*rect| rect.* = tighten(previous, current, rect.*);
+
+    while (rects.items.len > 1 and mergeCheapestPair(&rects, MAX_REGIONS)) {}
+
+    if (totalCost(rects.items) >= Rect.full.cost()) {
+        rects.clearRetainingCapacity();
+        try rects.append(Rect.full);
+    }
+
+    return rects.toOwnedSlice();
+}
+
+/// Wire form of a region update: each header followed by its pixel rows
+pub fn encode(allocator: std.mem.Allocator, frame: []const u8, rects: []const Rect) ![]u8 {
+    if (frame.len != ImageSize.total_bytes) {
+        return error.InvalidInputSize;
+    }
+
+    const stream = try allocator.alloc(u8, totalCost(rects));
+    errdefer allocator.free(stream);
+
+    var offset: usize = 0;
+    for (rects) |rect| {
+        std.mem.writeInt(u16, stream[offset..][0..2], rect.x, .little);
+        std.mem.writeInt(u16, stream[offset + 2 ..][0..2], rect.y, .little);
+        std.mem.writeInt(u16, stream[offset + 4 ..][0..2], rect.width, .little);
+        std.mem.writeInt(u16, stream[offset + 6 ..][0..2], rect.height, .little);
+        offset += HEADER_SIZE;
+
+        const row_bytes = @as(usize, rect.width) * ImageSize.bytes_per_pixel;
+        var y: usize = rect.y;
+        while (y < rect.y + rect.height) : (y += 1) {
+            const start = (y * ImageSize.width + rect.x) * ImageSize.bytes_per_pixel;
+            @memcpy(stream[offset..][0..row_bytes], frame[start..][0..row_bytes]);
+            offset += row_bytes;
+        }
+    }
+
+    return stream;
+}
+
+/// Last frame sent to the device, or null if there isn't a usable one
+pub fn loadLastFrame(allocator: std.mem.Allocator) ?[]u8 {
+    const frame = std.fs.cwd().readFileAlloc(allocator, cache_path, ImageSize.total_bytes + 1) catch return null;
+    if (frame.len != ImageSize.total_bytes) {
+        allocator.free(frame);
+        return null;
+    }
+    return frame;
+}
+
+pub fn saveLastFrame(frame: []const u8) !void {
+    try std.fs.cwd().writeFile(.{ .sub_path = cache_path, .data = frame });
+}
+
+/// The panel no longer shows the cached frame (test pattern, failed transfer)
+pub fn forgetLastFrame() void {
+    std.fs.cwd().deleteFile(cache_path) catch {};
+}
+
+fn setPixel(frame: []u8, x: usize, y: usize, value: u16) void {
+    const offset = (y * ImageSize.width + x) * ImageSize.bytes_per_pixel;
+    std.mem.writeInt(u16, frame[offset..][0..2], value, .little);
+}
+
+test "identical frames need no regions" {
+    const frame = try std.testing.allocator.alloc(u8, ImageSize.total_bytes);
+    defer std.testing.allocator.free(frame);
+    @memset(frame, 0x5A);
+
+    const rects = try diff(std.testing.allocator, frame, frame);
+    defer std.testing.allocator.free(rects);
+    try std.testing.expectEqual(@as(usize, 0), rects.len);
+}
+
+test "small change becomes one tight rectangle" {
+    const allocator = std.testing.allocator;
+    const previous = try allocator.alloc(u8, ImageSize.total_bytes);
+    defer allocator.free(previous);
+    const current = try allocator.alloc(u8, ImageSize.total_bytes);
+    defer allocator.free(current);
+    @memset(previous, 0);
+    @memset(current, 0);
+
+    // A 10x14 "digit" that straddles tile boundaries
+    var y: usize = 101;
+    while (y < 115) : (y += 1) {
+        var x: usize = 60;
+        while (x < 70) : (x += 1) setPixel(current, x, y, 0xFFFF);
+    }
+
+    const rects = try diff(allocator, previous, current);
+    defer allocator.free(rects);
+    try std.testing.expectEqual(@as(usize, 1), rects.len);
+    try std.testing.expectEqual(Rect{ .x = 60, .y = 101, .width = 10, .height = 14 }, rects[0]);
+    try std.testing.expect(totalCost(rects) * 100 < ImageSize.total_bytes);
+}
+
+test "distant changes stay separate and applying them reproduces the frame" {
+    const allocator = std.testing.allocator;
+    const previous = try allocator.alloc(u8, ImageSize.total_bytes);
+    defer allocator.free(previous);
+    const current = try allocator.alloc(u8, ImageSize.total_bytes);
+    defer allocator.free(current);
+    @memset(previous, 0x11);
+    @memcpy(current, previous);
+
+    setPixel(current, 3, 4, 0x1234);
+    setPixel(current, 200, 17, 0xBEEF);
+    setPixel(current, 120, 230, 0x0F0F);
+
+    const rects = try diff(allocator, previous, current);
+    defer allocator.free(rects);
+    try std.testing.expectEqual(@as(usize, 3), rects.len);
+
+    // Replay the encoded stream onto the old frame, as the device would
+    const stream = try encode(allocator, current, rects);
+    defer allocator.free(stream);
+    var offset: usize = 0;
+    while (offset < stream.len) {
+        const x = std.mem.readInt(u16, stream[offset..][0..2], .little);
+        const ry = std.mem.readInt(u16, stream[offset + 2 ..][0..2], .little);
+        const width = std.mem.readInt(u16, stream[offset + 4 ..][0..2], .little);
+        const height = std.mem.readInt(u16, stream[offset + 6 ..][0..2], .little);
+        offset += HEADER_SIZE;
+        var row: usize = 0;
+        while (row < height) : (row += 1) {
+            const start = ((ry + row) * ImageSize.width + x) * ImageSize.bytes_per_pixel;
+            const row_bytes = @as(usize, width) * ImageSize.bytes_per_pixel;
+            @memcpy(previous[start..][0..row_bytes], stream[offset..][0..row_bytes]);
+            offset += row_bytes;
+        }
+    }
+    try std.testing.expectEqualSlices(u8, current, previous);
+}
+
+test "full repaint falls back to one frame-sized rectangle" {
+    const allocator = std.testing.allocator;
+    const previous = try allocator.alloc(u8, ImageSize.total_bytes);
+    defer allocator.free(previous);
+    const current = try allocator.alloc(u8, ImageSize.total_bytes);
+    defer allocator.free(current);
+    @memset(previous, 0);
+    @memset(current, 0xFF);
+
+    const rects = try diff(allocator, previous, current);
+    defer allocator.free(rects);
+    try std.testing.expectEqual(@as(usize, 1), rects.len);
+    try std.testing.expectEqual(Rect.full, rects[0]);
+}
+
+test "scattered noise is merged down to the device limit" {
+    const allocator = std.testing.allocator;
+    const previous = try allocator.alloc(u8, ImageSize.total_bytes);
+    defer allocator.free(previous);
+    const current = try allocator.alloc(u8, ImageSize.total_bytes);
+    defer allocator.free(current);
+    @memset(previous, 0);
+    @memset(current, 0);
+
+    // One changed pixel in every other tile
+    var ty: usize = 0;
+    while (ty < tiles_y) : (ty += 2) {
+        var tx: usize = 0;
+        while (tx < tiles_x) : (tx += 2) setPixel(current, tx * TILE_SIZE, ty * TILE_SIZE, 1);
+    }
+
+    const rects = try diff(allocator, previous, current);
+    defer allocator.free(rects);
+    try std.testing.expect(rects.len <= MAX_REGIONS);
+    try std.testing.expect(totalCost(rects) <= Rect.full.cost());
+}
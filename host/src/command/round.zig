@@ -0,0 +1,89 @@
+const std = @import("std");
+const ImageSize = @import("image.zig").ImageSize;
+
+// The GC9A01 is round: row y only shows the pixels whose centre lies inside
+// the 240-pixel circle, (2x - 239)^2 + (2y - 239)^2 <= 240^2. Round frames
+// carry just those pixels, row by row, and the device writes each band of
+// rows with the same span into its own window. Must match
+// src/hardware/panel_span.h.
+
+pub const Span = struct {
+    start: u16,
+    width: u16,
+};
+
+pub const spans: [ImageSize.height]Span = blk: {
+    @setEvalBranchQuota(100_000);
+    var table: [ImageSize.height]Span = undefined;
+    for (&table, 0..) |*span, y| {
+        const dy = 2 * @as(i64, @intCast(y)) - (ImageSize.height - 1);
+        var half: u16 = 0;
+        while (true) : (half += 1) {
+            const dx = 2 * @as(i64, half) + 1;
+            if (dx * dx + dy * dy > @as(i64, ImageSize.width * ImageSize.width)) break;
+        }
+        span.* = .{ .start = @intCast(ImageSize.width / 2 - half), .width = 2 * half };
+    }
+    break :blk table;
+};
+
+pub const visible_pixels: usize = blk: {
+    var total: usize = 0;
+    for (spans) |span| total += span.width;
+    break :blk total;
+};
+
+/// Bytes a round frame costs on the wire
+pub const stream_size: usize = visible_pixels * ImageSize.bytes_per_pixel;
+
+/// The visible pixels of frame, row by row
+pub fn pack(allocator: std.mem.Allocator, frame: []const u8) ![]u8 {
+    const stream = try allocator.alloc(u8, stream_size);
+    var offset: usize = 0;
+    for (spans, 0..) |span, y| {
+        const start = (y * ImageSize.width + span.start) * ImageSize.bytes_per_pixel;
+        const length = @as(usize, span.width) * ImageSize.bytes_per_pixel;
+        @memcpy(stream[offset..][0..length], frame[start..][0..length]);
+        offset += length;
+    }
+    return stream;
+}
+
+/// Black out the corners nobody can see, so they cost nothing to diff or
+/// compress
+pub fn maskCorners(frame: []u8) void {
+    for (spans, 0..) |span, y| {
+        const row = frame[y * ImageSize.width * ImageSize.bytes_per_pixel ..][0 .. ImageSize.width * ImageSize.bytes_per_pixel];
+        @memset(row[0 .. @as(usize, span.start) * ImageSize.bytes_per_pixel], 0);
+        @memset(row[(@as(usize, span.start) + span.width) * ImageSize.bytes_per_pixel ..], 0);
+    }
+}
+
+test "span table matches the firmware" {
+    try std.testing.expectEqual(@as(usize, 45244), visible_pixels);
+    try std.testing.expectEqual(Span{ .start = 109, .width = 22 }, spans[0]);
+    try std.testing.expectEqual(Span{ .start = 0, .width = 240 }, spans[119]);
+    try std.testing.expectEqual(spans[0], spans[ImageSize.height - 1]);
+}
+
+test "round frame is about a fifth smaller" {
+    try std.testing.expect(stream_size * 5 < ImageSize.total_bytes * 4);
+}
+
+test "pack keeps spans and mask clears the rest" {
+    const allocator = std.testing.allocator;
+    const frame = try allocator.alloc(u8, ImageSize.total_bytes);
+    defer allocator.free(frame);
+    @memset(frame, 0xA5);
+
+    const stream = try pack(allocator, frame);
+    defer allocator.free(stream);
+    for (stream) |byte| try std.testing.expectEqual(@as(u8, 0xA5), byte);
+
+    maskCorners(frame);
+    var lit: usize = 0;
+    for (frame) |byte| {
+        if (byte != 0) lit += 1;
+    }
+    try std.testing.expectEqual(stream_size, lit);
+}
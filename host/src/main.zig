@@ -5,9 +5,9 @@ const Serial = protocol.Serial;
 const Logger = protocol.Logger;
 const StateMachine = protocol.StateMachine;
 
-const Command = enum { pattern, image, help, ping, monitor };
+const Command = enum { pattern, image, help, ping, boot, trace, stats, monitor };
 
-const Args = struct { command: Command, value: ?[]const u8, device: []const u8 };
+const Args = struct { command: Command, value: ?[]const u8, device: []const u8, full: bool, lossy: bool, colors: ?usize, raw: bool, watch: bool };
 
 fn printUsage() void {
     std.debug.print(
@@ -16,11 +16,19 @@ fn printUsage() void {
         \\  pattern <pattern>    Display a test pattern (1-9)
         \\  image <file>      Display an image from a PNG file
         \\  ping             Test connection (returns PONG)
-        \\  monitor          Monitor raw serial data
+        \\  boot             Show how long each boot phase took
+        \\  trace [file]     Save the device's trace as Chrome JSON (default: trace.json)
+        \\  stats            Show latency percentiles and traffic counters
+        \\  monitor          Show the device log, decoding binary log records
         \\  help             Show this help message
         \\
         \\Options:
         \\  --device <path>  Serial device path (default: /dev/ttyACM0)
+        \\  --full           Send the whole image instead of only changed regions
+        \\  --lossy          Send the image BC1-compressed (4 bits per pixel)
+        \\  --colors <n>     Reduce the image to n colours (2-256) and send it indexed
+        \\  --raw            With monitor: dump raw serial bytes instead
+        \\  --watch          With stats: redraw every second, over the last second
         \\
     , .{});
 }
@@ -31,7 +39,7 @@ fn parseArgs(args: []const []const u8) !Args {
         return error.InvalidArgs;
     }
 
-    var result = Args{ .command = .help, .value = null, .device = "/dev/ttyACM0" };
+    var result = Args{ .command = .help, .value = null, .device = "/dev/ttyACM0", .full = false, .lossy = false, .colors = null, .raw = false, .watch = false };
 
     const cmd = args[1];
     if (std.mem.eql(u8, cmd, "pattern")) {
@@ -52,6 +60,15 @@ fn parseArgs(args: []const []const u8) !Args {
         result.command = .help;
     } else if (std.mem.eql(u8, cmd, "ping")) {
         result.command = .ping;
+    } else if (std.mem.eql(u8, cmd, "boot")) {
+        result.command = .boot;
+    } else if (std.mem.eql(u8, cmd, "trace")) {
+        result.command = .trace;
+        if (args.len >= 3 and !std.mem.startsWith(u8, args[2], "--")) {
+            result.value = args[2];
+        }
+    } else if (std.mem.eql(u8, cmd, "stats")) {
+        result.command = .stats;
     } else if (std.mem.eql(u8, cmd, "monitor")) {
         result.command = .monitor;
     } else {
@@ -59,16 +76,36 @@ fn parseArgs(args: []const []const u8) !Args {
         return error.InvalidArgs;
     }
 
-    // Check for --device option
+    // Check for options
     var i: usize = 2;
-    while (i < args.len - 1) : (i += 1) {
+    while (i < args.len) : (i += 1) {
         if (std.mem.eql(u8, args[i], "--device")) {
             if (i + 1 >= args.len) {
                 std.debug.print("Error: --device requires a path\n", .{});
                 return error.InvalidArgs;
             }
             result.device = args[i + 1];
-            break;
+            i += 1;
+        } else if (std.mem.eql(u8, args[i], "--full")) {
+            result.full = true;
+        } else if (std.mem.eql(u8, args[i], "--lossy")) {
+            result.lossy = true;
+        } else if (std.mem.eql(u8, args[i], "--raw")) {
+            result.raw = true;
+        } else if (std.mem.eql(u8, args[i], "--watch")) {
+            result.watch = true;
+        } else if (std.mem.eql(u8, args[i], "--colors")) {
+            if (i + 1 >= args.len) {
+                std.debug.print("Error: --colors requires a count\n", .{});
+                return error.InvalidArgs;
+            }
+            const colors = std.fmt.parseInt(usize, args[i + 1], 10) catch 0;
+            if (colors < 2 or colors > 256) {
+                std.debug.print("Error: --colors must be between 2 and 256\n", .{});
+                return error.InvalidArgs;
+            }
+            result.colors = colors;
+            i += 1;
         }
     }
 
@@ -116,12 +153,26 @@ pub fn main() !void {
             try transfer.sendTestPattern(pattern_number);
         },
         .image => {
-            try transfer.sendImage(parsed_args.value.?);
+            try transfer.sendImage(parsed_args.value.?, parsed_args.full, parsed_args.lossy, parsed_args.colors);
         },
         .ping => {
             try transfer.sync();
         },
+        .boot => {
+            try transfer.queryBootTimeline();
+        },
+        .trace => {
+            try transfer.queryTrace(allocator, parsed_args.value orelse "trace.json");
+        },
+        .stats => {
+            try transfer.showStats(parsed_args.watch);
+        },
         .monitor => {
+            if (!parsed_args.raw) {
+                try transfer.monitor();
+                return;
+            }
+
             const stdout = std.io.getStdOut().writer();
             try stdout.print("Monitoring serial data (Ctrl+C to exit)...\n\n", .{});
 
@@ -7,6 +7,13 @@ pub const BASE_TIMEOUT_MS: u64 = 1000;
 pub const MIN_RETRY_DELAY_MS: u64 = 50;
 pub const MAX_RETRY_DELAY_MS: u64 = 1000;
 
+// Sliding window for DATA chunks (must match TRANSFER_WINDOW_SIZE on the device)
+pub const WINDOW_SIZE: usize = 8;
+pub const CHUNK_INDEX_SIZE: usize = 2; // u16 LE chunk index ahead of each DATA payload
+pub const ACK_SIZE: usize = 6; // u16 next chunk + u32 SACK bitmap, LE
+pub const MAX_TRANSFER_SIZE: usize = 240 * 240 * 2;
+pub const MAX_CHUNKS: usize = (MAX_TRANSFER_SIZE + CHUNK_SIZE - 1) / CHUNK_SIZE;
+
 // Packet structure limits
 pub const MAX_PACKET_SIZE: usize = 512;
 pub const HEADER_SIZE: usize = 8;
@@ -17,6 +24,16 @@ pub const Command = enum(u8) {
     stripes = '2',
     gradient = '3',
     image = 'I',
+    region = 'R', // Followed by the u32 LE size of the region stream
+    delta = 'U', // Followed by the u32 LE size of the delta stream
+    qoi = 'Q', // Followed by the u32 LE size of the QOI stream
+    bc1 = 'B', // Fixed-size BC1 frame, no argument
+    indexed = 'X', // Followed by the u32 LE size of the indexed stream
+    palette = 'L', // Followed by first entry, count - 1 and the RGB565 entries
+    round = 'C', // Fixed-size frame of the visible spans only, no argument
+    boot = 'T', // Boot timeline, answered with a "Boot" debug packet
+    trace = 'G', // Trace dump, answered with TRACE packets
+    stats = 'S', // Latency histograms and counters, answered with a STATS packet
     help = 'H',
     end = 'E',
 };
@@ -0,0 +1,238 @@
+const std = @import("std");
+
+/// The firmware's src/error/log_sites.def, embedded by build.zig. A LOG
+/// packet carries a site's index in it, never the format string.
+const sites_def = @embedFile("log_sites");
+
+pub const Level = enum { ERROR, WARN, INFO, DEBUG };
+
+pub const Site = struct {
+    name: []const u8,
+    level: Level,
+    module: []const u8,
+    format: []const u8,
+};
+
+/// Site table, parsed at compile time so it always matches the firmware
+/// built from the same tree
+pub const sites = parseSites(sites_def);
+
+/// Header of a LOG payload: timestamp (u32 LE, us), site id (u16 LE)
+pub const EVENT_HEADER_SIZE: usize = 6;
+
+pub const Event = struct {
+    timestamp_us: u32,
+    site: u16,
+    args: []const u8,
+
+    pub fn parse(payload: []const u8) !Event {
+        if (payload.len < EVENT_HEADER_SIZE) return error.InvalidEvent;
+        return Event{
+            .timestamp_us = std.mem.readInt(u32, payload[0..4], .little),
+            .site = std.mem.readInt(u16, payload[4..6], .little),
+            .args = payload[EVENT_HEADER_SIZE..],
+        };
+    }
+};
+
+fn countSites(comptime text: []const u8) usize {
+    @setEvalBranchQuota(100_000);
+    var count: usize = 0;
+    var lines = std.mem.splitScalar(u8, text, '\n');
+    while (lines.next()) |line| {
+        if (std.mem.startsWith(u8, std.mem.trim(u8, line, " \t\r"), "LOG_SITE(")) count += 1;
+    }
+    return count;
+}
+
+fn parseSites(comptime text: []const u8) [countSites(text)]Site {
+    @setEvalBranchQuota(1_000_000);
+    var result: [countSites(text)]Site = undefined;
+    var index: usize = 0;
+    var lines = std.mem.splitScalar(u8, text, '\n');
+    while (lines.next()) |raw| {
+        const line = std.mem.trim(u8, raw, " \t\r");
+        if (!std.mem.startsWith(u8, line, "LOG_SITE(")) continue;
+        result[index] = parseSite(line) catch @compileError("log_sites.def: malformed LOG_SITE line");
+        index += 1;
+    }
+    return result;
+}
+
+/// One `LOG_SITE(NAME, LOG_LEVEL_x, "Module", "format")` line
+fn parseSite(line: []const u8) !Site {
+    const open = std.mem.indexOfScalar(u8, line, '(') orelse return error.InvalidSite;
+    var rest = line[open + 1 ..];
+
+    const name_end = std.mem.indexOfScalar(u8, rest, ',') orelse return error.InvalidSite;
+    const name = std.mem.trim(u8, rest[0..name_end], " ");
+    rest = rest[name_end + 1 ..];
+
+    const level_end = std.mem.indexOfScalar(u8, rest, ',') orelse return error.InvalidSite;
+    const level_name = std.mem.trim(u8, rest[0..level_end], " ");
+    if (!std.mem.startsWith(u8, level_name, "LOG_LEVEL_")) return error.InvalidSite;
+    const level = std.meta.stringToEnum(Level, level_name["LOG_LEVEL_".len..]) orelse
+        return error.InvalidSite;
+    rest = rest[level_end + 1 ..];
+
+    const module = try takeQuoted(&rest);
+    const format = try takeQuoted(&rest);
+    return Site{ .name = name, .level = level, .module = module, .format = format };
+}
+
+fn takeQuoted(rest: *[]const u8) ![]const u8 {
+    const start = std.mem.indexOfScalar(u8, rest.*, '"') orelse return error.InvalidSite;
+    const end = std.mem.indexOfScalarPos(u8, rest.*, start + 1, '"') orelse return error.InvalidSite;
+    const text = rest.*[start + 1 .. end];
+    rest.* = rest.*[end + 1 ..];
+    return text;
+}
+
+/// Index of the site called name
+pub fn siteId(comptime name: []const u8) u16 {
+    inline for (sites, 0..) |site, id| {
+        if (comptime std.mem.eql(u8, site.name, name)) return id;
+    }
+    @compileError("no log site named " ++ name);
+}
+
+/// Reads arguments the way the firmware's LogArgs wrote them
+const ArgReader = struct {
+    bytes: []const u8,
+
+    fn int(self: *ArgReader) ?u32 {
+        if (self.bytes.len < 4) return null;
+        const value = std.mem.readInt(u32, self.bytes[0..4], .little);
+        self.bytes = self.bytes[4..];
+        return value;
+    }
+
+    fn string(self: *ArgReader) ?[]const u8 {
+        if (self.bytes.len < 1 or self.bytes.len < 1 + @as(usize, self.bytes[0])) {
+            self.bytes = self.bytes[self.bytes.len..];
+            return null;
+        }
+        const text = self.bytes[1 .. 1 + @as(usize, self.bytes[0])];
+        self.bytes = self.bytes[1 + text.len ..];
+        return text;
+    }
+};
+
+/// Substitute args into a C format. Arguments the device couldn't fit are
+/// shown as `?`.
+pub fn formatArgs(writer: anytype, format: []const u8, args: []const u8) !void {
+    var reader = ArgReader{ .bytes = args };
+    var i: usize = 0;
+    while (i < format.len) : (i += 1) {
+        if (format[i] != '%' or i + 1 >= format.len) {
+            try writer.writeByte(format[i]);
+            continue;
+        }
+        i += 1;
+
+        // The device sends every integer as a u32, whatever its C length
+        while (i + 1 < format.len and (format[i] == 'l' or format[i] == 'z' or format[i] == 'h')) : (i += 1) {}
+
+        switch (format[i]) {
+            '%' => try writer.writeByte('%'),
+            's' => try writer.writeAll(reader.string() orelse "?"),
+            'd', 'i' => if (reader.int()) |value| {
+                try writer.print("{d}", .{@as(i32, @bitCast(value))});
+            } else try writer.writeByte('?'),
+            'u' => if (reader.int()) |value| {
+                try writer.print("{d}", .{value});
+            } else try writer.writeByte('?'),
+            'x' => if (reader.int()) |value| {
+                try writer.print("{x}", .{value});
+            } else try writer.writeByte('?'),
+            'X' => if (reader.int()) |value| {
+                try writer.print("{X}", .{value});
+            } else try writer.writeByte('?'),
+            'c' => if (reader.int()) |value| {
+                try writer.writeByte(@truncate(value));
+            } else try writer.writeByte('?'),
+            else => {
+                try writer.writeByte('%');
+                try writer.writeByte(format[i]);
+            },
+        }
+    }
+}
+
+/// Write a LOG payload as `[seconds] LEVEL Module: message`. The timestamp
+/// is the device's microsecond clock, which wraps every 71 minutes.
+pub fn render(writer: anytype, payload: []const u8) !void {
+    const event = try Event.parse(payload);
+    try writer.print("[{d:>4}.{d:0>6}] ", .{ event.timestamp_us / 1_000_000, event.timestamp_us % 1_000_000 });
+
+    if (event.site >= sites.len) {
+        try writer.print("? Log: unknown site {d}, {d} argument bytes (host older than firmware?)", .{ event.site, event.args.len });
+        return;
+    }
+
+    const site = sites[event.site];
+    try writer.print("{s} {s}: ", .{ @tagName(site.level), site.module });
+    try formatArgs(writer, site.format, event.args);
+}
+
+fn renderToString(buffer: []u8, payload: []const u8) ![]const u8 {
+    var stream = std.io.fixedBufferStream(buffer);
+    try render(stream.writer(), payload);
+    return stream.getWritten();
+}
+
+test "site table is read from the firmware" {
+    try std.testing.expect(sites.len > 0);
+    try std.testing.expectEqualStrings("STATE_TRANSITION_ATTEMPT", sites[0].name);
+    try std.testing.expectEqual(Level.DEBUG, sites[0].level);
+    try std.testing.expectEqualStrings("State", sites[0].module);
+    try std.testing.expectEqualStrings("Attempting transition from %s to %s (condition: %s)", sites[0].format);
+}
+
+test "integers and strings decode in format order" {
+    const id = siteId("TRANSFER_REGIONS_DONE");
+    const payload = [_]u8{
+        0x40, 0x42, 0x0F, 0x00, // 1.000000 s
+        @truncate(id), @truncate(id >> 8),
+        3, 0, 0, 0,
+        0x00, 0x10, 0x00, 0x00,
+    };
+    var buffer: [256]u8 = undefined;
+    try std.testing.expectEqualStrings(
+        "[   1.000000] INFO Transfer: Region update complete: 3 regions, 4096 bytes",
+        try renderToString(&buffer, &payload),
+    );
+
+    const changed = siteId("STATE_CHANGED");
+    const strings = [_]u8{ 0, 0, 0, 0, @truncate(changed), @truncate(changed >> 8), 4, 'I', 'D', 'L', 'E', 5, 'R', 'E', 'A', 'D', 'Y' };
+    try std.testing.expectEqualStrings(
+        "[   0.000000] INFO Main: State changed from IDLE to READY",
+        try renderToString(&buffer, &strings),
+    );
+}
+
+test "missing arguments and unknown sites still render" {
+    const id = siteId("STATE_CHANGED");
+    const short = [_]u8{ 0, 0, 0, 0, @truncate(id), @truncate(id >> 8), 4, 'I', 'D' };
+    var buffer: [256]u8 = undefined;
+    try std.testing.expectEqualStrings(
+        "[   0.000000] INFO Main: State changed from ? to ?",
+        try renderToString(&buffer, &short),
+    );
+
+    const unknown = [_]u8{ 0, 0, 0, 0, 0xFF, 0xFF };
+    try std.testing.expect(std.mem.indexOf(u8, try renderToString(&buffer, &unknown), "unknown site 65535") != null);
+    try std.testing.expectError(error.InvalidEvent, renderToString(&buffer, unknown[0..4]));
+}
+
+test "formats only use conversions the firmware can encode" {
+    for (sites) |site| {
+        var i: usize = 0;
+        while (i < site.format.len) : (i += 1) {
+            if (site.format[i] != '%') continue;
+            i += 1;
+            try std.testing.expect(i < site.format.len);
+            try std.testing.expect(std.mem.indexOfScalar(u8, "%sdiuxXc", site.format[i]) != null);
+        }
+    }
+}
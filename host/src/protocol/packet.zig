@@ -91,3 +91,325 @@ pub const MessageError = error{
     InvalidChecksum,
     InvalidSequence,
 };
+
+/// Packet types, numbered as the device's PacketType enum
+pub const PacketType = enum(u8) {
+    DEBUG = 0,
+    CMD = 1,
+    DATA = 2,
+    ACK = 3,
+    NACK = 4,
+    ERROR = 5,
+    SYNC = 6,
+    LOG = 7, // Binary log event, see log_decoder.zig
+    TRACE = 8, // Part of a trace dump, see trace.zig
+    STATS = 9, // Latency histograms and counters, see stats.zig
+    _,
+};
+
+/// Wire framing. v1 is the escaped frame with a hex checksum the debug
+/// monitor reads; v2 is negotiated at SYNC and sends a COBS frame of packed
+/// header, payload and binary CRC32, terminated by 0x00.
+pub const Framing = enum(u8) {
+    v1 = 1,
+    v2 = 2,
+};
+
+pub const MAX_PAYLOAD_SIZE: usize = 1024;
+pub const V1_HEADER_SIZE: usize = 12; // Device's in-memory PacketHeader
+pub const V1_TRAILER_SIZE: usize = 9; // ' ' + 8 hex CRC chars
+pub const V2_HEADER_SIZE: usize = 4; // type, sequence, length (LE)
+pub const CRC_SIZE: usize = 4;
+pub const COBS_DELIMITER: u8 = 0x00;
+pub const V1_MAX_FRAME_SIZE: usize = 2 * (V1_HEADER_SIZE + MAX_PAYLOAD_SIZE) + V1_TRAILER_SIZE + 1;
+pub const V2_MAX_FRAME_SIZE: usize = cobsMaxEncodedSize(V2_HEADER_SIZE + MAX_PAYLOAD_SIZE + CRC_SIZE) + 1;
+pub const MAX_FRAME_SIZE: usize = @max(V1_MAX_FRAME_SIZE, V2_MAX_FRAME_SIZE);
+
+const V1_START: u8 = '~';
+const V1_END: u8 = '\n';
+const V1_ESCAPE: u8 = '\\';
+
+pub fn cobsMaxEncodedSize(len: usize) usize {
+    return len + len / 254 + 1;
+}
+
+pub const PacketHeader = struct {
+    packet_type: PacketType,
+    sequence: u8,
+    length: u16,
+};
+
+pub const Packet = struct {
+    header: PacketHeader,
+    payload: ?[]const u8,
+
+    const Self = @This();
+
+    pub fn init(packet_type: PacketType, sequence: u8, payload: []const u8) !Self {
+        if (payload.len > MAX_PAYLOAD_SIZE) {
+            return error.InvalidFormat;
+        }
+        return Self{
+            .header = .{
+                .packet_type = packet_type,
+                .sequence = sequence,
+                .length = @intCast(payload.len),
+            },
+            .payload = if (payload.len > 0) payload else null,
+        };
+    }
+
+    fn payloadBytes(self: Self) []const u8 {
+        return self.payload orelse &[_]u8{};
+    }
+
+    /// Encode into out using the given framing, delimiter included
+    pub fn encode(self: Self, framing: Framing, out: []u8) ![]u8 {
+        return switch (framing) {
+            .v1 => self.encodeV1(out),
+            .v2 => self.encodeV2(out),
+        };
+    }
+
+    /// Decode a frame with its delimiter stripped. Works in place, so the
+    /// payload points into frame.
+    pub fn decode(framing: Framing, frame: []u8) !Self {
+        return switch (framing) {
+            .v1 => decodeV1(frame),
+            .v2 => decodeV2(frame),
+        };
+    }
+
+    fn v1Header(self: Self) [V1_HEADER_SIZE]u8 {
+        var header = [_]u8{0} ** V1_HEADER_SIZE;
+        header[0] = V1_START;
+        header[4] = @intFromEnum(self.header.packet_type);
+        header[8] = self.header.sequence;
+        std.mem.writeInt(u16, header[10..12], self.header.length, .little);
+        return header;
+    }
+
+    fn encodeV1(self: Self, out: []u8) ![]u8 {
+        const header = self.v1Header();
+        var hasher = std.hash.Crc32.init();
+        hasher.update(&header);
+        hasher.update(self.payloadBytes());
+
+        var pos = try escapeV1(out, 0, &header);
+        pos = try escapeV1(out, pos, self.payloadBytes());
+        const trailer = std.fmt.bufPrint(out[pos..], " {X:0>8}\n", .{hasher.final()}) catch
+            return error.InvalidFormat;
+        return out[0 .. pos + trailer.len];
+    }
+
+    fn decodeV1(frame: []u8) !Self {
+        // Unescape in place; the output never runs ahead of the input
+        var len: usize = 0;
+        var i: usize = 0;
+        while (i < frame.len) : (i += 1) {
+            var byte = frame[i];
+            if (byte == V1_ESCAPE) {
+                i += 1;
+                if (i >= frame.len) return error.InvalidFormat;
+                byte = frame[i] ^ 0x20;
+            }
+            frame[len] = byte;
+            len += 1;
+        }
+
+        if (len < V1_HEADER_SIZE + V1_TRAILER_SIZE or frame[0] != V1_START) {
+            return error.InvalidFormat;
+        }
+        const length = std.mem.readInt(u16, frame[10..12], .little);
+        const body = V1_HEADER_SIZE + @as(usize, length);
+        if (length > MAX_PAYLOAD_SIZE or len != body + V1_TRAILER_SIZE or frame[body] != ' ') {
+            return error.InvalidFormat;
+        }
+
+        const expected = std.fmt.parseInt(u32, frame[body + 1 .. len], 16) catch
+            return error.InvalidFormat;
+        var hasher = std.hash.Crc32.init();
+        hasher.update(frame[0..body]);
+        if (hasher.final() != expected) return error.InvalidChecksum;
+
+        return Self{
+            .header = .{
+                .packet_type = @enumFromInt(frame[4]),
+                .sequence = frame[8],
+                .length = length,
+            },
+            .payload = if (length > 0) frame[V1_HEADER_SIZE..body] else null,
+        };
+    }
+
+    fn encodeV2(self: Self, out: []u8) ![]u8 {
+        var header: [V2_HEADER_SIZE]u8 = undefined;
+        header[0] = @intFromEnum(self.header.packet_type);
+        header[1] = self.header.sequence;
+        std.mem.writeInt(u16, header[2..4], self.header.length, .little);
+
+        var hasher = std.hash.Crc32.init();
+        hasher.update(&header);
+        hasher.update(self.payloadBytes());
+        var trailer: [CRC_SIZE]u8 = undefined;
+        std.mem.writeInt(u32, &trailer, hasher.final(), .little);
+
+        // Leave room for the delimiter
+        if (out.len < 2) return error.InvalidFormat;
+        var encoder = CobsEncoder{ .out = out[0 .. out.len - 1] };
+        try encoder.update(&header);
+        try encoder.update(self.payloadBytes());
+        try encoder.update(&trailer);
+        const len = encoder.finish();
+        out[len] = COBS_DELIMITER;
+        return out[0 .. len + 1];
+    }
+
+    fn decodeV2(frame: []u8) !Self {
+        const raw = try cobsDecode(frame);
+        if (raw.len < V2_HEADER_SIZE + CRC_SIZE) return error.InvalidFormat;
+
+        const length = std.mem.readInt(u16, raw[2..4], .little);
+        const body = V2_HEADER_SIZE + @as(usize, length);
+        if (length > MAX_PAYLOAD_SIZE or raw.len != body + CRC_SIZE) {
+            return error.InvalidFormat;
+        }
+
+        var hasher = std.hash.Crc32.init();
+        hasher.update(raw[0..body]);
+        if (hasher.final() != std.mem.readInt(u32, raw[body..][0..CRC_SIZE], .little)) {
+            return error.InvalidChecksum;
+        }
+
+        return Self{
+            .header = .{
+                .packet_type = @enumFromInt(raw[0]),
+                .sequence = raw[1],
+                .length = length,
+            },
+            .payload = if (length > 0) raw[V2_HEADER_SIZE..body] else null,
+        };
+    }
+};
+
+/// Frame delimiter for the given framing
+pub fn frameDelimiter(framing: Framing) u8 {
+    return switch (framing) {
+        .v1 => V1_END,
+        .v2 => COBS_DELIMITER,
+    };
+}
+
+fn escapeV1(out: []u8, start: usize, data: []const u8) !usize {
+    var pos = start;
+    for (data) |byte| {
+        if (byte == V1_START or byte == V1_END or byte == V1_ESCAPE) {
+            if (pos + 2 > out.len) return error.InvalidFormat;
+            out[pos] = V1_ESCAPE;
+            out[pos + 1] = byte ^ 0x20;
+            pos += 2;
+        } else {
+            if (pos + 1 > out.len) return error.InvalidFormat;
+            out[pos] = byte;
+            pos += 1;
+        }
+    }
+    return pos;
+}
+
+/// Incremental COBS encoder, so header, payload and CRC go out as one frame
+/// without first being copied together
+const CobsEncoder = struct {
+    out: []u8,
+    len: usize = 1,
+    code_index: usize = 0,
+    code: u8 = 1,
+
+    fn closeBlock(self: *CobsEncoder) !void {
+        self.out[self.code_index] = self.code;
+        if (self.len >= self.out.len) return error.InvalidFormat;
+        self.code_index = self.len;
+        self.len += 1;
+        self.code = 1;
+    }
+
+    fn update(self: *CobsEncoder, data: []const u8) !void {
+        for (data) |byte| {
+            if (byte == 0) {
+                try self.closeBlock();
+                continue;
+            }
+            if (self.len >= self.out.len) return error.InvalidFormat;
+            self.out[self.len] = byte;
+            self.len += 1;
+            self.code += 1;
+            if (self.code == 0xFF) try self.closeBlock();
+        }
+    }
+
+    fn finish(self: *CobsEncoder) usize {
+        self.out[self.code_index] = self.code;
+        return self.len;
+    }
+};
+
+/// Decode a COBS frame (delimiter stripped) in place
+pub fn cobsDecode(frame: []u8) ![]u8 {
+    var in: usize = 0;
+    var out: usize = 0;
+    while (in < frame.len) {
+        const code = frame[in];
+        if (code == 0 or in + code > frame.len) return error.InvalidFormat;
+        in += 1;
+
+        var i: usize = 1;
+        while (i < code) : (i += 1) {
+            frame[out] = frame[in];
+            out += 1;
+            in += 1;
+        }
+
+        // A full block carries no implicit zero, nor does the last one
+        if (code != 0xFF and in < frame.len) {
+            frame[out] = 0;
+            out += 1;
+        }
+    }
+    return frame[0..out];
+}
+
+test "v2 frame round trips without inner delimiters" {
+    const payload = [_]u8{ 0x00, '~', '\n', 0x12, 0x00 };
+    const packet = try Packet.init(.DATA, 7, &payload);
+
+    var frame: [V2_MAX_FRAME_SIZE]u8 = undefined;
+    const encoded = try packet.encode(.v2, &frame);
+    try std.testing.expectEqual(COBS_DELIMITER, encoded[encoded.len - 1]);
+    try std.testing.expect(std.mem.indexOfScalar(u8, encoded[0 .. encoded.len - 1], 0) == null);
+
+    const decoded = try Packet.decode(.v2, encoded[0 .. encoded.len - 1]);
+    try std.testing.expectEqual(PacketType.DATA, decoded.header.packet_type);
+    try std.testing.expectEqual(@as(u8, 7), decoded.header.sequence);
+    try std.testing.expectEqualSlices(u8, &payload, decoded.payload.?);
+}
+
+test "v2 frame rejects corruption" {
+    const packet = try Packet.init(.ACK, 1, "ok");
+    var frame: [V2_MAX_FRAME_SIZE]u8 = undefined;
+    const encoded = try packet.encode(.v2, &frame);
+    encoded[2] ^= 0x01;
+    try std.testing.expectError(error.InvalidChecksum, Packet.decode(.v2, encoded[0 .. encoded.len - 1]));
+}
+
+test "v1 frame round trips" {
+    const payload = [_]u8{ '~', 'a', '\\', '\n' };
+    const packet = try Packet.init(.SYNC, 3, &payload);
+
+    var frame: [V1_MAX_FRAME_SIZE]u8 = undefined;
+    const encoded = try packet.encode(.v1, &frame);
+    try std.testing.expectEqual(V1_END, encoded[encoded.len - 1]);
+
+    const decoded = try Packet.decode(.v1, encoded[0 .. encoded.len - 1]);
+    try std.testing.expectEqual(PacketType.SYNC, decoded.header.packet_type);
+    try std.testing.expectEqualSlices(u8, &payload, decoded.payload.?);
+}
@@ -4,3 +4,10 @@ pub const Logger = @import("logger.zig").Logger;
 pub const StateMachine = @import("state.zig").StateMachine;
 pub const constants = @import("constants.zig");
 pub const packet = @import("packet.zig");
+pub const log_decoder = @import("log_decoder.zig");
+pub const trace = @import("trace.zig");
+pub const stats = @import("stats.zig");
+
+test {
+    @import("std").testing.refAllDecls(@This());
+}
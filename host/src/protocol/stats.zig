@@ -0,0 +1,296 @@
+const std = @import("std");
+
+/// STATS payload header: now_us (u32 LE), histogram count, bucket count,
+/// reserved (u16); then the counters and the histograms, see
+/// src/debug/stats.h
+pub const HEADER_SIZE: usize = 8;
+pub const COUNTER_COUNT: usize = 6;
+pub const MAX_HISTOGRAMS: usize = 16;
+pub const MAX_BUCKETS: usize = 32;
+
+/// Histogram names, in the firmware's StatsLatency order. A newer firmware
+/// may send more; those show by index.
+pub const latency_names = [_][]const u8{ "parse", "crc", "chunk->spi", "frame", "ack", "state" };
+
+pub const Counters = struct {
+    rx_bytes: u32 = 0,
+    rx_packets: u32 = 0,
+    rx_dropped: u32 = 0,
+    tx_bytes: u32 = 0,
+    tx_packets: u32 = 0,
+    transfer_bps: u32 = 0,
+};
+
+/// Log2 buckets: 0 holds 0 us, b holds [2^(b-1), 2^b) us, and the last is
+/// open-ended
+pub const Histogram = struct {
+    max_us: u32 = 0,
+    counts: [MAX_BUCKETS]u32 = [_]u32{0} ** MAX_BUCKETS,
+    bucket_count: usize = 0,
+
+    pub fn total(self: Histogram) u64 {
+        var sum: u64 = 0;
+        for (self.counts[0..self.bucket_count]) |value| sum += value;
+        return sum;
+    }
+
+    /// Samples recorded after earlier. max_us stays the lifetime maximum;
+    /// the device keeps no other.
+    pub fn since(self: Histogram, earlier: Histogram) Histogram {
+        var result = self;
+        for (result.counts[0..self.bucket_count], 0..) |*value, b| {
+            value.* -%= earlier.counts[b];
+        }
+        return result;
+    }
+
+    fn lowerBound(b: usize) f64 {
+        if (b == 0) return 0;
+        return std.math.ldexp(@as(f64, 1), @as(i32, @intCast(b)) - 1);
+    }
+
+    fn upperBound(self: Histogram, b: usize) f64 {
+        if (b == 0) return 0;
+        if (b + 1 == self.bucket_count) return @max(lowerBound(b), @as(f64, @floatFromInt(self.max_us)));
+        return std.math.ldexp(@as(f64, 1), @as(i32, @intCast(b)));
+    }
+
+    /// Latency at fraction p (0..1) in us, interpolated inside its bucket;
+    /// null without samples
+    pub fn percentile(self: Histogram, p: f64) ?f64 {
+        const samples = self.total();
+        if (samples == 0) return null;
+
+        const rank = std.math.clamp(p, 0, 1) * @as(f64, @floatFromInt(samples));
+        var before: f64 = 0;
+        for (self.counts[0..self.bucket_count], 0..) |value, b| {
+            if (value == 0) continue;
+            const count: f64 = @floatFromInt(value);
+            if (before + count >= rank) {
+                const lower = lowerBound(b);
+                const fraction = (rank - before) / count;
+                const estimate = lower + fraction * (self.upperBound(b) - lower);
+                return @min(estimate, @as(f64, @floatFromInt(self.max_us)));
+            }
+            before += count;
+        }
+        return @floatFromInt(self.max_us);
+    }
+};
+
+pub const Snapshot = struct {
+    now_us: u32,
+    counters: Counters,
+    histograms: [MAX_HISTOGRAMS]Histogram,
+    histogram_count: usize,
+
+    pub fn parse(payload: []const u8) !Snapshot {
+        if (payload.len < HEADER_SIZE) return error.InvalidStats;
+        const histogram_count: usize = payload[4];
+        const bucket_count: usize = payload[5];
+        if (histogram_count > MAX_HISTOGRAMS or bucket_count == 0 or bucket_count > MAX_BUCKETS) {
+            return error.InvalidStats;
+        }
+        const size = HEADER_SIZE + COUNTER_COUNT * 4 + histogram_count * (1 + bucket_count) * 4;
+        if (payload.len != size) return error.InvalidStats;
+
+        var snapshot = Snapshot{
+            .now_us = readU32(payload, 0),
+            .counters = undefined,
+            .histograms = [_]Histogram{.{}} ** MAX_HISTOGRAMS,
+            .histogram_count = histogram_count,
+        };
+
+        var offset: usize = HEADER_SIZE;
+        inline for (std.meta.fields(Counters)) |field| {
+            @field(snapshot.counters, field.name) = readU32(payload, offset);
+            offset += 4;
+        }
+
+        for (snapshot.histograms[0..histogram_count]) |*histogram| {
+            histogram.bucket_count = bucket_count;
+            histogram.max_us = readU32(payload, offset);
+            offset += 4;
+            for (histogram.counts[0..bucket_count]) |*value| {
+                value.* = readU32(payload, offset);
+                offset += 4;
+            }
+        }
+        return snapshot;
+    }
+};
+
+fn readU32(payload: []const u8, offset: usize) u32 {
+    return std.mem.readInt(u32, payload[offset..][0..4], .little);
+}
+
+fn formatDuration(buffer: []u8, us: ?f64) []const u8 {
+    const value = us orelse return "-";
+    const text = if (value < 1000)
+        std.fmt.bufPrint(buffer, "{d:.1}us", .{value})
+    else if (value < 1_000_000)
+        std.fmt.bufPrint(buffer, "{d:.2}ms", .{value / 1000})
+    else
+        std.fmt.bufPrint(buffer, "{d:.2}s", .{value / 1_000_000});
+    return text catch "?";
+}
+
+fn formatRate(buffer: []u8, bytes_per_second: f64) []const u8 {
+    const text = if (bytes_per_second < 1024)
+        std.fmt.bufPrint(buffer, "{d:.0} B/s", .{bytes_per_second})
+    else if (bytes_per_second < 1024 * 1024)
+        std.fmt.bufPrint(buffer, "{d:.1} KiB/s", .{bytes_per_second / 1024})
+    else
+        std.fmt.bufPrint(buffer, "{d:.2} MiB/s", .{bytes_per_second / (1024 * 1024)});
+    return text catch "?";
+}
+
+/// Print latency percentiles and traffic. With previous, both cover only
+/// what happened since it; otherwise everything since boot.
+pub fn render(writer: anytype, current: Snapshot, previous: ?Snapshot) !void {
+    const interval_us: u32 = if (previous) |earlier| current.now_us -% earlier.now_us else 0;
+    if (previous != null) {
+        try writer.print("Last {d:.1}s\n\n", .{@as(f64, @floatFromInt(interval_us)) / 1_000_000});
+    } else {
+        try writer.print("Since boot\n\n", .{});
+    }
+
+    try writer.print("{s:<12}{s:>10}{s:>12}{s:>12}{s:>12}\n", .{ "latency", "samples", "p50", "p99", "max" });
+    for (current.histograms[0..current.histogram_count], 0..) |lifetime, index| {
+        const histogram = if (previous) |earlier| lifetime.since(earlier.histograms[index]) else lifetime;
+
+        var name_buffer: [16]u8 = undefined;
+        const name = if (index < latency_names.len)
+            latency_names[index]
+        else
+            std.fmt.bufPrint(&name_buffer, "#{d}", .{index}) catch "?";
+
+        var p50: [24]u8 = undefined;
+        var p99: [24]u8 = undefined;
+        var max: [24]u8 = undefined;
+        const max_us: ?f64 = if (lifetime.total() > 0) @as(f64, @floatFromInt(lifetime.max_us)) else null;
+        try writer.print("{s:<12}{d:>10}{s:>12}{s:>12}{s:>12}\n", .{
+            name,
+            histogram.total(),
+            formatDuration(&p50, histogram.percentile(0.50)),
+            formatDuration(&p99, histogram.percentile(0.99)),
+            formatDuration(&max, max_us),
+        });
+    }
+
+    const counters = current.counters;
+    try writer.print("\n", .{});
+    if (previous) |earlier| {
+        const seconds = @max(@as(f64, @floatFromInt(interval_us)) / 1_000_000, 1e-6);
+        const rx_bytes: f64 = @floatFromInt(counters.rx_bytes -% earlier.counters.rx_bytes);
+        const tx_bytes: f64 = @floatFromInt(counters.tx_bytes -% earlier.counters.tx_bytes);
+        var rx_rate: [24]u8 = undefined;
+        var tx_rate: [24]u8 = undefined;
+        try writer.print("RX {s:>12}  {d} packets, {d} dropped\n", .{
+            formatRate(&rx_rate, rx_bytes / seconds),
+            counters.rx_packets -% earlier.counters.rx_packets,
+            counters.rx_dropped -% earlier.counters.rx_dropped,
+        });
+        try writer.print("TX {s:>12}  {d} packets\n", .{
+            formatRate(&tx_rate, tx_bytes / seconds),
+            counters.tx_packets -% earlier.counters.tx_packets,
+        });
+    } else {
+        try writer.print("RX {d} bytes, {d} packets, {d} dropped\n", .{ counters.rx_bytes, counters.rx_packets, counters.rx_dropped });
+        try writer.print("TX {d} bytes, {d} packets\n", .{ counters.tx_bytes, counters.tx_packets });
+    }
+
+    var transfer_rate: [24]u8 = undefined;
+    if (counters.transfer_bps > 0) {
+        try writer.print("Last transfer {s}\n", .{formatRate(&transfer_rate, @floatFromInt(counters.transfer_bps))});
+    }
+}
+
+// Tests
+
+fn testPayload(comptime histograms: usize, comptime buckets: usize) [HEADER_SIZE + COUNTER_COUNT * 4 + histograms * (1 + buckets) * 4]u8 {
+    var payload = [_]u8{0} ** (HEADER_SIZE + COUNTER_COUNT * 4 + histograms * (1 + buckets) * 4);
+    payload[4] = histograms;
+    payload[5] = buckets;
+    return payload;
+}
+
+fn writeU32(payload: []u8, offset: usize, value: u32) void {
+    std.mem.writeInt(u32, payload[offset..][0..4], value, .little);
+}
+
+fn histogramOffset(histogram: usize, buckets: usize) usize {
+    return HEADER_SIZE + COUNTER_COUNT * 4 + histogram * (1 + buckets) * 4;
+}
+
+test "payload parses counters and histograms" {
+    var payload = testPayload(2, 24);
+    writeU32(&payload, 0, 5_000_000);
+    writeU32(&payload, HEADER_SIZE, 4096); // rx_bytes
+    writeU32(&payload, HEADER_SIZE + 20, 250_000); // transfer_bps
+    writeU32(&payload, histogramOffset(1, 24), 700); // crc max_us
+    writeU32(&payload, histogramOffset(1, 24) + 4 + 10 * 4, 3); // 3 in [512, 1024)
+
+    const snapshot = try Snapshot.parse(&payload);
+    try std.testing.expectEqual(@as(u32, 5_000_000), snapshot.now_us);
+    try std.testing.expectEqual(@as(u32, 4096), snapshot.counters.rx_bytes);
+    try std.testing.expectEqual(@as(u32, 250_000), snapshot.counters.transfer_bps);
+    try std.testing.expectEqual(@as(usize, 2), snapshot.histogram_count);
+    try std.testing.expectEqual(@as(u32, 700), snapshot.histograms[1].max_us);
+    try std.testing.expectEqual(@as(u64, 3), snapshot.histograms[1].total());
+    try std.testing.expectEqual(@as(u64, 0), snapshot.histograms[0].total());
+
+    try std.testing.expectError(error.InvalidStats, Snapshot.parse(payload[0 .. payload.len - 1]));
+    payload[5] = 0;
+    try std.testing.expectError(error.InvalidStats, Snapshot.parse(&payload));
+}
+
+test "percentiles interpolate within a bucket" {
+    var histogram = Histogram{ .bucket_count = 24, .max_us = 2000 };
+    histogram.counts[7] = 50; // [64, 128)
+    histogram.counts[11] = 50; // [1024, 2048)
+
+    try std.testing.expectEqual(@as(?f64, null), (Histogram{ .bucket_count = 24 }).percentile(0.5));
+    try std.testing.expectApproxEqAbs(@as(f64, 128), histogram.percentile(0.50).?, 0.001);
+    try std.testing.expectApproxEqAbs(@as(f64, 96), histogram.percentile(0.25).?, 0.001);
+    // 1024 + 0.98 * 1024, capped at the recorded maximum
+    try std.testing.expectApproxEqAbs(@as(f64, 2000), histogram.percentile(0.99).?, 0.001);
+    try std.testing.expectApproxEqAbs(@as(f64, 1024 + 0.9 * 1024), histogram.percentile(0.95).?, 0.001);
+}
+
+test "interval histograms subtract the earlier snapshot" {
+    var earlier = Histogram{ .bucket_count = 24, .max_us = 10 };
+    earlier.counts[3] = 4;
+    var later = earlier;
+    later.counts[3] = 6;
+    later.counts[5] = 1;
+    later.max_us = 20;
+
+    const delta = later.since(earlier);
+    try std.testing.expectEqual(@as(u64, 3), delta.total());
+    try std.testing.expectEqual(@as(u32, 2), delta.counts[3]);
+    try std.testing.expectEqual(@as(u32, 20), delta.max_us);
+}
+
+test "render shows throughput over the interval" {
+    var payload = testPayload(6, 24);
+    writeU32(&payload, 0, 1_000_000);
+    const earlier = try Snapshot.parse(&payload);
+
+    writeU32(&payload, 0, 3_000_000);
+    writeU32(&payload, HEADER_SIZE, 4096); // rx_bytes
+    writeU32(&payload, HEADER_SIZE + 4, 8); // rx_packets
+    writeU32(&payload, histogramOffset(0, 24), 90);
+    writeU32(&payload, histogramOffset(0, 24) + 4 + 7 * 4, 1);
+    const later = try Snapshot.parse(&payload);
+
+    var output = std.ArrayList(u8).init(std.testing.allocator);
+    defer output.deinit();
+    try render(output.writer(), later, earlier);
+
+    try std.testing.expect(std.mem.indexOf(u8, output.items, "Last 2.0s") != null);
+    try std.testing.expect(std.mem.indexOf(u8, output.items, "2.0 KiB/s") != null);
+    try std.testing.expect(std.mem.indexOf(u8, output.items, "8 packets") != null);
+    try std.testing.expect(std.mem.indexOf(u8, output.items, "chunk->spi") != null);
+    try std.testing.expect(std.mem.indexOf(u8, output.items, "90.0us") != null);
+}
@@ -0,0 +1,374 @@
+const std = @import("std");
+
+/// The firmware's src/debug/trace_events.def, embedded by build.zig. A
+/// trace record carries an event's index in it, never the name.
+const events_def = @embedFile("trace_events");
+
+pub const EventInfo = struct {
+    name: []const u8,
+    category: []const u8,
+    begin_arg: []const u8, // Label of a begin or instant record's argument, "" for none
+    end_arg: []const u8, // Label of an end record's argument, "" for none
+};
+
+/// Event table, parsed at compile time so it always matches the firmware
+/// built from the same tree
+pub const events = parseEvents(events_def);
+
+pub const Phase = enum(u8) { begin = 0, end = 1, instant = 2, _ };
+
+/// TRACE payload header: now_us (u32 LE), lost (u32 LE), core, flags,
+/// record count (u16 LE); then the records
+pub const HEADER_SIZE: usize = 12;
+/// Record: timestamp_us (u32 LE), event, phase, arg (u16 LE)
+pub const RECORD_SIZE: usize = 8;
+/// Set on the last TRACE packet of a dump
+pub const FLAG_LAST: u8 = 0x01;
+pub const MAX_CORES: usize = 2;
+
+pub const Record = struct {
+    timestamp_us: u32,
+    event: u8,
+    phase: Phase,
+    arg: u16,
+};
+
+/// One TRACE packet's payload
+pub const Part = struct {
+    now_us: u32,
+    lost: u32,
+    core: u8,
+    flags: u8,
+    records: []const u8,
+
+    pub fn parse(payload: []const u8) !Part {
+        if (payload.len < HEADER_SIZE) return error.InvalidTrace;
+        const records = std.mem.readInt(u16, payload[10..12], .little);
+        if (payload.len != HEADER_SIZE + @as(usize, records) * RECORD_SIZE) return error.InvalidTrace;
+        if (payload[8] >= MAX_CORES) return error.InvalidTrace;
+        return Part{
+            .now_us = std.mem.readInt(u32, payload[0..4], .little),
+            .lost = std.mem.readInt(u32, payload[4..8], .little),
+            .core = payload[8],
+            .flags = payload[9],
+            .records = payload[HEADER_SIZE..],
+        };
+    }
+
+    pub fn count(self: Part) usize {
+        return self.records.len / RECORD_SIZE;
+    }
+
+    pub fn record(self: Part, index: usize) Record {
+        const bytes = self.records[index * RECORD_SIZE ..][0..RECORD_SIZE];
+        return Record{
+            .timestamp_us = std.mem.readInt(u32, bytes[0..4], .little),
+            .event = bytes[4],
+            .phase = @enumFromInt(bytes[5]),
+            .arg = std.mem.readInt(u16, bytes[6..8], .little),
+        };
+    }
+
+    pub fn isLast(self: Part) bool {
+        return self.flags & FLAG_LAST != 0;
+    }
+};
+
+/// A whole dump, collected part by part. Each core's records are in the
+/// order that core recorded them.
+pub const Dump = struct {
+    const Core = struct {
+        seen: bool = false,
+        now_us: u32 = 0,
+        lost: u32 = 0,
+        records: std.ArrayList(Record),
+    };
+
+    cores: [MAX_CORES]Core,
+    complete: bool = false,
+
+    pub fn init(allocator: std.mem.Allocator) Dump {
+        var dump = Dump{ .cores = undefined };
+        for (&dump.cores) |*core| {
+            core.* = Core{ .records = std.ArrayList(Record).init(allocator) };
+        }
+        return dump;
+    }
+
+    pub fn deinit(self: *Dump) void {
+        for (&self.cores) |*core| core.records.deinit();
+    }
+
+    /// Add a TRACE payload. Returns true once the dump's last part is in.
+    pub fn add(self: *Dump, payload: []const u8) !bool {
+        const part = try Part.parse(payload);
+        const core = &self.cores[part.core];
+        if (!core.seen) {
+            core.seen = true;
+            core.now_us = part.now_us;
+            core.lost = part.lost;
+        }
+        for (0..part.count()) |i| {
+            try core.records.append(part.record(i));
+        }
+        self.complete = part.isLast();
+        return self.complete;
+    }
+
+    pub fn eventCount(self: *const Dump) usize {
+        var total: usize = 0;
+        for (self.cores) |core| total += core.records.items.len;
+        return total;
+    }
+
+    /// Write the dump as Chrome trace-event JSON (chrome://tracing or
+    /// Perfetto): one thread per core, spans as B/E pairs, instants as i.
+    ///
+    /// Timestamps are the device's 32-bit us clock, unwrapped by counting
+    /// back from when each ring was read, and shifted so the first event is
+    /// at 0. An end whose begin was overwritten is dropped; a span still
+    /// open when the ring was read ends there.
+    pub fn writeChromeJson(self: *const Dump, writer: anytype) !void {
+        // Core0's read time is the reference; core1's is a little later
+        const reference: i64 = self.cores[0].now_us;
+        var bases: [MAX_CORES]i64 = undefined;
+        var first: ?i64 = null;
+        for (self.cores, 0..) |core, i| {
+            bases[i] = reference + @as(i32, @bitCast(core.now_us -% self.cores[0].now_us));
+            for (core.records.items) |record| {
+                const at = bases[i] - (core.now_us -% record.timestamp_us);
+                if (first == null or at < first.?) first = at;
+            }
+        }
+        const origin = first orelse 0;
+
+        try writer.writeAll("{\"displayTimeUnit\":\"ms\",\"traceEvents\":[");
+        var out = JsonEvents(@TypeOf(writer)){ .writer = writer };
+
+        for (self.cores, 0..) |core, tid| {
+            if (!core.seen) continue;
+            try out.separator();
+            try writer.print("{{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":0,\"tid\":{d},\"args\":{{\"name\":\"core{d}", .{ tid, tid });
+            if (core.lost > 0) try writer.print(" ({d} earlier events lost)", .{core.lost});
+            try writer.writeAll("\"}}");
+
+            var open: [32]u8 = undefined;
+            var depth: usize = 0;
+            for (core.records.items) |record| {
+                const ts = bases[tid] - (core.now_us -% record.timestamp_us) - origin;
+                switch (record.phase) {
+                    .begin => {
+                        if (depth == open.len) continue; // Deeper than any real nesting
+                        open[depth] = record.event;
+                        depth += 1;
+                        try out.event(record.event, "B", ts, tid, record.arg, false);
+                    },
+                    .end => {
+                        const at = std.mem.lastIndexOfScalar(u8, open[0..depth], record.event) orelse continue;
+                        // Close anything left open inside it first
+                        while (depth > at + 1) {
+                            depth -= 1;
+                            try out.event(open[depth], "E", ts, tid, 0, true);
+                        }
+                        depth -= 1;
+                        try out.event(record.event, "E", ts, tid, record.arg, true);
+                    },
+                    .instant => try out.event(record.event, "i", ts, tid, record.arg, false),
+                    _ => {},
+                }
+            }
+
+            const end_ts = bases[tid] - origin;
+            while (depth > 0) {
+                depth -= 1;
+                try out.event(open[depth], "E", end_ts, tid, 0, true);
+            }
+        }
+        try writer.writeAll("]}\n");
+    }
+};
+
+fn JsonEvents(comptime Writer: type) type {
+    return struct {
+        writer: Writer,
+        count: usize = 0,
+
+        fn separator(self: *@This()) !void {
+            if (self.count > 0) try self.writer.writeByte(',');
+            self.count += 1;
+        }
+
+        fn event(self: *@This(), id: u8, ph: []const u8, ts: i64, tid: usize, arg: u16, is_end: bool) !void {
+            try self.separator();
+            if (id < events.len) {
+                const info = events[id];
+                try self.writer.print("{{\"name\":\"{s}\",\"cat\":\"{s}\"", .{ info.name, info.category });
+            } else {
+                try self.writer.print("{{\"name\":\"event {d}\",\"cat\":\"unknown\"", .{id});
+            }
+            try self.writer.print(",\"ph\":\"{s}\",\"ts\":{d},\"pid\":0,\"tid\":{d}", .{ ph, ts, tid });
+            if (std.mem.eql(u8, ph, "i")) try self.writer.writeAll(",\"s\":\"t\"");
+
+            const label = if (id >= events.len) "arg" else if (is_end) events[id].end_arg else events[id].begin_arg;
+            if (label.len > 0) {
+                try self.writer.print(",\"args\":{{\"{s}\":{d}}}", .{ label, arg });
+            }
+            try self.writer.writeByte('}');
+        }
+    };
+}
+
+fn countEvents(comptime text: []const u8) usize {
+    @setEvalBranchQuota(100_000);
+    var count: usize = 0;
+    var lines = std.mem.splitScalar(u8, text, '\n');
+    while (lines.next()) |line| {
+        if (std.mem.startsWith(u8, std.mem.trim(u8, line, " \t\r"), "TRACE_EVENT(")) count += 1;
+    }
+    return count;
+}
+
+fn parseEvents(comptime text: []const u8) [countEvents(text)]EventInfo {
+    @setEvalBranchQuota(1_000_000);
+    var result: [countEvents(text)]EventInfo = undefined;
+    var index: usize = 0;
+    var lines = std.mem.splitScalar(u8, text, '\n');
+    while (lines.next()) |raw| {
+        const line = std.mem.trim(u8, raw, " \t\r");
+        if (!std.mem.startsWith(u8, line, "TRACE_EVENT(")) continue;
+        result[index] = parseEvent(line) catch @compileError("trace_events.def: malformed TRACE_EVENT line");
+        index += 1;
+    }
+    return result;
+}
+
+/// One `TRACE_EVENT(NAME, "category", "begin arg", "end arg")` line
+fn parseEvent(line: []const u8) !EventInfo {
+    const open = std.mem.indexOfScalar(u8, line, '(') orelse return error.InvalidEvent;
+    var rest = line[open + 1 ..];
+
+    const name_end = std.mem.indexOfScalar(u8, rest, ',') orelse return error.InvalidEvent;
+    const name = std.mem.trim(u8, rest[0..name_end], " ");
+    rest = rest[name_end + 1 ..];
+
+    const category = try takeQuoted(&rest);
+    const begin_arg = try takeQuoted(&rest);
+    const end_arg = try takeQuoted(&rest);
+    return EventInfo{ .name = name, .category = category, .begin_arg = begin_arg, .end_arg = end_arg };
+}
+
+fn takeQuoted(rest: *[]const u8) ![]const u8 {
+    const start = std.mem.indexOfScalar(u8, rest.*, '"') orelse return error.InvalidEvent;
+    const end = std.mem.indexOfScalarPos(u8, rest.*, start + 1, '"') orelse return error.InvalidEvent;
+    const text = rest.*[start + 1 .. end];
+    rest.* = rest.*[end + 1 ..];
+    return text;
+}
+
+/// Index of the event called name
+pub fn eventId(comptime name: []const u8) u8 {
+    inline for (events, 0..) |info, id| {
+        if (comptime std.mem.eql(u8, info.name, name)) return id;
+    }
+    @compileError("no trace event named " ++ name);
+}
+
+fn appendRecord(payload: []u8, index: usize, timestamp_us: u32, event: u8, phase: Phase, arg: u16) void {
+    const bytes = payload[HEADER_SIZE + index * RECORD_SIZE ..][0..RECORD_SIZE];
+    std.mem.writeInt(u32, bytes[0..4], timestamp_us, .little);
+    bytes[4] = event;
+    bytes[5] = @intFromEnum(phase);
+    std.mem.writeInt(u16, bytes[6..8], arg, .little);
+}
+
+fn writeHeader(payload: []u8, now_us: u32, lost: u32, core: u8, flags: u8, count: u16) void {
+    std.mem.writeInt(u32, payload[0..4], now_us, .little);
+    std.mem.writeInt(u32, payload[4..8], lost, .little);
+    payload[8] = core;
+    payload[9] = flags;
+    std.mem.writeInt(u16, payload[10..12], count, .little);
+}
+
+test "event table is read from the firmware" {
+    try std.testing.expect(events.len > 0);
+    try std.testing.expectEqualStrings("RX_POLL", events[0].name);
+    try std.testing.expectEqualStrings("serial", events[0].category);
+    try std.testing.expectEqualStrings("", events[0].begin_arg);
+    try std.testing.expectEqualStrings("bytes", events[0].end_arg);
+    try std.testing.expect(events.len <= 256);
+}
+
+test "parts are checked against their record count" {
+    var payload: [HEADER_SIZE + 2 * RECORD_SIZE]u8 = undefined;
+    writeHeader(&payload, 1000, 0, 0, FLAG_LAST, 2);
+    const part = try Part.parse(&payload);
+    try std.testing.expectEqual(@as(usize, 2), part.count());
+    try std.testing.expect(part.isLast());
+
+    try std.testing.expectError(error.InvalidTrace, Part.parse(payload[0 .. payload.len - 1]));
+    writeHeader(&payload, 1000, 0, 2, 0, 2);
+    try std.testing.expectError(error.InvalidTrace, Part.parse(&payload));
+}
+
+test "dump converts to nested Chrome trace events" {
+    const rx = eventId("RX_POLL");
+    const crc = eventId("CRC");
+    const decode = eventId("CHUNK_DECODE");
+    const dma = eventId("SPI_DMA");
+
+    var dump = Dump.init(std.testing.allocator);
+    defer dump.deinit();
+
+    // Core0: an orphan end (its begin was overwritten), a nested span, and
+    // a span still open when the ring was read. The clock wrapped mid-dump.
+    var core0: [HEADER_SIZE + 6 * RECORD_SIZE]u8 = undefined;
+    writeHeader(&core0, 40, 3, 0, 0, 6);
+    appendRecord(&core0, 0, 0xFFFF_FFF0, crc, .end, 1);
+    appendRecord(&core0, 1, 0xFFFF_FFF6, rx, .begin, 0);
+    appendRecord(&core0, 2, 0xFFFF_FFFA, crc, .begin, 512);
+    appendRecord(&core0, 3, 4, crc, .end, 1);
+    appendRecord(&core0, 4, 10, rx, .end, 600);
+    appendRecord(&core0, 5, 20, rx, .begin, 0);
+    try std.testing.expect(!try dump.add(&core0));
+
+    var core1: [HEADER_SIZE + 3 * RECORD_SIZE]u8 = undefined;
+    writeHeader(&core1, 50, 0, 1, FLAG_LAST, 3);
+    appendRecord(&core1, 0, 12, decode, .begin, 7);
+    appendRecord(&core1, 1, 14, dma, .instant, 480);
+    appendRecord(&core1, 2, 30, decode, .end, 1);
+    try std.testing.expect(try dump.add(&core1));
+    try std.testing.expectEqual(@as(usize, 9), dump.eventCount());
+
+    var buffer: [2048]u8 = undefined;
+    var stream = std.io.fixedBufferStream(&buffer);
+    try dump.writeChromeJson(stream.writer());
+    const json = stream.getWritten();
+
+    // Valid JSON, with the orphan end dropped and the open span closed
+    const parsed = try std.json.parseFromSlice(std.json.Value, std.testing.allocator, json, .{});
+    defer parsed.deinit();
+    const list = parsed.value.object.get("traceEvents").?.array.items;
+    try std.testing.expectEqual(@as(usize, 2 + 5 + 1 + 3), list.len);
+
+    // 0 is the orphan end, 56 us before core0 was read at 40
+    const first = list[1].object;
+    try std.testing.expectEqualStrings("RX_POLL", first.get("name").?.string);
+    try std.testing.expectEqualStrings("B", first.get("ph").?.string);
+    try std.testing.expectEqual(@as(i64, 6), first.get("ts").?.integer);
+
+    const crc_end = list[3].object;
+    try std.testing.expectEqualStrings("CRC", crc_end.get("name").?.string);
+    try std.testing.expectEqual(@as(i64, 20), crc_end.get("ts").?.integer);
+    try std.testing.expectEqual(@as(i64, 1), crc_end.get("args").?.object.get("ok").?.integer);
+
+    const open_end = list[6].object;
+    try std.testing.expectEqualStrings("E", open_end.get("ph").?.string);
+    try std.testing.expectEqual(@as(i64, 56), open_end.get("ts").?.integer);
+
+    // Core1 lines up on the same clock
+    const instant = list[9].object;
+    try std.testing.expectEqualStrings("i", instant.get("ph").?.string);
+    try std.testing.expectEqual(@as(i64, 1), instant.get("tid").?.integer);
+    try std.testing.expectEqual(@as(i64, 30), instant.get("ts").?.integer);
+    try std.testing.expectEqual(@as(i64, 480), instant.get("args").?.object.get("bytes").?.integer);
+}
@@ -5,10 +5,41 @@ const StateMachine = @import("state.zig").StateMachine;
 const State = @import("state.zig").State;
 const Packet = @import("packet.zig").Packet;
 const PacketType = @import("packet.zig").PacketType;
-const PacketHeader = @import("packet.zig").PacketHeader;
+const Framing = @import("packet.zig").Framing;
+const packet_codec = @import("packet.zig");
 const constants = @import("constants.zig");
+const log_decoder = @import("log_decoder.zig");
+const trace = @import("trace.zig");
+const stats = @import("stats.zig");
 const commands = @import("command");
 const image = commands.image;
+const region = commands.region;
+const delta = commands.delta;
+const palette = commands.palette;
+const round = commands.round;
+
+/// Module prefix of the device's boot timeline debug packet
+const boot_prefix = "Boot: ";
+
+/// Print "name=us" pairs as milliseconds since power-on and since the
+/// previous phase
+fn printBootTimeline(pairs: []const u8) !void {
+    const stdout = std.io.getStdOut().writer();
+    try stdout.print("Boot timeline (ms since power-on):\n", .{});
+
+    var previous: u64 = 0;
+    var it = std.mem.tokenizeScalar(u8, pairs, ' ');
+    while (it.next()) |pair| {
+        const eq = std.mem.indexOfScalar(u8, pair, '=') orelse continue;
+        const us = std.fmt.parseInt(u64, pair[eq + 1 ..], 10) catch continue;
+        try stdout.print("  {s:<10} {d:>8.1}  (+{d:.1})\n", .{
+            pair[0..eq],
+            @as(f64, @floatFromInt(us)) / 1000.0,
+            @as(f64, @floatFromInt(us -| previous)) / 1000.0,
+        });
+        previous = us;
+    }
+}
 
 pub const TransferError = error{
     SyncFailed,
@@ -21,11 +52,38 @@ pub const TransferError = error{
     NotImplemented,
 };
 
+/// Cumulative/selective ACK the device returns for each windowed DATA chunk
+pub const WindowAck = struct {
+    next_chunk: u16, // Every chunk below this has arrived
+    sack_bitmap: u32, // Bit n set: chunk next_chunk + 1 + n has arrived
+
+    pub fn parse(payload: []const u8) !WindowAck {
+        if (payload.len != constants.ACK_SIZE) {
+            return error.InvalidResponse;
+        }
+        return WindowAck{
+            .next_chunk = std.mem.readInt(u16, payload[0..2], .little),
+            .sack_bitmap = std.mem.readInt(u32, payload[2..6], .little),
+        };
+    }
+
+    pub fn covers(self: WindowAck, index: u16) bool {
+        if (index < self.next_chunk) return true;
+        const offset = index - self.next_chunk;
+        if (offset == 0 or offset > 32) return false;
+        return (self.sack_bitmap >> @intCast(offset - 1)) & 1 == 1;
+    }
+};
+
 pub const Transfer = struct {
     serial: *Serial,
     logger: *Logger,
     state: *StateMachine,
-    buffer: [constants.MAX_PACKET_SIZE]u8,
+    framing: Framing,
+    tx_buffer: [packet_codec.MAX_FRAME_SIZE]u8,
+    rx_buffer: [2 * packet_codec.MAX_FRAME_SIZE]u8,
+    rx_len: usize,
+    frame_buffer: [packet_codec.MAX_FRAME_SIZE]u8,
 
     const Self = @This();
 
@@ -34,7 +92,11 @@ pub const Transfer = struct {
             .serial = serial,
             .logger = logger,
             .state = state,
-            .buffer = undefined,
+            .framing = .v1,
+            .tx_buffer = undefined,
+            .rx_buffer = undefined,
+            .rx_len = 0,
+            .frame_buffer = undefined,
         };
     }
 
@@ -43,17 +105,19 @@ pub const Transfer = struct {
         const stdout = std.io.getStdOut().writer();
         try stdout.print("\nInitiating protocol sync...\n", .{});
 
-        // Clear any pending data
+        // Clear any pending data; the device talks v1 until we negotiate
         try self.serial.clearInput();
+        self.rx_len = 0;
+        self.framing = .v1;
 
         // Enter sync state
         try self.state.transition(.syncing);
 
-        // Send sync packet with version
+        // Send sync packet with version and the framing we'd like to switch to
         const sync_packet = try Packet.init(
             .SYNC,
             self.state.nextSequence(),
-            &[_]u8{constants.VERSION},
+            &[_]u8{ constants.VERSION, @intFromEnum(Framing.v2) },
         );
 
         var retry: u8 = 0;
@@ -74,9 +138,16 @@ pub const Transfer = struct {
                 continue;
             };
 
-            if (response.header.packet_type == .SYNC_ACK) {
+            if (response.header.packet_type == .ACK) {
+                // The ACK names the framing the device uses from now on;
+                // older firmware sends no payload and stays on v1
+                if (response.payload) |payload| {
+                    if (payload.len == 1 and payload[0] == @intFromEnum(Framing.v2)) {
+                        self.framing = .v2;
+                    }
+                }
                 try self.state.transition(.ready);
-                try stdout.print("\nSync established (Protocol v{})\n", .{constants.VERSION});
+                try stdout.print("\nSync established (Protocol v{}, framing {s})\n", .{ constants.VERSION, @tagName(self.framing) });
                 self.state.resetRetry();
                 return;
             }
@@ -88,16 +159,26 @@ pub const Transfer = struct {
 
     /// Send a command to the device
     pub fn sendCommand(self: *Self, command: constants.Command) !void {
+        try self.sendCommandArgs(command, &[_]u8{});
+    }
+
+    /// Send a command followed by its argument bytes
+    pub fn sendCommandArgs(self: *Self, command: constants.Command, args: []const u8) !void {
         if (self.state.current_state != .ready) {
             try self.sync();
         }
 
         try self.state.transition(.sending_command);
 
+        var cmd_payload: [packet_codec.MAX_PAYLOAD_SIZE]u8 = undefined;
+        if (args.len + 1 > cmd_payload.len) return error.InvalidPacket;
+        cmd_payload[0] = @intFromEnum(command);
+        @memcpy(cmd_payload[1..][0..args.len], args);
+
         const cmd_packet = try Packet.init(
             .CMD,
             self.state.nextSequence(),
-            &[_]u8{@intFromEnum(command)},
+            cmd_payload[0 .. args.len + 1],
         );
 
         try self.sendPacket(cmd_packet);
@@ -110,133 +191,328 @@ pub const Transfer = struct {
         try self.state.transition(.ready);
     }
 
-    /// Send data in chunks
+    /// Send data in chunks, keeping up to WINDOW_SIZE chunks in flight.
+    /// Every chunk carries its 16-bit index; the device answers each one
+    /// with a cumulative/selective ACK and only missing chunks are resent.
     pub fn sendData(self: *Self, data: []const u8) !void {
         if (self.state.current_state != .ready) {
             return error.InvalidState;
         }
 
+        const total_chunks = (data.len + constants.CHUNK_SIZE - 1) / constants.CHUNK_SIZE;
+        if (total_chunks > constants.MAX_CHUNKS) {
+            return error.TransferFailed;
+        }
+
         const stdout = std.io.getStdOut().writer();
-        var total_sent: usize = 0;
-
-        while (total_sent < data.len) {
-            const chunk_size = @min(constants.CHUNK_SIZE, data.len - total_sent);
-            const chunk = data[total_sent .. total_sent + chunk_size];
-
-            const data_packet = try Packet.init(
-                .DATA,
-                self.state.nextSequence(),
-                chunk,
-            );
-
-            var retry: u8 = 0;
-            while (retry < constants.MAX_RETRIES) : (retry += 1) {
-                if (retry > 0) {
-                    const delay = self.state.getRetryDelay();
-                    try stdout.print("\rRetry {}/{}: Waiting {}ms...", .{ retry + 1, constants.MAX_RETRIES, delay });
-                    std.time.sleep(delay * std.time.ns_per_ms);
-                }
+        var acked = std.StaticBitSet(constants.MAX_CHUNKS).initEmpty();
+        var base: usize = 0; // Oldest unacknowledged chunk
+        var next: usize = 0; // Next chunk never sent
+        var fast_retransmit: ?usize = null;
+
+        while (base < total_chunks) {
+            // Fill the window
+            while (next < total_chunks and next < base + constants.WINDOW_SIZE) : (next += 1) {
+                try self.sendChunk(data, next);
+            }
 
-                try self.sendPacket(data_packet);
+            const response = self.receivePacketWithin(constants.BASE_TIMEOUT_MS) catch |err| {
+                try stdout.print("\nTransfer error: {}\n", .{err});
+                try self.state.incrementRetry();
+                try self.resendUnacked(data, &acked, base, next);
+                continue;
+            };
 
-                const response = self.receivePacket() catch |err| {
-                    try stdout.print("Transfer error: {}\n", .{err});
+            switch (response.header.packet_type) {
+                .ACK => {
+                    const payload = response.payload orelse continue;
+                    const ack = WindowAck.parse(payload) catch continue;
+
+                    var index = base;
+                    while (index < next) : (index += 1) {
+                        if (ack.covers(@intCast(index))) acked.set(index);
+                    }
+
+                    const previous_base = base;
+                    while (base < next and acked.isSet(base)) base += 1;
+                    if (base > previous_base) {
+                        self.state.resetRetry();
+                        const sent = @min(base * constants.CHUNK_SIZE, data.len);
+                        const progress = @as(f32, @floatFromInt(sent)) / @as(f32, @floatFromInt(data.len)) * 100.0;
+                        try stdout.print("\rProgress: {d:.1}% ({}/{} bytes)", .{ progress, sent, data.len });
+                    }
+
+                    // Chunks past the cumulative point arrived, so the one at
+                    // it was lost; resend it once rather than on every ACK
+                    if (ack.sack_bitmap != 0 and ack.next_chunk < total_chunks and
+                        fast_retransmit != ack.next_chunk)
+                    {
+                        fast_retransmit = ack.next_chunk;
+                        try self.sendChunk(data, ack.next_chunk);
+                    }
+                },
+                .NACK => {
+                    if (response.payload) |payload| {
+                        try stdout.print("\nNACK received: {s}\n", .{payload});
+                    }
                     try self.state.incrementRetry();
-                    continue;
-                };
-
-                switch (response.header.packet_type) {
-                    .ACK => break,
-                    .NACK => {
-                        if (response.payload) |payload| {
-                            try stdout.print("\nNACK received: {s}\n", .{payload});
-                        }
-                        try self.state.incrementRetry();
-                        continue;
-                    },
-                    else => {
-                        try self.state.incrementRetry();
-                        continue;
-                    },
-                }
+                    try self.resendUnacked(data, &acked, base, next);
+                },
+                // Debug and heartbeat traffic interleaves with ACKs
+                else => {},
             }
+        }
 
-            if (retry >= constants.MAX_RETRIES) {
-                try self.state.transition(.error_state);
-                return error.TransferFailed;
-            }
+        try stdout.print("\nTransfer complete!\n", .{});
+    }
+
+    /// Send one windowed chunk: u16 LE index followed by its slice of data
+    fn sendChunk(self: *Self, data: []const u8, index: usize) !void {
+        const start = index * constants.CHUNK_SIZE;
+        const end = @min(start + constants.CHUNK_SIZE, data.len);
 
-            total_sent += chunk_size;
-            self.state.resetRetry();
+        var payload: [constants.CHUNK_INDEX_SIZE + constants.CHUNK_SIZE]u8 = undefined;
+        std.mem.writeInt(u16, payload[0..constants.CHUNK_INDEX_SIZE], @intCast(index), .little);
+        @memcpy(payload[constants.CHUNK_INDEX_SIZE..][0 .. end - start], data[start..end]);
 
-            const progress = @as(f32, @floatFromInt(total_sent)) / @as(f32, @floatFromInt(data.len)) * 100.0;
-            try stdout.print("\rProgress: {d:.1}% ({}/{} bytes)", .{ progress, total_sent, data.len });
+        // DATA is ordered by chunk index, the header sequence just mirrors it
+        const data_packet = try Packet.init(
+            .DATA,
+            @truncate(index),
+            payload[0 .. constants.CHUNK_INDEX_SIZE + end - start],
+        );
+        try self.sendPacket(data_packet);
+    }
+
+    /// Resend every chunk in [base, next) the device hasn't acknowledged
+    fn resendUnacked(self: *Self, data: []const u8, acked: *const std.StaticBitSet(constants.MAX_CHUNKS), base: usize, next: usize) !void {
+        var index = base;
+        while (index < next) : (index += 1) {
+            if (!acked.isSet(index)) try self.sendChunk(data, index);
         }
+    }
 
-        try stdout.print("\nTransfer complete!\n", .{});
+    /// Poll for a packet until one arrives or timeout_ms passes
+    fn receivePacketWithin(self: *Self, timeout_ms: u64) !Packet {
+        const deadline = std.time.milliTimestamp() + @as(i64, @intCast(timeout_ms));
+        while (true) {
+            return self.receivePacket() catch |err| {
+                if (err != error.Timeout or std.time.milliTimestamp() >= deadline) {
+                    return err;
+                }
+                std.time.sleep(std.time.ns_per_ms);
+                continue;
+            };
+        }
     }
 
-    /// Send a packet to the device
+    /// Send a packet to the device as a single frame
     fn sendPacket(self: *Self, packet: Packet) !void {
-        const header_size = @sizeOf(PacketHeader);
-        const header_bytes = std.mem.asBytes(&packet.header);
-        _ = try self.serial.write(header_bytes[0..header_size]);
-
-        if (packet.payload) |payload| {
-            _ = try self.serial.write(payload);
+        const frame = try packet.encode(self.framing, &self.tx_buffer);
+        const deadline = std.time.milliTimestamp() + @as(i64, @intCast(constants.BASE_TIMEOUT_MS));
+
+        var written: usize = 0;
+        while (written < frame.len) {
+            const bytes_written = try self.serial.write(frame[written..]);
+            if (bytes_written == 0) {
+                if (std.time.milliTimestamp() >= deadline) return error.Timeout;
+                std.time.sleep(std.time.ns_per_ms);
+            }
+            written += bytes_written;
         }
     }
 
-    /// Receive a packet from the device
+    /// Receive a packet from the device. Bytes are gathered until the
+    /// framing's delimiter; the payload stays valid until the next receive.
     fn receivePacket(self: *Self) !Packet {
-        const header_size = @sizeOf(PacketHeader);
-        const header_bytes = self.buffer[0..header_size];
+        const delimiter = packet_codec.frameDelimiter(self.framing);
+
+        while (true) {
+            if (std.mem.indexOfScalar(u8, self.rx_buffer[0..self.rx_len], delimiter)) |end| {
+                const frame_len = end;
+                const oversized = frame_len > self.frame_buffer.len;
+                if (!oversized) {
+                    @memcpy(self.frame_buffer[0..frame_len], self.rx_buffer[0..frame_len]);
+                }
+
+                // Drop the frame and its delimiter from the receive buffer
+                std.mem.copyForwards(u8, self.rx_buffer[0..], self.rx_buffer[end + 1 .. self.rx_len]);
+                self.rx_len -= end + 1;
+
+                // Empty frames are just line noise between packets
+                if (oversized) return error.InvalidPacket;
+                if (frame_len == 0) continue;
 
-        // Read header
-        var total_read: usize = 0;
-        while (total_read < header_size) {
-            const bytes_read = try self.serial.read(header_bytes[total_read..header_size]);
+                return Packet.decode(self.framing, self.frame_buffer[0..frame_len]) catch
+                    return error.InvalidPacket;
+            }
+
+            // No delimiter within a full buffer: the stream is garbage, resync
+            if (self.rx_len == self.rx_buffer.len) {
+                self.rx_len = 0;
+                return error.InvalidPacket;
+            }
+
+            const bytes_read = try self.serial.read(self.rx_buffer[self.rx_len..]);
             if (bytes_read == 0) {
                 return error.Timeout;
             }
-            total_read += bytes_read;
+            self.rx_len += bytes_read;
         }
+    }
 
-        // Convert bytes to header struct
-        const header = std.mem.bytesToValue(PacketHeader, header_bytes[0..@sizeOf(PacketHeader)]);
+    /// Ask the device for its boot timeline and print each phase
+    pub fn queryBootTimeline(self: *Self) !void {
+        if (self.state.current_state != .ready) {
+            try self.sync();
+        }
+
+        const cmd_packet = try Packet.init(
+            .CMD,
+            self.state.nextSequence(),
+            &[_]u8{@intFromEnum(constants.Command.boot)},
+        );
+        try self.sendPacket(cmd_packet);
 
-        // Validate payload length
-        if (header.length > constants.MAX_PACKET_SIZE - header_size) {
-            return error.InvalidPacket;
+        // The timeline arrives as a debug packet next to the ACK; skip
+        // whatever else the device is logging meanwhile
+        const deadline = std.time.milliTimestamp() + @as(i64, @intCast(constants.BASE_TIMEOUT_MS));
+        while (std.time.milliTimestamp() < deadline) {
+            const response = self.receivePacketWithin(constants.BASE_TIMEOUT_MS) catch |err| switch (err) {
+                error.InvalidPacket => continue,
+                else => return err,
+            };
+            if (response.header.packet_type != .DEBUG) continue;
+            const payload = response.payload orelse continue;
+            const text = std.mem.trimLeft(u8, payload, " ");
+            if (!std.mem.startsWith(u8, text, boot_prefix)) continue;
+
+            try printBootTimeline(text[boot_prefix.len..]);
+            return;
         }
+        return error.Timeout;
+    }
 
-        // Read payload if present
-        var payload: ?[]const u8 = null;
-        if (header.length > 0) {
-            const payload_bytes = self.buffer[header_size .. header_size + header.length];
-            total_read = 0;
-            while (total_read < header.length) {
-                const bytes_read = try self.serial.read(payload_bytes[total_read..header.length]);
-                if (bytes_read == 0) {
-                    return error.Timeout;
-                }
-                total_read += bytes_read;
-            }
-            payload = payload_bytes;
+    /// Ask the device for its trace rings and write them to out_path as
+    /// Chrome trace-event JSON
+    pub fn queryTrace(self: *Self, allocator: std.mem.Allocator, out_path: []const u8) !void {
+        if (self.state.current_state != .ready) {
+            try self.sync();
         }
 
-        const packet = Packet{
-            .header = header,
-            .payload = payload,
-        };
+        const cmd_packet = try Packet.init(
+            .CMD,
+            self.state.nextSequence(),
+            &[_]u8{@intFromEnum(constants.Command.trace)},
+        );
+        try self.sendPacket(cmd_packet);
 
-        // Verify CRC32
-        const calculated_crc = try packet.calculateCRC32();
-        if (calculated_crc != header.crc32) {
-            return error.InvalidPacket;
+        var dump = trace.Dump.init(allocator);
+        defer dump.deinit();
+
+        // A few TRACE packets per core, interleaved with whatever else the
+        // device sends; each one pushes the deadline back
+        var deadline = std.time.milliTimestamp() + @as(i64, @intCast(constants.BASE_TIMEOUT_MS));
+        while (!dump.complete) {
+            if (std.time.milliTimestamp() >= deadline) return error.Timeout;
+            const response = self.receivePacketWithin(constants.BASE_TIMEOUT_MS) catch |err| switch (err) {
+                error.InvalidPacket => continue,
+                else => return err,
+            };
+            if (response.header.packet_type != .TRACE) continue;
+            const payload = response.payload orelse continue;
+            _ = dump.add(payload) catch return error.InvalidResponse;
+            deadline = std.time.milliTimestamp() + @as(i64, @intCast(constants.BASE_TIMEOUT_MS));
         }
 
-        return packet;
+        const file = try std.fs.cwd().createFile(out_path, .{});
+        defer file.close();
+        var buffered = std.io.bufferedWriter(file.writer());
+        try dump.writeChromeJson(buffered.writer());
+        try buffered.flush();
+
+        const stdout = std.io.getStdOut().writer();
+        try stdout.print("Wrote {d} trace events to {s}", .{ dump.eventCount(), out_path });
+        for (dump.cores, 0..) |core, index| {
+            if (core.lost > 0) try stdout.print(" (core{d}: {d} older events overwritten)", .{ index, core.lost });
+        }
+        try stdout.print("\nOpen it in chrome://tracing or ui.perfetto.dev\n", .{});
+    }
+
+    /// Ask the device for its latency histograms and traffic counters
+    pub fn queryStats(self: *Self) !stats.Snapshot {
+        if (self.state.current_state != .ready) {
+            try self.sync();
+        }
+
+        const cmd_packet = try Packet.init(
+            .CMD,
+            self.state.nextSequence(),
+            &[_]u8{@intFromEnum(constants.Command.stats)},
+        );
+        try self.sendPacket(cmd_packet);
+
+        // One STATS packet next to the ACK; skip whatever else arrives
+        const deadline = std.time.milliTimestamp() + @as(i64, @intCast(constants.BASE_TIMEOUT_MS));
+        while (std.time.milliTimestamp() < deadline) {
+            const response = self.receivePacketWithin(constants.BASE_TIMEOUT_MS) catch |err| switch (err) {
+                error.InvalidPacket => continue,
+                else => return err,
+            };
+            if (response.header.packet_type != .STATS) continue;
+            const payload = response.payload orelse continue;
+            return stats.Snapshot.parse(payload) catch error.InvalidResponse;
+        }
+        return error.Timeout;
+    }
+
+    /// Print latency percentiles and throughput. With watch, redraw every
+    /// second until interrupted, each time over the last second only.
+    pub fn showStats(self: *Self, watch: bool) !void {
+        const stdout = std.io.getStdOut().writer();
+        var previous: ?stats.Snapshot = null;
+        while (true) {
+            const current = try self.queryStats();
+            if (watch) try stdout.print("[2J[H", .{});
+            try stats.render(stdout, current, previous);
+            if (!watch) return;
+
+            try stdout.print("\n(Ctrl+C to exit)\n", .{});
+            previous = current;
+            std.time.sleep(std.time.ns_per_s);
+        }
+    }
+
+    /// Print what the device logs until interrupted: DEBUG packets as
+    /// text, LOG packets decoded against the firmware's site table
+    pub fn monitor(self: *Self) !void {
+        try self.sync();
+
+        const stdout = std.io.getStdOut().writer();
+        try stdout.print("Monitoring device log (Ctrl+C to exit)...\n\n", .{});
+
+        while (true) {
+            const packet = self.receivePacket() catch |err| switch (err) {
+                error.Timeout => {
+                    std.time.sleep(10 * std.time.ns_per_ms); // Small delay to prevent busy-waiting
+                    continue;
+                },
+                error.InvalidPacket => continue,
+                else => return err,
+            };
+            const payload = packet.payload orelse continue;
+
+            switch (packet.header.packet_type) {
+                .DEBUG => try stdout.print("{s}\n", .{std.mem.trimLeft(u8, payload, " ")}),
+                .LOG => {
+                    log_decoder.render(stdout, payload) catch {
+                        try stdout.print("Malformed log record ({d} bytes)", .{payload.len});
+                    };
+                    try stdout.print("\n", .{});
+                },
+                else => {},
+            }
+        }
     }
 
     /// Send a test pattern to the device
@@ -247,17 +523,99 @@ pub const Transfer = struct {
             3 => constants.Command.gradient,
             else => return error.InvalidPattern,
         };
+        // The panel no longer shows the last image, so the next one goes in full
+        region.forgetLastFrame();
+        palette.forgetLast();
         try self.sendCommand(cmd);
     }
 
-    /// Send an image to the device
-    pub fn sendImage(self: *Self, image_path: []const u8) !void {
+    /// Send only the rectangles of frame listed in rects; each lands in its
+    /// own display window on the device
+    pub fn sendRegions(self: *Self, allocator: std.mem.Allocator, frame: []const u8, rects: []const region.Rect) !void {
+        const stream = try region.encode(allocator, frame, rects);
+        defer allocator.free(stream);
+
+        var size: [4]u8 = undefined;
+        std.mem.writeInt(u32, &size, @intCast(stream.len), .little);
+        try self.sendCommandArgs(constants.Command.region, &size);
+        try self.sendData(stream);
+        try self.sendCommand(constants.Command.end);
+    }
+
+    /// Send a skip/copy delta stream against the frame the device shows
+    pub fn sendDelta(self: *Self, stream: []const u8) !void {
+        var size: [4]u8 = undefined;
+        std.mem.writeInt(u32, &size, @intCast(stream.len), .little);
+        try self.sendCommandArgs(constants.Command.delta, &size);
+        try self.sendData(stream);
+        try self.sendCommand(constants.Command.end);
+    }
+
+    /// The device still holds this indexed frame; cache it again
+    fn keepIndexed(allocator: std.mem.Allocator, indexed: palette.Indexed) !void {
+        const stream = try palette.encode(allocator, indexed);
+        defer allocator.free(stream);
+        try palette.saveLast(stream);
+    }
+
+    fn printFrameBytes(wire_bytes: usize) !void {
+        const ratio = @as(f32, @floatFromInt(image.ImageSize.total_bytes)) / @as(f32, @floatFromInt(@max(wire_bytes, 1)));
+        try std.io.getStdOut().writer().print("Frame: {} bytes, {d:.1}:1 vs raw\n", .{ wire_bytes, ratio });
+    }
+
+    /// Send a QOI-compressed full frame; the device decodes it into the
+    /// full-screen window as chunks arrive
+    pub fn sendQOI(self: *Self, stream: []const u8) !void {
+        var size: [4]u8 = undefined;
+        std.mem.writeInt(u32, &size, @intCast(stream.len), .little);
+        try self.sendCommandArgs(constants.Command.qoi, &size);
+        try self.sendData(stream);
+        try self.sendCommand(constants.Command.end);
+    }
+
+    /// Send a BC1 frame. Lossy, but always a quarter of a raw frame, so
+    /// every frame takes the same time on the wire and on the device.
+    pub fn sendBC1(self: *Self, stream: []const u8) !void {
+        try self.sendCommand(constants.Command.bc1);
+        try self.sendData(stream);
+        try self.sendCommand(constants.Command.end);
+    }
+
+    /// Send a raw frame of only the pixels the round panel shows. Like BC1
+    /// the size is fixed, so the command takes no argument.
+    pub fn sendRound(self: *Self, stream: []const u8) !void {
+        try self.sendCommand(constants.Command.round);
+        try self.sendData(stream);
+        try self.sendCommand(constants.Command.end);
+    }
+
+    /// Send an indexed frame. The device keeps its indices, so sendPalette
+    /// can recolour it afterwards.
+    pub fn sendIndexed(self: *Self, stream: []const u8) !void {
+        var size: [4]u8 = undefined;
+        std.mem.writeInt(u32, &size, @intCast(stream.len), .little);
+        try self.sendCommandArgs(constants.Command.indexed, &size);
+        try self.sendData(stream);
+        try self.sendCommand(constants.Command.end);
+    }
+
+    /// Replace palette entries of the indexed frame on the device; the whole
+    /// update fits in the command packet
+    pub fn sendPalette(self: *Self, update: palette.Recolor) !void {
+        var args: [palette.HEADER_SIZE + palette.MAX_COLORS * palette.ENTRY_SIZE]u8 = undefined;
+        try self.sendCommandArgs(constants.Command.palette, update.args(&args));
+    }
+
+    /// Send an image to the device. If the last frame sent is known, the
+    /// cheapest of a palette update, a region update, a delta update and the
+    /// full frame is sent, unless full is set. Full frames go indexed or
+    /// QOI-compressed when either is smaller than the visible spans raw. With lossy set the
+    /// frame always goes as BC1; with colors set it is quantised to that
+    /// many colours and goes indexed.
+    pub fn sendImage(self: *Self, image_path: []const u8, full: bool, lossy: bool, colors: ?usize) !void {
         const stdout = std.io.getStdOut().writer();
         try stdout.print("Loading image from {s}...\n", .{image_path});
 
-        // Start image transfer
-        try self.sendCommand(constants.Command.image);
-
         // Load and validate PNG
         var arena = std.heap.ArenaAllocator.init(std.heap.page_allocator);
         defer arena.deinit();
@@ -271,11 +629,141 @@ pub const Transfer = struct {
         const rgb565_data = try image.convertToRGB565(allocator, rgb888_data, image.ImageSize.width, image.ImageSize.height);
         defer allocator.free(rgb565_data);
 
-        // Send image data
-        try self.sendData(rgb565_data);
+        // The corners are off the round panel; blank them so they never
+        // show up as changes or cost anything to compress
+        round.maskCorners(rgb565_data);
+
+        if (lossy) {
+            const blocks = try image.encodeBC1(allocator, rgb565_data);
+            defer allocator.free(blocks);
+
+            // Cache what the panel will actually show so later deltas line up
+            const shown = try allocator.alloc(u8, image.ImageSize.total_bytes);
+            defer allocator.free(shown);
+            try image.decodeBC1(blocks, shown);
+
+            region.forgetLastFrame();
+            palette.forgetLast();
+            try stdout.print("Sending BC1 image\n", .{});
+            try self.sendBC1(blocks);
+            try region.saveLastFrame(shown);
+            try printFrameBytes(blocks.len);
+            try stdout.print("Image transfer complete!\n", .{});
+            return;
+        }
 
-        // End transfer
-        try self.sendCommand(constants.Command.end);
+        if (colors) |max_colors| {
+            const indexed = try palette.quantize(allocator, rgb565_data, max_colors);
+            defer indexed.deinit(allocator);
+            const stream = try palette.encode(allocator, indexed);
+            defer allocator.free(stream);
+
+            const shown = try allocator.alloc(u8, image.ImageSize.total_bytes);
+            defer allocator.free(shown);
+            palette.render(indexed, shown);
+
+            region.forgetLastFrame();
+            palette.forgetLast();
+            try stdout.print("Sending indexed image, {} colour(s)\n", .{indexed.palette.len});
+            try self.sendIndexed(stream);
+            try region.saveLastFrame(shown);
+            try palette.saveLast(stream);
+            try printFrameBytes(stream.len);
+            try stdout.print("Image transfer complete!\n", .{});
+            return;
+        }
+
+        const compressed = try image.encodeQOI(allocator, rgb565_data);
+        defer allocator.free(compressed);
+
+        // A frame of 256 colours or fewer can also go indexed, losslessly
+        const exact = try palette.exact(allocator, rgb565_data);
+        defer if (exact) |indexed| indexed.deinit(allocator);
+        const indexed_stream = if (exact) |indexed| try palette.encode(allocator, indexed) else null;
+        defer if (indexed_stream) |stream| allocator.free(stream);
+        const indexed_cost = if (indexed_stream) |stream| stream.len else std.math.maxInt(usize);
+        const frame_cost = @min(compressed.len, round.stream_size, indexed_cost);
+
+        // Until this transfer completes the panel contents are unknown
+        const last_frame = if (full) null else region.loadLastFrame(allocator);
+        const last_indexed = if (full) null else palette.loadLast(allocator);
+        defer if (last_indexed) |last| last.deinit(allocator);
+        region.forgetLastFrame();
+        palette.forgetLast();
+
+        if (last_frame) |previous| {
+            const rects = try region.diff(allocator, previous, rgb565_data);
+            if (rects.len == 0) {
+                try stdout.print("Image unchanged, nothing to send\n", .{});
+                try region.saveLastFrame(rgb565_data);
+                if (last_indexed) |last| try keepIndexed(allocator, last);
+                return;
+            }
+            const region_cost = region.totalCost(rects);
+            const update = try delta.encode(allocator, previous, rgb565_data);
+            defer allocator.free(update.stream);
+
+            // The indices on the device may still fit with different colours
+            if (last_indexed) |last| {
+                if (palette.recolor(last, rgb565_data)) |recolor| {
+                    const recolor_cost = palette.HEADER_SIZE + recolor.entries.len * palette.ENTRY_SIZE;
+                    if (recolor_cost < update.stream.len and recolor_cost < region_cost) {
+                        try stdout.print("Sending palette update, {} colour(s)\n", .{recolor.entries.len});
+                        try self.sendPalette(recolor);
+                        try region.saveLastFrame(rgb565_data);
+                        try keepIndexed(allocator, last);
+                        try printFrameBytes(recolor_cost);
+                        try stdout.print("Palette update complete!\n", .{});
+                        return;
+                    }
+                }
+            }
+
+            if (update.stream.len < region_cost and update.stream.len < frame_cost) {
+                try stdout.print("Sending delta update, {} changed pixel(s)\n", .{update.stats.changed_pixels});
+                try self.sendDelta(update.stream);
+                try region.saveLastFrame(rgb565_data);
+                try printFrameBytes(update.stream.len);
+                try stdout.print("Delta update complete!\n", .{});
+                return;
+            }
+            if (region_cost < frame_cost) {
+                try stdout.print("Sending {} changed region(s)\n", .{rects.len});
+                try self.sendRegions(allocator, rgb565_data, rects);
+                try region.saveLastFrame(rgb565_data);
+                try printFrameBytes(region_cost);
+                try stdout.print("Region update complete!\n", .{});
+                return;
+            }
+        }
+
+        if (indexed_stream) |stream| {
+            if (stream.len == frame_cost) {
+                try stdout.print("Sending indexed image, {} colour(s)\n", .{exact.?.palette.len});
+                try self.sendIndexed(stream);
+                try region.saveLastFrame(rgb565_data);
+                try palette.saveLast(stream);
+                try printFrameBytes(stream.len);
+                try stdout.print("Image transfer complete!\n", .{});
+                return;
+            }
+        }
+
+        if (compressed.len < round.stream_size) {
+            try stdout.print("Sending QOI-compressed image\n", .{});
+            try self.sendQOI(compressed);
+            try region.saveLastFrame(rgb565_data);
+            try printFrameBytes(compressed.len);
+            try stdout.print("Image transfer complete!\n", .{});
+            return;
+        }
+
+        // Raw frames go as the visible spans only
+        const spans = try round.pack(allocator, rgb565_data);
+        defer allocator.free(spans);
+        try self.sendRound(spans);
+        try region.saveLastFrame(rgb565_data);
+        try printFrameBytes(spans.len);
         try stdout.print("Image transfer complete!\n", .{});
     }
 };
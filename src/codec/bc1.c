@@ -0,0 +1,113 @@
+#include "bc1.h"
+#include <string.h>
+
+// Weighted mix of two 565 colours per channel: (a * wa + b * wb) / (wa + wb)
+static uint16_t bc1_mix(uint16_t a, uint16_t b, uint8_t wa, uint8_t wb) {
+    uint8_t total = wa + wb;
+    uint16_t r = (((a >> 11) * wa + (b >> 11) * wb) + total / 2) / total;
+    uint16_t g = ((((a >> 5) & 0x3F) * wa + ((b >> 5) & 0x3F) * wb) + total / 2) / total;
+    uint16_t bl = (((a & 0x1F) * wa + (b & 0x1F) * wb) + total / 2) / total;
+    return (r << 11) | (g << 5) | bl;
+}
+
+void bc1_decode_block(const uint8_t *block, uint16_t pixels[16]) {
+    uint16_t palette[4];
+    palette[0] = block[0] | (block[1] << 8);
+    palette[1] = block[2] | (block[3] << 8);
+    if (palette[0] > palette[1]) {
+        palette[2] = bc1_mix(palette[0], palette[1], 2, 1);
+        palette[3] = bc1_mix(palette[0], palette[1], 1, 2);
+    } else {
+        palette[2] = bc1_mix(palette[0], palette[1], 1, 1);
+        palette[3] = 0x0000;
+    }
+
+    uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | ((uint32_t)block[7] << 24);
+    for (int i = 0; i < 16; i++) {
+        pixels[i] = palette[indices & 3];
+        indices >>= 2;
+    }
+}
+
+bool bc1_decoder_init(Bc1Decoder *decoder, uint16_t width, uint16_t height, const Bc1Sink *sink) {
+    memset(decoder, 0, sizeof(Bc1Decoder));
+    if (width == 0 || height == 0 || width > BC1_MAX_WIDTH ||
+        width % BC1_BLOCK_DIM != 0 || height % BC1_BLOCK_DIM != 0) {
+        return false;
+    }
+    decoder->width = width;
+    decoder->height = height;
+    if (sink) {
+        decoder->sink = *sink;
+    }
+    return true;
+}
+
+// Place a block in the row buffer; flush the four scanlines when the row is full
+static bool bc1_decoder_put_block(Bc1Decoder *decoder, const uint8_t *block) {
+    if (decoder->block_row >= decoder->height / BC1_BLOCK_DIM) {
+        return false;
+    }
+
+    uint16_t pixels[16];
+    bc1_decode_block(block, pixels);
+
+    uint32_t stride = (uint32_t)decoder->width * BC1_PIXEL_SIZE;
+    uint8_t *out = decoder->rows + decoder->block_x * BC1_BLOCK_DIM * BC1_PIXEL_SIZE;
+    for (int y = 0; y < BC1_BLOCK_DIM; y++) {
+        for (int x = 0; x < BC1_BLOCK_DIM; x++) {
+            uint16_t pixel = pixels[y * BC1_BLOCK_DIM + x];
+            out[2 * x] = pixel & 0xFF;
+            out[2 * x + 1] = pixel >> 8;
+        }
+        out += stride;
+    }
+
+    if (++decoder->block_x < decoder->width / BC1_BLOCK_DIM) {
+        return true;
+    }
+    decoder->block_x = 0;
+    decoder->block_row++;
+    return !decoder->sink.write ||
+           decoder->sink.write(decoder->rows, stride * BC1_BLOCK_DIM, decoder->sink.context);
+}
+
+bool bc1_decoder_feed(Bc1Decoder *decoder, const uint8_t *data, size_t length) {
+    // Finish a block split across the previous call
+    if (decoder->block_length > 0) {
+        size_t take = BC1_BLOCK_SIZE - decoder->block_length;
+        if (take > length) {
+            take = length;
+        }
+        memcpy(decoder->block + decoder->block_length, data, take);
+        decoder->block_length += take;
+        data += take;
+        length -= take;
+
+        if (decoder->block_length < BC1_BLOCK_SIZE) {
+            return true;
+        }
+        decoder->block_length = 0;
+        if (!bc1_decoder_put_block(decoder, decoder->block)) {
+            return false;
+        }
+    }
+
+    while (length >= BC1_BLOCK_SIZE) {
+        if (!bc1_decoder_put_block(decoder, data)) {
+            return false;
+        }
+        data += BC1_BLOCK_SIZE;
+        length -= BC1_BLOCK_SIZE;
+    }
+
+    memcpy(decoder->block, data, length);
+    decoder->block_length = length;
+    return true;
+}
+
+bool bc1_decoder_complete(const Bc1Decoder *decoder) {
+    return decoder->block_row == decoder->height / BC1_BLOCK_DIM &&
+           decoder->block_x == 0 &&
+           decoder->block_length == 0;
+}
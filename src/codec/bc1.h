@@ -0,0 +1,56 @@
+#ifndef DESKTHANG_BC1_H
+#define DESKTHANG_BC1_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// BC1/DXT1-style block compression at a fixed 4 bits per pixel. The frame
+// is cut into 4x4 blocks, sent left to right, top to bottom, each 8 bytes:
+//   color0, color1: RGB565 endpoints (u16 LE)
+//   indices:        u32 LE, 2 bits per pixel, pixel (x, y) at bit 2 * (4y + x)
+// Index 0 and 1 pick the endpoints. If color0 > color1, 2 and 3 are the
+// points a third and two thirds of the way from color0 to color1; otherwise
+// 2 is the midpoint and 3 is black. Interpolation is per 565 channel,
+// rounded to nearest, so host and device agree bit for bit.
+#define BC1_BLOCK_SIZE   8
+#define BC1_BLOCK_DIM    4
+#define BC1_PIXEL_SIZE   2
+#define BC1_MAX_WIDTH    240
+
+#define BC1_ENCODED_SIZE(width, height) \
+    ((size_t)((width) / BC1_BLOCK_DIM) * ((height) / BC1_BLOCK_DIM) * BC1_BLOCK_SIZE)
+
+// A block row expands to four full scanlines, which go to the sink in one
+// write once the row's last block is in
+#define BC1_ROW_BUFFER_SIZE (BC1_BLOCK_DIM * BC1_MAX_WIDTH * BC1_PIXEL_SIZE)
+
+typedef struct {
+    bool (*write)(const uint8_t *data, uint32_t length, void *context);
+    void *context;
+} Bc1Sink;
+
+typedef struct {
+    Bc1Sink sink;
+    uint16_t width;           // Pixels, a multiple of 4
+    uint16_t height;          // Pixels, a multiple of 4
+    uint16_t block_x;         // Blocks decoded in the current block row
+    uint16_t block_row;       // Block rows handed to the sink
+    uint8_t block[BC1_BLOCK_SIZE];  // Block being gathered across feed calls
+    uint8_t block_length;
+    uint8_t rows[BC1_ROW_BUFFER_SIZE];
+} Bc1Decoder;
+
+// False if the size isn't a multiple of 4 or is wider than BC1_MAX_WIDTH
+bool bc1_decoder_init(Bc1Decoder *decoder, uint16_t width, uint16_t height, const Bc1Sink *sink);
+
+// False on a block past the end of the frame or a sink failure
+bool bc1_decoder_feed(Bc1Decoder *decoder, const uint8_t *data, size_t length);
+
+// True once every block row has been handed to the sink
+bool bc1_decoder_complete(const Bc1Decoder *decoder);
+
+// Expand one block into 16 pixels, row by row
+void bc1_decode_block(const uint8_t *block, uint16_t pixels[16]);
+
+#endif // DESKTHANG_BC1_H
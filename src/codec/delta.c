@@ -0,0 +1,70 @@
+#include "delta.h"
+#include <string.h>
+
+void delta_decoder_init(DeltaDecoder *decoder, uint32_t frame_size, const DeltaSink *sink) {
+    memset(decoder, 0, sizeof(DeltaDecoder));
+    decoder->frame_size = frame_size;
+    if (sink) {
+        decoder->sink = *sink;
+    }
+}
+
+// Op header complete: skips apply at once, copies wait for their pixels
+static bool delta_decoder_start_op(DeltaDecoder *decoder) {
+    uint16_t op = decoder->op[0] | (decoder->op[1] << 8);
+    uint32_t length = (uint32_t)(op & DELTA_MAX_RUN) * DELTA_PIXEL_SIZE;
+    
+    if (length == 0 || length > decoder->frame_size - decoder->position) {
+        return false;
+    }
+    decoder->ops++;
+    
+    if (op & DELTA_OP_COPY) {
+        decoder->copy_remaining = length;
+        return true;
+    }
+    
+    if (decoder->sink.skip &&
+        !decoder->sink.skip(decoder->position, length, decoder->sink.context)) {
+        return false;
+    }
+    decoder->position += length;
+    return true;
+}
+
+bool delta_decoder_feed(DeltaDecoder *decoder, const uint8_t *data, size_t length) {
+    while (length > 0) {
+        if (decoder->copy_remaining == 0) {
+            decoder->op[decoder->op_length++] = *data++;
+            length--;
+            
+            if (decoder->op_length < DELTA_OP_SIZE) {
+                continue;
+            }
+            decoder->op_length = 0;
+            
+            if (!delta_decoder_start_op(decoder)) {
+                return false;
+            }
+            continue;
+        }
+        
+        uint32_t take = decoder->copy_remaining < length ? decoder->copy_remaining : (uint32_t)length;
+        if (decoder->sink.copy &&
+            !decoder->sink.copy(decoder->position, data, take, decoder->sink.context)) {
+            return false;
+        }
+        data += take;
+        length -= take;
+        decoder->position += take;
+        decoder->copy_remaining -= take;
+        decoder->copied += take;
+    }
+    return true;
+}
+
+bool delta_decoder_complete(const DeltaDecoder *decoder) {
+    return decoder->position == decoder->frame_size &&
+           decoder->copy_remaining == 0 &&
+           decoder->op_length == 0;
+}
@@ -0,0 +1,45 @@
+#ifndef DESKTHANG_DELTA_H
+#define DESKTHANG_DELTA_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Frame delta decoding. A delta stream walks the frame from the first pixel
+// as a run of ops, each a little-endian u16:
+//   bit 15 clear: skip the next `count` pixels, they are unchanged
+//   bit 15 set:   copy: `count` RGB565 pixels follow the op
+// Ops and pixels may be split across any number of feed calls. The decoder
+// only tracks position; the sink decides what a skip or copy does.
+#define DELTA_OP_SIZE    2
+#define DELTA_OP_COPY    0x8000
+#define DELTA_MAX_RUN    0x7FFF   // Pixels per op
+#define DELTA_PIXEL_SIZE 2
+
+typedef struct {
+    // position is the byte offset into the frame where the run starts
+    bool (*skip)(uint32_t position, uint32_t length, void *context);
+    bool (*copy)(uint32_t position, const uint8_t *data, uint32_t length, void *context);
+    void *context;
+} DeltaSink;
+
+typedef struct {
+    DeltaSink sink;
+    uint32_t frame_size;      // Bytes in the frame being updated
+    uint32_t position;        // Byte offset of the next pixel
+    uint32_t copy_remaining;  // Pixel bytes still to come for the current copy
+    uint8_t op[DELTA_OP_SIZE];
+    uint8_t op_length;        // Op bytes gathered so far
+    uint32_t ops;             // Ops decoded
+    uint32_t copied;          // Pixel bytes copied
+} DeltaDecoder;
+
+void delta_decoder_init(DeltaDecoder *decoder, uint32_t frame_size, const DeltaSink *sink);
+
+// False on an op that runs past the frame, a zero-length op, or a sink failure
+bool delta_decoder_feed(DeltaDecoder *decoder, const uint8_t *data, size_t length);
+
+// True once every pixel of the frame has been skipped or copied
+bool delta_decoder_complete(const DeltaDecoder *decoder);
+
+#endif // DESKTHANG_DELTA_H
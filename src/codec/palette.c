@@ -0,0 +1,166 @@
+#include "palette.h"
+#include <string.h>
+
+void palette_expand(const uint8_t *indices, uint32_t pixels, uint8_t bits,
+                    const uint16_t *lut, uint8_t *out) {
+    uint8_t per_byte = 8 / bits;
+    uint8_t mask = (1u << bits) - 1;
+
+    while (pixels > 0) {
+        uint8_t packed = *indices++;
+        uint8_t count = pixels < per_byte ? pixels : per_byte;
+        for (uint8_t i = 0; i < count; i++) {
+            uint16_t pixel = lut[packed & mask];
+            *out++ = pixel & 0xFF;
+            *out++ = pixel >> 8;
+            packed >>= bits;
+        }
+        pixels -= count;
+    }
+}
+
+bool palette_decoder_init(PaletteDecoder *decoder, uint16_t width, uint16_t height,
+                          uint8_t *indices, uint32_t capacity) {
+    memset(decoder, 0, sizeof(PaletteDecoder));
+    if (width == 0 || width > PALETTE_MAX_WIDTH || height == 0 || !indices) {
+        return false;
+    }
+    decoder->width = width;
+    decoder->height = height;
+    decoder->indices = indices;
+    decoder->capacity = capacity;
+    return true;
+}
+
+void palette_decoder_start(PaletteDecoder *decoder, uint32_t stream_size, const PaletteSink *sink) {
+    decoder->sink = sink ? *sink : (PaletteSink){0};
+    decoder->stream_size = stream_size;
+    decoder->received = 0;
+    decoder->bits = 0;
+    decoder->colors = 0;
+    decoder->index_size = 0;
+    decoder->index_length = 0;
+    decoder->lines_rendered = 0;
+    // The indices are about to be overwritten
+    decoder->resident = false;
+}
+
+static uint32_t palette_line_bytes(const PaletteDecoder *decoder) {
+    return PALETTE_INDEX_SIZE(decoder->width, decoder->bits);
+}
+
+// Header complete: check the depth, palette size and stream size agree
+static bool palette_decoder_open(PaletteDecoder *decoder) {
+    uint8_t bits = decoder->header[0];
+    uint16_t colors = decoder->header[1] + 1;
+    uint32_t pixels = (uint32_t)decoder->width * decoder->height;
+
+    if ((bits != 2 && bits != 4 && bits != 8) || colors > (1u << bits)) {
+        return false;
+    }
+    // Scanlines must start on a byte for palette_expand
+    if (((uint32_t)decoder->width * bits) % 8 != 0 ||
+        PALETTE_INDEX_SIZE(pixels, bits) > decoder->capacity ||
+        PALETTE_STREAM_SIZE(pixels, bits, colors) != decoder->stream_size) {
+        return false;
+    }
+
+    decoder->bits = bits;
+    decoder->colors = colors;
+    decoder->index_size = PALETTE_INDEX_SIZE(pixels, bits);
+    return true;
+}
+
+// Expand every scanline whose indices are all in
+static bool palette_decoder_flush_lines(PaletteDecoder *decoder) {
+    uint32_t line_bytes = palette_line_bytes(decoder);
+    while ((uint32_t)(decoder->lines_rendered + 1) * line_bytes <= decoder->index_length) {
+        palette_expand(decoder->indices + decoder->lines_rendered * line_bytes,
+                       decoder->width, decoder->bits, decoder->lut, decoder->line);
+        decoder->lines_rendered++;
+        if (decoder->sink.write &&
+            !decoder->sink.write(decoder->line, decoder->width * PALETTE_PIXEL_SIZE,
+                                 decoder->sink.context)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool palette_decoder_feed(PaletteDecoder *decoder, const uint8_t *data, size_t length) {
+    if (length > decoder->stream_size - decoder->received) {
+        return false;
+    }
+
+    while (length > 0) {
+        uint32_t position = decoder->received;
+
+        if (position < PALETTE_HEADER_SIZE) {
+            decoder->header[position] = *data++;
+            length--;
+            decoder->received++;
+            if (decoder->received == PALETTE_HEADER_SIZE && !palette_decoder_open(decoder)) {
+                return false;
+            }
+            continue;
+        }
+
+        uint32_t palette_end = PALETTE_HEADER_SIZE + (uint32_t)decoder->colors * PALETTE_ENTRY_SIZE;
+        if (position < palette_end) {
+            // Entries may straddle feed calls, so build them a byte at a time
+            uint32_t offset = position - PALETTE_HEADER_SIZE;
+            uint16_t *entry = &decoder->lut[offset / PALETTE_ENTRY_SIZE];
+            if (offset % PALETTE_ENTRY_SIZE == 0) {
+                *entry = *data++;
+            } else {
+                *entry |= (uint16_t)(*data++) << 8;
+            }
+            length--;
+            decoder->received++;
+            continue;
+        }
+
+        uint32_t take = decoder->index_size - decoder->index_length;
+        if (take > length) {
+            take = length;
+        }
+        memcpy(decoder->indices + decoder->index_length, data, take);
+        decoder->index_length += take;
+        decoder->received += take;
+        data += take;
+        length -= take;
+
+        if (!palette_decoder_flush_lines(decoder)) {
+            return false;
+        }
+    }
+
+    if (decoder->lines_rendered == decoder->height) {
+        decoder->resident = true;
+    }
+    return true;
+}
+
+bool palette_decoder_complete(const PaletteDecoder *decoder) {
+    return decoder->bits != 0 && decoder->lines_rendered == decoder->height;
+}
+
+bool palette_decoder_set_colors(PaletteDecoder *decoder, uint8_t first,
+                                const uint8_t *entries, uint16_t count) {
+    if (!decoder->resident || count == 0 || first + count > decoder->colors) {
+        return false;
+    }
+    for (uint16_t i = 0; i < count; i++) {
+        decoder->lut[first + i] = entries[2 * i] | (entries[2 * i + 1] << 8);
+    }
+    return true;
+}
+
+bool palette_decoder_render(PaletteDecoder *decoder, const PaletteSink *sink) {
+    if (!decoder->resident) {
+        return false;
+    }
+    decoder->sink = sink ? *sink : (PaletteSink){0};
+    decoder->lines_rendered = 0;
+    return palette_decoder_flush_lines(decoder);
+}
@@ -0,0 +1,83 @@
+#ifndef DESKTHANG_PALETTE_H
+#define DESKTHANG_PALETTE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Indexed-colour images. An indexed stream is:
+//   bits (u8):        2, 4 or 8 bits per pixel
+//   colors - 1 (u8):  palette entries, at most 1 << bits
+//   palette:          colors RGB565 entries (u16 LE)
+//   indices:          one per pixel, row by row, packed from the low bits of
+//                     each byte up
+// The decoder keeps the packed indices in a resident buffer and expands them
+// through a 256-entry LUT a scanline at a time, so a later palette change can
+// recolour the screen without the indices being sent again.
+#define PALETTE_HEADER_SIZE  2
+#define PALETTE_MAX_COLORS   256
+#define PALETTE_ENTRY_SIZE   2
+#define PALETTE_MAX_WIDTH    240
+#define PALETTE_PIXEL_SIZE   2
+
+// Packed index bytes for a frame at the given depth
+#define PALETTE_INDEX_SIZE(pixels, bits) ((uint32_t)(pixels) * (bits) / 8)
+
+// Whole stream for a frame at the given depth and palette size
+#define PALETTE_STREAM_SIZE(pixels, bits, colors) \
+    (PALETTE_HEADER_SIZE + (uint32_t)(colors) * PALETTE_ENTRY_SIZE + PALETTE_INDEX_SIZE(pixels, bits))
+
+typedef struct {
+    bool (*write)(const uint8_t *data, uint32_t length, void *context);
+    void *context;
+} PaletteSink;
+
+typedef struct {
+    PaletteSink sink;
+    uint16_t width;
+    uint16_t height;
+    uint8_t *indices;           // Resident packed indices
+    uint32_t capacity;          // Bytes available in indices
+
+    // Current stream
+    uint32_t stream_size;       // Bytes the stream must add up to
+    uint32_t received;          // Stream bytes consumed
+    uint8_t header[PALETTE_HEADER_SIZE];
+    uint8_t bits;
+    uint16_t colors;
+    uint32_t index_size;        // Packed index bytes expected
+    uint32_t index_length;      // Packed index bytes received
+    uint16_t lines_rendered;
+    bool resident;              // indices hold a complete image
+
+    uint16_t lut[PALETTE_MAX_COLORS];
+    uint8_t line[PALETTE_MAX_WIDTH * PALETTE_PIXEL_SIZE];
+} PaletteDecoder;
+
+// Bind the resident index buffer. Nothing is resident afterwards.
+bool palette_decoder_init(PaletteDecoder *decoder, uint16_t width, uint16_t height,
+                          uint8_t *indices, uint32_t capacity);
+
+// Begin an indexed stream of stream_size bytes; the header must agree
+void palette_decoder_start(PaletteDecoder *decoder, uint32_t stream_size, const PaletteSink *sink);
+
+// False on a bad header, a stream size that disagrees with it, or a sink failure
+bool palette_decoder_feed(PaletteDecoder *decoder, const uint8_t *data, size_t length);
+
+// True once every scanline has been handed to the sink
+bool palette_decoder_complete(const PaletteDecoder *decoder);
+
+// Replace count LUT entries (u16 LE) from first. False if they run past the
+// palette of the resident image.
+bool palette_decoder_set_colors(PaletteDecoder *decoder, uint8_t first,
+                                const uint8_t *entries, uint16_t count);
+
+// Expand the resident image through the current LUT, one scanline per write
+bool palette_decoder_render(PaletteDecoder *decoder, const PaletteSink *sink);
+
+// Expand pixels packed indices at the given depth through lut into
+// little-endian RGB565. The first pixel starts a byte.
+void palette_expand(const uint8_t *indices, uint32_t pixels, uint8_t bits,
+                    const uint16_t *lut, uint8_t *out);
+
+#endif // DESKTHANG_PALETTE_H
@@ -0,0 +1,195 @@
+#include "qoi.h"
+#include <string.h>
+
+#define QOI_RED(p)   ((p) >> 11)
+#define QOI_GREEN(p) (((p) >> 5) & 0x3F)
+#define QOI_BLUE(p)  ((p) & 0x1F)
+#define QOI_PACK(r, g, b) (uint16_t)((((r) & 0x1F) << 11) | (((g) & 0x3F) << 5) | ((b) & 0x1F))
+
+static inline uint8_t qoi_hash(uint16_t pixel) {
+    return (QOI_RED(pixel) * 3 + QOI_GREEN(pixel) * 5 + QOI_BLUE(pixel) * 7) % QOI_INDEX_SIZE;
+}
+
+// Sign-extend a wrapped channel difference
+static inline int qoi_wrap(int diff, int bits) {
+    int half = 1 << (bits - 1);
+    diff &= (1 << bits) - 1;
+    return diff >= half ? diff - (1 << bits) : diff;
+}
+
+void qoi_decoder_init(QoiDecoder *decoder, uint32_t pixels, const QoiSink *sink) {
+    memset(decoder, 0, sizeof(QoiDecoder));
+    decoder->pixels = pixels;
+    if (sink) {
+        decoder->sink = *sink;
+    }
+}
+
+static bool qoi_flush(QoiDecoder *decoder) {
+    if (decoder->line_length == 0) {
+        return true;
+    }
+    uint16_t length = decoder->line_length;
+    decoder->line_length = 0;
+    return !decoder->sink.write ||
+           decoder->sink.write(decoder->line, length, decoder->sink.context);
+}
+
+static bool qoi_emit(QoiDecoder *decoder, uint16_t pixel, uint32_t count) {
+    if (count > decoder->pixels - decoder->position) {
+        return false;
+    }
+    decoder->position += count;
+
+    while (count-- > 0) {
+        decoder->line[decoder->line_length++] = pixel & 0xFF;
+        decoder->line[decoder->line_length++] = pixel >> 8;
+        if (decoder->line_length == sizeof(decoder->line) && !qoi_flush(decoder)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Length of the op that starts with tag
+static inline uint8_t qoi_op_size(uint8_t tag) {
+    if (tag == QOI_OP_RGB) {
+        return 3;
+    }
+    return (tag & QOI_MASK_2) == QOI_OP_LUMA ? 2 : 1;
+}
+
+static bool qoi_decode_op(QoiDecoder *decoder, const uint8_t *op) {
+    uint8_t tag = op[0];
+    uint16_t prev = decoder->previous;
+    uint16_t pixel;
+
+    if (tag == QOI_OP_RGB) {
+        pixel = op[1] | (op[2] << 8);
+    } else if (tag == 0xFF) {
+        return false;
+    } else {
+        switch (tag & QOI_MASK_2) {
+            case QOI_OP_INDEX:
+                pixel = decoder->index[tag];
+                break;
+            case QOI_OP_DIFF:
+                pixel = QOI_PACK(QOI_RED(prev) + ((tag >> 4) & 3) - 2,
+                                 QOI_GREEN(prev) + ((tag >> 2) & 3) - 2,
+                                 QOI_BLUE(prev) + (tag & 3) - 2);
+                break;
+            case QOI_OP_LUMA: {
+                int dg = (tag & 0x3F) - 32;
+                int half = dg >> 1;
+                pixel = QOI_PACK(QOI_RED(prev) + half + (op[1] >> 4) - 8,
+                                 QOI_GREEN(prev) + dg,
+                                 QOI_BLUE(prev) + half + (op[1] & 0x0F) - 8);
+                break;
+            }
+            default:
+                // Runs repeat the previous pixel, which is already indexed
+                return qoi_emit(decoder, prev, (tag & 0x3F) + 1);
+        }
+    }
+
+    decoder->index[qoi_hash(pixel)] = pixel;
+    decoder->previous = pixel;
+    return qoi_emit(decoder, pixel, 1);
+}
+
+bool qoi_decoder_feed(QoiDecoder *decoder, const uint8_t *data, size_t length) {
+    // Finish an op split across the previous call
+    while (decoder->op_length > 0 && length > 0) {
+        decoder->op[decoder->op_length++] = *data++;
+        length--;
+        if (decoder->op_length == qoi_op_size(decoder->op[0])) {
+            decoder->op_length = 0;
+            if (!qoi_decode_op(decoder, decoder->op)) {
+                return false;
+            }
+        }
+    }
+
+    while (length > 0) {
+        uint8_t size = qoi_op_size(data[0]);
+        if (size > length) {
+            // Keep the partial op for the next call
+            memcpy(decoder->op, data, length);
+            decoder->op_length = (uint8_t)length;
+            break;
+        }
+        if (!qoi_decode_op(decoder, data)) {
+            return false;
+        }
+        data += size;
+        length -= size;
+    }
+
+    // Don't hold pixels back from the panel while waiting for the next chunk
+    return qoi_flush(decoder);
+}
+
+bool qoi_decoder_complete(const QoiDecoder *decoder) {
+    return decoder->position == decoder->pixels &&
+           decoder->op_length == 0 &&
+           decoder->line_length == 0;
+}
+
+size_t qoi_encode(const uint8_t *frame, uint32_t pixels, uint8_t *out, size_t capacity) {
+    uint16_t index[QOI_INDEX_SIZE] = {0};
+    uint16_t prev = 0;
+    uint32_t run = 0;
+    size_t length = 0;
+
+    for (uint32_t i = 0; i < pixels; i++) {
+        uint16_t pixel = frame[i * 2] | (frame[i * 2 + 1] << 8);
+
+        if (pixel == prev) {
+            run++;
+            if (run < QOI_MAX_RUN && i + 1 < pixels) {
+                continue;
+            }
+        }
+        if (run > 0) {
+            if (length + 1 > capacity) {
+                return 0;
+            }
+            out[length++] = QOI_OP_RUN | (run - 1);
+            run = 0;
+            if (pixel == prev) {
+                continue;
+            }
+        }
+        if (length + 3 > capacity) {
+            return 0;
+        }
+
+        uint8_t slot = qoi_hash(pixel);
+        if (index[slot] == pixel) {
+            out[length++] = QOI_OP_INDEX | slot;
+            prev = pixel;
+            continue;
+        }
+        index[slot] = pixel;
+
+        int dr = qoi_wrap(QOI_RED(pixel) - QOI_RED(prev), 5);
+        int dg = qoi_wrap(QOI_GREEN(pixel) - QOI_GREEN(prev), 6);
+        int db = qoi_wrap(QOI_BLUE(pixel) - QOI_BLUE(prev), 5);
+        int dr_dg = dr - (dg >> 1);
+        int db_dg = db - (dg >> 1);
+
+        if (dr >= -2 && dr <= 1 && dg >= -2 && dg <= 1 && db >= -2 && db <= 1) {
+            out[length++] = QOI_OP_DIFF | ((dr + 2) << 4) | ((dg + 2) << 2) | (db + 2);
+        } else if (dr_dg >= -8 && dr_dg <= 7 && db_dg >= -8 && db_dg <= 7) {
+            // dg always fits 6 bits once wrapped
+            out[length++] = QOI_OP_LUMA | (dg + 32);
+            out[length++] = ((dr_dg + 8) << 4) | (db_dg + 8);
+        } else {
+            out[length++] = QOI_OP_RGB;
+            out[length++] = pixel & 0xFF;
+            out[length++] = pixel >> 8;
+        }
+        prev = pixel;
+    }
+    return length;
+}
@@ -0,0 +1,68 @@
+#ifndef DESKTHANG_QOI_H
+#define DESKTHANG_QOI_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// QOI-style lossless codec adapted to RGB565. Pixels are the little-endian
+// u16s the panel takes; the stream is a run of byte-aligned ops, each
+// predicting from the previous pixel or a 64-entry index of recent pixels:
+//   00iiiiii            INDEX: pixel from index slot i
+//   01rrggbb            DIFF:  r, g, b each moved by -2..1 (biased by 2)
+//   10gggggg rrrrbbbb   LUMA:  g moved by -32..31 (biased by 32), r and b by
+//                              (dg >> 1) plus -8..7 (biased by 8)
+//   11rrrrrr            RUN:   previous pixel repeated 1..62 times (biased by 1)
+//   11111110 lo hi      RGB:   literal pixel
+// Channel arithmetic wraps at the channel width. Every pixel decoded lands in
+// slot (r * 3 + g * 5 + b * 7) % 64 of the index. Decoding starts from a
+// zeroed index and a previous pixel of 0, and ends when the frame is full;
+// there is no header or end marker.
+#define QOI_OP_INDEX   0x00
+#define QOI_OP_DIFF    0x40
+#define QOI_OP_LUMA    0x80
+#define QOI_OP_RUN     0xC0
+#define QOI_OP_RGB     0xFE
+#define QOI_MASK_2     0xC0
+#define QOI_MAX_RUN    62
+#define QOI_INDEX_SIZE 64
+#define QOI_PIXEL_SIZE 2
+
+// Worst case: every pixel a literal
+#define QOI_MAX_ENCODED_SIZE(pixels) ((size_t)(pixels) * 3)
+
+// Decoded pixels collect here and go to the sink a line at a time, or when
+// a feed call runs out of input
+#define QOI_LINE_PIXELS 64
+
+typedef struct {
+    bool (*write)(const uint8_t *data, uint32_t length, void *context);
+    void *context;
+} QoiSink;
+
+typedef struct {
+    QoiSink sink;
+    uint32_t pixels;          // Pixels in the frame
+    uint32_t position;        // Pixels decoded so far
+    uint16_t index[QOI_INDEX_SIZE];
+    uint16_t previous;
+    uint8_t op[3];            // Op being gathered across feed calls
+    uint8_t op_length;
+    uint8_t line[QOI_LINE_PIXELS * QOI_PIXEL_SIZE];
+    uint16_t line_length;     // Bytes waiting in line
+} QoiDecoder;
+
+void qoi_decoder_init(QoiDecoder *decoder, uint32_t pixels, const QoiSink *sink);
+
+// False on an unknown op, a pixel past the end of the frame, or a sink failure
+bool qoi_decoder_feed(QoiDecoder *decoder, const uint8_t *data, size_t length);
+
+// True once every pixel of the frame has been decoded and handed to the sink
+bool qoi_decoder_complete(const QoiDecoder *decoder);
+
+// Encode a frame of little-endian RGB565 pixels. Returns the stream length,
+// or 0 if it would not fit in capacity. Used by tests and benchmarks; the host
+// tool has its own encoder.
+size_t qoi_encode(const uint8_t *frame, uint32_t pixels, uint8_t *out, size_t capacity);
+
+#endif // DESKTHANG_QOI_H
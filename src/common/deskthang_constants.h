@@ -63,11 +63,27 @@
 #define DISPLAY_PIN_DC   16
 #define DISPLAY_PIN_RST  20
 
-// Display Timing Parameters
-#define DISPLAY_RESET_PULSE_US 10000   // 10ms reset pulse
-#define DISPLAY_INIT_DELAY_MS  120     // 120ms init delay
+// Display Timing Parameters (GC9A01 datasheet minimums)
+#define DISPLAY_RESET_PULSE_US 10      // RESX low at least 10us
+#define DISPLAY_RESET_READY_MS 5       // Commands accepted 5ms after reset
+#define DISPLAY_INIT_DELAY_MS  120     // Sleep Out not allowed until 120ms after reset
+#define DISPLAY_WAKE_DELAY_MS  5       // Supplies settle 5ms after Sleep Out
 #define DISPLAY_CMD_DELAY_US   10      // 10us command delay
 
+/**
+ * Boot Options
+ * Both default off, so a fast boot goes straight to READY. Set to 1 (CMake
+ * options of the same name) to bring back the LED blink code after each
+ * init phase or the test patterns shown during display init.
+ */
+#ifndef DESKTHANG_BOOT_BLINK
+#define DESKTHANG_BOOT_BLINK 0
+#endif
+
+#ifndef DESKTHANG_BOOT_SELF_TEST
+#define DESKTHANG_BOOT_SELF_TEST 0
+#endif
+
 /**
  * Command Processing Constants
  */
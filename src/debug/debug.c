@@ -1,6 +1,7 @@
 #include "debug.h"
 #include "../error/logging.h"
 #include "../system/time.h"
+#include "../protocol/packet_pool.h"
 #include <string.h>
 #include <stdio.h>
 
@@ -10,17 +11,11 @@ static struct {
     StateDebugStats state_stats;
     ResourceDebugStats resource_stats;
     PerformanceStats perf_stats;
-    struct {
-        uint32_t start_time;
-        char operation[32];
-    } current_operation;
-    uint32_t state_durations[STATE_COUNT];
     uint32_t state_transitions[STATE_COUNT];
 } debug_state = {0};
 
 void debug_init(void) {
     memset(&debug_state, 0, sizeof(debug_state));
-    debug_state.perf_stats.shortest_operation_ms = UINT32_MAX;
     debug_state.enabled = true;
 }
 
@@ -109,41 +104,15 @@ void debug_log_overflow(void) {
 }
 
 ResourceDebugStats* debug_get_resource_stats(void) {
+    // Pool counters live with the pool; refresh them on every read
+    PacketPoolStats pool;
+    packet_pool_get_stats(&pool);
+    debug_state.resource_stats.pool_slabs_in_use = pool.slabs_in_use;
+    debug_state.resource_stats.pool_high_water = pool.high_water;
+    debug_state.resource_stats.pool_exhausted_count = pool.exhausted;
     return &debug_state.resource_stats;
 }
 
-void debug_log_operation_start(const char* operation) {
-    if (!debug_state.enabled) return;
-
-    debug_state.current_operation.start_time = deskthang_time_get_ms();
-    strncpy(debug_state.current_operation.operation, operation, sizeof(debug_state.current_operation.operation) - 1);
-    debug_state.current_operation.operation[sizeof(debug_state.current_operation.operation) - 1] = '\0';
-}
-
-void debug_log_operation_end(const char* operation) {
-    if (!debug_state.enabled) return;
-
-    if (strcmp(operation, debug_state.current_operation.operation) != 0) {
-        return; // Mismatched operation
-    }
-
-    uint32_t duration = deskthang_time_get_ms() - debug_state.current_operation.start_time;
-    
-    // Update statistics
-    if (duration > debug_state.perf_stats.longest_operation_ms) {
-        debug_state.perf_stats.longest_operation_ms = duration;
-    }
-    if (duration < debug_state.perf_stats.shortest_operation_ms) {
-        debug_state.perf_stats.shortest_operation_ms = duration;
-    }
-
-    char message[128];
-    snprintf(message, sizeof(message), 
-            "Operation '%s' completed in %lu ms", 
-            operation, duration);
-    logging_write("Debug", message);
-}
-
 void debug_log_retry(const char* operation) {
     if (!debug_state.enabled) return;
 
@@ -183,14 +152,22 @@ void debug_print_summary(void) {
             debug_state.resource_stats.buffer_full_count);
     logging_write("Debug", resource_stats);
 
+    ResourceDebugStats *resources = debug_get_resource_stats();
+    snprintf(resource_stats, sizeof(resource_stats),
+            "Packet Pool: %lu/%u in use, High Water: %lu, Exhausted: %lu",
+            resources->pool_slabs_in_use,
+            PACKET_POOL_SLAB_COUNT,
+            resources->pool_high_water,
+            resources->pool_exhausted_count);
+    logging_write("Debug", resource_stats);
+
     // Performance statistics
     logging_write("Debug", "=== Performance Statistics ===");
     char perf_stats[128];
     snprintf(perf_stats, sizeof(perf_stats),
-            "Longest Op: %lu ms, Shortest Op: %lu ms, Retries: %lu",
-            debug_state.perf_stats.longest_operation_ms,
-            debug_state.perf_stats.shortest_operation_ms,
-            debug_state.perf_stats.total_retries);
+            "Retries: %lu, Timeouts: %lu",
+            debug_state.perf_stats.total_retries,
+            debug_state.perf_stats.operation_timeouts);
     logging_write("Debug", perf_stats);
 }
 
@@ -198,8 +175,6 @@ void debug_reset_stats(void) {
     memset(&debug_state.state_stats, 0, sizeof(StateDebugStats));
     memset(&debug_state.resource_stats, 0, sizeof(ResourceDebugStats));
     memset(&debug_state.perf_stats, 0, sizeof(PerformanceStats));
-    memset(debug_state.state_durations, 0, sizeof(debug_state.state_durations));
     memset(debug_state.state_transitions, 0, sizeof(debug_state.state_transitions));
-    debug_state.perf_stats.shortest_operation_ms = UINT32_MAX;
     logging_write("Debug", "Debug statistics reset");
 } 
\ No newline at end of file
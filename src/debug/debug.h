@@ -24,12 +24,14 @@ typedef struct {
     uint32_t last_overflow_time;
     uint32_t buffer_full_count;
     uint32_t bytes_processed;
+    uint32_t pool_slabs_in_use;     // Packet payload slabs currently held
+    uint32_t pool_high_water;       // Most slabs held at once
+    uint32_t pool_exhausted_count;  // Payload allocations refused, pool empty
 } ResourceDebugStats;
 
-// Performance metrics
+// Performance metrics. Operation timing lives in the trace (trace.h) and
+// the latency histograms (stats.h).
 typedef struct {
-    uint32_t longest_operation_ms;
-    uint32_t shortest_operation_ms;
     uint32_t total_retries;
     uint32_t operation_timeouts;
 } PerformanceStats;
@@ -51,8 +53,6 @@ void debug_log_overflow(void);
 ResourceDebugStats* debug_get_resource_stats(void);
 
 // Performance monitoring
-void debug_log_operation_start(const char* operation);
-void debug_log_operation_end(const char* operation);
 void debug_log_retry(const char* operation);
 PerformanceStats* debug_get_performance_stats(void);
 
@@ -0,0 +1,131 @@
+#include "stats.h"
+#include "../protocol/packet.h"
+#include "../system/time.h"
+#include <string.h>
+
+_Static_assert(sizeof(StatsCounters) == STATS_COUNTER_COUNT * 4, "StatsCounters is all u32 fields");
+_Static_assert(STATS_PAYLOAD_SIZE <= MAX_PAYLOAD_SIZE, "The STATS payload must fit one packet");
+
+static StatsHistogram g_histograms[STATS_LATENCY_COUNT];
+static StatsCounters g_counters;
+static uint32_t g_rx_frame_us;
+static bool g_rx_frame_marked;
+
+static void put_u16(uint8_t *out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+}
+
+static void put_u32(uint8_t *out, uint32_t value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = (value >> 24) & 0xFF;
+}
+
+void stats_reset(void) {
+    memset(g_histograms, 0, sizeof(g_histograms));
+    memset(&g_counters, 0, sizeof(g_counters));
+    g_rx_frame_marked = false;
+}
+
+uint8_t stats_bucket(uint32_t us) {
+    uint8_t bucket = 0;
+    while (us != 0 && bucket < STATS_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+void stats_latency_record(StatsLatency which, uint32_t us) {
+    if (which >= STATS_LATENCY_COUNT) {
+        return;
+    }
+    StatsHistogram *histogram = &g_histograms[which];
+    histogram->buckets[stats_bucket(us)]++;
+    if (us > histogram->max_us) {
+        histogram->max_us = us;
+    }
+}
+
+void stats_get_histogram(StatsLatency which, StatsHistogram *histogram) {
+    if (which >= STATS_LATENCY_COUNT || !histogram) {
+        return;
+    }
+    *histogram = g_histograms[which];
+}
+
+void stats_count_rx(uint32_t bytes) {
+    g_counters.rx_bytes += bytes;
+}
+
+void stats_count_rx_packet(bool decoded) {
+    if (decoded) {
+        g_counters.rx_packets++;
+    } else {
+        g_counters.rx_dropped++;
+    }
+}
+
+void stats_count_tx_packet(uint32_t bytes) {
+    g_counters.tx_bytes += bytes;
+    g_counters.tx_packets++;
+}
+
+void stats_set_transfer_speed(uint32_t bytes_per_second) {
+    g_counters.transfer_bps = bytes_per_second;
+}
+
+void stats_get_counters(StatsCounters *counters) {
+    if (counters) {
+        *counters = g_counters;
+    }
+}
+
+void stats_mark_rx_frame(void) {
+    g_rx_frame_us = deskthang_time_get_us();
+    g_rx_frame_marked = true;
+}
+
+// Only the first ACK after a frame is timed, so a retransmitted or
+// unsolicited ACK doesn't count the wait for the host
+void stats_ack_sent(void) {
+    if (!g_rx_frame_marked) {
+        return;
+    }
+    g_rx_frame_marked = false;
+    stats_latency_record(STATS_LATENCY_ACK, deskthang_time_get_us() - g_rx_frame_us);
+}
+
+bool stats_encode(uint8_t *out, size_t size) {
+    if (!out || size < STATS_PAYLOAD_SIZE) {
+        return false;
+    }
+
+    put_u32(&out[0], deskthang_time_get_us());
+    out[4] = STATS_LATENCY_COUNT;
+    out[5] = STATS_BUCKETS;
+    put_u16(&out[6], 0);
+    out += STATS_HEADER_SIZE;
+
+    StatsCounters counters;
+    stats_get_counters(&counters);
+    const uint32_t fields[STATS_COUNTER_COUNT] = {
+        counters.rx_bytes, counters.rx_packets, counters.rx_dropped,
+        counters.tx_bytes, counters.tx_packets, counters.transfer_bps,
+    };
+    for (int i = 0; i < STATS_COUNTER_COUNT; i++, out += 4) {
+        put_u32(out, fields[i]);
+    }
+
+    for (int which = 0; which < STATS_LATENCY_COUNT; which++) {
+        const StatsHistogram *histogram = &g_histograms[which];
+        put_u32(out, histogram->max_us);
+        out += 4;
+        for (int b = 0; b < STATS_BUCKETS; b++, out += 4) {
+            put_u32(out, histogram->buckets[b]);
+        }
+    }
+    return true;
+}
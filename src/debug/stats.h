@@ -0,0 +1,76 @@
+#ifndef DESKTHANG_STATS_H
+#define DESKTHANG_STATS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Latency histograms and traffic counters, read with the STATS command
+// ('S'). Each histogram counts samples in log2 buckets: bucket 0 holds
+// 0 us, bucket b holds [2^(b-1), 2^b) us and the last one everything
+// from 2^(STATS_BUCKETS-2) up, so 24 buckets reach past four seconds.
+// The host interpolates percentiles from the buckets.
+//
+// Every histogram and counter has one writer core. The other core may
+// read while it writes; a sample can land between two reads, never
+// half-written, since each count is a single 32-bit store.
+#define STATS_BUCKETS 24
+
+typedef enum {
+    STATS_LATENCY_PARSE,   // Frame decode, from its last byte to a packet
+    STATS_LATENCY_CRC,     // Checksum over a packet's header and payload
+    STATS_LATENCY_CHUNK,   // Chunk queued by core0 to decoded onto the panel
+    STATS_LATENCY_FRAME,   // Transfer start to its last chunk on the panel
+    STATS_LATENCY_ACK,     // Last frame received to an ACK transmitted
+    STATS_LATENCY_STATE,   // Time spent in a state before leaving it
+    STATS_LATENCY_COUNT
+} StatsLatency;
+
+typedef struct {
+    uint32_t max_us;
+    uint32_t buckets[STATS_BUCKETS];
+} StatsHistogram;
+
+typedef struct {
+    uint32_t rx_bytes;        // Bytes fed to the packet parser
+    uint32_t rx_packets;      // Frames decoded into packets
+    uint32_t rx_dropped;      // Frames that failed to decode
+    uint32_t tx_bytes;        // Frame bytes written, before v1 escaping
+    uint32_t tx_packets;
+    uint32_t transfer_bps;    // Speed of the last completed transfer
+} StatsCounters;
+
+// STATS payload, little-endian:
+//   u32 now_us
+//   u8  histograms   STATS_LATENCY_COUNT
+//   u8  buckets      STATS_BUCKETS
+//   u16 reserved
+//   u32 counters     StatsCounters, in field order
+//   per histogram, in StatsLatency order: u32 max_us, u32 buckets[]
+#define STATS_HEADER_SIZE    8
+#define STATS_COUNTER_COUNT  6
+#define STATS_PAYLOAD_SIZE   (STATS_HEADER_SIZE + STATS_COUNTER_COUNT * 4 + \
+                              STATS_LATENCY_COUNT * (1 + STATS_BUCKETS) * 4)
+
+void stats_reset(void);
+
+uint8_t stats_bucket(uint32_t us);
+void stats_latency_record(StatsLatency which, uint32_t us);
+void stats_get_histogram(StatsLatency which, StatsHistogram *histogram);
+
+// Traffic, from core0's packet paths
+void stats_count_rx(uint32_t bytes);
+void stats_count_rx_packet(bool decoded);
+void stats_count_tx_packet(uint32_t bytes);
+void stats_set_transfer_speed(uint32_t bytes_per_second);
+void stats_get_counters(StatsCounters *counters);
+
+// ACK turnaround: the parser marks each completed frame, packet_transmit
+// times an ACK from the latest mark
+void stats_mark_rx_frame(void);
+void stats_ack_sent(void);
+
+// Fill out with the STATS payload; false if it is under STATS_PAYLOAD_SIZE
+bool stats_encode(uint8_t *out, size_t size);
+
+#endif // DESKTHANG_STATS_H
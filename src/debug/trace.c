@@ -0,0 +1,144 @@
+#include "trace.h"
+#include "../protocol/packet.h"
+#include "../system/platform.h"
+#include "../system/time.h"
+#include <string.h>
+
+#if (TRACE_RING_RECORDS & (TRACE_RING_RECORDS - 1)) != 0
+#error "TRACE_RING_RECORDS must be a power of two"
+#endif
+
+_Static_assert(sizeof(TraceRecord) == TRACE_RECORD_SIZE, "TraceRecord must pack to 8 bytes");
+_Static_assert(TRACE_DUMP_HEADER_SIZE + TRACE_DUMP_RECORDS * TRACE_RECORD_SIZE <= MAX_PAYLOAD_SIZE,
+               "A trace dump packet must fit MAX_PAYLOAD_SIZE");
+
+#define TRACE_RING_MASK (TRACE_RING_RECORDS - 1)
+
+// One core's ring. Only that core writes it; written counts every record
+// ever stored and is published after the record, so a reader knows which
+// slots hold whole records.
+typedef struct {
+    TraceRecord records[TRACE_RING_RECORDS];
+    volatile uint32_t written;
+} TraceRing;
+
+static TraceRing g_rings[TRACE_CORES];
+
+// Dump staging, core0 only
+static TraceRecord g_snapshot[TRACE_RING_RECORDS];
+static uint8_t g_payload[TRACE_DUMP_HEADER_SIZE + TRACE_DUMP_RECORDS * TRACE_RECORD_SIZE];
+
+static inline uint32_t load_acquire(const volatile uint32_t *value) {
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+static inline void store_release(volatile uint32_t *value, uint32_t new_value) {
+    __atomic_store_n(value, new_value, __ATOMIC_RELEASE);
+}
+
+static void put_u16(uint8_t *out, uint16_t value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+}
+
+static void put_u32(uint8_t *out, uint32_t value) {
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = (value >> 24) & 0xFF;
+}
+
+void trace_reset(void) {
+    memset(g_rings, 0, sizeof(g_rings));
+}
+
+void trace_record(TraceEvent event, TracePhase phase, uint32_t arg) {
+    TraceRing *ring = &g_rings[platform_core_index() ? 1 : 0];
+    uint32_t written = ring->written;
+
+    TraceRecord *record = &ring->records[written & TRACE_RING_MASK];
+    record->timestamp_us = deskthang_time_get_us();
+    record->event = (uint8_t)event;
+    record->phase = (uint8_t)phase;
+    record->arg = arg > UINT16_MAX ? UINT16_MAX : (uint16_t)arg;
+
+    store_release(&ring->written, written + 1);
+}
+
+size_t trace_snapshot(unsigned core, TraceRecord *records, uint32_t *lost) {
+    if (core >= TRACE_CORES || !records) {
+        return 0;
+    }
+
+    TraceRing *ring = &g_rings[core];
+    uint32_t end = load_acquire(&ring->written);
+    uint32_t start = end > TRACE_RING_RECORDS ? end - TRACE_RING_RECORDS : 0;
+    for (uint32_t i = start; i != end; i++) {
+        records[i - start] = ring->records[i & TRACE_RING_MASK];
+    }
+
+    // The other core may have lapped the copy. Anything it reached, plus
+    // the slot it may be filling now, is dropped from the front.
+    uint32_t after = load_acquire(&ring->written);
+    if (core != (platform_core_index() ? 1u : 0u)) {
+        after++;
+    }
+    uint32_t first = start;
+    if (after > TRACE_RING_RECORDS && after - TRACE_RING_RECORDS > first) {
+        first = after - TRACE_RING_RECORDS;
+    }
+    if (first >= end) {
+        first = end;
+    }
+    if (first > start) {
+        memmove(records, records + (first - start), (end - first) * sizeof(TraceRecord));
+    }
+
+    if (lost) {
+        *lost = first;
+    }
+    return end - first;
+}
+
+bool trace_dump(TraceSendFn send, void *context) {
+    if (!send) {
+        return false;
+    }
+
+    for (unsigned core = 0; core < TRACE_CORES; core++) {
+        uint32_t lost = 0;
+        uint32_t now = deskthang_time_get_us();
+        size_t count = trace_snapshot(core, g_snapshot, &lost);
+
+        // At least one packet per core, so the host hears about an empty ring
+        size_t sent = 0;
+        do {
+            size_t batch = count - sent;
+            if (batch > TRACE_DUMP_RECORDS) {
+                batch = TRACE_DUMP_RECORDS;
+            }
+            bool last = core == TRACE_CORES - 1 && sent + batch == count;
+
+            put_u32(&g_payload[0], now);
+            put_u32(&g_payload[4], lost);
+            g_payload[8] = (uint8_t)core;
+            g_payload[9] = last ? TRACE_DUMP_FLAG_LAST : 0;
+            put_u16(&g_payload[10], (uint16_t)batch);
+
+            uint8_t *out = &g_payload[TRACE_DUMP_HEADER_SIZE];
+            for (size_t i = 0; i < batch; i++, out += TRACE_RECORD_SIZE) {
+                const TraceRecord *record = &g_snapshot[sent + i];
+                put_u32(&out[0], record->timestamp_us);
+                out[4] = record->event;
+                out[5] = record->phase;
+                put_u16(&out[6], record->arg);
+            }
+
+            if (!send(g_payload, TRACE_DUMP_HEADER_SIZE + batch * TRACE_RECORD_SIZE, context)) {
+                return false;
+            }
+            sent += batch;
+        } while (sent < count);
+    }
+    return true;
+}
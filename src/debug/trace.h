@@ -0,0 +1,87 @@
+#ifndef DESKTHANG_TRACE_H
+#define DESKTHANG_TRACE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Hot-path trace. TRACE_BEGIN/TRACE_END bracket a span and TRACE_INSTANT
+// marks a point; each stores an 8-byte record (us timestamp, event, phase,
+// 16-bit argument) in the calling core's ring and returns. Spans nest, so
+// a CRC inside a packet decode inside an RX poll shows as three levels.
+//
+// Each core has its own ring with a single writer, so neither core takes
+// a lock. The rings wrap, keeping the newest TRACE_RING_RECORDS events;
+// they are read on demand with the TRACE command ('G'), and the host turns
+// the dump into Chrome trace-event JSON. Never trace from an interrupt
+// handler: it would be a second writer on the ring.
+#ifndef DESKTHANG_TRACE
+#define DESKTHANG_TRACE 1
+#endif
+
+#ifndef TRACE_RING_RECORDS
+#define TRACE_RING_RECORDS 256  // Per core, power of two
+#endif
+
+#define TRACE_CORES 2
+
+// Event ids, from trace_events.def
+typedef enum {
+#define TRACE_EVENT(name, category, begin_arg, end_arg) TRACE_EVENT_##name,
+#include "trace_events.def"
+#undef TRACE_EVENT
+    TRACE_EVENT_COUNT
+} TraceEvent;
+
+typedef enum {
+    TRACE_PHASE_BEGIN,
+    TRACE_PHASE_END,
+    TRACE_PHASE_INSTANT
+} TracePhase;
+
+typedef struct {
+    uint32_t timestamp_us;
+    uint8_t event;    // TraceEvent
+    uint8_t phase;    // TracePhase
+    uint16_t arg;     // Saturated at 0xFFFF
+} TraceRecord;
+
+// Dump: one or more TRACE packets per core, each a header and records, all
+// little-endian. The last packet of the dump has TRACE_DUMP_FLAG_LAST set.
+//   u32 now_us   Clock when the core's ring was read, to line the cores up
+//   u32 lost     Events overwritten before the oldest one sent
+//   u8  core
+//   u8  flags
+//   u16 count    Records that follow, 8 bytes each
+#define TRACE_DUMP_HEADER_SIZE  12
+#define TRACE_RECORD_SIZE       8
+#define TRACE_DUMP_FLAG_LAST    0x01
+#define TRACE_DUMP_RECORDS      126  // Per packet, so one fits MAX_PAYLOAD_SIZE
+
+// Sends one dump payload; false aborts the dump
+typedef bool (*TraceSendFn)(const uint8_t *payload, size_t length, void *context);
+
+// Empty both rings
+void trace_reset(void);
+
+void trace_record(TraceEvent event, TracePhase phase, uint32_t arg);
+
+// Copy core's ring, oldest first, into records (TRACE_RING_RECORDS long).
+// Returns the count; *lost gets the events overwritten before the oldest.
+// Safe while the other core keeps tracing.
+size_t trace_snapshot(unsigned core, TraceRecord *records, uint32_t *lost);
+
+// Send both rings, core0 first
+bool trace_dump(TraceSendFn send, void *context);
+
+#if DESKTHANG_TRACE
+#define TRACE_BEGIN(event, arg)   trace_record(TRACE_EVENT_##event, TRACE_PHASE_BEGIN, (arg))
+#define TRACE_END(event, arg)     trace_record(TRACE_EVENT_##event, TRACE_PHASE_END, (arg))
+#define TRACE_INSTANT(event, arg) trace_record(TRACE_EVENT_##event, TRACE_PHASE_INSTANT, (arg))
+#else
+#define TRACE_BEGIN(event, arg)   ((void)0)
+#define TRACE_END(event, arg)     ((void)0)
+#define TRACE_INSTANT(event, arg) ((void)0)
+#endif
+
+#endif // DESKTHANG_TRACE_H
@@ -1,28 +1,104 @@
 #include "logging.h"
-#include <time.h>
 #include "../hardware/serial.h"
+#include "../hardware/serial_ring.h"
 #include "../protocol/packet.h"
+#include "../system/platform.h"
+#include "../system/time.h"
 #include "../common/deskthang_constants.h"
 #include <stdio.h>
-#include <stdlib.h>  // For free()
+#include <string.h>
+
+// Record kinds
+#define LOG_RECORD_TEXT   0  // Module and message, sent as a DEBUG packet
+#define LOG_RECORD_EVENT  1  // Site and raw arguments, sent as a LOG packet
+
+// One queued log record. A power-of-two size, so records tile the byte
+// ring and a write span at a record boundary always holds a whole record.
+typedef struct {
+    uint8_t kind;
+    uint8_t length;          // Event: argument bytes
+    uint16_t site;           // Event: LogSite
+    uint32_t timestamp_us;   // Event: when it was queued
+    union {
+        struct {
+            char module[LOG_MODULE_SIZE];
+            char message[LOG_MESSAGE_SIZE];
+        } text;
+        uint8_t args[LOG_EVENT_ARGS_SIZE];
+    };
+} LogRecord;
+
+_Static_assert((sizeof(LogRecord) & (sizeof(LogRecord) - 1)) == 0,
+               "LogRecord size must be a power of two");
+
+#if (LOG_RING_RECORDS & (LOG_RING_RECORDS - 1)) != 0 || \
+    (LOG_CORE1_RING_RECORDS & (LOG_CORE1_RING_RECORDS - 1)) != 0
+#error "Log ring record counts must be powers of two"
+#endif
+
+// Token bucket for one module. The producing core owns the bucket; the
+// draining core only reads suppressed and keeps its own reported count.
+typedef struct {
+    const char *module;            // Pointer last matched, for the fast path
+    char name[LOG_MODULE_SIZE];
+    uint32_t tokens;               // Thousandths of a record
+    uint32_t refilled_ms;
+    volatile uint32_t suppressed;  // Records over the rate
+    uint32_t reported;             // Drain side: suppressed already reported
+} LogRateSlot;
+
+// Per-core queue: SPSC from the core that logs to core0, which drains it
+typedef struct {
+    SerialRing ring;
+    LogRateSlot slots[LOG_RATE_MODULES];
+    volatile uint32_t slot_count;    // Published after a slot's name is set
+    volatile uint32_t queued;
+    volatile uint32_t dropped_full;
+    uint32_t reported_full;          // Drain side: dropped_full already reported
+} LogQueue;
+
+// Each site's module, for rate limiting. The formats stay on the host.
+static const char *const g_site_modules[LOG_SITE_COUNT] = {
+#define LOG_SITE(name, level, module, format) module,
+#include "log_sites.def"
+#undef LOG_SITE
+};
+
+static LogRecord g_core0_records[LOG_RING_RECORDS];
+static LogRecord g_core1_records[LOG_CORE1_RING_RECORDS];
+static LogQueue g_queues[2];
+static uint32_t g_sent;
 
 // Static configuration
 static bool logging_enabled = true;
 static bool use_debug_packets = true;
+static bool queues_ready = false;
+
+static inline uint32_t load_acquire(const volatile uint32_t *value) {
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+static inline void store_release(volatile uint32_t *value, uint32_t new_value) {
+    __atomic_store_n(value, new_value, __ATOMIC_RELEASE);
+}
+
+static void logging_init_queues(void) {
+    memset(g_queues, 0, sizeof(g_queues));
+    serial_ring_init(&g_queues[0].ring, (uint8_t*)g_core0_records, sizeof(g_core0_records));
+    serial_ring_init(&g_queues[1].ring, (uint8_t*)g_core1_records, sizeof(g_core1_records));
+    g_sent = 0;
+    queues_ready = true;
+}
 
 // Internal helper functions
 static bool send_message(const char *module, const char *message) {
-    if (!logging_enabled) {
-        return false;
-    }
-    
     if (use_debug_packets) {
         // Create and send debug packet
         Packet packet;
         if (!packet_create_debug(&packet, module, message)) {
             return false;
         }
-        
+
         bool result = packet_transmit(&packet);
         packet_free(&packet);
         return result;
@@ -37,10 +113,126 @@ static bool send_message(const char *module, const char *message) {
     }
 }
 
+static bool send_event(const LogRecord *record) {
+    if (use_debug_packets) {
+        Packet packet;
+        if (!packet_create_log(&packet, record->timestamp_us, record->site,
+                               record->args, record->length)) {
+            return false;
+        }
+
+        bool result = packet_transmit(&packet);
+        packet_free(&packet);
+        return result;
+    } else {
+        // Without the host's table all we can name is the site
+        char line[MAX_LINE_SIZE];
+        int len = snprintf(line, sizeof(line), "[%s] event %u\n",
+                           g_site_modules[record->site], record->site);
+        if (len < 0 || len >= sizeof(line)) {
+            return false;
+        }
+        return serial_write((uint8_t*)line, len);
+    }
+}
+
+// Copy a string into a fixed field, truncating
+static void copy_field(char *field, const char *text, size_t size) {
+    size_t length = strnlen(text, size - 1);
+    memcpy(field, text, length);
+    field[length] = '\0';
+}
+
+static LogRateSlot *logging_rate_slot(LogQueue *queue, const char *module, uint32_t now) {
+    uint32_t count = queue->slot_count;
+    for (uint32_t i = 0; i < count; i++) {
+        LogRateSlot *slot = &queue->slots[i];
+        if (slot->module == module || strncmp(slot->name, module, LOG_MODULE_SIZE - 1) == 0) {
+            slot->module = module;
+            return slot;
+        }
+    }
+
+    if (count == LOG_RATE_MODULES) {
+        return NULL;  // Table full: this module goes unlimited
+    }
+
+    LogRateSlot *slot = &queue->slots[count];
+    slot->module = module;
+    copy_field(slot->name, module, sizeof(slot->name));
+    slot->tokens = LOG_RATE_BURST * 1000;
+    slot->refilled_ms = now;
+    store_release(&queue->slot_count, count + 1);
+    return slot;
+}
+
+// Token bucket: LOG_RATE_BURST back to back, then LOG_RATE_PER_SEC
+static bool logging_rate_allow(LogQueue *queue, const char *module) {
+    uint32_t now = deskthang_time_get_ms();
+    LogRateSlot *slot = logging_rate_slot(queue, module, now);
+    if (!slot) {
+        return true;
+    }
+
+    // Capped before multiplying, so a long quiet spell can't overflow
+    uint32_t elapsed = now - slot->refilled_ms;
+    uint32_t room = LOG_RATE_BURST * 1000 - slot->tokens;
+    uint32_t gained = elapsed >= room ? room : elapsed * LOG_RATE_PER_SEC;
+    slot->tokens += gained < room ? gained : room;
+    slot->refilled_ms = now;
+
+    if (slot->tokens < 1000) {
+        store_release(&slot->suppressed, slot->suppressed + 1);
+        return false;
+    }
+    slot->tokens -= 1000;
+    return true;
+}
+
+// A free record in the calling core's ring, or NULL if it is over its rate
+// or the ring is full. Filled in, then published with logging_commit.
+static LogRecord *logging_reserve(LogQueue **queue, const char *module) {
+    if (!queues_ready) {
+        logging_init_queues();
+    }
+
+    *queue = &g_queues[platform_core_index() ? 1 : 0];
+    if (!logging_rate_allow(*queue, module)) {
+        return NULL;
+    }
+
+    size_t span;
+    LogRecord *record = (LogRecord*)serial_ring_write_span(&(*queue)->ring, &span);
+    if (span < sizeof(LogRecord)) {
+        store_release(&(*queue)->dropped_full, (*queue)->dropped_full + 1);
+        return NULL;
+    }
+    return record;
+}
+
+static void logging_commit(LogQueue *queue) {
+    serial_ring_commit(&queue->ring, sizeof(LogRecord));
+    store_release(&queue->queued, queue->queued + 1);
+}
+
+static void logging_enqueue(const char *module, const char *message) {
+    LogQueue *queue;
+    LogRecord *record = logging_reserve(&queue, module);
+    if (!record) {
+        return;
+    }
+
+    record->kind = LOG_RECORD_TEXT;
+    copy_field(record->text.module, module, sizeof(record->text.module));
+    copy_field(record->text.message, message, sizeof(record->text.message));
+    logging_commit(queue);
+}
+
 // Initialize logging
 bool logging_init(void) {
     logging_enabled = true;
     use_debug_packets = true;  // Start with debug packets
+    logging_init_queues();
     return true;
 }
 
@@ -52,16 +244,162 @@ void logging_enable_debug_packets(void) {
 // Basic logging
 void logging_write(const char *module, const char *message) {
     if (!logging_enabled || !module || !message) return;
-    send_message(module, message);
+    logging_enqueue(module, message);
+}
+
+void logging_write_with_context(const char *module, const char *message, const char *context) {
+    if (!logging_enabled || !module || !message) return;
+    if (!context) {
+        logging_enqueue(module, message);
+        return;
+    }
+
+    char line[LOG_MESSAGE_SIZE];
+    snprintf(line, sizeof(line), "%s (%s)", message, context);
+    logging_enqueue(module, line);
+}
+
+void logging_event(LogSite site, const LogArgs *args) {
+    if (!logging_enabled || site >= LOG_SITE_COUNT || !args) return;
+
+    LogQueue *queue;
+    LogRecord *record = logging_reserve(&queue, g_site_modules[site]);
+    if (!record) {
+        return;
+    }
+
+    record->kind = LOG_RECORD_EVENT;
+    record->length = args->length;
+    record->site = (uint16_t)site;
+    record->timestamp_us = deskthang_time_get_us();
+    memcpy(record->args, args->data, args->length);
+    logging_commit(queue);
+}
+
+void log_args_u32(LogArgs *args, uint32_t value) {
+    if (args->full || args->length + 4 > LOG_EVENT_ARGS_SIZE) {
+        args->full = true;  // Later arguments would be misread
+        return;
+    }
+    uint8_t *out = &args->data[args->length];
+    out[0] = value & 0xFF;
+    out[1] = (value >> 8) & 0xFF;
+    out[2] = (value >> 16) & 0xFF;
+    out[3] = (value >> 24) & 0xFF;
+    args->length += 4;
+}
+
+void log_args_string(LogArgs *args, const char *value) {
+    if (args->full || args->length >= LOG_EVENT_ARGS_SIZE) {
+        args->full = true;
+        return;
+    }
+    size_t room = LOG_EVENT_ARGS_SIZE - args->length - 1;
+    size_t length = value ? strnlen(value, room) : 0;
+    args->data[args->length] = (uint8_t)length;
+    if (length > 0) {
+        memcpy(&args->data[args->length + 1], value, length);
+    }
+    args->length += (uint8_t)(length + 1);
 }
 
 // Error logging with details
 void logging_error_details(const ErrorDetails *error) {
     if (!logging_enabled || !error) return;
 
-    char message[256];
-    snprintf(message, sizeof(message), "%s (Code: %u)", 
-             error->message, error->code);
+    // A long message is cut rather than the code after it
+    char message[LOG_MESSAGE_SIZE];
+    const int code_size = sizeof(" (Code: 4294967295)") - 1;
+    snprintf(message, sizeof(message), "%.*s (Code: %u)",
+             (int)sizeof(message) - 1 - code_size, error->message, error->code);
 
-    send_message("ERROR", message);
+    logging_enqueue("ERROR", message);
+}
+
+// Report records lost since the last report, once the ring they would have
+// been in has drained
+static size_t logging_report_losses(LogQueue *queue) {
+    size_t sent = 0;
+    char line[64];
+
+    uint32_t dropped = load_acquire(&queue->dropped_full);
+    if (dropped != queue->reported_full) {
+        snprintf(line, sizeof(line), "%lu records dropped, queue full",
+                 (unsigned long)(dropped - queue->reported_full));
+        send_message("Log", line);
+        queue->reported_full = dropped;
+        sent++;
+    }
+
+    uint32_t count = load_acquire(&queue->slot_count);
+    for (uint32_t i = 0; i < count; i++) {
+        LogRateSlot *slot = &queue->slots[i];
+        uint32_t suppressed = load_acquire(&slot->suppressed);
+        if (suppressed != slot->reported) {
+            snprintf(line, sizeof(line), "%lu %s records over rate limit",
+                     (unsigned long)(suppressed - slot->reported), slot->name);
+            send_message("Log", line);
+            slot->reported = suppressed;
+            sent++;
+        }
+    }
+    return sent;
+}
+
+size_t logging_service(void) {
+    if (!queues_ready) {
+        return 0;
+    }
+
+    size_t sent = 0;
+    for (int core = 0; core < 2 && sent < LOG_DRAIN_BATCH; core++) {
+        LogQueue *queue = &g_queues[core];
+        size_t span;
+        const LogRecord *record;
+        while (sent < LOG_DRAIN_BATCH &&
+               (record = (const LogRecord*)serial_ring_read_span(&queue->ring, &span)) &&
+               span >= sizeof(LogRecord)) {
+            if (record->kind == LOG_RECORD_EVENT) {
+                send_event(record);
+            } else {
+                send_message(record->text.module, record->text.message);
+            }
+            serial_ring_consume(&queue->ring, sizeof(LogRecord));
+            g_sent++;
+            sent++;
+        }
+
+        if (sent < LOG_DRAIN_BATCH) {
+            sent += logging_report_losses(queue);
+        }
+    }
+    return sent;
+}
+
+void logging_flush(void) {
+    while (logging_service() > 0) {
+    }
+}
+
+void logging_get_stats(LoggingStats *stats) {
+    if (!stats) {
+        return;
+    }
+    if (!queues_ready) {
+        logging_init_queues();
+    }
+
+    memset(stats, 0, sizeof(LoggingStats));
+    stats->sent = g_sent;
+    for (int core = 0; core < 2; core++) {
+        LogQueue *queue = &g_queues[core];
+        stats->queued += load_acquire(&queue->queued);
+        stats->dropped_full += load_acquire(&queue->dropped_full);
+        stats->pending += (uint16_t)(serial_ring_count(&queue->ring) / sizeof(LogRecord));
+
+        uint32_t count = load_acquire(&queue->slot_count);
+        for (uint32_t i = 0; i < count; i++) {
+            stats->dropped_rate += load_acquire(&queue->slots[i].suppressed);
+        }
+    }
 }
@@ -2,19 +2,132 @@
 #define LOGGING_H
 
 #include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
 #include "error.h"
 
+// Log lines are queued, not sent. logging_write copies a fixed-size record
+// into the calling core's ring and returns; the idle loop sends queued
+// records as debug packets in small batches, so a log line never costs its
+// caller a packet build, CRC or serial write.
+//
+// Each core has its own SPSC ring (core0 drains both), so core1 can log
+// without a lock. A full ring drops the record and counts it, and each
+// module is held to a token-bucket rate; both kinds of loss are reported
+// as "Log: ..." lines once the ring drains.
+#define LOG_MODULE_SIZE      16   // Module name, NUL included
+#define LOG_MESSAGE_SIZE     104  // Message, NUL included; longer is truncated
+#define LOG_EVENT_ARGS_SIZE  (LOG_MODULE_SIZE + LOG_MESSAGE_SIZE)  // Raw event arguments
+
+#ifndef LOG_RING_RECORDS
+#define LOG_RING_RECORDS     32   // Core0 ring, power of two
+#endif
+
+#ifndef LOG_CORE1_RING_RECORDS
+#define LOG_CORE1_RING_RECORDS 8  // Core1 only logs failures
+#endif
+
+#define LOG_DRAIN_BATCH      4    // Records sent per logging_service call
+#define LOG_RATE_BURST       8    // Records a module may queue back to back
+#define LOG_RATE_PER_SEC     16   // Then this many a second
+#define LOG_RATE_MODULES     16   // Modules tracked per core; others aren't limited
+
+// Log levels for LOG_EVENT sites. Sites above DESKTHANG_LOG_LEVEL compile
+// to nothing: no call, and no argument is evaluated.
+#define LOG_LEVEL_ERROR      0
+#define LOG_LEVEL_WARN       1
+#define LOG_LEVEL_INFO       2
+#define LOG_LEVEL_DEBUG      3
+
+#ifndef DESKTHANG_LOG_LEVEL
+#define DESKTHANG_LOG_LEVEL  LOG_LEVEL_DEBUG
+#endif
+
+// Site ids and levels, from log_sites.def
+typedef enum {
+#define LOG_SITE(name, level, module, format) LOG_SITE_##name,
+#include "log_sites.def"
+#undef LOG_SITE
+    LOG_SITE_COUNT
+} LogSite;
+
+enum {
+#define LOG_SITE(name, level, module, format) LOG_SITE_LEVEL_##name = level,
+#include "log_sites.def"
+#undef LOG_SITE
+};
+
+// Raw arguments of one event, as the host decodes them: a string is a
+// length byte and its bytes, anything else a u32 LE. Arguments that don't
+// fit are cut short; the host shows what arrived.
+typedef struct {
+    uint8_t data[LOG_EVENT_ARGS_SIZE];
+    uint8_t length;
+    bool full;  // An argument didn't fit; the rest are left out
+} LogArgs;
+
+void log_args_u32(LogArgs *args, uint32_t value);
+void log_args_string(LogArgs *args, const char *value);
+
+#define LOG_ARG(args, value) _Generic((value), \
+    char *: log_args_string,                   \
+    const char *: log_args_string,             \
+    default: log_args_u32)((args), (value))
+
+#define LOG_ARG_COUNT(...) LOG_ARG_COUNT_(_, ##__VA_ARGS__, 4, 3, 2, 1, 0)
+#define LOG_ARG_COUNT_(_0, _1, _2, _3, _4, count, ...) count
+#define LOG_ARGS_CAT_(prefix, count) prefix##count
+#define LOG_ARGS_(count) LOG_ARGS_CAT_(LOG_ARGS_, count)
+#define LOG_ARGS_0(args)
+#define LOG_ARGS_1(args, a) LOG_ARG(args, a);
+#define LOG_ARGS_2(args, a, ...) LOG_ARG(args, a); LOG_ARGS_1(args, __VA_ARGS__)
+#define LOG_ARGS_3(args, a, ...) LOG_ARG(args, a); LOG_ARGS_2(args, __VA_ARGS__)
+#define LOG_ARGS_4(args, a, ...) LOG_ARG(args, a); LOG_ARGS_3(args, __VA_ARGS__)
+
+// Queue a binary log record for a site in log_sites.def, with up to four
+// arguments matching its format. The device sends (timestamp, site, raw
+// arguments) and never formats the line.
+#define LOG_EVENT(site, ...) do {                                          \
+    if (LOG_SITE_LEVEL_##site <= DESKTHANG_LOG_LEVEL) {                    \
+        LogArgs log_args_;                                                 \
+        log_args_.length = 0;                                              \
+        log_args_.full = false;                                            \
+        LOG_ARGS_(LOG_ARG_COUNT(__VA_ARGS__))(&log_args_, ##__VA_ARGS__)   \
+        logging_event(LOG_SITE_##site, &log_args_);                        \
+    }                                                                      \
+} while (0)
+
+typedef struct {
+    uint32_t queued;          // Records accepted
+    uint32_t sent;            // Records handed to the packet layer
+    uint32_t dropped_full;    // Records lost to a full ring
+    uint32_t dropped_rate;    // Records over their module's rate
+    uint16_t pending;         // Records waiting now
+} LoggingStats;
+
 // Initialize logging system
 bool logging_init(void);
 
 // Enable debug packet mode for logging
 void logging_enable_debug_packets(void);
 
-// Basic logging functions
+// Basic logging functions: queue a record, never block
 void logging_write(const char *module, const char *message);
 void logging_write_with_context(const char *module, const char *message, const char *context);
 
+// Queue an event record; use LOG_EVENT rather than calling this
+void logging_event(LogSite site, const LogArgs *args);
+
 // Error logging with details
 void logging_error_details(const ErrorDetails *error);
 
+// Core0 idle loop: send up to LOG_DRAIN_BATCH queued records, plus any
+// loss reports. Returns the lines sent.
+size_t logging_service(void);
+
+// Core0: send everything queued (end of boot, before a reset)
+void logging_flush(void);
+
+void logging_get_stats(LoggingStats *stats);
+
 #endif // LOGGING_H
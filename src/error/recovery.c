@@ -2,6 +2,7 @@
 #include "error.h"
 #include "logging.h"
 #include "../system/time.h"
+#include "../system/scheduler.h"
 #include <string.h>
 #include <stdio.h>
 #include "pico/stdlib.h"
@@ -21,8 +22,13 @@ static RecoveryStats g_recovery_stats;
 // Recovery handlers
 static RecoveryHandler g_recovery_handlers[5] = {NULL}; // One for each strategy
 
+// Backoff before the next scheduled retry
+static SchedTimer g_retry_timer;
+static RecoveryRetryFn g_retry_fn;
+
 // Initialize recovery system
 bool recovery_init(void) {
+    scheduler_timer_cancel(&g_retry_timer);
     memset(&g_recovery_stats, 0, sizeof(RecoveryStats));
     memset(g_recovery_handlers, 0, sizeof(g_recovery_handlers));
     return true;
@@ -82,8 +88,7 @@ bool recovery_is_strategy_allowed(RecoveryStrategy strategy) {
 
 // Simplified recovery handlers for prototype
 static bool handle_retry_recovery(const ErrorDetails *error) {
-    uint32_t delay = recovery_get_retry_delay(g_recovery_stats.total_attempts);
-    recovery_wait_before_retry(delay);
+    // The backoff is the caller's, through recovery_schedule_retry
     return true;
 }
 
@@ -192,8 +197,24 @@ uint32_t recovery_get_retry_delay(uint32_t attempt_count) {
         g_recovery_config.max_delay_ms : delay;
 }
 
-void recovery_wait_before_retry(uint32_t delay_ms) {
-    sleep_ms(delay_ms);
+static void recovery_retry_due(void *context) {
+    (void)context;
+    g_retry_fn();
+}
+
+void recovery_schedule_retry(RecoveryRetryFn retry) {
+    if (!retry) {
+        return;
+    }
+    uint32_t delay_ms = recovery_get_retry_delay(g_recovery_stats.total_attempts);
+    g_recovery_stats.total_attempts++;
+    g_recovery_stats.total_retry_time += delay_ms;
+    g_retry_fn = retry;
+    scheduler_timer_start(&g_retry_timer, delay_ms * 1000, 0, recovery_retry_due, NULL);
+}
+
+bool recovery_retry_pending(void) {
+    return scheduler_timer_armed(&g_retry_timer);
 }
 
 // Recovery handlers
@@ -43,7 +43,12 @@ bool recovery_is_in_progress(void);
 // Retry management
 bool recovery_should_retry(uint32_t attempt_count);
 uint32_t recovery_get_retry_delay(uint32_t attempt_count);
-void recovery_wait_before_retry(uint32_t delay_ms);
+
+// Run retry from the scheduler after the backoff for the attempts so far,
+// instead of sleeping it out. Replaces a retry already pending.
+typedef void (*RecoveryRetryFn)(void);
+void recovery_schedule_retry(RecoveryRetryFn retry);
+bool recovery_retry_pending(void);
 
 // Recovery handlers
 typedef bool (*RecoveryHandler)(const ErrorDetails *error);
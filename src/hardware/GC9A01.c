@@ -1,38 +1,89 @@
 #include "GC9A01.h"
 #include "deskthang_spi.h"  // Changed from spi.h
-#include "hardware/gpio.h"
+#include "deskthang_gpio.h"
 #include "../common/deskthang_constants.h"
 #include "../error/logging.h"
 #include <stdio.h>
+#include <string.h>
 
 static uint8_t current_orientation = 0;
 
+// Ping-pong buffers for the pixel engine. At most one buffer is in flight
+// (the one last handed to DMA), so the other is always free to fill.
+static struct {
+    uint16_t buffers[2][GC9A01_PIXEL_BUFFER_PIXELS];
+    uint16_t fill_color;   // Source of the fixed-address fill DMA
+    uint8_t next;          // Buffer the next push fills
+    uint8_t split_byte;    // High byte of a pixel split across pushes
+    bool has_split_byte;
+    bool active;
+} pixel_engine = {0};
+
 void GC9A01_set_orientation(uint8_t orientation) {
     current_orientation = orientation & 0x03;  // Ensure valid range 0-3
 }
 
-void GC9A01_write_command(uint8_t cmd) {
+// Window the controller currently holds, so unchanged CASET/RASET can be
+// skipped. Invalid after a reset or a failed transaction.
+static struct {
+    struct GC9A01_frame frame;
+    bool valid;
+} window_cache = {0};
+
+static GC9A01Stats gc9a01_stats = {0};
+
+// Send each command and its parameters with CS already asserted. D/C only
+// changes at command/parameter boundaries: a blocking SPI write returns
+// once its last bit is out, which is all the D/C and CS setup times
+// (tens of ns) need, so no sleeps go between them.
+static bool GC9A01_send_commands(const GC9A01_command *commands, size_t count) {
+    bool success = true;
+    for (size_t i = 0; i < count; i++) {
+        GC9A01_set_data_command(0);  // Command mode
+        success &= deskthang_spi_write(&commands[i].cmd, 1);
+
+        if (commands[i].len > 0) {
+            GC9A01_set_data_command(1);  // Data mode
+            success &= deskthang_spi_write(commands[i].params, commands[i].len);
+        }
+
+        gc9a01_stats.commands++;
+        gc9a01_stats.param_bytes += commands[i].len;
+    }
+    return success;
+}
+
+bool GC9A01_transaction(const GC9A01_command *commands, size_t count) {
+    if (!commands || count == 0) {
+        return false;
+    }
+
     if (!deskthang_spi_is_initialized()) {
-        printf("Display Error: SPI not initialized when writing command 0x%02X\n", cmd);
-        return;
+        printf("Display Error: SPI not initialized when writing command 0x%02X\n", commands[0].cmd);
+        window_cache.valid = false;
+        return false;
     }
 
-    GC9A01_set_data_command(0);  // Command mode
-    sleep_us(1);                 // Small delay for D/C setup
-    
-    GC9A01_set_chip_select(0);   // CS active
-    sleep_us(1);                 // Small delay for CS setup
-    
-    bool success = deskthang_spi_write(&cmd, sizeof(cmd));
-    
-    sleep_us(1);                 // Small delay before CS change
+    GC9A01_set_chip_select(0);   // CS active for the whole list
+    bool success = GC9A01_send_commands(commands, count);
     GC9A01_set_chip_select(1);   // CS inactive
-    
+    gc9a01_stats.transactions++;
+
     if (!success) {
-        printf("Display Error: Failed to write command 0x%02X (SPI error)\n", cmd);
+        printf("Display Error: Failed to write command 0x%02X (SPI error)\n", commands[0].cmd);
+        window_cache.valid = false;  // Unknown which address sets landed
     }
-    
-    sleep_us(10);  // Delay between commands
+    return success;
+}
+
+void GC9A01_write_command(uint8_t cmd) {
+    GC9A01_command command = {cmd, 0, NULL};
+    GC9A01_transaction(&command, 1);
+}
+
+void GC9A01_write_command_data(uint8_t cmd, const uint8_t *params, uint8_t len) {
+    GC9A01_command command = {cmd, len, params};
+    GC9A01_transaction(&command, 1);
 }
 
 void GC9A01_write_data(const uint8_t *data, size_t len) {
@@ -47,16 +98,12 @@ void GC9A01_write_data(const uint8_t *data, size_t len) {
     }
 
     GC9A01_set_data_command(1);  // Data mode
-    sleep_us(1);                 // Small delay for D/C setup
-    
     GC9A01_set_chip_select(0);   // CS active
-    sleep_us(1);                 // Small delay for CS setup
-    
     bool success = deskthang_spi_write(data, len);
-    
-    sleep_us(1);                 // Small delay before CS change
     GC9A01_set_chip_select(1);   // CS inactive
-    
+    gc9a01_stats.transactions++;
+    gc9a01_stats.param_bytes += len;
+
     if (!success) {
         printf("Display Error: Failed to write %zu bytes of data (SPI error)\n", len);
         // Print first byte if available for debugging
@@ -64,17 +111,111 @@ void GC9A01_write_data(const uint8_t *data, size_t len) {
             printf("Display Error: First byte was 0x%02X\n", data[0]);
         }
     }
-    
-    sleep_us(10);  // Delay between data writes
 }
 
-static inline void GC9A01_write_byte(uint8_t val) {
-    GC9A01_write_data(&val, sizeof(val));
-    sleep_us(5);  // Small delay between bytes
+bool GC9A01_run_sequence(const GC9A01_command *commands, size_t count) {
+    size_t start = 0;
+    for (size_t i = 0; i < count; i++) {
+        if (commands[i].delay_ms == 0 && i + 1 < count) {
+            continue;
+        }
+
+        if (!GC9A01_transaction(commands + start, i + 1 - start)) {
+            return false;
+        }
+        if (commands[i].delay_ms > 0) {
+            GC9A01_delay(commands[i].delay_ms);
+        }
+        start = i + 1;
+    }
+    return true;
 }
 
+// Parameters of an init-table command
+#define GC9A01_PARAMS(...) \
+    sizeof((const uint8_t[]){__VA_ARGS__}), (const uint8_t[]){__VA_ARGS__}
+
+#if ORIENTATION == 0
+#define GC9A01_INIT_MADCTL 0x18
+#elif ORIENTATION == 1
+#define GC9A01_INIT_MADCTL 0x28
+#elif ORIENTATION == 2
+#define GC9A01_INIT_MADCTL 0x48
+#else
+#define GC9A01_INIT_MADCTL 0x88
+#endif
+
+// Vendor power-up sequence: (cmd, len, params, post-delay). Nothing in it
+// needs a delay, so it goes as a single transaction.
+static const GC9A01_command init_sequence[] = {
+    // Power control
+    {0xEF, 0, NULL},
+    {0xEB, GC9A01_PARAMS(0x14)},
+    {0xFE, 0, NULL},
+    {0xEF, 0, NULL},
+    {0xEB, GC9A01_PARAMS(0x14)},
+    {0x84, GC9A01_PARAMS(0x40)},
+    {0x85, GC9A01_PARAMS(0xFF)},
+    {0x86, GC9A01_PARAMS(0xFF)},
+    {0x87, GC9A01_PARAMS(0xFF)},
+    {0x88, GC9A01_PARAMS(0x0A)},
+    {0x89, GC9A01_PARAMS(0x21)},
+    {0x8A, GC9A01_PARAMS(0x00)},
+    {0x8B, GC9A01_PARAMS(0x80)},
+    {0x8C, GC9A01_PARAMS(0x01)},
+    {0x8D, GC9A01_PARAMS(0x01)},
+    {0x8E, GC9A01_PARAMS(0xFF)},
+    {0x8F, GC9A01_PARAMS(0xFF)},
+
+    // Display parameters, orientation (MADCTL) and 16-bit colour
+    {0xB6, GC9A01_PARAMS(0x00, 0x00)},
+    {0x36, GC9A01_PARAMS(GC9A01_INIT_MADCTL)},
+    {0x3A, GC9A01_PARAMS(0x05)},
+
+    // Gamma
+    {0x90, GC9A01_PARAMS(0x08, 0x08, 0x08, 0x08)},
+    {0xBD, GC9A01_PARAMS(0x06)},
+    {0xBC, GC9A01_PARAMS(0x00)},
+    {0xFF, GC9A01_PARAMS(0x60, 0x01, 0x04)},
+
+    // Power control registers
+    {0xC3, GC9A01_PARAMS(0x13)},
+    {0xC4, GC9A01_PARAMS(0x13)},
+    {0xC9, GC9A01_PARAMS(0x22)},
+    {0xBE, GC9A01_PARAMS(0x11)},
+    {0xE1, GC9A01_PARAMS(0x10, 0x0E)},
+    {0xDF, GC9A01_PARAMS(0x21, 0x0c, 0x02)},
+    {0xF0, GC9A01_PARAMS(0x45, 0x09, 0x08, 0x08, 0x26, 0x2A)},
+    {0xF1, GC9A01_PARAMS(0x43, 0x70, 0x72, 0x36, 0x37, 0x6F)},
+    {0xF2, GC9A01_PARAMS(0x45, 0x09, 0x08, 0x08, 0x26, 0x2A)},
+    {0xF3, GC9A01_PARAMS(0x43, 0x70, 0x72, 0x36, 0x37, 0x6F)},
+    {0xED, GC9A01_PARAMS(0x1B, 0x0B)},
+    {0xAE, GC9A01_PARAMS(0x77)},
+    {0xCD, GC9A01_PARAMS(0x63)},
+    {0x70, GC9A01_PARAMS(0x07, 0x07, 0x04, 0x0E, 0x0F, 0x09, 0x07, 0x08, 0x03)},
+    {0xE8, GC9A01_PARAMS(0x34)},
+    {0x62, GC9A01_PARAMS(0x18, 0x0D, 0x71, 0xED, 0x70, 0x70, 0x18, 0x0F, 0x71, 0xEF, 0x70, 0x70)},
+    {0x63, GC9A01_PARAMS(0x18, 0x11, 0x71, 0xF1, 0x70, 0x70, 0x18, 0x13, 0x71, 0xF3, 0x70, 0x70)},
+    {0x64, GC9A01_PARAMS(0x28, 0x29, 0xF1, 0x01, 0xF1, 0x00, 0x07)},
+    {0x66, GC9A01_PARAMS(0x3C, 0x00, 0xCD, 0x67, 0x45, 0x45, 0x10, 0x00, 0x00, 0x00)},
+    {0x67, GC9A01_PARAMS(0x00, 0x3C, 0x00, 0x00, 0x00, 0x01, 0x54, 0x10, 0x32, 0x98)},
+    {0x74, GC9A01_PARAMS(0x10, 0x85, 0x80, 0x00, 0x00, 0x4E, 0x00)},
+    {0x98, GC9A01_PARAMS(0x3e, 0x07)},
+    {0x35, 0, NULL},
+    {0x21, 0, NULL},
+};
+
+// Sleep Out, then Display ON once the supplies have settled
+static const GC9A01_command wake_sequence[] = {
+    {0x11, 0, NULL, DISPLAY_WAKE_DELAY_MS},
+    {0x29, 0, NULL},
+};
+
+#define GC9A01_SEQUENCE_LENGTH(sequence) (sizeof(sequence) / sizeof(sequence[0]))
+
 void GC9A01_init(void) {
     logging_write("Display", "Starting initialization sequence");
+    uint32_t start_ms = deskthang_time_get_ms();
     
     // Check if SPI is initialized
     if (!deskthang_spi_is_initialized()) {
@@ -83,299 +224,113 @@ void GC9A01_init(void) {
     }
     
     // Check GPIO pins
-    logging_write("Display", "Checking GPIO pins...");
-    if (!gpio_is_dir_out(DISPLAY_PIN_CS) || !gpio_is_dir_out(DISPLAY_PIN_DC) || !gpio_is_dir_out(DISPLAY_PIN_RST)) {
+    if (!deskthang_gpio_is_output(DISPLAY_PIN_CS) || !deskthang_gpio_is_output(DISPLAY_PIN_DC) || !deskthang_gpio_is_output(DISPLAY_PIN_RST)) {
         char error_msg[100];
         snprintf(error_msg, sizeof(error_msg), 
                 "GPIO pins not properly configured - CS:%d DC:%d RST:%d", 
-                gpio_is_dir_out(DISPLAY_PIN_CS),
-                gpio_is_dir_out(DISPLAY_PIN_DC),
-                gpio_is_dir_out(DISPLAY_PIN_RST));
+                deskthang_gpio_is_output(DISPLAY_PIN_CS),
+                deskthang_gpio_is_output(DISPLAY_PIN_DC),
+                deskthang_gpio_is_output(DISPLAY_PIN_RST));
         logging_write("Display", error_msg);
         return;
     }
-    logging_write("Display", "GPIO pins configured correctly");
     
+    // Hardware reset: only the datasheet minimums
     GC9A01_set_chip_select(1);
-    GC9A01_delay(5);
-    logging_write("Display", "Starting reset sequence");
     GC9A01_set_reset(0);
-    GC9A01_delay(10);
+    deskthang_delay_us(DISPLAY_RESET_PULSE_US);
     GC9A01_set_reset(1);
-    GC9A01_delay(120);
-    logging_write("Display", "Reset sequence complete");
-    
-    /* Initial Sequence */ 
-    logging_write("Display", "Starting power control sequence");
-    GC9A01_write_command(0xEF);
-    GC9A01_write_command(0xEB);
-    GC9A01_write_byte(0x14);
-    
-    GC9A01_write_command(0xFE);
-    GC9A01_write_command(0xEF);
-    
-    GC9A01_write_command(0xEB);
-    GC9A01_write_byte(0x14);
-    
-    GC9A01_write_command(0x84);
-    GC9A01_write_byte(0x40);
-    
-    GC9A01_write_command(0x85);
-    GC9A01_write_byte(0xFF);
-    
-    GC9A01_write_command(0x86);
-    GC9A01_write_byte(0xFF);
-    
-    GC9A01_write_command(0x87);
-    GC9A01_write_byte(0xFF);
-    
-    GC9A01_write_command(0x88);
-    GC9A01_write_byte(0x0A);
-    
-    GC9A01_write_command(0x89);
-    GC9A01_write_byte(0x21);
-    
-    GC9A01_write_command(0x8A);
-    GC9A01_write_byte(0x00);
-    
-    GC9A01_write_command(0x8B);
-    GC9A01_write_byte(0x80);
-    
-    GC9A01_write_command(0x8C);
-    GC9A01_write_byte(0x01);
-    
-    GC9A01_write_command(0x8D);
-    GC9A01_write_byte(0x01);
-    
-    GC9A01_write_command(0x8E);
-    GC9A01_write_byte(0xFF);
-    
-    GC9A01_write_command(0x8F);
-    GC9A01_write_byte(0xFF);
-    logging_write("Display", "Power control sequence complete");
-    
-    logging_write("Display", "Configuring display parameters");
-    GC9A01_write_command(0xB6);
-    GC9A01_write_byte(0x00);
-    GC9A01_write_byte(0x00);
-    
-    logging_write("Display", "Setting orientation (MADCTL)");
-    GC9A01_write_command(0x36);
-#if ORIENTATION == 0
-    GC9A01_write_byte(0x18);
-#elif ORIENTATION == 1
-    GC9A01_write_byte(0x28);
-#elif ORIENTATION == 2
-    GC9A01_write_byte(0x48);
-#else
-    GC9A01_write_byte(0x88);
-#endif
-    
-    logging_write("Display", "Setting color mode to 16-bit");
-    GC9A01_write_command(0x3A);
-    GC9A01_write_byte(0x05);
-    
-    logging_write("Display", "Configuring gamma settings");
-    GC9A01_write_command(0x90);
-    GC9A01_write_byte(0x08);
-    GC9A01_write_byte(0x08);
-    GC9A01_write_byte(0x08);
-    GC9A01_write_byte(0x08);
-    
-    GC9A01_write_command(0xBD);
-    GC9A01_write_byte(0x06);
-    
-    GC9A01_write_command(0xBC);
-    GC9A01_write_byte(0x00);
-    
-    GC9A01_write_command(0xFF);
-    GC9A01_write_byte(0x60);
-    GC9A01_write_byte(0x01);
-    GC9A01_write_byte(0x04);
-    
-    logging_write("Display", "Setting power control registers");
-    GC9A01_write_command(0xC3);
-    GC9A01_write_byte(0x13);
-    GC9A01_write_command(0xC4);
-    GC9A01_write_byte(0x13);
-    
-    GC9A01_write_command(0xC9);
-    GC9A01_write_byte(0x22);
-    
-    GC9A01_write_command(0xBE);
-    GC9A01_write_byte(0x11);
-    
-    GC9A01_write_command(0xE1);
-    GC9A01_write_byte(0x10);
-    GC9A01_write_byte(0x0E);
-    
-    GC9A01_write_command(0xDF);
-    GC9A01_write_byte(0x21);
-    GC9A01_write_byte(0x0c);
-    GC9A01_write_byte(0x02);
-    
-    GC9A01_write_command(0xF0);
-    GC9A01_write_byte(0x45);
-    GC9A01_write_byte(0x09);
-    GC9A01_write_byte(0x08);
-    GC9A01_write_byte(0x08);
-    GC9A01_write_byte(0x26);
-    GC9A01_write_byte(0x2A);
-    
-    GC9A01_write_command(0xF1);
-    GC9A01_write_byte(0x43);
-    GC9A01_write_byte(0x70);
-    GC9A01_write_byte(0x72);
-    GC9A01_write_byte(0x36);
-    GC9A01_write_byte(0x37);
-    GC9A01_write_byte(0x6F);
-    
-    GC9A01_write_command(0xF2);
-    GC9A01_write_byte(0x45);
-    GC9A01_write_byte(0x09);
-    GC9A01_write_byte(0x08);
-    GC9A01_write_byte(0x08);
-    GC9A01_write_byte(0x26);
-    GC9A01_write_byte(0x2A);
-    
-    GC9A01_write_command(0xF3);
-    GC9A01_write_byte(0x43);
-    GC9A01_write_byte(0x70);
-    GC9A01_write_byte(0x72);
-    GC9A01_write_byte(0x36);
-    GC9A01_write_byte(0x37);
-    GC9A01_write_byte(0x6F);
-    
-    GC9A01_write_command(0xED);
-    GC9A01_write_byte(0x1B);
-    GC9A01_write_byte(0x0B);
-    
-    GC9A01_write_command(0xAE);
-    GC9A01_write_byte(0x77);
-    
-    GC9A01_write_command(0xCD);
-    GC9A01_write_byte(0x63);
-    
-    GC9A01_write_command(0x70);
-    GC9A01_write_byte(0x07);
-    GC9A01_write_byte(0x07);
-    GC9A01_write_byte(0x04);
-    GC9A01_write_byte(0x0E);
-    GC9A01_write_byte(0x0F);
-    GC9A01_write_byte(0x09);
-    GC9A01_write_byte(0x07);
-    GC9A01_write_byte(0x08);
-    GC9A01_write_byte(0x03);
-    
-    GC9A01_write_command(0xE8);
-    GC9A01_write_byte(0x34);
-    
-    GC9A01_write_command(0x62);
-    GC9A01_write_byte(0x18);
-    GC9A01_write_byte(0x0D);
-    GC9A01_write_byte(0x71);
-    GC9A01_write_byte(0xED);
-    GC9A01_write_byte(0x70);
-    GC9A01_write_byte(0x70);
-    GC9A01_write_byte(0x18);
-    GC9A01_write_byte(0x0F);
-    GC9A01_write_byte(0x71);
-    GC9A01_write_byte(0xEF);
-    GC9A01_write_byte(0x70);
-    GC9A01_write_byte(0x70);
-    
-    GC9A01_write_command(0x63);
-    GC9A01_write_byte(0x18);
-    GC9A01_write_byte(0x11);
-    GC9A01_write_byte(0x71);
-    GC9A01_write_byte(0xF1);
-    GC9A01_write_byte(0x70);
-    GC9A01_write_byte(0x70);
-    GC9A01_write_byte(0x18);
-    GC9A01_write_byte(0x13);
-    GC9A01_write_byte(0x71);
-    GC9A01_write_byte(0xF3);
-    GC9A01_write_byte(0x70);
-    GC9A01_write_byte(0x70);
-    
-    GC9A01_write_command(0x64);
-    GC9A01_write_byte(0x28);
-    GC9A01_write_byte(0x29);
-    GC9A01_write_byte(0xF1);
-    GC9A01_write_byte(0x01);
-    GC9A01_write_byte(0xF1);
-    GC9A01_write_byte(0x00);
-    GC9A01_write_byte(0x07);
-    
-    GC9A01_write_command(0x66);
-    GC9A01_write_byte(0x3C);
-    GC9A01_write_byte(0x00);
-    GC9A01_write_byte(0xCD);
-    GC9A01_write_byte(0x67);
-    GC9A01_write_byte(0x45);
-    GC9A01_write_byte(0x45);
-    GC9A01_write_byte(0x10);
-    GC9A01_write_byte(0x00);
-    GC9A01_write_byte(0x00);
-    GC9A01_write_byte(0x00);
-    
-    GC9A01_write_command(0x67);
-    GC9A01_write_byte(0x00);
-    GC9A01_write_byte(0x3C);
-    GC9A01_write_byte(0x00);
-    GC9A01_write_byte(0x00);
-    GC9A01_write_byte(0x00);
-    GC9A01_write_byte(0x01);
-    GC9A01_write_byte(0x54);
-    GC9A01_write_byte(0x10);
-    GC9A01_write_byte(0x32);
-    GC9A01_write_byte(0x98);
-    
-    GC9A01_write_command(0x74);
-    GC9A01_write_byte(0x10);
-    GC9A01_write_byte(0x85);
-    GC9A01_write_byte(0x80);
-    GC9A01_write_byte(0x00);
-    GC9A01_write_byte(0x00);
-    GC9A01_write_byte(0x4E);
-    GC9A01_write_byte(0x00);
-    
-    GC9A01_write_command(0x98);
-    GC9A01_write_byte(0x3e);
-    GC9A01_write_byte(0x07);
-    
-    GC9A01_write_command(0x35);
-    GC9A01_write_command(0x21);
-    
-    logging_write("Display", "Exiting sleep mode");
-    GC9A01_write_command(0x11);    // Sleep Out
-    GC9A01_delay(120);
-    
-    logging_write("Display", "Turning display on");
-    GC9A01_write_command(0x29);    // Display ON
-    GC9A01_delay(20);
+    uint32_t reset_ms = deskthang_time_get_ms();
+    GC9A01_delay(DISPLAY_RESET_READY_MS);
+    GC9A01_window_invalidate();  // Reset cleared the address window
+    
+    // The init table goes out while the reset's 120 ms Sleep Out lockout
+    // runs, then only what is left of it is waited
+    GC9A01_run_sequence(init_sequence, GC9A01_SEQUENCE_LENGTH(init_sequence));
+    uint32_t since_reset = deskthang_time_get_ms() - reset_ms;
+    if (since_reset < DISPLAY_INIT_DELAY_MS) {
+        GC9A01_delay(DISPLAY_INIT_DELAY_MS - since_reset);
+    }
+    GC9A01_run_sequence(wake_sequence, GC9A01_SEQUENCE_LENGTH(wake_sequence));
     
-    logging_write("Display", "Initialization complete");
+    char msg[64];
+    snprintf(msg, sizeof(msg), "Initialization complete in %lu ms",
+             (unsigned long)(deskthang_time_get_ms() - start_ms));
+    logging_write("Display", msg);
+}
+
+void GC9A01_window_invalidate(void) {
+    window_cache.valid = false;
+}
+
+// CASET/RASET for whatever part of frame the controller doesn't already
+// hold. Fills commands (room for two) and returns how many are needed.
+static size_t GC9A01_window_commands(struct GC9A01_frame frame,
+                                     GC9A01_command *commands,
+                                     uint8_t params[2][4]) {
+    size_t count = 0;
+    bool columns_current = window_cache.valid &&
+                           window_cache.frame.start.X == frame.start.X &&
+                           window_cache.frame.end.X == frame.end.X;
+    bool rows_current = window_cache.valid &&
+                        window_cache.frame.start.Y == frame.start.Y &&
+                        window_cache.frame.end.Y == frame.end.Y;
+
+    if (columns_current) {
+        gc9a01_stats.address_sets_skipped++;
+    } else {
+        params[count][0] = (frame.start.X >> 8) & 0xFF;
+        params[count][1] = frame.start.X & 0xFF;
+        params[count][2] = (frame.end.X >> 8) & 0xFF;
+        params[count][3] = frame.end.X & 0xFF;
+        commands[count] = (GC9A01_command){GC9A01_COL_ADDR_SET, 4, params[count]};
+        count++;
+    }
+
+    if (rows_current) {
+        gc9a01_stats.address_sets_skipped++;
+    } else {
+        params[count][0] = (frame.start.Y >> 8) & 0xFF;
+        params[count][1] = frame.start.Y & 0xFF;
+        params[count][2] = (frame.end.Y >> 8) & 0xFF;
+        params[count][3] = frame.end.Y & 0xFF;
+        commands[count] = (GC9A01_command){GC9A01_ROW_ADDR_SET, 4, params[count]};
+        count++;
+    }
+
+    window_cache.frame = frame;
+    window_cache.valid = true;
+    return count;
 }
 
 void GC9A01_set_frame(struct GC9A01_frame frame) {
+    GC9A01_command commands[2];
+    uint8_t params[2][4];
+    size_t count = GC9A01_window_commands(frame, commands, params);
+    if (count > 0) {
+        GC9A01_transaction(commands, count);
+    }
+}
 
-    uint8_t data[4];
-    
-    GC9A01_write_command(GC9A01_COL_ADDR_SET);
-    data[0] = (frame.start.X >> 8) & 0xFF;
-    data[1] = frame.start.X & 0xFF;
-    data[2] = (frame.end.X >> 8) & 0xFF;
-    data[3] = frame.end.X & 0xFF;
-    GC9A01_write_data(data, sizeof(data));
-
-    GC9A01_write_command(GC9A01_ROW_ADDR_SET);
-    data[0] = (frame.start.Y >> 8) & 0xFF;
-    data[1] = frame.start.Y & 0xFF;
-    data[2] = (frame.end.Y >> 8) & 0xFF;
-    data[3] = frame.end.Y & 0xFF;
-    GC9A01_write_data(data, sizeof(data));
-    
+void GC9A01_start_write(struct GC9A01_frame frame) {
+    // MEM_WR always goes: it moves the write pointer back to the window start
+    GC9A01_command commands[3];
+    uint8_t params[2][4];
+    size_t count = GC9A01_window_commands(frame, commands, params);
+    commands[count++] = (GC9A01_command){GC9A01_MEM_WR, 0, NULL};
+    GC9A01_transaction(commands, count);
+}
+
+bool GC9A01_get_stats(GC9A01Stats *stats) {
+    if (!stats) {
+        return false;
+    }
+    *stats = gc9a01_stats;
+    return true;
+}
+
+void GC9A01_reset_stats(void) {
+    memset(&gc9a01_stats, 0, sizeof(gc9a01_stats));
 }
 
 void GC9A01_write(const uint8_t *data, size_t len) {
@@ -390,44 +345,152 @@ void GC9A01_write_continue(const uint8_t *data, size_t len) {
     GC9A01_write_data(data, len);
 }
 
+void GC9A01_pixels_begin(void) {
+    if (pixel_engine.active) {
+        GC9A01_pixels_end();
+    }
+
+    pixel_engine.next = 0;
+    pixel_engine.has_split_byte = false;
+    pixel_engine.active = true;
+
+    GC9A01_set_data_command(1);  // Data mode
+    GC9A01_set_chip_select(0);   // CS stays active for the whole stream
+}
+
+bool GC9A01_pixels_push(const uint8_t *data, size_t len) {
+    if (!pixel_engine.active || !data) {
+        return false;
+    }
+
+    while (len > 0) {
+        uint16_t *buffer = pixel_engine.buffers[pixel_engine.next];
+        size_t pixels = 0;
+
+        // Finish a pixel whose first byte arrived in the previous push
+        if (pixel_engine.has_split_byte) {
+            buffer[pixels++] = (uint16_t)(pixel_engine.split_byte << 8) | data[0];
+            pixel_engine.has_split_byte = false;
+            data++;
+            len--;
+        }
+
+        // Big-endian RGB565 bytes to native halfwords; 16-bit frames shift
+        // them out MSB first, so the wire sees the original byte order
+        while (pixels < GC9A01_PIXEL_BUFFER_PIXELS && len >= 2) {
+            buffer[pixels++] = (uint16_t)(data[0] << 8) | data[1];
+            data += 2;
+            len -= 2;
+        }
+
+        if (len == 1 && pixels < GC9A01_PIXEL_BUFFER_PIXELS) {
+            pixel_engine.split_byte = data[0];
+            pixel_engine.has_split_byte = true;
+            len = 0;
+        }
+
+        if (pixels == 0) {
+            continue;
+        }
+
+        // Waits only if the other buffer is still draining
+        if (!deskthang_spi_write_async(buffer, pixels * 2, 16)) {
+            printf("Display Error: Failed to queue %zu pixels (SPI error)\n", pixels);
+            return false;
+        }
+        pixel_engine.next ^= 1;
+    }
+
+    return true;
+}
+
+bool GC9A01_pixels_fill(uint16_t color, uint32_t count) {
+    if (!pixel_engine.active || pixel_engine.has_split_byte) {
+        return false;
+    }
+    if (count == 0) {
+        return true;
+    }
+
+    // A previous fill may still be reading the colour
+    deskthang_spi_wait();
+    pixel_engine.fill_color = color;
+    if (!deskthang_spi_fill_async(&pixel_engine.fill_color, count)) {
+        printf("Display Error: Failed to fill %lu pixels (SPI error)\n", (unsigned long)count);
+        return false;
+    }
+    return true;
+}
+
+bool GC9A01_pixels_send(const uint16_t *pixels, uint32_t count) {
+    if (!pixel_engine.active || pixel_engine.has_split_byte || !pixels) {
+        return false;
+    }
+    if (count == 0) {
+        return true;
+    }
+
+    // Waits only if the previous transfer is still draining
+    if (!deskthang_spi_write_async(pixels, count * 2, 16)) {
+        printf("Display Error: Failed to send %lu pixels (SPI error)\n", (unsigned long)count);
+        return false;
+    }
+    return true;
+}
+
+bool GC9A01_pixels_busy(void) {
+    return deskthang_spi_busy();
+}
+
+void GC9A01_pixels_wait(void) {
+    deskthang_spi_wait();
+}
+
+void GC9A01_pixels_end(void) {
+    if (!pixel_engine.active) {
+        return;
+    }
+
+    deskthang_spi_wait();
+    GC9A01_set_chip_select(1);   // CS inactive
+
+    if (pixel_engine.has_split_byte) {
+        printf("Display Error: Pixel stream ended on half a pixel\n");
+    }
+    pixel_engine.has_split_byte = false;
+    pixel_engine.active = false;
+}
+
 void GC9A01_delay(uint16_t ms) {
     deskthang_delay_ms(ms);
 }
 
 void GC9A01_draw_pixel(uint16_t x, uint16_t y, uint16_t color) {
-    struct GC9A01_frame frame = {
-        .start = {x, y},
-        .end = {x, y}
-    };
-    GC9A01_set_frame(frame);
-    GC9A01_write_command(GC9A01_MEM_WR);
-    GC9A01_write_data((uint8_t*)&color, 2);
+    // A one-pixel rectangle, so the colour goes out big-endian like the rest
+    GC9A01_fill_rect(x, y, 1, 1, color);
 }
 
 void GC9A01_fill_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color) {
+    if (w == 0 || h == 0) {
+        return;
+    }
+
     struct GC9A01_frame frame = {
         .start = {x, y},
         .end = {x + w - 1, y + h - 1}
     };
-    GC9A01_set_frame(frame);
 
-    // Start memory write
-    GC9A01_write_command(GC9A01_MEM_WR);
-    
-    // Calculate total number of pixels
-    uint32_t total_pixels = w * h;
-    
-    // Write first pixel
-    GC9A01_write_data((uint8_t*)&color, 2);
-    
-    // Write remaining pixels using continue command
-    for(uint32_t i = 1; i < total_pixels; i++) {
-        GC9A01_write_continue((uint8_t*)&color, 2);
-    }
+    // One memory write for the whole rectangle, CS held throughout
+    GC9A01_start_write(frame);
+    GC9A01_pixels_begin();
+    GC9A01_pixels_fill(color, (uint32_t)w * h);
+    GC9A01_pixels_end();
 }
 
 uint8_t GC9A01_read_status(void) {
-    return 0;  // Placeholder for compatibility
+    // The panel is wired write-only (no MISO), so there is no status to read
+    // back. Report ready so callers gating on the status don't stall forever.
+    return GC9A01_STATUS_READY;
 }
 
 uint8_t GC9A01_read_display_mode(void) {
@@ -16,9 +16,43 @@ void GC9A01_delay(uint16_t ms);
 void GC9A01_spi_tx(uint8_t *data, size_t len);
 void GC9A01_set_orientation(uint8_t orientation);
 
+// One command and its parameter bytes. delay_ms is only honoured by
+// GC9A01_run_sequence.
+typedef struct {
+    uint8_t cmd;
+    uint8_t len;
+    const uint8_t *params;
+    uint8_t delay_ms;       // Wait after the command
+} GC9A01_command;
+
+// Send a list of commands under one CS assertion, switching D/C only
+// between each command byte and its parameters. False on SPI error.
+bool GC9A01_transaction(const GC9A01_command *commands, size_t count);
+
+// Send a command table as few transactions as its delays allow: each run
+// of commands up to one with a delay goes as one transaction, then the
+// delay. False on SPI error.
+bool GC9A01_run_sequence(const GC9A01_command *commands, size_t count);
+
 // Helper function to write a command
 void GC9A01_write_command(uint8_t cmd);
 
+// A command and its parameters as one transaction
+void GC9A01_write_command_data(uint8_t cmd, const uint8_t *params, uint8_t len);
+
+// Transaction counters. Every transaction is one CS assertion, so
+// commands + data-only writes - transactions is the number of CS toggles
+// the batching saved.
+typedef struct {
+    uint32_t transactions;          // CS assertions for commands or data
+    uint32_t commands;              // Command bytes sent
+    uint32_t param_bytes;           // Parameter/data bytes sent outside the pixel engine
+    uint32_t address_sets_skipped;  // CASET/RASET left out because the window was current
+} GC9A01Stats;
+
+bool GC9A01_get_stats(GC9A01Stats *stats);
+void GC9A01_reset_stats(void);
+
 struct GC9A01_point {
     uint16_t X, Y;
 };
@@ -29,10 +63,41 @@ struct GC9A01_frame {
 
 void GC9A01_init(void);
 void GC9A01_set_frame(struct GC9A01_frame frame);
+
+// Set the window and start a memory write (MEM_WR) in one transaction.
+// CASET/RASET are only sent for the parts of the window that changed.
+void GC9A01_start_write(struct GC9A01_frame frame);
+
+// Forget the cached window, so the next one is sent in full. Needed after
+// anything that resets the controller behind the driver's back.
+void GC9A01_window_invalidate(void);
 void GC9A01_write(const uint8_t *data, size_t len);
 void GC9A01_write_continue(const uint8_t *data, size_t len);
 void GC9A01_write_data(const uint8_t *data, size_t len);
 
+// Asynchronous pixel engine. Between begin and end the panel is held in a
+// memory write (CS low, DC high); each push copies RGB565 bytes into a free
+// ping-pong buffer and hands it to the SPI DMA as 16-bit frames, returning
+// while the transfer drains so the caller can prepare the next chunk.
+#define GC9A01_PIXEL_BUFFER_PIXELS (CHUNK_SIZE / 2)
+
+void GC9A01_pixels_begin(void);
+bool GC9A01_pixels_push(const uint8_t *data, size_t len);
+bool GC9A01_pixels_busy(void);
+void GC9A01_pixels_wait(void);
+void GC9A01_pixels_end(void);
+
+// Stream count pixels of one colour into the open write. The colour goes
+// out as a single fixed-address DMA transfer, so a fill costs the SPI clock
+// and nothing else. False if a pixel is split across the previous push.
+bool GC9A01_pixels_fill(uint16_t color, uint32_t count);
+
+// Stream count native RGB565 pixels straight from the caller's buffer, with
+// no copy. The buffer belongs to DMA until the next send, fill or end, so
+// callers alternate between two. False if a pixel is split across the
+// previous push.
+bool GC9A01_pixels_send(const uint16_t *pixels, uint32_t count);
+
 // Drawing functions
 void GC9A01_draw_pixel(uint16_t x, uint16_t y, uint16_t color);
 void GC9A01_fill_rect(uint16_t x, uint16_t y, uint16_t w, uint16_t h, uint16_t color);
@@ -67,6 +67,10 @@ bool deskthang_gpio_get(uint8_t pin) {
     return gpio_get(pin);
 }
 
+bool deskthang_gpio_is_output(uint8_t pin) {
+    return gpio_is_dir_out(pin);
+}
+
 bool deskthang_gpio_is_initialized(void) {
     return gpio_initialized;
 } 
\ No newline at end of file
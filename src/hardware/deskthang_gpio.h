@@ -12,6 +12,7 @@ void deskthang_gpio_deinit(void);
 // GPIO pin control
 void deskthang_gpio_set(uint8_t pin, bool value);
 bool deskthang_gpio_get(uint8_t pin);
+bool deskthang_gpio_is_output(uint8_t pin);
 
 // GPIO status check
 bool deskthang_gpio_is_initialized(void);
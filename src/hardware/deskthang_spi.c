@@ -1,8 +1,14 @@
 #include "deskthang_spi.h"
+#include "pico/stdlib.h"
 #include "hardware/spi.h"  // Pico SDK SPI
 #include "hardware/gpio.h" // Pico SDK GPIO
+#include "hardware/dma.h"  // Pico SDK DMA
+#include "hardware/irq.h"
 #include "deskthang_gpio.h"
 #include "../error/logging.h"
+#include "../system/platform.h"
+#include "../system/scheduler.h"
+#include "../debug/trace.h"
 #include <stdio.h>
 
 // Static configuration
@@ -13,12 +19,33 @@ static struct {
     uint8_t sck_pin;
     uint8_t mosi_pin;
     uint8_t miso_pin;
+    int dma_channel;     // -1 when no channel could be claimed
+    unsigned irq_core;   // Core whose NVIC takes the DMA completion IRQ
+    uint8_t frame_bits;  // Current SPI data size (8 or 16)
     bool initialized;
 } spi_state = {0};
 
 // Add at the top with other static variables
 static bool spi_initialized = false;
 
+static void spi_set_frame_bits(uint8_t bits) {
+    if (spi_state.frame_bits == bits) {
+        return;
+    }
+
+    spi_set_format(spi_state.spi, bits, 0, 0, SPI_MSB_FIRST);
+    spi_state.frame_bits = bits;
+}
+
+// A panel transfer finished. The interrupt itself ends a WFE in
+// deskthang_spi_wait; the event wakes tasks waiting on the panel.
+static void spi_dma_irq(void) {
+    if (spi_state.dma_channel >= 0 && dma_channel_get_irq0_status(spi_state.dma_channel)) {
+        dma_channel_acknowledge_irq0(spi_state.dma_channel);
+        scheduler_signal(SCHED_EVENT_SPI_DONE);
+    }
+}
+
 bool deskthang_spi_init(const DeskthangSPIConfig *config) {
     if (!config) {
         return false;
@@ -51,6 +78,18 @@ bool deskthang_spi_init(const DeskthangSPIConfig *config) {
                    0,       // CPOL = 0
                    0,       // CPHA = 0
                    SPI_MSB_FIRST);
+    spi_state.frame_bits = 8;
+
+    // Claim a DMA channel for asynchronous writes (falls back to blocking)
+    spi_state.dma_channel = dma_claim_unused_channel(false);
+    if (spi_state.dma_channel < 0) {
+        logging_write("SPI", "No DMA channel available, async writes will block");
+    } else {
+        spi_state.irq_core = platform_core_index();
+        irq_add_shared_handler(DMA_IRQ_0, spi_dma_irq, PICO_SHARED_IRQ_HANDLER_DEFAULT_ORDER_PRIORITY);
+        dma_channel_set_irq0_enabled(spi_state.dma_channel, true);
+        irq_set_enabled(DMA_IRQ_0, true);
+    }
 
     // Add a small delay after initialization
     sleep_ms(1);
@@ -65,6 +104,14 @@ void deskthang_spi_deinit(void) {
         return;
     }
 
+    deskthang_spi_wait();
+    if (spi_state.dma_channel >= 0) {
+        dma_channel_set_irq0_enabled(spi_state.dma_channel, false);
+        irq_remove_handler(DMA_IRQ_0, spi_dma_irq);
+        dma_channel_unclaim(spi_state.dma_channel);
+        spi_state.dma_channel = -1;
+    }
+
     spi_deinit(spi_state.spi);
     gpio_set_function(spi_state.sck_pin, GPIO_FUNC_NULL);
     gpio_set_function(spi_state.mosi_pin, GPIO_FUNC_NULL);
@@ -85,6 +132,10 @@ bool deskthang_spi_write(const uint8_t *data, size_t len) {
         return false;
     }
 
+    // Let any DMA transfer drain before switching back to byte frames
+    deskthang_spi_wait();
+    spi_set_frame_bits(8);
+
     // Check if SPI is properly configured
     if (!spi_is_writable(spi_state.spi)) {
         logging_write("SPI", "Write failed: SPI not writable");
@@ -141,6 +192,132 @@ void deskthang_spi_chip_select(bool select) {
     gpio_put(spi_state.cs_pin, !select); // CS is active low
 }
 
+bool deskthang_spi_write_async(const void *data, size_t len, uint8_t frame_bits) {
+    if (!spi_state.initialized) {
+        logging_write("SPI", "Async write failed: SPI not initialized");
+        return false;
+    }
+
+    if (!data || (frame_bits != 8 && frame_bits != 16) ||
+        (frame_bits == 16 && (len & 1))) {
+        logging_write("SPI", "Async write failed: invalid parameters");
+        return false;
+    }
+
+    // Single channel: the previous transfer must finish first
+    deskthang_spi_wait();
+    spi_set_frame_bits(frame_bits);
+
+    if (spi_state.dma_channel < 0) {
+        if (frame_bits == 16) {
+            spi_write16_blocking(spi_state.spi, (const uint16_t *)data, len / 2);
+        } else {
+            spi_write_blocking(spi_state.spi, (const uint8_t *)data, len);
+        }
+        return true;
+    }
+
+    dma_channel_config config = dma_channel_get_default_config(spi_state.dma_channel);
+    channel_config_set_transfer_data_size(&config, frame_bits == 16 ? DMA_SIZE_16 : DMA_SIZE_8);
+    channel_config_set_dreq(&config, spi_get_dreq(spi_state.spi, true));
+    channel_config_set_read_increment(&config, true);
+    channel_config_set_write_increment(&config, false);
+
+    dma_channel_configure(spi_state.dma_channel, &config,
+                          &spi_get_hw(spi_state.spi)->dr,
+                          data,
+                          frame_bits == 16 ? len / 2 : len,
+                          true);
+    TRACE_INSTANT(SPI_DMA, len);
+    return true;
+}
+
+bool deskthang_spi_fill_async(const uint16_t *value, uint32_t count) {
+    if (!spi_state.initialized) {
+        logging_write("SPI", "Async fill failed: SPI not initialized");
+        return false;
+    }
+
+    if (!value || count == 0) {
+        logging_write("SPI", "Async fill failed: invalid parameters");
+        return false;
+    }
+
+    deskthang_spi_wait();
+    spi_set_frame_bits(16);
+
+    // Without DMA, repeat a prefilled line instead
+    if (spi_state.dma_channel < 0) {
+        uint16_t line[64];
+        for (size_t i = 0; i < sizeof(line) / sizeof(line[0]); i++) {
+            line[i] = *value;
+        }
+        while (count > 0) {
+            uint32_t frames = count < 64 ? count : 64;
+            spi_write16_blocking(spi_state.spi, line, frames);
+            count -= frames;
+        }
+        return true;
+    }
+
+    dma_channel_config config = dma_channel_get_default_config(spi_state.dma_channel);
+    channel_config_set_transfer_data_size(&config, DMA_SIZE_16);
+    channel_config_set_dreq(&config, spi_get_dreq(spi_state.spi, true));
+    channel_config_set_read_increment(&config, false);  // Same pixel every frame
+    channel_config_set_write_increment(&config, false);
+
+    dma_channel_configure(spi_state.dma_channel, &config,
+                          &spi_get_hw(spi_state.spi)->dr,
+                          value,
+                          count,
+                          true);
+    TRACE_INSTANT(SPI_DMA, count * 2);
+    return true;
+}
+
+bool deskthang_spi_busy(void) {
+    if (!spi_state.initialized) {
+        return false;
+    }
+
+    if (spi_state.dma_channel >= 0 && dma_channel_is_busy(spi_state.dma_channel)) {
+        return true;
+    }
+    return spi_is_busy(spi_state.spi);
+}
+
+void deskthang_spi_wait(void) {
+    if (!spi_state.initialized) {
+        return;
+    }
+
+    if (spi_state.dma_channel >= 0 && dma_channel_is_busy(spi_state.dma_channel)) {
+        // Traced only when there is something to wait for: the time the
+        // caller lost to the panel
+        TRACE_BEGIN(SPI_WAIT, 0);
+        // Sleep until the completion IRQ rather than spin. Only the core
+        // that takes the IRQ can; the other has nothing to wake it.
+        if (platform_core_index() == spi_state.irq_core) {
+            while (dma_channel_is_busy(spi_state.dma_channel)) {
+                platform_idle(UINT32_MAX);
+            }
+        }
+        dma_channel_wait_for_finish_blocking(spi_state.dma_channel);
+        TRACE_END(SPI_WAIT, 0);
+    }
+
+    // DMA done only means the FIFO is loaded; wait for the last frame to shift out
+    while (spi_is_busy(spi_state.spi)) {
+        tight_loop_contents();
+    }
+
+    // TX-only DMA leaves the RX FIFO full and overrun set; drain it
+    while (spi_is_readable(spi_state.spi)) {
+        (void)spi_get_hw(spi_state.spi)->dr;
+    }
+    spi_get_hw(spi_state.spi)->icr = SPI_SSPICR_RORIC_BITS;
+}
+
 // Add initialization check function
 bool deskthang_spi_is_initialized(void) {
     return spi_initialized;
@@ -4,8 +4,6 @@
 #include <stdint.h>
 #include <stdbool.h>
 #include <stddef.h>
-#include "pico/stdlib.h"
-#include "hardware/spi.h"  // This provides spi_inst_t and SPI functions
 #include "deskthang_gpio.h"  // Update if it's using gpio.h
 
 // SPI Configuration structure
@@ -26,6 +24,19 @@ bool deskthang_spi_read(uint8_t *data, size_t len);
 bool deskthang_spi_transfer(const uint8_t *tx_data, uint8_t *rx_data, size_t len);
 void deskthang_spi_chip_select(bool select);
 
+// Asynchronous (DMA) writes. Only one transfer is in flight at a time;
+// starting a new one waits for the previous to drain. The buffer must stay
+// untouched until deskthang_spi_busy() reports false. frame_bits is 8 or 16;
+// 16-bit frames send each uint16_t MSB first, len is always in bytes.
+bool deskthang_spi_write_async(const void *data, size_t len, uint8_t frame_bits);
+
+// Asynchronous fill: send *value count times as 16-bit frames. DMA reads
+// the same address for the whole transfer, so value must stay put until
+// deskthang_spi_busy() reports false.
+bool deskthang_spi_fill_async(const uint16_t *value, uint32_t count);
+bool deskthang_spi_busy(void);
+void deskthang_spi_wait(void);
+
 // SPI status check
 bool deskthang_spi_is_initialized(void);
 
@@ -1,9 +1,12 @@
 #include <stdio.h>
 #include "../system/time.h"
+#include "../system/boot.h"
 #include "display.h"
 #include "deskthang_gpio.h"
 #include "deskthang_spi.h"
 #include "GC9A01.h"
+#include "panel_span.h"
+#include "scanline.h"
 #include <string.h>
 
 // Static configuration
@@ -21,6 +24,12 @@ static uint8_t display_status = 0;
 static uint16_t display_buffer[DISPLAY_WIDTH * DISPLAY_HEIGHT];
 static size_t buffer_used = 0;
 
+// Round write progress: bands of rows sharing a span are opened in turn
+static struct {
+    uint16_t next_row;         // First row of the next band
+    uint32_t band_remaining;   // Bytes left in the open band's window
+} round_write = {0};
+
 // GC9A01 HAL function implementations
 void GC9A01_set_reset(uint8_t val) {
     if (hw_config) {
@@ -70,12 +79,15 @@ bool display_init(const HardwareConfig *hw_config_in, const DisplayConfig *disp_
         return false;
     }
 
+    boot_mark(BOOT_PHASE_PANEL);
+
     // Clear display to black
     if (!display_clear()) {
         printf("Display Error: Failed to clear display\n");
         return false;
     }
 
+#if DESKTHANG_BOOT_SELF_TEST
     // Draw test pattern
     printf("Display: Drawing test pattern\n");
     if (!display_draw_test_pattern(TEST_PATTERN_COLOR_BARS, 0)) {
@@ -97,7 +109,9 @@ bool display_init(const HardwareConfig *hw_config_in, const DisplayConfig *disp_
         return false;
     }
     deskthang_delay_ms(2000);  // 2 second delay
+#endif
 
+    boot_mark(BOOT_PHASE_DISPLAY);
     buffer_used = 0;
     display_state.initialized = true;
     return true;
@@ -117,9 +131,8 @@ bool display_set_orientation(DisplayOrientation orientation) {
     display_state.config.orientation = orientation;
 
     // Send orientation command to display
-    GC9A01_write_command(0x36); // MADCTL
     uint8_t madctl = orientation;
-    GC9A01_write_data(&madctl, 1);
+    GC9A01_write_command_data(0x36, &madctl, 1); // MADCTL
 
     return true;
 }
@@ -129,8 +142,7 @@ bool display_set_brightness(uint8_t brightness) {
     display_state.config.brightness = brightness;
 
     // Send brightness command to display
-    GC9A01_write_command(0x51); // Write brightness
-    GC9A01_write_data(&brightness, 1);
+    GC9A01_write_command_data(0x51, &brightness, 1); // Write brightness
 
     return true;
 }
@@ -155,33 +167,36 @@ bool display_write_pixels(uint16_t x, uint16_t y, uint16_t width, uint16_t heigh
         .start = {x, y},
         .end = {x + width - 1, y + height - 1}
     };
-    GC9A01_set_frame(frame);
+    GC9A01_start_write(frame);
 
     // Write pixel data
-    deskthang_spi_write(data, width * height * 2); // 2 bytes per pixel (RGB565)
+    GC9A01_write(data, width * height * 2); // 2 bytes per pixel (RGB565)
 
     return true;
 }
 
 bool display_fill_region(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t color) {
-    // Set up write window
-    struct GC9A01_frame frame = {
-        .start = {x, y},
-        .end = {x + width - 1, y + height - 1}
-    };
-    GC9A01_set_frame(frame);
-
-    // Fill with color
-    uint8_t color_bytes[2] = {color >> 8, color & 0xFF};
-    for (uint32_t i = 0; i < width * height; i++) {
-        GC9A01_write(color_bytes, 2);
+    // Open the window once and let the pixel engine repeat the colour
+    if (!display_begin_write(x, y, width, height)) {
+        return false;
     }
+    bool filled = GC9A01_pixels_fill(color, (uint32_t)width * height);
+    return display_end_write() && filled;
+}
 
+bool display_fill_round(uint16_t color) {
+    // One window per band of rows with the same span; the corners are skipped
+    for (uint16_t y = 0; y < DISPLAY_HEIGHT; y += panel_span_band_height(y)) {
+        if (!display_fill_region(panel_span_start(y), y, panel_span_width(y),
+                                 panel_span_band_height(y), color)) {
+            return false;
+        }
+    }
     return true;
 }
 
 bool display_clear(void) {
-    return display_fill_region(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, 0x0000); // Black
+    return display_fill_round(0x0000); // Black
 }
 
 const DisplayConfig* display_get_config(void) {
@@ -238,44 +253,53 @@ bool display_draw_test_pattern(TestPattern pattern, uint16_t color) {
     }
 }
 
-bool display_draw_color_bars(void) {
+// Scanline generators for the test patterns
+
+static const uint16_t color_bar_colors[] = {
+    COLOR_RED,
+    COLOR_GREEN,
+    COLOR_BLUE,
+    COLOR_YELLOW,
+    COLOR_MAGENTA,
+    COLOR_CYAN,
+    COLOR_WHITE,
+    COLOR_BLACK
+};
+
+#define COLOR_BAR_COUNT (sizeof(color_bar_colors) / sizeof(color_bar_colors[0]))
+#define COLOR_BAR_WIDTH (DISPLAY_WIDTH / COLOR_BAR_COUNT)
+
+static void color_bars_row(uint16_t y, uint16_t x, uint16_t width, uint16_t *line, void *context) {
+    for (uint16_t i = 0; i < width; i++) {
+        line[i] = color_bar_colors[(x + i) / COLOR_BAR_WIDTH];
+    }
+}
 
-    const uint16_t colors[] = {
-        COLOR_RED,
-        COLOR_GREEN,
-        COLOR_BLUE,
-        COLOR_YELLOW,
-        COLOR_MAGENTA,
-        COLOR_CYAN,
-        COLOR_WHITE,
-        COLOR_BLACK
-    };
-    const uint8_t num_bars = sizeof(colors) / sizeof(colors[0]);
-    const uint16_t bar_width = DISPLAY_WIDTH / num_bars;
+static void gradient_row(uint16_t y, uint16_t x, uint16_t width, uint16_t *line, void *context) {
+    // Green only depends on the row
+    uint8_t g = (y * 255) / DISPLAY_HEIGHT;
+    for (uint16_t i = 0; i < width; i++) {
+        uint16_t px = x + i;
+        uint8_t r = (px * 255) / DISPLAY_WIDTH;
+        uint8_t b = ((px + y) * 255) / (DISPLAY_WIDTH + DISPLAY_HEIGHT);
+        line[i] = RGB565(r, g, b);
+    }
+}
 
-    for (uint8_t i = 0; i < num_bars; i++) {
-        uint16_t x = i * bar_width;
-        GC9A01_fill_rect(x, 0, bar_width, DISPLAY_HEIGHT, colors[i]);
+static void checkerboard_row(uint16_t y, uint16_t x, uint16_t width, uint16_t *line, void *context) {
+    uint8_t square_size = *(const uint8_t *)context;
+    uint16_t row_parity = y / square_size;
+    for (uint16_t i = 0; i < width; i++) {
+        line[i] = ((x + i) / square_size + row_parity) % 2 ? COLOR_BLACK : COLOR_WHITE;
     }
+}
 
-    return true;
+bool display_draw_color_bars(void) {
+    return scanline_render(color_bars_row, NULL);
 }
 
 bool display_draw_gradient(void) {
-
-    for (uint16_t y = 0; y < DISPLAY_HEIGHT; y++) {
-        for (uint16_t x = 0; x < DISPLAY_WIDTH; x++) {
-            // Calculate RGB components based on position
-            uint8_t r = (x * 255) / DISPLAY_WIDTH;
-            uint8_t g = (y * 255) / DISPLAY_HEIGHT;
-            uint8_t b = ((x + y) * 255) / (DISPLAY_WIDTH + DISPLAY_HEIGHT);
-            
-            uint16_t color = RGB565(r, g, b);
-            GC9A01_draw_pixel(x, y, color);
-        }
-    }
-
-    return true;
+    return scanline_render(gradient_row, NULL);
 }
 
 bool display_draw_checkerboard(uint8_t square_size) {
@@ -283,22 +307,12 @@ bool display_draw_checkerboard(uint8_t square_size) {
         return false;
     }
 
-    for (uint16_t y = 0; y < DISPLAY_HEIGHT; y += square_size) {
-        for (uint16_t x = 0; x < DISPLAY_WIDTH; x += square_size) {
-            uint16_t color = ((x / square_size + y / square_size) % 2) ? COLOR_BLACK : COLOR_WHITE;
-            uint16_t width = (x + square_size > DISPLAY_WIDTH) ? DISPLAY_WIDTH - x : square_size;
-            uint16_t height = (y + square_size > DISPLAY_HEIGHT) ? DISPLAY_HEIGHT - y : square_size;
-            GC9A01_fill_rect(x, y, width, height, color);
-        }
-    }
-
-    return true;
+    return scanline_render(checkerboard_row, &square_size);
 }
 
 bool display_fill_solid(uint16_t color) {
-
-    GC9A01_fill_rect(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, color);
-    return true;
+    // Nothing to generate: the fill engine repeats one pixel with no CPU work
+    return display_fill_round(color);
 }
 
 // Display status checks
@@ -328,12 +342,30 @@ bool display_ready(void) {
 }
 
 // Display write functions
+bool display_begin_write(uint16_t x, uint16_t y, uint16_t width, uint16_t height) {
+    if (width == 0 || height == 0 ||
+        x + width > DISPLAY_WIDTH || y + height > DISPLAY_HEIGHT) {
+        return false;
+    }
+
+    struct GC9A01_frame frame = {
+        .start = {x, y},
+        .end = {x + width - 1, y + height - 1}
+    };
+    GC9A01_start_write(frame);
+    GC9A01_pixels_begin();
+    return true;
+}
+
 bool display_write_data(const uint8_t *data, uint32_t len) {
     if (!data || len == 0) {
         return false;
     }
 
-    GC9A01_write_data(data, len);
+    // Queued on the pixel engine; returns while the chunk drains over DMA
+    if (!GC9A01_pixels_push(data, len)) {
+        return false;
+    }
     
     // Check status after write
     uint8_t status = GC9A01_read_status();
@@ -341,14 +373,60 @@ bool display_write_data(const uint8_t *data, uint32_t len) {
 }
 
 bool display_end_write(void) {
-    // Wait for display to be ready
-    uint16_t timeout = 1000; // 1 second timeout
-    while (timeout-- > 0) {
-        uint8_t status = GC9A01_read_status();
-        if (status & GC9A01_STATUS_READY) {
-            return true;
+    // Returns once the last chunk has left the SPI, sleeping on its DMA
+    // completion rather than polling
+    GC9A01_pixels_end();
+
+    // The panel is write-only, so there is no busy flag to wait out
+    return (GC9A01_read_status() & GC9A01_STATUS_READY) != 0;
+}
+
+// Open the window for the next band of rows that share a span
+static bool display_round_open_band(void) {
+    uint16_t y = round_write.next_row;
+    if (y >= DISPLAY_HEIGHT) {
+        return false;
+    }
+
+    uint16_t rows = panel_span_band_height(y);
+    if (!display_begin_write(panel_span_start(y), y, panel_span_width(y), rows)) {
+        return false;
+    }
+    round_write.band_remaining = (uint32_t)panel_span_width(y) * rows * 2;
+    round_write.next_row += rows;
+    return true;
+}
+
+bool display_begin_round_write(void) {
+    round_write.next_row = 0;
+    round_write.band_remaining = 0;
+    return display_round_open_band();
+}
+
+bool display_write_round_data(const uint8_t *data, uint32_t len) {
+    if (!data || len == 0) {
+        return false;
+    }
+
+    while (len > 0) {
+        if (round_write.band_remaining == 0 && !display_round_open_band()) {
+            return false;
+        }
+
+        uint32_t take = len < round_write.band_remaining ? len : round_write.band_remaining;
+        if (!display_write_data(data, take)) {
+            return false;
         }
-        deskthang_delay_ms(1);
+        round_write.band_remaining -= take;
+        data += take;
+        len -= take;
     }
-    return false;
+    return true;
+}
+
+bool display_end_round_write(void) {
+    bool complete = round_write.next_row == DISPLAY_HEIGHT && round_write.band_remaining == 0;
+    round_write.next_row = 0;
+    round_write.band_remaining = 0;
+    return display_end_write() && complete;
 }
@@ -92,7 +92,15 @@ bool display_write_pixels(uint16_t x, uint16_t y, uint16_t width, uint16_t heigh
 bool display_fill_region(uint16_t x, uint16_t y, uint16_t width, uint16_t height, uint16_t color);
 
 /**
- * Clear display (fill with black)
+ * Fill the visible area of the round panel (see panel_span.h) with a solid
+ * color, one window per band of rows with the same span
+ * @param color Color in RGB565 format
+ * @return true if fill successful, false otherwise
+ */
+bool display_fill_round(uint16_t color);
+
+/**
+ * Clear display (fill the visible area with black)
  * @return true if clear successful, false otherwise
  */
 bool display_clear(void);
@@ -173,9 +181,32 @@ void display_set_pixel(uint16_t x, uint16_t y, uint16_t color);
 bool display_ready(void);
 
 // Display write functions
+
+/**
+ * Open a write window and start a memory write (CASET/RASET + MEM_WR)
+ * Subsequent display_write_data calls queue pixels on the DMA pixel engine;
+ * display_end_write waits for the last chunk to drain
+ * @param x X coordinate of window origin
+ * @param y Y coordinate of window origin
+ * @param width Window width in pixels
+ * @param height Window height in pixels
+ * @return true if window opened, false if it falls outside the panel
+ */
+bool display_begin_write(uint16_t x, uint16_t y, uint16_t width, uint16_t height);
 bool display_write_data(const uint8_t *data, uint32_t len);
 bool display_end_write(void);
 
+/**
+ * Start a round write: a full frame of only the visible pixels, row by row
+ * (PANEL_SPAN_SIZE bytes). Each band of rows sharing a span gets its own
+ * window as the data reaches it; display_end_round_write fails if the frame
+ * stopped short.
+ * @return true if the first band's window opened
+ */
+bool display_begin_round_write(void);
+bool display_write_round_data(const uint8_t *data, uint32_t len);
+bool display_end_round_write(void);
+
 #ifdef __cplusplus
 }
 #endif
@@ -0,0 +1,40 @@
+#include "panel_span.h"
+
+// Half the visible width of rows 0 to 119; the bottom half mirrors the top.
+// Entry y is the number of odd d > 0 with d^2 + (239 - 2y)^2 <= 240^2.
+static const uint8_t g_half_width[DISPLAY_HEIGHT / 2] = {
+     11,  19,  24,  29,  33,  36,  39,  42,  44,  47,  49,  51,
+     53,  55,  57,  59,  61,  62,  64,  66,  67,  69,  70,  71,
+     73,  74,  75,  76,  78,  79,  80,  81,  82,  83,  84,  85,
+     86,  87,  88,  89,  90,  91,  92,  92,  93,  94,  95,  96,
+     96,  97,  98,  99,  99, 100, 101, 101, 102, 102, 103, 104,
+    104, 105, 105, 106, 106, 107, 107, 108, 108, 109, 109, 110,
+    110, 111, 111, 111, 112, 112, 113, 113, 113, 114, 114, 114,
+    115, 115, 115, 116, 116, 116, 116, 117, 117, 117, 117, 117,
+    118, 118, 118, 118, 118, 119, 119, 119, 119, 119, 119, 119,
+    119, 120, 120, 120, 120, 120, 120, 120, 120, 120, 120, 120,
+};
+
+static uint8_t panel_span_half_width(uint16_t y) {
+    if (y >= DISPLAY_HEIGHT) {
+        return 0;
+    }
+    return g_half_width[y < DISPLAY_HEIGHT / 2 ? y : DISPLAY_HEIGHT - 1 - y];
+}
+
+uint16_t panel_span_start(uint16_t y) {
+    return DISPLAY_WIDTH / 2 - panel_span_half_width(y);
+}
+
+uint16_t panel_span_width(uint16_t y) {
+    return 2 * panel_span_half_width(y);
+}
+
+uint16_t panel_span_band_height(uint16_t y) {
+    uint8_t half_width = panel_span_half_width(y);
+    uint16_t rows = 0;
+    while (y + rows < DISPLAY_HEIGHT && panel_span_half_width(y + rows) == half_width) {
+        rows++;
+    }
+    return rows;
+}
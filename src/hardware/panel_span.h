@@ -0,0 +1,26 @@
+#ifndef DESKTHANG_PANEL_SPAN_H
+#define DESKTHANG_PANEL_SPAN_H
+
+#include <stdint.h>
+#include "../common/deskthang_constants.h"
+
+// Visible area of the round GC9A01 panel. Row y shows the pixels from
+// panel_span_start(y) for panel_span_width(y), the ones whose centre lies
+// inside the 240-pixel circle:
+//   (2x - 239)^2 + (2y - 239)^2 <= 240^2
+// The corners outside it are never seen, so full-screen writes can skip
+// them: 45244 of the 57600 pixels are visible.
+#define PANEL_SPAN_PIXELS   45244
+#define PANEL_SPAN_SIZE     (PANEL_SPAN_PIXELS * 2)  // RGB565 bytes
+
+#if DISPLAY_WIDTH != 240 || DISPLAY_HEIGHT != 240
+#error "Panel span table is for a 240x240 round panel"
+#endif
+
+uint16_t panel_span_start(uint16_t y);
+uint16_t panel_span_width(uint16_t y);
+
+// Rows from y on with the same span as row y, which can share one window
+uint16_t panel_span_band_height(uint16_t y);
+
+#endif // DESKTHANG_PANEL_SPAN_H
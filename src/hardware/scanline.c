@@ -0,0 +1,42 @@
+#include "scanline.h"
+#include "display.h"
+#include "panel_span.h"
+#include "GC9A01.h"
+
+// Ping-pong line buffers: DMA reads one while the generator writes the other
+static uint16_t scanline_buffers[2][DISPLAY_WIDTH];
+
+bool scanline_render(ScanlineGenerator generate, void *context) {
+    if (!generate) {
+        return false;
+    }
+
+    uint8_t next = 0;
+    for (uint16_t y = 0; y < DISPLAY_HEIGHT; y += panel_span_band_height(y)) {
+        uint16_t x = panel_span_start(y);
+        uint16_t width = panel_span_width(y);
+        uint16_t rows = panel_span_band_height(y);
+
+        if (!display_begin_write(x, y, width, rows)) {
+            return false;
+        }
+
+        for (uint16_t row = y; row < y + rows; row++) {
+            // The send before last used this buffer, and the last send
+            // waited for it to drain
+            uint16_t *line = scanline_buffers[next];
+            generate(row, x, width, line, context);
+            if (!GC9A01_pixels_send(line, width)) {
+                display_end_write();
+                return false;
+            }
+            next ^= 1;
+        }
+
+        if (!display_end_write()) {
+            return false;
+        }
+    }
+
+    return true;
+}
@@ -0,0 +1,22 @@
+#ifndef DESKTHANG_SCANLINE_H
+#define DESKTHANG_SCANLINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../common/deskthang_constants.h"
+
+// Scanline renderer for procedural content. A generator fills one row at a
+// time into one of two line buffers while the other drains over DMA, so a
+// pattern costs one line of RAM and runs at the SPI rate as long as a row
+// generates faster than it sends (about 0.4 ms at 10 MHz). Only the visible
+// span of each row is generated and sent, one window per band (see
+// panel_span.h).
+
+// Fill line[0 .. width - 1] with row y from column x on, as native RGB565
+typedef void (*ScanlineGenerator)(uint16_t y, uint16_t x, uint16_t width,
+                                  uint16_t *line, void *context);
+
+// Render a full frame. False if a window or transfer failed.
+bool scanline_render(ScanlineGenerator generate, void *context);
+
+#endif // DESKTHANG_SCANLINE_H
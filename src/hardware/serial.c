@@ -1,208 +1,247 @@
 #include "../system/time.h"
+#include "../system/scheduler.h"
 #include "serial.h"
+#include "serial_ring.h"
 #include "pico/stdlib.h"
-#include "pico/stdio.h"
-#include <stdio.h>      // For fwrite, fflush, stdout
-#include "pico/binary_info/code.h"  // For string operations
+#include "pico/stdio_usb.h"
+#include "hardware/sync.h"
+#include "tusb.h"
 #include "../error/logging.h"
-#include <string.h>     // For strncpy
+#include <stdio.h>      // For snprintf
+#include <string.h>
 #include "../debug/debug.h"
 
+#if (SERIAL_RX_RING_SIZE & (SERIAL_RX_RING_SIZE - 1)) || (SERIAL_TX_RING_SIZE & (SERIAL_TX_RING_SIZE - 1))
+#error "Serial ring sizes must be powers of two"
+#endif
+
+// Ring storage; the rings themselves only hold pointers and counters
+static uint8_t g_rx_storage[SERIAL_RX_RING_SIZE];
+static uint8_t g_tx_storage[SERIAL_TX_RING_SIZE];
+static SerialRing g_rx_ring;
+static SerialRing g_tx_ring;
+
+// Wake the scheduler for a flush deadline, and to poll for RX when the SDK
+// can't call us back
+static SchedTimer g_flush_timer;
+#if !PICO_STDIO_USB_SUPPORT_CHARS_AVAILABLE_CALLBACK
+static SchedTimer g_rx_poll_timer;
+#endif
+
 // Static configuration
 static struct {
     bool initialized;
-    uint32_t timeout_ms;
-    uint32_t overflow_count;
-    uint32_t last_overflow_time;
-    bool in_overflow;
+    bool flush_pending;        // Bytes are waiting for a short-packet flush
+    uint32_t flush_deadline;   // time_us_32 when the pending flush is due
+    SerialStats stats;
 } serial_state = {
     .initialized = false,
-    .timeout_ms = BASE_TIMEOUT_MS,
-    .overflow_count = 0,
-    .last_overflow_time = 0,
-    .in_overflow = false
+    .flush_pending = false,
+    .flush_deadline = 0
 };
 
+// RX producer. Runs in the USB IRQ (chars-available callback) and from the
+// main loop; interrupts are masked so the two never interleave and TinyUSB
+// isn't re-entered while the SDK's background task is servicing it. New
+// bytes wake the scheduler's receive task.
+static void serial_rx_fill(void) {
+    uint32_t irq_state = save_and_disable_interrupts();
+    uint32_t before = serial_state.stats.rx_bytes;
+
+    while (tud_cdc_available() > 0) {
+        size_t span;
+        uint8_t *dst = serial_ring_write_span(&g_rx_ring, &span);
+        if (span == 0) {
+            break;  // Ring full; the rest waits in the TinyUSB FIFO
+        }
+        uint32_t count = tud_cdc_read(dst, span);
+        if (count == 0) {
+            break;
+        }
+        serial_ring_commit(&g_rx_ring, count);
+        serial_state.stats.rx_bytes += count;
+    }
+
+    size_t used = serial_ring_count(&g_rx_ring);
+    if (used > serial_state.stats.rx_high_water) {
+        serial_state.stats.rx_high_water = used;
+    }
+
+    restore_interrupts(irq_state);
+
+    if (serial_state.stats.rx_bytes != before) {
+        scheduler_signal(SCHED_EVENT_USB_RX);
+    }
+}
+
+#if PICO_STDIO_USB_SUPPORT_CHARS_AVAILABLE_CALLBACK
+static void serial_rx_callback(void *param) {
+    (void)param;
+    serial_rx_fill();
+}
+#else
+static void serial_rx_poll(void *context) {
+    (void)context;
+    serial_rx_fill();
+}
+#endif
+
+static void serial_flush_due(void *context) {
+    (void)context;
+    serial_service();
+}
+
+// Core0 only: the timer wheel isn't safe from the USB IRQ
+static void serial_arm_flush(void) {
+    if (serial_state.flush_pending) {
+        uint32_t delay = serial_state.flush_deadline - time_us_32();
+        scheduler_timer_start(&g_flush_timer, (int32_t)delay > 0 ? delay : 0, 0,
+                              serial_flush_due, NULL);
+    }
+}
+
+// TX consumer: move as much of the ring as TinyUSB will take. Full packets
+// go out on their own; a short tail stays in the TinyUSB FIFO until flushed.
+static void serial_tx_pump(bool flush) {
+    uint32_t irq_state = save_and_disable_interrupts();
+
+    if (!tud_cdc_connected()) {
+        // Nobody is listening; discard like stdio does instead of filling up
+        serial_state.stats.tx_dropped += serial_ring_count(&g_tx_ring);
+        serial_ring_clear(&g_tx_ring);
+        serial_state.flush_pending = false;
+        restore_interrupts(irq_state);
+        return;
+    }
+
+    while (tud_cdc_write_available() > 0) {
+        size_t span;
+        const uint8_t *src = serial_ring_read_span(&g_tx_ring, &span);
+        if (span == 0) {
+            break;
+        }
+        uint32_t count = tud_cdc_write(src, span);
+        if (count == 0) {
+            break;
+        }
+        serial_ring_consume(&g_tx_ring, count);
+    }
+
+    if (flush) {
+        tud_cdc_write_flush();
+        serial_state.stats.flushes++;
+        serial_state.flush_pending = serial_ring_count(&g_tx_ring) > 0;
+        if (serial_state.flush_pending) {
+            serial_state.flush_deadline = time_us_32() + SERIAL_FLUSH_DEADLINE_US;
+        }
+    }
+
+    restore_interrupts(irq_state);
+}
+
+// TinyUSB finished a transfer: refill its FIFO from the ring (USB IRQ)
+void tud_cdc_tx_complete_cb(uint8_t itf) {
+    (void)itf;
+    if (serial_state.initialized) {
+        serial_tx_pump(false);
+    }
+}
+
 bool serial_init(void) {
     if (serial_state.initialized) {
         return true;
     }
 
-    // Initialize USB stdio
+    // USB stdio still owns device setup and runs tud_task in the background;
+    // data bypasses stdio and goes through the rings
     stdio_init_all();
-    serial_state.timeout_ms = BASE_TIMEOUT_MS;
+    serial_ring_init(&g_rx_ring, g_rx_storage, sizeof(g_rx_storage));
+    serial_ring_init(&g_tx_ring, g_tx_storage, sizeof(g_tx_storage));
+    memset(&serial_state.stats, 0, sizeof(serial_state.stats));
+    serial_state.flush_pending = false;
     serial_state.initialized = true;
 
+#if PICO_STDIO_USB_SUPPORT_CHARS_AVAILABLE_CALLBACK
+    stdio_set_chars_available_callback(serial_rx_callback, NULL);
+#else
+    scheduler_timer_start(&g_rx_poll_timer, SERIAL_RX_POLL_US, SERIAL_RX_POLL_US, serial_rx_poll, NULL);
+#endif
+
     return true;
 }
 
 void serial_deinit(void) {
+#if PICO_STDIO_USB_SUPPORT_CHARS_AVAILABLE_CALLBACK
+    stdio_set_chars_available_callback(NULL, NULL);
+#else
+    scheduler_timer_cancel(&g_rx_poll_timer);
+#endif
+    scheduler_timer_cancel(&g_flush_timer);
     serial_state.initialized = false;
 }
 
 bool serial_write(const uint8_t *data, size_t len) {
-    if (!serial_state.initialized) {
+    if (!serial_state.initialized || (data == NULL && len > 0)) {
         return false;
     }
 
-    // Check for potential overflow
-    if (len > CHUNK_SIZE && !serial_state.in_overflow) {
-        serial_state.in_overflow = true;
-        serial_state.overflow_count++;
-        serial_state.last_overflow_time = deskthang_time_get_ms();
-        
-        debug_log_overflow();
-        
-        ErrorDetails error = {
-            .type = ERROR_TYPE_HARDWARE,
-            .severity = ERROR_SEVERITY_ERROR,
-            .code = ERROR_SERIAL_OVERFLOW,
-            .timestamp = deskthang_time_get_ms(),
-            .source_state = 0,
-            .recoverable = true,
-            .retry_count = 0,
-            .backoff_ms = 0
-        };
-        strncpy(error.message, "Buffer overflow detected", ERROR_MESSAGE_SIZE - 1);
-        snprintf(error.context, ERROR_CONTEXT_SIZE - 1, "Buffer size: %d, Write size: %zu", CHUNK_SIZE, len);
-        logging_error_details(&error);
-        
-        // Attempt recovery by flushing
-        serial_flush();
-        serial_clear();
-        
-        // Add delay to allow system to recover
-        sleep_ms(10);
+    debug_log_buffer_usage(len, SERIAL_TX_RING_SIZE);
+
+    if (len > serial_ring_space(&g_tx_ring)) {
+        // Make room by handing what we can to USB, then give up rather than wait
+        serial_tx_pump(false);
+        if (len > serial_ring_space(&g_tx_ring)) {
+            // No logging here: the log line would need the same full ring
+            serial_state.stats.backpressure_count++;
+            serial_state.stats.overflow_count++;
+            serial_state.stats.last_overflow_time = deskthang_time_get_ms();
+            serial_state.stats.in_overflow = true;
+            return false;
+        }
     }
 
-    debug_log_buffer_usage(len, CHUNK_SIZE);
-    debug_log_operation_start("serial_write");
+    // Frames go in whole so a refused write never leaves half a packet behind
+    serial_ring_write(&g_tx_ring, data, len);
+    serial_state.stats.tx_bytes += len;
+    serial_state.stats.in_overflow = false;
 
-    size_t remaining = len;
-    const uint8_t *ptr = data;
-    uint32_t retry_count = 0;
-    const uint32_t max_retries = 3;
-    
-    while (remaining > 0 && retry_count < max_retries) {
-        size_t chunk = (remaining > CHUNK_SIZE) ? CHUNK_SIZE : remaining;
-        if (!serial_write_chunk(ptr, chunk)) {
-            retry_count++;
-            if (retry_count < max_retries) {
-                // Log retry attempt
-                char msg[64];
-                snprintf(msg, sizeof(msg), "Retrying write (attempt %u/%u)", retry_count + 1, max_retries);
-                logging_write("Serial", msg);
-                
-                // Flush and wait before retry
-                serial_flush();
-                sleep_ms(5 * retry_count);  // Exponential backoff
-                continue;
-            }
-            
-            debug_log_operation_end("serial_write");
-            return false;
-        }
-        ptr += chunk;
-        remaining -= chunk;
-        retry_count = 0;  // Reset retry count on successful write
+    size_t used = serial_ring_count(&g_tx_ring);
+    if (used > serial_state.stats.tx_high_water) {
+        serial_state.stats.tx_high_water = used;
     }
 
-    // Clear overflow state if write succeeds
-    if (serial_state.in_overflow) {
-        serial_state.in_overflow = false;
-        logging_write("Serial", "Recovered from overflow condition");
+    if (!serial_state.flush_pending) {
+        serial_state.flush_pending = true;
+        serial_state.flush_deadline = time_us_32() + SERIAL_FLUSH_DEADLINE_US;
+        serial_arm_flush();
     }
 
-    debug_log_operation_end("serial_write");
-    return remaining == 0;  // Return true only if all data was written
+    serial_tx_pump(false);
+    return true;
 }
 
 bool serial_write_chunk(const uint8_t *data, size_t len) {
-    if (!serial_state.initialized || len > CHUNK_SIZE) {
+    if (len > CHUNK_SIZE) {
         return false;
     }
-
-    debug_log_operation_start("serial_write_chunk");
-
-    // Try to write with timeout
-    absolute_time_t timeout = make_timeout_time_ms(SERIAL_WRITE_TIMEOUT_MS);
-    while (len > 0) {
-        if (time_reached(timeout)) {
-            debug_log_operation_end("serial_write_chunk");
-            
-            ErrorDetails error = {
-                .type = ERROR_TYPE_HARDWARE,
-                .severity = ERROR_SEVERITY_ERROR,
-                .code = ERROR_SERIAL_TIMEOUT,
-                .timestamp = deskthang_time_get_ms(),
-                .source_state = 0,
-                .recoverable = true,
-                .retry_count = 0,
-                .backoff_ms = 0
-            };
-            strncpy(error.message, "Write timeout", ERROR_MESSAGE_SIZE - 1);
-            error.message[ERROR_MESSAGE_SIZE - 1] = '\0';
-            error.context[0] = '\0';
-            logging_error_details(&error);
-            return false;
-        }
-
-        int written = fwrite(data, 1, len, stdout);
-        if (written <= 0) {
-            debug_log_operation_end("serial_write_chunk");
-            return false;
-        }
-        
-        data += written;
-        len -= written;
-    }
-
-    debug_log_operation_end("serial_write_chunk");
-    return true;
+    return serial_write(data, len);
 }
 
+// All or nothing: returns false without consuming anything if fewer than
+// len bytes have arrived
 bool serial_read(uint8_t *data, size_t len) {
     if (!serial_state.initialized || data == NULL) {
         return false;
     }
 
-    uint32_t start = deskthang_time_get_ms();
-    size_t total_read = 0;
-
-    while (total_read < len) {
-        if (deskthang_time_get_ms() - start > serial_state.timeout_ms) {
-            // Only report timeout as error if we've started reading data
-            if (total_read > 0) {
-                ErrorDetails error = {
-                    .type = ERROR_TYPE_HARDWARE,
-                    .severity = ERROR_SEVERITY_WARNING,
-                    .code = ERROR_SERIAL_UNDERFLOW,
-                    .timestamp = deskthang_time_get_ms(),
-                    .source_state = 0,
-                    .recoverable = true,
-                    .retry_count = 0,
-                    .backoff_ms = 0
-                };
-                strncpy(error.message, "Incomplete read detected", ERROR_MESSAGE_SIZE - 1);
-                error.message[ERROR_MESSAGE_SIZE - 1] = '\0';
-                snprintf(error.context, ERROR_CONTEXT_SIZE - 1, "Expected %zu bytes, got %zu", len, total_read);
-                logging_error_details(&error);
-            }
-            return false;  // Timeout
-        }
-
-        int c = getchar_timeout_us(0);  // Non-blocking read
-        if (c == PICO_ERROR_TIMEOUT) {
-            // No data available, not an error
+    if (serial_ring_count(&g_rx_ring) < len) {
+        serial_rx_fill();
+        if (serial_ring_count(&g_rx_ring) < len) {
             return false;
         }
-        
-        if (c != PICO_ERROR_TIMEOUT) {
-            data[total_read++] = (uint8_t)c;
-        }
     }
 
-    return total_read == len;
+    return serial_ring_read(&g_rx_ring, data, len) == len;
 }
 
 bool serial_write_debug(const char *module, const char *message) {
@@ -219,11 +258,10 @@ bool serial_write_debug(const char *module, const char *message) {
                 message,
                 "", "");  // No context for debug messages
 
-    if (len > 0 && len < sizeof(buffer)) {
-        bool success = serial_write((uint8_t*)buffer, len);
-        if (success) {
-            return serial_write((uint8_t*)"\n", 1);  // Add newline
-        }
+    // Newline goes in with the message so the pair can't be split
+    if (len > 0 && len < (int)sizeof(buffer) - 1) {
+        buffer[len++] = '\n';
+        return serial_write((uint8_t*)buffer, len);
     }
     return false;
 }
@@ -235,7 +273,7 @@ bool serial_write_chunked(const uint8_t *data, size_t len) {
 
     size_t remaining = len;
     const uint8_t *ptr = data;
-    
+
     while (remaining > 0) {
         size_t chunk = (remaining > CHUNK_SIZE) ? CHUNK_SIZE : remaining;
         if (!serial_write(ptr, chunk)) {
@@ -249,51 +287,81 @@ bool serial_write_chunked(const uint8_t *data, size_t len) {
 
 void serial_flush(void) {
     if (serial_state.initialized) {
-        fflush(stdout);
-        // Reset overflow state after successful flush
-        if (serial_state.in_overflow) {
-            serial_state.in_overflow = false;
-            logging_write("Serial", "Overflow cleared after flush");
-        }
+        serial_tx_pump(true);
+        serial_arm_flush();
     }
 }
 
+void serial_service(void) {
+    if (!serial_state.initialized) {
+        return;
+    }
+
+    serial_rx_fill();
+
+    if (serial_state.flush_pending &&
+        (int32_t)(time_us_32() - serial_state.flush_deadline) >= 0) {
+        serial_tx_pump(true);
+        serial_arm_flush();
+    } else if (serial_ring_count(&g_tx_ring) > 0) {
+        serial_tx_pump(false);
+    }
+}
+
+size_t serial_write_space(void) {
+    return serial_state.initialized ? serial_ring_space(&g_tx_ring) : 0;
+}
+
 bool serial_available(void) {
-    return serial_state.initialized && (getchar_timeout_us(0) != PICO_ERROR_TIMEOUT);
+    if (!serial_state.initialized) {
+        return false;
+    }
+
+    if (serial_ring_count(&g_rx_ring) == 0) {
+        serial_rx_fill();
+    }
+    return serial_ring_count(&g_rx_ring) > 0;
+}
+
+size_t serial_read_available(uint8_t *data, size_t max_len) {
+    if (!serial_state.initialized || data == NULL) {
+        return 0;
+    }
+
+    if (serial_ring_count(&g_rx_ring) < max_len) {
+        serial_rx_fill();
+    }
+    return serial_ring_read(&g_rx_ring, data, max_len);
 }
 
 void serial_clear(void) {
     if (!serial_state.initialized) {
         return;
     }
-    
-    while (getchar_timeout_us(0) != PICO_ERROR_TIMEOUT) {
-        // Keep reading until no more data
-    }
+
+    uint32_t irq_state = save_and_disable_interrupts();
+    serial_ring_clear(&g_rx_ring);
+    tud_cdc_read_flush();
+    restore_interrupts(irq_state);
 }
 
 bool serial_get_stats(SerialStats *stats) {
     if (!stats) {
         return false;
     }
-    
-    stats->overflow_count = serial_state.overflow_count;
-    stats->last_overflow_time = serial_state.last_overflow_time;
-    stats->in_overflow = serial_state.in_overflow;
+
+    *stats = serial_state.stats;
 
     // Also update debug stats
     ResourceDebugStats *debug_stats = debug_get_resource_stats();
-    debug_stats->total_overflows = serial_state.overflow_count;
-    debug_stats->last_overflow_time = serial_state.last_overflow_time;
-    
+    debug_stats->total_overflows = serial_state.stats.overflow_count;
+    debug_stats->last_overflow_time = serial_state.stats.last_overflow_time;
+
     return true;
 }
 
 int serial_read_byte(void) {
     uint8_t byte;
-    if (!serial_available()) {
-        return -1;
-    }
     if (!serial_read(&byte, 1)) {
         return -1;
     }
@@ -9,6 +9,30 @@
 // Serial configuration
 #define SERIAL_WRITE_TIMEOUT_MS 100
 
+// USB CDC backend. Received bytes are pulled from TinyUSB into the RX ring in
+// bulk (from the USB IRQ when the SDK offers a chars-available callback);
+// writes land in the TX ring and go out as full USB packets. A short write
+// is held for at most SERIAL_FLUSH_DEADLINE_US so an ACK and the log line
+// after it share one packet. Writes never wait: if a frame doesn't fit in
+// the TX ring serial_write returns false and counts a backpressure event.
+#ifndef SERIAL_RX_RING_SIZE
+#define SERIAL_RX_RING_SIZE 2048  // Power of two
+#endif
+
+#ifndef SERIAL_TX_RING_SIZE
+#define SERIAL_TX_RING_SIZE 4096  // Power of two, holds a worst-case escaped v1 frame
+#endif
+
+#ifndef SERIAL_FLUSH_DEADLINE_US
+#define SERIAL_FLUSH_DEADLINE_US 500
+#endif
+
+// Without the SDK's chars-available callback nothing signals received
+// bytes, so the scheduler polls for them this often
+#ifndef SERIAL_RX_POLL_US
+#define SERIAL_RX_POLL_US 1000
+#endif
+
 // Error codes
 #define ERROR_SERIAL_OVERFLOW  1001
 #define ERROR_SERIAL_TIMEOUT   1002
@@ -21,20 +45,30 @@ typedef struct {
     uint32_t last_overflow_time;  // Timestamp of last overflow
     uint32_t last_underflow_time; // Timestamp of last underflow
     bool in_overflow;             // Currently in overflow state
+    uint32_t backpressure_count;  // Writes refused because the TX ring was full
+    uint32_t tx_bytes;            // Bytes accepted for transmit
+    uint32_t rx_bytes;            // Bytes pulled from USB
+    uint32_t tx_dropped;          // Bytes discarded while no host was connected
+    uint32_t flushes;             // Short USB packets sent on deadline or request
+    uint16_t rx_high_water;       // Fullest the RX ring has been
+    uint16_t tx_high_water;       // Fullest the TX ring has been
 } SerialStats;
 
 // Core serial functions
 bool serial_init(void);
 void serial_deinit(void);
-bool serial_write(const uint8_t *data, size_t len);
+bool serial_write(const uint8_t *data, size_t len);  // All or nothing, never waits
 bool serial_write_chunk(const uint8_t *data, size_t len);
 bool serial_read(uint8_t *data, size_t len);
 int serial_read_byte(void);  // Returns -1 if no data available, otherwise returns byte value
+size_t serial_read_available(uint8_t *data, size_t max_len);  // Non-blocking, returns bytes read
 bool serial_write_debug(const char *module, const char *message);
 bool serial_write_chunked(const uint8_t *data, size_t len);
 void serial_flush(void);
-bool serial_available(void);
+bool serial_available(void);  // Peeks; the byte stays readable
 void serial_clear(void);
+size_t serial_write_space(void);  // Bytes serial_write would accept right now
+void serial_service(void);        // Core0, each scheduler pass: flush deadlines, refill
 
 // Statistics and monitoring
 bool serial_get_stats(SerialStats *stats);
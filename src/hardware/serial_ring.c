@@ -0,0 +1,109 @@
+#include "serial_ring.h"
+#include <string.h>
+
+// Acquire on the other side's counter, release on our own, so data copied
+// before a publish is visible to whoever sees the new counter
+static inline uint32_t load_acquire(const volatile uint32_t *counter) {
+    return __atomic_load_n(counter, __ATOMIC_ACQUIRE);
+}
+
+static inline void store_release(volatile uint32_t *counter, uint32_t value) {
+    __atomic_store_n(counter, value, __ATOMIC_RELEASE);
+}
+
+bool serial_ring_init(SerialRing *ring, uint8_t *storage, size_t size) {
+    if (!ring || !storage || size == 0 || (size & (size - 1)) != 0) {
+        return false;
+    }
+    
+    ring->data = storage;
+    ring->mask = (uint32_t)size - 1;
+    ring->head = 0;
+    ring->tail = 0;
+    return true;
+}
+
+void serial_ring_clear(SerialRing *ring) {
+    store_release(&ring->tail, load_acquire(&ring->head));
+}
+
+size_t serial_ring_count(const SerialRing *ring) {
+    return load_acquire(&ring->head) - load_acquire(&ring->tail);
+}
+
+size_t serial_ring_space(const SerialRing *ring) {
+    return ring->mask + 1 - serial_ring_count(ring);
+}
+
+uint8_t *serial_ring_write_span(SerialRing *ring, size_t *length) {
+    uint32_t head = ring->head;
+    uint32_t space = ring->mask + 1 - (head - load_acquire(&ring->tail));
+    uint32_t offset = head & ring->mask;
+    uint32_t to_end = ring->mask + 1 - offset;
+    
+    *length = space < to_end ? space : to_end;
+    return ring->data + offset;
+}
+
+void serial_ring_commit(SerialRing *ring, size_t length) {
+    store_release(&ring->head, ring->head + (uint32_t)length);
+}
+
+const uint8_t *serial_ring_read_span(const SerialRing *ring, size_t *length) {
+    uint32_t tail = ring->tail;
+    uint32_t count = load_acquire(&ring->head) - tail;
+    uint32_t offset = tail & ring->mask;
+    uint32_t to_end = ring->mask + 1 - offset;
+    
+    *length = count < to_end ? count : to_end;
+    return ring->data + offset;
+}
+
+void serial_ring_consume(SerialRing *ring, size_t length) {
+    store_release(&ring->tail, ring->tail + (uint32_t)length);
+}
+
+size_t serial_ring_write(SerialRing *ring, const uint8_t *data, size_t length) {
+    size_t written = 0;
+    
+    // At most two spans: up to the end of storage, then from the start
+    while (written < length) {
+        size_t span;
+        uint8_t *dst = serial_ring_write_span(ring, &span);
+        if (span == 0) {
+            break;
+        }
+        if (span > length - written) {
+            span = length - written;
+        }
+        memcpy(dst, data + written, span);
+        serial_ring_commit(ring, span);
+        written += span;
+    }
+    return written;
+}
+
+size_t serial_ring_read(SerialRing *ring, uint8_t *data, size_t length) {
+    size_t read = 0;
+    
+    while (read < length) {
+        size_t span;
+        const uint8_t *src = serial_ring_read_span(ring, &span);
+        if (span == 0) {
+            break;
+        }
+        if (span > length - read) {
+            span = length - read;
+        }
+        memcpy(data + read, src, span);
+        serial_ring_consume(ring, span);
+        read += span;
+    }
+    return read;
+}
+
+int serial_ring_peek(const SerialRing *ring) {
+    size_t span;
+    const uint8_t *src = serial_ring_read_span(ring, &span);
+    return span > 0 ? *src : -1;
+}
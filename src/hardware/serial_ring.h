@@ -0,0 +1,45 @@
+#ifndef DESKTHANG_SERIAL_RING_H
+#define DESKTHANG_SERIAL_RING_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Single-producer single-consumer byte ring for the serial backend. The size
+// is a power of two so positions wrap with a mask, and head/tail are free
+// running counters so full and empty never look alike. One side may run in
+// an interrupt handler: the producer only writes head, the consumer only
+// writes tail, and each publishes with a release store after touching data.
+//
+// The span functions expose the contiguous region at the current position
+// so bulk copies (tud_cdc_read, tud_cdc_write) work on the storage directly.
+typedef struct {
+    uint8_t *data;
+    uint32_t mask;
+    volatile uint32_t head;  // Total bytes written, producer-owned
+    volatile uint32_t tail;  // Total bytes read, consumer-owned
+} SerialRing;
+
+// False if size isn't a power of two
+bool serial_ring_init(SerialRing *ring, uint8_t *storage, size_t size);
+void serial_ring_clear(SerialRing *ring);  // Consumer side: drops unread bytes
+
+size_t serial_ring_count(const SerialRing *ring);
+size_t serial_ring_space(const SerialRing *ring);
+
+// Copy in/out as much as fits, returning the bytes moved
+size_t serial_ring_write(SerialRing *ring, const uint8_t *data, size_t length);
+size_t serial_ring_read(SerialRing *ring, uint8_t *data, size_t length);
+
+// Next byte without consuming it, -1 if empty
+int serial_ring_peek(const SerialRing *ring);
+
+// Producer: contiguous free span, then publish what was filled
+uint8_t *serial_ring_write_span(SerialRing *ring, size_t *length);
+void serial_ring_commit(SerialRing *ring, size_t length);
+
+// Consumer: contiguous readable span, then release what was used
+const uint8_t *serial_ring_read_span(const SerialRing *ring, size_t *length);
+void serial_ring_consume(SerialRing *ring, size_t length);
+
+#endif // DESKTHANG_SERIAL_RING_H
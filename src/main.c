@@ -7,6 +7,28 @@
 #include "error/logging.h"
 #include "error/recovery.h"
 #include "protocol/packet.h"
+#include "protocol/packet_parser.h"
+#include "protocol/pipeline.h"
+#include "system/boot.h"
+#include "system/scheduler.h"
+#include "debug/trace.h"
+
+// Status LED, also flashed on every received packet
+static const uint LED_PIN = 25;
+
+// Receive parser, fed by the receive task
+static PacketParser g_parser;
+
+#define LED_FLASH_US 50000
+#define HEARTBEAT_INTERVAL_US 1000000
+
+// The LED shows the heartbeat, and flashes on while a packet is handled
+static SchedTimer g_led_flash_timer;
+static SchedTimer g_heartbeat_timer;
+static bool g_led_state = false;
+
+static int g_rx_task = -1;
+static SystemState g_last_state = STATE_HARDWARE_INIT;
 
 // Hardware configuration
 const HardwareConfig hw_config = {
@@ -46,6 +68,78 @@ const ProtocolConfig protocol_config = {
     // ... other protocol configuration ...
 };
 
+// Return the LED to the heartbeat after a receive flash
+static void led_flash_end(void *context) {
+    (void)context;
+    gpio_put(LED_PIN, g_led_state);
+}
+
+// Toggle the LED and report uptime and state to the host
+static void heartbeat(void *context) {
+    (void)context;
+    g_led_state = !g_led_state;
+    if (!scheduler_timer_armed(&g_led_flash_timer)) {
+        gpio_put(LED_PIN, g_led_state);
+    }
+
+    // Queued like any log line; log_task sends it under the rate limit
+    char message[64];
+    snprintf(message, sizeof(message), "Heartbeat: %lu, State: %s",
+             (unsigned long)(time_us_32() / 1000000), state_to_string(state_machine_get_current()));
+    logging_write("SYSTEM", message);
+}
+
+// Packets are taken whenever the link is up, including while a command
+// or transfer runs; only init, sync and error can't handle input
+static bool accepting_packets(SystemState state) {
+    return state == STATE_IDLE ||
+           state == STATE_READY ||
+           state == STATE_COMMAND_PROCESSING ||
+           state == STATE_DATA_TRANSFER;
+}
+
+// Back off, then try to leave ERROR; keep trying while it refuses
+static void attempt_recovery(void) {
+    logging_write("Main", "In ERROR state, attempting recovery");
+    state_machine_attempt_recovery();
+    if (state_machine_is_in_error()) {
+        logging_write("Main", "Error recovery failed");
+        recovery_schedule_retry(attempt_recovery);
+    }
+}
+
+// Called by the parser for every complete packet
+static void handle_received_packet(Packet *packet, void *context) {
+    (void)context;
+    logging_write("Main", "Packet received, processing");
+    gpio_put(LED_PIN, 1);  // Flash LED briefly when packet received
+    scheduler_timer_start(&g_led_flash_timer, LED_FLASH_US, 0, led_flash_end, NULL);
+    
+    TRACE_BEGIN(PACKET_HANDLE, packet_get_type(packet));
+    bool processed = protocol_process_packet(packet);
+    TRACE_END(PACKET_HANDLE, 0);
+    if (!processed) {
+        logging_write("Main", "Protocol processing failed, transitioning to ERROR");
+        state_machine_transition(STATE_ERROR, CONDITION_ERROR);
+    } else {
+        logging_write("Main", "Packet processed successfully");
+    }
+}
+
+// Blink code after an init phase: count blinks, then a long pause. Only
+// with DESKTHANG_BOOT_BLINK; a fast boot skips it.
+static void boot_blink(int count) {
+#if DESKTHANG_BOOT_BLINK
+    for (int i = 0; i < count; i++) {
+        gpio_put(LED_PIN, 0); sleep_ms(200);
+        gpio_put(LED_PIN, 1); sleep_ms(200);
+    }
+    sleep_ms(1000);  // Long pause after section
+#else
+    (void)count;
+#endif
+}
+
 // Recovery handlers
 static bool retry_handler(const ErrorDetails *error) {
     // Implement retry logic
@@ -62,47 +156,16 @@ static bool reinit_handler(const ErrorDetails *error) {
     return hardware_reset();
 }
 
-// Initialize subsystems
+// Initialize subsystems. Error handling, serial and logging are already
+// up: main brings them up first so everything after can log.
 static bool init_subsystems(void) {
-    const uint LED_PIN = 25;  // Make LED_PIN accessible here
-    
-    // Initialize error handling first (doesn't depend on anything)
-    error_init();
-    gpio_put(LED_PIN, 0); sleep_ms(200); gpio_put(LED_PIN, 1);  // 1 blink for error init
-    sleep_ms(1000);  // Long pause after section
-    
-    // Initialize serial directly (don't call stdio_init_all() since it's done in main)
-    if (!serial_init()) {
-        return false;
-    }
-    gpio_put(LED_PIN, 0); sleep_ms(200); gpio_put(LED_PIN, 1);  // 1 more blink for serial
-    sleep_ms(1000);
-    
-    // Now initialize logging (depends on serial)
-    if (!logging_init()) {
-        return false;
-    }
-    gpio_put(LED_PIN, 0); sleep_ms(200); 
-    gpio_put(LED_PIN, 1); sleep_ms(200); 
-    gpio_put(LED_PIN, 0); sleep_ms(200);
-    gpio_put(LED_PIN, 1);  // 2 blinks for logging init
-    sleep_ms(1000);  // Long pause after section
-    
-    // From here on we can use logging for debug output
-    logging_write("Init", "Logging system initialized");
-    
     // Initialize recovery system
     if (!recovery_init()) {
         logging_write("Init", "Recovery system initialization failed");
         return false;
     }
-    gpio_put(LED_PIN, 0); sleep_ms(200);
-    gpio_put(LED_PIN, 1); sleep_ms(200);
-    gpio_put(LED_PIN, 0); sleep_ms(200);
-    gpio_put(LED_PIN, 1); sleep_ms(200);
-    gpio_put(LED_PIN, 0); sleep_ms(200);
-    gpio_put(LED_PIN, 1);  // 3 blinks for recovery init
-    sleep_ms(1000);  // Long pause after section
+    boot_mark(BOOT_PHASE_RECOVERY);
+    boot_blink(3);  // 3 blinks for recovery init
     
     logging_write("Init", "Recovery system initialized");
     
@@ -120,49 +183,106 @@ static bool init_subsystems(void) {
         error_report(ERROR_TYPE_HARDWARE, ERROR_SEVERITY_FATAL, 1, "Hardware initialization failed");
         return false;
     }
-    for(int i = 0; i < 4; i++) {  // 4 blinks for hardware init
-        gpio_put(LED_PIN, 0); sleep_ms(200);
-        gpio_put(LED_PIN, 1); sleep_ms(200);
-    }
-    sleep_ms(1000);  // Long pause after section
+    boot_mark(BOOT_PHASE_HARDWARE);
+    boot_blink(4);  // 4 blinks for hardware init
     
     logging_write("Init", "Core subsystems initialized successfully");
+    logging_flush();  // Boot lines, before the ring can fill
     return true;
 }
 
+// Feed whatever has arrived; partial packets stay in the parser until the
+// rest shows up. Stays runnable while packets keep completing.
+static bool rx_task(void *context) {
+    (void)context;
+    if (!accepting_packets(state_machine_get_current())) {
+        return false;  // state_task wakes us on the way back
+    }
+    return packet_parser_poll(&g_parser) > 0;
+}
+
+// Follow state changes: log them, mark boot ready, start recovery
+static bool state_task(void *context) {
+    (void)context;
+    SystemState current = state_machine_get_current();
+
+    if (current == STATE_DISPLAY_INIT && display_is_initialized()) {
+        logging_write("Main", "Display initialized, transitioning to IDLE");
+        state_machine_transition(STATE_IDLE, CONDITION_DISPLAY_READY);
+        current = state_machine_get_current();
+    }
+
+    if (current == g_last_state) {
+        return false;
+    }
+    LOG_EVENT(STATE_CHANGED, state_to_string(g_last_state), state_to_string(current));
+    g_last_state = current;
+
+    if (accepting_packets(current)) {
+        if (!boot_is_ready()) {
+            boot_mark(BOOT_PHASE_READY);
+            char message[64];
+            snprintf(message, sizeof(message), "Ready %lu us after power-on",
+                     (unsigned long)boot_phase_us(BOOT_PHASE_READY));
+            logging_write("Main", message);
+        }
+        scheduler_task_wake(g_rx_task);
+    } else if (current == STATE_ERROR && !recovery_retry_pending()) {
+        recovery_schedule_retry(attempt_recovery);
+    }
+    return false;
+}
+
+// Send queued log lines. While packets stream they wait for a quiet line,
+// a frame boundary with nothing more received.
+static bool log_task(void *context) {
+    (void)context;
+    if (accepting_packets(state_machine_get_current()) &&
+        (packet_parser_in_frame(&g_parser) || serial_available())) {
+        return false;
+    }
+    return logging_service() > 0;
+}
+
+// Push out coalesced writes whose flush deadline has passed
+static bool serial_task(void *context) {
+    (void)context;
+    serial_service();
+    return false;
+}
+
 int main() {
+    // Timers are armed from serial_init on, so the wheel comes first
+    scheduler_init();
+
     // Initialize stdio for initial printf only
     stdio_init_all();
     printf("DeskThang starting up...\n");
     fflush(stdout);
 
+    boot_mark(BOOT_PHASE_STDIO);
+
     // Initialize GPIO for LED
-    const uint LED_PIN = 25;
     gpio_init(LED_PIN);
     gpio_set_dir(LED_PIN, GPIO_OUT);
     gpio_put(LED_PIN, 1);
 
     // Initialize error handling first (doesn't depend on anything)
     error_init();
-    gpio_put(LED_PIN, 0); sleep_ms(200); gpio_put(LED_PIN, 1);  // 1 blink for error init
-    sleep_ms(1000);  // Long pause after section
+    boot_mark(BOOT_PHASE_ERROR);
+    boot_blink(1);  // 1 blink for error init
     
     // Initialize serial directly
     if (!serial_init()) {
         return false;
     }
-    gpio_put(LED_PIN, 0); sleep_ms(200); gpio_put(LED_PIN, 1);  // 1 more blink for serial
-    sleep_ms(1000);
+    boot_mark(BOOT_PHASE_SERIAL);
+    boot_blink(1);  // 1 more blink for serial
     
     // Initialize logging (depends on serial)
     if (!logging_init()) {
         return false;
     }
-    gpio_put(LED_PIN, 0); sleep_ms(200); 
-    gpio_put(LED_PIN, 1); sleep_ms(200); 
-    gpio_put(LED_PIN, 0); sleep_ms(200);
-    gpio_put(LED_PIN, 1);  // 2 blinks for logging init
-    sleep_ms(1000);  // Long pause after section
 
     // Initialize packet system
     if (!packet_buffer_init()) {
@@ -174,6 +294,8 @@ int main() {
     
     // From here on we use debug packets for all output
     logging_write("Init", "System initialized, switching to debug packets");
+    boot_mark(BOOT_PHASE_LOGGING);
+    boot_blink(2);  // 2 blinks for logging init
     
     // Rest of initialization...
     if (!init_subsystems()) {
@@ -198,85 +320,25 @@ int main() {
 
     logging_write("Main", "State machine initialized successfully");
 
-    // Main event loop
-    uint32_t last_heartbeat = time_us_32() / 1000;  // Current time in ms
-    bool led_state = false;
-    Packet packet;  // Moved outside switch
-    SystemState last_state = STATE_HARDWARE_INIT;  // Start with initial state
+    // Core1 decodes transfer chunks onto the panel; this core keeps USB,
+    // parsing and ACKs. Without it chunks are decoded here instead.
+    if (!pipeline_start()) {
+        logging_write("Main", "Core1 pipeline failed to start, decoding on core0");
+    }
+
+    // Tasks run in this order each pass they are woken: receive before the
+    // state check, so a packet's transitions are seen in the same pass,
+    // and logs after both so they don't delay the reply
+    packet_parser_init(&g_parser, handle_received_packet, NULL);
+    g_rx_task = scheduler_task_add("rx", rx_task, NULL, SCHED_EVENT_BIT(SCHED_EVENT_USB_RX));
+    scheduler_task_add("state", state_task, NULL, SCHED_WAKE_ALWAYS);
+    scheduler_task_add("log", log_task, NULL, SCHED_WAKE_ALWAYS);
+    scheduler_task_add("serial", serial_task, NULL, SCHED_WAKE_ALWAYS);
+    scheduler_timer_start(&g_heartbeat_timer, HEARTBEAT_INTERVAL_US, HEARTBEAT_INTERVAL_US, heartbeat, NULL);
+    scheduler_task_wake(g_rx_task);  // Bytes may have arrived during boot
 
     logging_write("Main", "Entering main event loop");
+    logging_flush();
 
-    while (1) {
-        uint32_t current_time = time_us_32() / 1000;  // Current time in ms
-        SystemState current_state = state_machine_get_current();
-        char state_log[64];
-        
-        // Log state changes
-        if (current_state != last_state) {
-            char state_msg[64];
-            snprintf(state_msg, sizeof(state_msg), "State changed from %s to %s", 
-                    state_to_string(last_state), state_to_string(current_state));
-            logging_write("Main", state_msg);
-            last_state = current_state;
-        }
-        
-        // Process state-specific actions
-        switch (current_state) {
-            case STATE_HARDWARE_INIT:
-                logging_write("Main", "Processing HARDWARE_INIT state");
-                break;
-                
-            case STATE_DISPLAY_INIT:
-                logging_write("Main", "In DISPLAY_INIT state, checking initialization");
-                if (display_is_initialized()) {
-                    logging_write("Main", "Display initialized, transitioning to IDLE");
-                    state_machine_transition(STATE_IDLE, CONDITION_DISPLAY_READY);
-                }
-                break;
-                
-            case STATE_IDLE:
-            case STATE_READY:
-                // Process packets in these states
-                if (packet_receive(&packet)) {
-                    logging_write("Main", "Packet received, processing");
-                    gpio_put(LED_PIN, 1);  // Flash LED briefly when packet received
-                    if (!protocol_process_packet(&packet)) {
-                        logging_write("Main", "Protocol processing failed, transitioning to ERROR");
-                        state_machine_transition(STATE_ERROR, CONDITION_ERROR);
-                    } else {
-                        logging_write("Main", "Packet processed successfully");
-                    }
-                    sleep_ms(50);  // Keep LED on briefly
-                    gpio_put(LED_PIN, led_state);  // Return to heartbeat state
-                } else {
-                    sleep_ms(1);  // Shorter delay when no packet
-                }
-                break;
-                
-            case STATE_ERROR:
-                logging_write("Main", "In ERROR state, attempting recovery");
-                if (state_machine_handle_error()) {
-                    logging_write("Main", "Error handled, continuing");
-                    continue;
-                }
-                logging_write("Main", "Error recovery failed");
-                break;
-        }
-        
-        // Heartbeat every second
-        if (current_time - last_heartbeat >= 1000) {
-            led_state = !led_state;  // Toggle LED with heartbeat
-            gpio_put(LED_PIN, led_state);
-            
-            // Send heartbeat through debug packet
-            char message[64];
-            snprintf(message, sizeof(message), "Heartbeat: %lu, State: %s", current_time / 1000, state_to_string(current_state));
-            Packet debug_packet;
-            if (packet_create_debug(&debug_packet, "SYSTEM", message)) {
-                packet_transmit(&debug_packet);
-            }
-            
-            last_heartbeat = current_time;
-        }
-    }
+    scheduler_run();
 }
@@ -0,0 +1,90 @@
+#include "cobs.h"
+
+// Close the current block by writing its code and open a new one
+static void cobs_encoder_close_block(CobsEncoder *encoder) {
+    encoder->out[encoder->code_index] = encoder->code;
+    encoder->code_index = encoder->length;
+    encoder->code = 1;
+
+    if (encoder->length >= encoder->capacity) {
+        encoder->overflow = true;
+        return;
+    }
+    encoder->length++;
+}
+
+void cobs_encoder_init(CobsEncoder *encoder, uint8_t *out, size_t capacity) {
+    encoder->out = out;
+    encoder->capacity = capacity;
+    encoder->length = 1;
+    encoder->code_index = 0;
+    encoder->code = 1;
+    encoder->overflow = (out == NULL || capacity == 0);
+}
+
+void cobs_encoder_update(CobsEncoder *encoder, const uint8_t *data, size_t length) {
+    for (size_t i = 0; i < length && !encoder->overflow; i++) {
+        if (data[i] == 0) {
+            cobs_encoder_close_block(encoder);
+            continue;
+        }
+
+        if (encoder->length >= encoder->capacity) {
+            encoder->overflow = true;
+            return;
+        }
+        encoder->out[encoder->length++] = data[i];
+
+        // A full block of 254 data bytes carries no implicit zero
+        if (++encoder->code == 0xFF) {
+            cobs_encoder_close_block(encoder);
+        }
+    }
+}
+
+size_t cobs_encoder_finish(CobsEncoder *encoder) {
+    if (encoder->overflow) {
+        return 0;
+    }
+
+    encoder->out[encoder->code_index] = encoder->code;
+    return encoder->length;
+}
+
+size_t cobs_encode(const uint8_t *in, size_t length, uint8_t *out, size_t capacity) {
+    CobsEncoder encoder;
+    cobs_encoder_init(&encoder, out, capacity);
+    cobs_encoder_update(&encoder, in, length);
+    return cobs_encoder_finish(&encoder);
+}
+
+bool cobs_decode(const uint8_t *in, size_t length, uint8_t *out, size_t *out_length) {
+    if (!in || !out || !out_length) {
+        return false;
+    }
+
+    // The write position never passes the read position, so in-place is safe
+    size_t read = 0;
+    size_t write = 0;
+    while (read < length) {
+        uint8_t code = in[read++];
+        if (code == COBS_DELIMITER) {
+            return false;
+        }
+
+        for (uint8_t i = 1; i < code; i++) {
+            if (read >= length || in[read] == COBS_DELIMITER) {
+                return false;
+            }
+            out[write++] = in[read++];
+        }
+
+        // Every block but a full one (and the last) ends in an implicit zero
+        if (code != 0xFF && read < length) {
+            out[write++] = 0;
+        }
+    }
+
+    *out_length = write;
+    return true;
+}
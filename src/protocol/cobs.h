@@ -0,0 +1,33 @@
+#ifndef DESKTHANG_COBS_H
+#define DESKTHANG_COBS_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Consistent Overhead Byte Stuffing. Encoded data never contains 0x00, so a
+// single zero byte can delimit frames. Overhead is one byte per 254 bytes of
+// input plus one, regardless of content.
+#define COBS_MAX_ENCODED_SIZE(n) ((n) + ((n) / 254) + 1)
+#define COBS_DELIMITER 0x00
+
+// Incremental encoder: feed any number of spans, then finish. Writes each
+// byte exactly once into the output buffer.
+typedef struct {
+    uint8_t *out;
+    size_t capacity;
+    size_t length;      // Bytes written, including the open code slot
+    size_t code_index;  // Position of the current block's code byte
+    uint8_t code;       // Current block length + 1
+    bool overflow;
+} CobsEncoder;
+
+void cobs_encoder_init(CobsEncoder *encoder, uint8_t *out, size_t capacity);
+void cobs_encoder_update(CobsEncoder *encoder, const uint8_t *data, size_t length);
+size_t cobs_encoder_finish(CobsEncoder *encoder);  // Returns 0 on overflow
+
+// One-shot helpers. Decoding may be done in place (out == in).
+size_t cobs_encode(const uint8_t *in, size_t length, uint8_t *out, size_t capacity);
+bool cobs_decode(const uint8_t *in, size_t length, uint8_t *out, size_t *out_length);
+
+#endif // DESKTHANG_COBS_H
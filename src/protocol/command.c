@@ -1,10 +1,15 @@
 #include "../system/time.h"
+#include "../system/boot.h"
 #include "command.h"
 #include "../state/state.h"
 #include <string.h>
 #include <stdlib.h>
 #include <stdio.h>
 #include "../hardware/display.h"
+#include "transfer.h"
+#include "pipeline.h"
+#include "../debug/trace.h"
+#include "../debug/stats.h"
 
 // Global command context
 static CommandContext g_command_context = {0};
@@ -37,8 +42,12 @@ bool command_process(const uint8_t *data, size_t len) {
         return false;
     }
 
+    // Each command reports its own outcome
+    memset(&g_command_status, 0, sizeof(g_command_status));
+
     // Validate command state
     if (!command_validate_state()) {
+        command_set_status(false, "Not ready for commands");
         return false;
     }
 
@@ -58,6 +67,34 @@ bool command_process(const uint8_t *data, size_t len) {
             result = command_end_image_transfer();
             break;
             
+        case CMD_REGION_START:
+            result = command_start_region_transfer(data + 1, len - 1);
+            break;
+            
+        case CMD_DELTA_START:
+            result = command_start_delta_transfer(data + 1, len - 1);
+            break;
+            
+        case CMD_QOI_START:
+            result = command_start_qoi_transfer(data + 1, len - 1);
+            break;
+            
+        case CMD_BC1_START:
+            result = command_start_bc1_transfer(data + 1, len - 1);
+            break;
+            
+        case CMD_INDEXED_START:
+            result = command_start_indexed_transfer(data + 1, len - 1);
+            break;
+            
+        case CMD_ROUND_START:
+            result = command_start_round_transfer(data + 1, len - 1);
+            break;
+            
+        case CMD_PALETTE_UPDATE:
+            result = command_update_palette(data + 1, len - 1);
+            break;
+            
         case CMD_PATTERN_CHECKER:
             result = command_show_checkerboard();
             break;
@@ -70,6 +107,18 @@ bool command_process(const uint8_t *data, size_t len) {
             result = command_show_gradient();
             break;
             
+        case CMD_BOOT_TIMELINE:
+            result = command_boot_timeline();
+            break;
+            
+        case CMD_TRACE_DUMP:
+            result = command_trace_dump();
+            break;
+            
+        case CMD_STATS:
+            result = command_stats();
+            break;
+            
         case CMD_HELP:
             result = command_show_help();
             break;
@@ -124,9 +173,19 @@ bool command_validate_type(CommandType type) {
     switch (type) {
         case CMD_IMAGE_START:
         case CMD_IMAGE_END:
+        case CMD_REGION_START:
+        case CMD_DELTA_START:
+        case CMD_QOI_START:
+        case CMD_BC1_START:
+        case CMD_INDEXED_START:
+        case CMD_PALETTE_UPDATE:
+        case CMD_ROUND_START:
         case CMD_PATTERN_CHECKER:
         case CMD_PATTERN_STRIPE:
         case CMD_PATTERN_GRADIENT:
+        case CMD_BOOT_TIMELINE:
+        case CMD_TRACE_DUMP:
+        case CMD_STATS:
         case CMD_HELP:
         case CMD_PING:
             return true;
@@ -137,22 +196,127 @@ bool command_validate_type(CommandType type) {
 
 bool command_validate_state(void) {
     SystemState current = state_machine_get_current();
-    return current == STATE_COMMAND_PROCESSING ||
+    return current == STATE_READY ||
+           current == STATE_COMMAND_PROCESSING ||
            current == STATE_DATA_TRANSFER;
 }
 
 bool command_validate_sequence(const Packet *packet) {
-    return packet_validate_sequence(packet_get_sequence(packet));
+    return protocol_validate_sequence(packet_get_sequence(packet));
 }
 
 // Image transfer commands
 bool command_start_image_transfer(const uint8_t *data, size_t len) {
-    // Validate transfer parameters here
+    // Open the display window so chunks stream straight to the panel
+    if (!transfer_start(TRANSFER_MODE_STREAM, TRANSFER_MAX_SIZE)) {
+        command_set_status(false, "Failed to start image stream");
+        return false;
+    }
     
     // Transition to transfer state
     return state_machine_transition(STATE_DATA_TRANSFER, CONDITION_TRANSFER_START);
 }
 
+// Size argument shared by the variable-length stream start commands
+static bool command_read_stream_size(const uint8_t *data, size_t len, uint32_t *size) {
+    if (!data || len != 4) {
+        return false;
+    }
+    *size = data[0] | (data[1] << 8) | (data[2] << 16) | ((uint32_t)data[3] << 24);
+    return true;
+}
+
+bool command_start_region_transfer(const uint8_t *data, size_t len) {
+    uint32_t total_size;
+    if (!command_read_stream_size(data, len, &total_size)) {
+        command_set_status(false, "Region update needs a 32-bit size");
+        return false;
+    }
+    
+    // Rectangles stream into their own windows as their headers arrive
+    if (!transfer_start(TRANSFER_MODE_REGION, total_size)) {
+        command_set_status(false, "Failed to start region update");
+        return false;
+    }
+    
+    return state_machine_transition(STATE_DATA_TRANSFER, CONDITION_TRANSFER_START);
+}
+
+bool command_start_delta_transfer(const uint8_t *data, size_t len) {
+    uint32_t total_size;
+    if (!command_read_stream_size(data, len, &total_size)) {
+        command_set_status(false, "Delta update needs a 32-bit size");
+        return false;
+    }
+    
+    // Skip/copy runs apply against whatever the panel shows now
+    if (!transfer_start(TRANSFER_MODE_DELTA, total_size)) {
+        command_set_status(false, "Failed to start delta update");
+        return false;
+    }
+    
+    return state_machine_transition(STATE_DATA_TRANSFER, CONDITION_TRANSFER_START);
+}
+
+bool command_start_qoi_transfer(const uint8_t *data, size_t len) {
+    uint32_t total_size;
+    if (!command_read_stream_size(data, len, &total_size)) {
+        command_set_status(false, "QOI image needs a 32-bit size");
+        return false;
+    }
+    
+    // Chunks are decoded into the full-screen window as they arrive
+    if (!transfer_start(TRANSFER_MODE_QOI, total_size)) {
+        command_set_status(false, "Failed to start QOI image");
+        return false;
+    }
+    
+    return state_machine_transition(STATE_DATA_TRANSFER, CONDITION_TRANSFER_START);
+}
+
+bool command_start_bc1_transfer(const uint8_t *data, size_t len) {
+    // Fixed rate, so like 'I' there is no size to send
+    if (!transfer_start(TRANSFER_MODE_BC1, TRANSFER_BC1_SIZE)) {
+        command_set_status(false, "Failed to start BC1 image");
+        return false;
+    }
+    
+    return state_machine_transition(STATE_DATA_TRANSFER, CONDITION_TRANSFER_START);
+}
+
+bool command_start_round_transfer(const uint8_t *data, size_t len) {
+    // The span table fixes the size, so there is none to send
+    if (!transfer_start(TRANSFER_MODE_ROUND, TRANSFER_ROUND_SIZE)) {
+        command_set_status(false, "Failed to start round image");
+        return false;
+    }
+    
+    return state_machine_transition(STATE_DATA_TRANSFER, CONDITION_TRANSFER_START);
+}
+
+bool command_start_indexed_transfer(const uint8_t *data, size_t len) {
+    uint32_t total_size;
+    if (!command_read_stream_size(data, len, &total_size)) {
+        command_set_status(false, "Indexed image needs a 32-bit size");
+        return false;
+    }
+    
+    // Scanlines are expanded through the palette as their indices arrive
+    if (!transfer_start(TRANSFER_MODE_INDEXED, total_size)) {
+        command_set_status(false, "Failed to start indexed image");
+        return false;
+    }
+    
+    return state_machine_transition(STATE_DATA_TRANSFER, CONDITION_TRANSFER_START);
+}
+
+// The palette fits in one command, and the indices are already on the device
+bool command_update_palette(const uint8_t *data, size_t len) {
+    bool result = transfer_recolor(data, len);
+    command_set_status(result, result ? "Palette updated" : "Failed to update palette");
+    return result;
+}
+
 bool command_process_image_chunk(const uint8_t *data, uint16_t length) {
     if (!g_command_context.in_progress || !data) {
         return false;
@@ -167,44 +331,142 @@ bool command_process_image_chunk(const uint8_t *data, uint16_t length) {
 }
 
 bool command_end_image_transfer(void) {
-    // Validate transfer completion here
+    // Flush the stream and close the display window
+    if (!transfer_complete()) {
+        // An aborted transfer leaves nothing to stay in DATA_TRANSFER for
+        if (transfer_abort()) {
+            state_machine_transition(STATE_READY, CONDITION_TRANSFER_COMPLETE);
+        }
+        command_set_status(false, "Image transfer incomplete");
+        return false;
+    }
     
     // Return to ready state
     return state_machine_transition(STATE_READY, CONDITION_TRANSFER_COMPLETE);
 }
 
-// Pattern commands
+// Pattern commands. A pattern interrupts any transfer in flight: the
+// transfer is aborted, which waits for core1 to finish its chunks, and the
+// device drops back to READY before the pattern takes the panel.
+static bool command_take_panel(void) {
+    pipeline_flush();
+    if (transfer_get_context()->state == TRANSFER_STATE_IDLE) {
+        return true;
+    }
+    transfer_abort();
+    return state_machine_transition(STATE_READY, CONDITION_TRANSFER_COMPLETE);
+}
+
 bool command_show_checkerboard(void) {
+    if (!command_take_panel()) {
+        command_set_status(false, "Failed to stop transfer");
+        return false;
+    }
     bool result = display_draw_test_pattern(TEST_PATTERN_CHECKERBOARD, 0);
     command_set_status(result, result ? "Checkerboard pattern displayed" : "Failed to display checkerboard pattern");
     return result;
 }
 
 bool command_show_stripes(void) {
+    if (!command_take_panel()) {
+        command_set_status(false, "Failed to stop transfer");
+        return false;
+    }
     bool result = display_draw_test_pattern(TEST_PATTERN_COLOR_BARS, 0);
     command_set_status(result, result ? "Color bars pattern displayed" : "Failed to display color bars pattern");
     return result;
 }
 
 bool command_show_gradient(void) {
+    if (!command_take_panel()) {
+        command_set_status(false, "Failed to stop transfer");
+        return false;
+    }
     bool result = display_draw_test_pattern(TEST_PATTERN_GRADIENT, 0);
     command_set_status(result, result ? "Gradient pattern displayed" : "Failed to display gradient pattern");
     return result;
 }
 
-// Help command
+// Help command. One line, so it fits the status message and a single
+// DEBUG packet.
+static const char HELP_TEXT[] =
+    "I image, R region, U delta, Q QOI, B BC1, X indexed, C round (end with E); "
+    "L palette; 1 checkerboard, 2 stripes, 3 gradient; "
+    "T boot timeline, G trace, S stats, P ping, H help";
+
+_Static_assert(sizeof(HELP_TEXT) <= DEBUG_MESSAGE_MAX, "Help text must fit CommandStatus.message");
+
 bool command_show_help(void) {
-    const char *help_text =
-        "Available commands:\n"
-        "I: Start image transfer (RGB565 format, 240×240)\n"
-        "E: End image transfer\n"
-        "1: Show checkerboard pattern\n"
-        "2: Show stripe pattern\n"
-        "3: Show gradient pattern\n"
-        "P: Ping (returns PONG)\n"
-        "H: Display this help message\n";
+    command_set_status(true, HELP_TEXT);
+    
+    Packet response;
+    if (!packet_create_debug(&response, "Help", HELP_TEXT)) {
+        command_set_status(false, "Failed to create help packet");
+        return false;
+    }
+    bool sent = packet_transmit(&response);
+    packet_free(&response);
+    
+    g_command_status.success = sent;
+    return sent;
+}
+
+// Boot timeline command
+bool command_boot_timeline(void) {
+    boot_timeline_format(g_command_status.message, sizeof(g_command_status.message));
+    
+    Packet response;
+    if (!packet_create_debug(&response, "Boot", g_command_status.message)) {
+        command_set_status(false, "Failed to create boot timeline packet");
+        return false;
+    }
+    bool sent = packet_transmit(&response);
+    packet_free(&response);
+    
+    g_command_status.success = sent;
+    return sent;
+}
+
+static bool command_send_trace(const uint8_t *payload, size_t length, void *context) {
+    (void)context;
+    Packet response;
+    if (!packet_create_trace(&response, payload, (uint16_t)length)) {
+        return false;
+    }
+    bool sent = packet_transmit(&response);
+    packet_free(&response);
+    return sent;
+}
+
+// Trace dump command
+bool command_trace_dump(void) {
+    if (!trace_dump(command_send_trace, NULL)) {
+        command_set_status(false, "Failed to send trace dump");
+        return false;
+    }
     
-    strncpy(g_command_status.message, help_text, sizeof(g_command_status.message) - 1);
+    g_command_status.success = true;
+    return true;
+}
+
+// Stats command
+bool command_stats(void) {
+    static uint8_t payload[STATS_PAYLOAD_SIZE];
+    Packet response;
+    if (!stats_encode(payload, sizeof(payload)) ||
+        !packet_create_stats(&response, payload, sizeof(payload))) {
+        command_set_status(false, "Failed to encode stats");
+        return false;
+    }
+    
+    bool sent = packet_transmit(&response);
+    packet_free(&response);
+    if (!sent) {
+        command_set_status(false, "Failed to send stats");
+        return false;
+    }
+    
+    g_command_status.success = true;
     return true;
 }
 
@@ -233,9 +495,19 @@ const char *command_type_to_string(CommandType type) {
     switch (type) {
         case CMD_IMAGE_START:     return "IMAGE_START";
         case CMD_IMAGE_END:       return "IMAGE_END";
+        case CMD_REGION_START:    return "REGION_START";
+        case CMD_DELTA_START:     return "DELTA_START";
+        case CMD_QOI_START:       return "QOI_START";
+        case CMD_BC1_START:       return "BC1_START";
+        case CMD_INDEXED_START:   return "INDEXED_START";
+        case CMD_PALETTE_UPDATE:  return "PALETTE_UPDATE";
+        case CMD_ROUND_START:     return "ROUND_START";
         case CMD_PATTERN_CHECKER: return "PATTERN_CHECKER";
         case CMD_PATTERN_STRIPE:  return "PATTERN_STRIPE";
         case CMD_PATTERN_GRADIENT:return "PATTERN_GRADIENT";
+        case CMD_BOOT_TIMELINE:   return "BOOT_TIMELINE";
+        case CMD_TRACE_DUMP:      return "TRACE_DUMP";
+        case CMD_STATS:           return "STATS";
         case CMD_HELP:           return "HELP";
         case CMD_PING:           return "PING";
         default:                 return "UNKNOWN";
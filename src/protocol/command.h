@@ -13,9 +13,19 @@ typedef enum {
     CMD_IMAGE_START = 'I',    // Start image transfer (RGB565 format, DISPLAY_WIDTH×DISPLAY_HEIGHT)
     CMD_IMAGE_DATA = 'D',     // Image data chunk
     CMD_IMAGE_END = 'E',      // End image transfer
+    CMD_REGION_START = 'R',   // Start region update (u32 LE stream size, ended by 'E')
+    CMD_DELTA_START = 'U',    // Start delta update (u32 LE stream size, ended by 'E')
+    CMD_QOI_START = 'Q',      // Start QOI image transfer (u32 LE stream size, ended by 'E')
+    CMD_BC1_START = 'B',      // Start BC1 image transfer (fixed size, ended by 'E')
+    CMD_INDEXED_START = 'X',  // Start indexed image transfer (u32 LE stream size, ended by 'E')
+    CMD_PALETTE_UPDATE = 'L', // Recolour the last indexed image (first, count - 1, entries)
+    CMD_ROUND_START = 'C',    // Start round image transfer (visible spans only, ended by 'E')
     CMD_PATTERN_CHECKER = '1', // Show checkerboard pattern
     CMD_PATTERN_STRIPE = '2',  // Show stripe pattern
     CMD_PATTERN_GRADIENT = '3',// Show gradient pattern
+    CMD_BOOT_TIMELINE = 'T',  // Report the boot timeline (us per phase)
+    CMD_TRACE_DUMP = 'G',     // Dump the trace rings as TRACE packets
+    CMD_STATS = 'S',          // Report latency histograms and counters as a STATS packet
     CMD_HELP = 'H',           // Display help/command list
     CMD_PING = 'P'            // Ping command for testing
 } CommandType;
@@ -49,6 +59,13 @@ bool command_validate_sequence(const Packet *packet);
 // Image transfer commands
 bool command_start_image_transfer(const uint8_t *data, size_t len);
 bool command_end_image_transfer(void);
+bool command_start_region_transfer(const uint8_t *data, size_t len);
+bool command_start_delta_transfer(const uint8_t *data, size_t len);
+bool command_start_qoi_transfer(const uint8_t *data, size_t len);
+bool command_start_bc1_transfer(const uint8_t *data, size_t len);
+bool command_start_round_transfer(const uint8_t *data, size_t len);
+bool command_start_indexed_transfer(const uint8_t *data, size_t len);
+bool command_update_palette(const uint8_t *data, size_t len);
 
 // Pattern commands
 bool command_show_checkerboard(void);
@@ -58,6 +75,15 @@ bool command_show_gradient(void);
 // Help command
 bool command_show_help(void);
 
+// Boot timeline, sent back as a "Boot" debug packet
+bool command_boot_timeline(void);
+
+// Trace dump, sent back as TRACE packets
+bool command_trace_dump(void);
+
+// Latency histograms and traffic counters, sent back as a STATS packet
+bool command_stats(void);
+
 // Command status
 typedef struct {
     bool success;
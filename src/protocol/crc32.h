@@ -0,0 +1,54 @@
+#ifndef DESKTHANG_CRC32_H
+#define DESKTHANG_CRC32_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// CRC-32 (IEEE 802.3, reflected, poly 0xEDB88320) as used on the wire.
+// Run incrementally: start from CRC32_INIT, feed any number of spans through
+// crc32_update, then crc32_finalize. crc32_compute does all three at once.
+#define CRC32_INIT 0xFFFFFFFFu
+
+// Spans shorter than this stay on the CPU even with the DMA backend selected;
+// below it, channel setup costs more than the sniffer saves
+#define CRC32_DMA_MIN_LENGTH 64
+
+// Byte-at-a-time lookup table, slice 0 of the slice-by-8 tables
+extern const uint32_t crc32_table[256];
+
+typedef enum {
+    CRC32_BACKEND_BYTEWISE,  // One table lookup per byte (reference)
+    CRC32_BACKEND_SLICE8,    // Eight bytes per step, 8 KB of tables
+    CRC32_BACKEND_DMA        // RP2040 DMA sniffer, only on device builds
+} Crc32Backend;
+
+// Build the slice tables and pick the fastest available backend. Safe to
+// skip: the software kernels build their tables on first use.
+void crc32_init(void);
+
+// Returns false (and keeps the current backend) if it isn't available
+bool crc32_set_backend(Crc32Backend backend);
+Crc32Backend crc32_get_backend(void);
+bool crc32_backend_available(Crc32Backend backend);
+
+// Update a running CRC with the active backend
+uint32_t crc32_update(uint32_t crc, const void *data, size_t length);
+
+// Copy src to dst and fold the copied bytes into crc. With the DMA backend
+// the CRC is computed by the sniffer while the DMA moves the data.
+uint32_t crc32_copy(uint32_t crc, void *dst, const void *src, size_t length);
+
+// Individual kernels, regardless of the active backend
+uint32_t crc32_update_bytewise(uint32_t crc, const void *data, size_t length);
+uint32_t crc32_update_slice8(uint32_t crc, const void *data, size_t length);
+
+static inline uint32_t crc32_finalize(uint32_t crc) {
+    return crc ^ 0xFFFFFFFFu;
+}
+
+static inline uint32_t crc32_compute(const void *data, size_t length) {
+    return crc32_finalize(crc32_update(CRC32_INIT, data, length));
+}
+
+#endif // DESKTHANG_CRC32_H
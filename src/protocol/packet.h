@@ -9,6 +9,9 @@
 #include "../error/error.h"
 #include "../system/time.h"  // For deskthang_delay_ms
 #include "../hardware/serial.h"
+#include "cobs.h"
+#include "crc32.h"
+#include "packet_pool.h"
 
 // Add packet-specific constants to deskthang_constants.h first
 // Then update packet.h to use them
@@ -22,9 +25,6 @@
 #define ERROR_PROTOCOL_OVERFLOW 2006
 #define ERROR_PROTOCOL_NACK_RECEIVED 2007
 
-// CRC32 table for checksum calculation
-extern const uint32_t crc32_table[256];
-
 // Message types
 typedef enum {
     MESSAGE_TYPE_DEBUG = 'D',
@@ -40,6 +40,10 @@ typedef enum {
 #define MAX_MODULE_NAME 32
 #define MAX_MESSAGE_SIZE 256
 
+#if MAX_PAYLOAD_SIZE > PACKET_POOL_SLAB_SIZE
+#error "Packet pool slabs must hold MAX_PAYLOAD_SIZE"
+#endif
+
 // Message structure
 typedef struct {
     MessageType type;
@@ -56,7 +60,10 @@ typedef enum {
     PACKET_TYPE_ACK,      // Positive acknowledgment
     PACKET_TYPE_NACK,     // Negative acknowledgment
     PACKET_TYPE_ERROR,    // System/hardware error reports
-    PACKET_TYPE_SYNC      // Protocol synchronization
+    PACKET_TYPE_SYNC,     // Protocol synchronization
+    PACKET_TYPE_LOG,      // Binary log event, formatted by the host
+    PACKET_TYPE_TRACE,    // Part of a trace dump, see debug/trace.h
+    PACKET_TYPE_STATS     // Latency histograms and counters, see debug/stats.h
 } PacketType;
 
 // Packet flags
@@ -76,9 +83,12 @@ typedef struct {
 // Complete packet structure
 typedef struct {
     PacketHeader header;  // Start metadata
-    uint8_t *payload;     // Variable length payload
+    uint8_t *payload;     // Variable length payload: inline_payload or a pool slab
     uint32_t checksum;    // End metadata - checksum
     uint8_t end_marker;   // End metadata - marker
+    bool validated;       // Payload CRC already checked on receipt or set at
+                          // creation; packet_validate won't recompute it
+    uint8_t inline_payload[PACKET_INLINE_PAYLOAD_SIZE];  // Small payloads, no slab
 } Packet;
 
 // Debug payload structure (for heartbeat and status messages)
@@ -94,6 +104,34 @@ typedef struct {
     uint8_t context[14];  // Additional error context
 } NackPayload;
 
+// Wire framing. v1 is the escaped format with a hex checksum that the debug
+// monitor reads; the device boots in v1. v2 is negotiated during SYNC: a
+// packed little-endian header, the payload, a raw CRC32 trailer, all COBS
+// encoded and terminated by a single 0x00.
+#define PACKET_FRAMING_V1 1
+#define PACKET_FRAMING_V2 2
+
+#define PACKET_V1_START_MARKER '~'
+#define PACKET_V1_END_MARKER '\n'
+#define PACKET_V1_ESCAPE_CHAR '\\'  // Next byte is XORed with 0x20
+#define PACKET_V1_TRAILER_SIZE 9  // ' ' + 8 hex checksum digits
+// Header and payload fully escaped, the trailer and the end marker
+#define PACKET_V1_MAX_FRAME_SIZE (2 * (sizeof(PacketHeader) + MAX_PAYLOAD_SIZE) + PACKET_V1_TRAILER_SIZE + 1)
+
+#define PACKET_V2_HEADER_SIZE 4   // type, sequence, length (u16 LE)
+#define PACKET_V2_CRC_SIZE 4      // CRC32 of header + payload (u32 LE)
+#define PACKET_V2_MAX_RAW_SIZE (PACKET_V2_HEADER_SIZE + MAX_PAYLOAD_SIZE + PACKET_V2_CRC_SIZE)
+#define PACKET_V2_MAX_FRAME_SIZE (COBS_MAX_ENCODED_SIZE(PACKET_V2_MAX_RAW_SIZE) + 1)
+
+void packet_set_framing(uint8_t framing);
+uint8_t packet_get_framing(void);
+size_t packet_encode_v2(const Packet *packet, uint8_t *frame, size_t frame_size);
+bool packet_decode_v2(uint8_t *frame, size_t length, Packet *packet);
+bool packet_decode_v1(const uint8_t *frame, size_t length, Packet *packet);
+
+// Hand a packet and its payload over to dst; src is left empty
+void packet_move(Packet *dst, Packet *src);
+
 // Packet buffer management
 bool packet_buffer_init(void);
 void packet_buffer_reset(void);
@@ -110,13 +148,20 @@ bool packet_create_debug(Packet *packet, const char *module, const char *message
 bool packet_create_command(Packet *packet, const char *command);
 bool packet_create_data(Packet *packet, const uint8_t *data, uint16_t length);
 bool packet_create_ack(Packet *packet, uint8_t sequence);
-bool packet_create_nack(const Packet *packet, uint8_t sequence, const char *error);
+bool packet_create_window_ack(Packet *packet, uint8_t sequence, uint16_t next_chunk, uint32_t sack_bitmap);
 bool packet_create_error(Packet *packet, const char *module, const char *error);
+bool packet_create_log(Packet *packet, uint32_t timestamp_us, uint16_t site, const uint8_t *args, uint8_t length);
 bool packet_create_sync(Packet *packet, uint8_t version);
+bool packet_create_trace(Packet *packet, const uint8_t *payload, uint16_t length);
+bool packet_create_stats(Packet *packet, const uint8_t *payload, uint16_t length);
+
+// Build, transmit and free a NACK carrying the error text
+bool packet_send_nack(uint8_t sequence, const char *error);
 
 // Packet validation
 bool packet_validate(const Packet *packet);
 uint32_t packet_calculate_checksum(const Packet *packet);
+bool packet_checksum_valid(const Packet *packet);
 
 // Packet transmission
 bool packet_transmit(const Packet *packet);
@@ -152,7 +197,8 @@ bool packet_get_transmission_stats(PacketTransmissionStats* stats);
 void packet_print(const Packet *packet);
 const char *packet_type_to_string(PacketType type);
 
-// Cleanup
+// Cleanup: returns the payload slab to the pool. Packets own their payload
+// storage, so pass them by pointer rather than copying them.
 void packet_free(Packet *packet);
 
 // Function declarations
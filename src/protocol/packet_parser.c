@@ -0,0 +1,155 @@
+#include "packet_parser.h"
+#include <string.h>
+#include "../hardware/serial.h"
+#include "../error/logging.h"
+#include "../debug/trace.h"
+#include "../debug/stats.h"
+#include "../system/time.h"
+
+void packet_parser_init(PacketParser *parser, PacketParserCallback callback, void *context) {
+    if (!parser) {
+        return;
+    }
+    
+    memset(parser, 0, sizeof(PacketParser));
+    parser->callback = callback;
+    parser->context = context;
+}
+
+// Drop any partial frame; callback and statistics are kept
+void packet_parser_reset(PacketParser *parser) {
+    if (!parser) {
+        return;
+    }
+    
+    parser->length = 0;
+    parser->in_frame = false;
+    parser->escape = false;
+    parser->discarding = false;
+}
+
+// Decode the buffered frame and hand it to the callback
+static bool packet_parser_emit(PacketParser *parser) {
+    Packet packet;
+    bool decoded;
+    uint32_t start_us = deskthang_time_get_us();
+    
+    TRACE_BEGIN(PACKET_DECODE, parser->length);
+    if (parser->framing == PACKET_FRAMING_V2) {
+        // v1 escapes its own start marker, so a v1 frame opens with
+        // ESCAPE_CHAR, '~' ^ 0x20. Check before the in-place decode.
+        bool v1_start = parser->length >= 2 &&
+                        parser->buffer[0] == PACKET_V1_ESCAPE_CHAR &&
+                        parser->buffer[1] == (PACKET_V1_START_MARKER ^ 0x20);
+        decoded = packet_decode_v2(parser->buffer, parser->length, &packet);
+        
+        // A restarted host syncs in v1 again; drop back so it can renegotiate
+        if (!decoded && v1_start) {
+            logging_write("Packet", "v1 frame seen, falling back to v1 framing");
+            packet_set_framing(PACKET_FRAMING_V1);
+        }
+    } else {
+        // An escape right before the end marker is a truncated frame
+        decoded = !parser->escape && packet_decode_v1(parser->buffer, parser->length, &packet);
+    }
+    TRACE_END(PACKET_DECODE, decoded);
+    stats_latency_record(STATS_LATENCY_PARSE, deskthang_time_get_us() - start_us);
+    stats_count_rx_packet(decoded);
+    
+    if (!decoded) {
+        parser->stats.frames_dropped++;
+        return false;
+    }
+    
+    parser->stats.packets++;
+    stats_mark_rx_frame();
+    if (parser->callback) {
+        parser->callback(&packet, parser->context);
+    }
+    packet_free(&packet);
+    return true;
+}
+
+size_t packet_parser_feed(PacketParser *parser, const uint8_t *data, size_t length) {
+    if (!parser || !data) {
+        return 0;
+    }
+    
+    size_t emitted = 0;
+    parser->stats.bytes_received += length;
+    stats_count_rx(length);
+    
+    for (size_t i = 0; i < length; i++) {
+        uint8_t byte = data[i];
+        
+        // Framing can change between frames (SYNC ACK), never inside one
+        if (!parser->in_frame) {
+            parser->framing = packet_get_framing();
+            parser->in_frame = true;
+        }
+        
+        uint8_t delimiter = (parser->framing == PACKET_FRAMING_V2) ? COBS_DELIMITER : PACKET_V1_END_MARKER;
+        if (byte == delimiter) {
+            // Back-to-back delimiters are idle line noise, not errors
+            if (!parser->discarding && (parser->length > 0 || parser->escape) &&
+                packet_parser_emit(parser)) {
+                emitted++;
+            }
+            packet_parser_reset(parser);
+            continue;
+        }
+        
+        if (parser->discarding) {
+            continue;
+        }
+        
+        if (parser->framing == PACKET_FRAMING_V1) {
+            if (parser->escape) {
+                byte ^= 0x20;
+                parser->escape = false;
+            } else if (byte == PACKET_V1_ESCAPE_CHAR) {
+                parser->escape = true;
+                continue;
+            }
+        }
+        
+        if (parser->length >= sizeof(parser->buffer)) {
+            parser->stats.overflows++;
+            parser->discarding = true;
+            continue;
+        }
+        parser->buffer[parser->length++] = byte;
+    }
+    
+    return emitted;
+}
+
+size_t packet_parser_poll(PacketParser *parser) {
+    if (!parser) {
+        return 0;
+    }
+    
+    // Bounded so a continuous stream can't starve the rest of the main loop
+    uint8_t chunk[PACKET_PARSER_READ_SIZE];
+    size_t emitted = 0;
+    size_t total = 0;
+    TRACE_BEGIN(RX_POLL, 0);
+    while (total < PACKET_PARSER_BUFFER_SIZE) {
+        size_t count = serial_read_available(chunk, sizeof(chunk));
+        if (count == 0) {
+            break;
+        }
+        emitted += packet_parser_feed(parser, chunk, count);
+        total += count;
+    }
+    TRACE_END(RX_POLL, total);
+    return emitted;
+}
+
+bool packet_parser_in_frame(const PacketParser *parser) {
+    return parser && parser->in_frame && (parser->length > 0 || parser->escape);
+}
+
+const PacketParserStats *packet_parser_get_stats(const PacketParser *parser) {
+    return parser ? &parser->stats : NULL;
+}
@@ -0,0 +1,60 @@
+#ifndef DESKTHANG_PACKET_PARSER_H
+#define DESKTHANG_PACKET_PARSER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+#include "packet.h"
+
+// Resumable receive-side parser. Feed it whatever bytes the serial port has,
+// in spans of any size; partial frames are kept between calls and every
+// completed packet is handed to the callback. Nothing here waits for data.
+//
+// Frames are delimited ('\n' in v1, 0x00 in v2) and the delimiter can't
+// occur inside a frame, so a corrupt or oversized frame costs exactly its
+// own bytes: the parser drops to the next delimiter and carries on.
+
+// Largest frame either framing produces (v1 is counted unescaped)
+#define PACKET_PARSER_V1_MAX_SIZE (sizeof(PacketHeader) + MAX_PAYLOAD_SIZE + PACKET_V1_TRAILER_SIZE)
+#define PACKET_PARSER_BUFFER_SIZE \
+    (PACKET_PARSER_V1_MAX_SIZE > PACKET_V2_MAX_FRAME_SIZE ? PACKET_PARSER_V1_MAX_SIZE : PACKET_V2_MAX_FRAME_SIZE)
+
+// Bytes pulled from serial per read in packet_parser_poll
+#define PACKET_PARSER_READ_SIZE 64
+
+// The packet is only valid during the call and is freed afterwards; use
+// packet_move to keep it
+typedef void (*PacketParserCallback)(Packet *packet, void *context);
+
+typedef struct {
+    uint32_t bytes_received;
+    uint32_t packets;         // Packets handed to the callback
+    uint32_t frames_dropped;  // Frames that failed decoding or checksum
+    uint32_t overflows;       // Frames longer than the buffer
+} PacketParserStats;
+
+typedef struct {
+    uint8_t buffer[PACKET_PARSER_BUFFER_SIZE];
+    size_t length;          // Bytes of the current frame so far
+    uint8_t framing;        // Framing of the current frame, fixed at its first byte
+    bool in_frame;
+    bool escape;            // v1: last byte was ESCAPE_CHAR
+    bool discarding;        // Skipping to the next delimiter after an overflow
+    PacketParserCallback callback;
+    void *context;
+    PacketParserStats stats;
+} PacketParser;
+
+void packet_parser_init(PacketParser *parser, PacketParserCallback callback, void *context);
+void packet_parser_reset(PacketParser *parser);
+
+// Consume a span and emit every packet it completes. Returns packets emitted.
+size_t packet_parser_feed(PacketParser *parser, const uint8_t *data, size_t length);
+
+// Feed whatever serial has right now, without waiting. Returns packets emitted.
+size_t packet_parser_poll(PacketParser *parser);
+
+bool packet_parser_in_frame(const PacketParser *parser);
+const PacketParserStats *packet_parser_get_stats(const PacketParser *parser);
+
+#endif // DESKTHANG_PACKET_PARSER_H
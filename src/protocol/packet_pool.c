@@ -0,0 +1,96 @@
+#include "packet_pool.h"
+#include <string.h>
+
+#if PACKET_POOL_SLAB_COUNT > 32
+#error "PACKET_POOL_SLAB_COUNT must fit the 32-bit in-use mask"
+#endif
+
+#if PACKET_POOL_SLAB_SIZE % 4 != 0
+#error "PACKET_POOL_SLAB_SIZE must be a multiple of 4"
+#endif
+
+// Slabs are words so payloads start aligned for the CRC and DMA paths
+static uint32_t g_slabs[PACKET_POOL_SLAB_COUNT][PACKET_POOL_SLAB_SIZE / 4];
+
+static struct {
+    bool initialized;
+    uint8_t free_stack[PACKET_POOL_SLAB_COUNT];
+    uint8_t free_count;
+    uint32_t in_use_mask;  // Catches double releases
+    PacketPoolStats stats;
+} g_pool;
+
+void packet_pool_init(void) {
+    memset(&g_pool, 0, sizeof(g_pool));
+    
+    // Hand out low slabs first
+    for (uint8_t i = 0; i < PACKET_POOL_SLAB_COUNT; i++) {
+        g_pool.free_stack[i] = PACKET_POOL_SLAB_COUNT - 1 - i;
+    }
+    g_pool.free_count = PACKET_POOL_SLAB_COUNT;
+    g_pool.stats.slabs_total = PACKET_POOL_SLAB_COUNT;
+    g_pool.initialized = true;
+}
+
+uint8_t *packet_pool_acquire(void) {
+    if (!g_pool.initialized) {
+        packet_pool_init();
+    }
+    
+    if (g_pool.free_count == 0) {
+        g_pool.stats.exhausted++;
+        return NULL;
+    }
+    
+    uint8_t index = g_pool.free_stack[--g_pool.free_count];
+    g_pool.in_use_mask |= (1u << index);
+    
+    g_pool.stats.acquired++;
+    g_pool.stats.slabs_in_use++;
+    if (g_pool.stats.slabs_in_use > g_pool.stats.high_water) {
+        g_pool.stats.high_water = g_pool.stats.slabs_in_use;
+    }
+    
+    return (uint8_t*)g_slabs[index];
+}
+
+// Slab index for ptr, -1 if it isn't the start of a slab
+static int packet_pool_index(const uint8_t *ptr) {
+    const uint8_t *base = (const uint8_t*)g_slabs;
+    if (!ptr || ptr < base || ptr >= base + sizeof(g_slabs)) {
+        return -1;
+    }
+    
+    size_t offset = (size_t)(ptr - base);
+    if (offset % PACKET_POOL_SLAB_SIZE != 0) {
+        return -1;
+    }
+    return (int)(offset / PACKET_POOL_SLAB_SIZE);
+}
+
+bool packet_pool_release(uint8_t *slab) {
+    int index = packet_pool_index(slab);
+    if (index < 0 || !(g_pool.in_use_mask & (1u << index))) {
+        g_pool.stats.invalid_releases++;
+        return false;
+    }
+    
+    g_pool.in_use_mask &= ~(1u << index);
+    g_pool.free_stack[g_pool.free_count++] = (uint8_t)index;
+    g_pool.stats.slabs_in_use--;
+    return true;
+}
+
+bool packet_pool_owns(const uint8_t *ptr) {
+    return packet_pool_index(ptr) >= 0;
+}
+
+void packet_pool_get_stats(PacketPoolStats *stats) {
+    if (!stats) {
+        return;
+    }
+    if (!g_pool.initialized) {
+        packet_pool_init();
+    }
+    *stats = g_pool.stats;
+}
@@ -0,0 +1,46 @@
+#ifndef DESKTHANG_PACKET_POOL_H
+#define DESKTHANG_PACKET_POOL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Fixed pool of payload slabs for the packet layer, replacing malloc/free.
+// Sized at compile time; acquire and release are O(1) pops/pushes on a free
+// stack. Payloads of PACKET_INLINE_PAYLOAD_SIZE bytes or less (ACK, NACK,
+// SYNC) never touch the pool, they live inside the Packet itself.
+#ifndef PACKET_POOL_SLAB_SIZE
+#define PACKET_POOL_SLAB_SIZE 1024  // Must hold MAX_PAYLOAD_SIZE
+#endif
+
+#ifndef PACKET_POOL_SLAB_COUNT
+#define PACKET_POOL_SLAB_COUNT 6    // Received packet, its response, a log line, spare
+#endif
+
+#ifndef PACKET_INLINE_PAYLOAD_SIZE
+#define PACKET_INLINE_PAYLOAD_SIZE 16
+#endif
+
+typedef struct {
+    uint16_t slabs_total;
+    uint16_t slabs_in_use;
+    uint16_t high_water;       // Most slabs held at once since init
+    uint32_t acquired;         // Successful acquisitions
+    uint32_t exhausted;        // Acquisitions refused because the pool was empty
+    uint32_t invalid_releases; // Releases of pointers the pool doesn't own
+} PacketPoolStats;
+
+// Return every slab to the pool and clear the statistics. Runs on first use
+// if not called; don't call it while packets are still held.
+void packet_pool_init(void);
+
+// Word-aligned slab of PACKET_POOL_SLAB_SIZE bytes, NULL when exhausted
+uint8_t *packet_pool_acquire(void);
+
+// False (and counted) if the pointer isn't a held slab
+bool packet_pool_release(uint8_t *slab);
+
+bool packet_pool_owns(const uint8_t *ptr);
+void packet_pool_get_stats(PacketPoolStats *stats);
+
+#endif // DESKTHANG_PACKET_POOL_H
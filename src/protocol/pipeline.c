@@ -0,0 +1,254 @@
+#include "pipeline.h"
+#include "../hardware/serial_ring.h"
+#include "../system/platform.h"
+#include "../debug/trace.h"
+#include "../debug/stats.h"
+#include "../system/time.h"
+#include <string.h>
+
+#if PIPELINE_BUFFER_COUNT > 256 || (PIPELINE_BUFFER_COUNT & (PIPELINE_BUFFER_COUNT - 1)) != 0
+#error "PIPELINE_BUFFER_COUNT must be a power of two that fits a byte index"
+#endif
+
+static PipelineBuffer g_buffers[PIPELINE_BUFFER_COUNT];
+
+// Buffer indices: filled ones from core0 to core1, decoded ones back. Each
+// ring holds the whole pool, so a write never finds it full.
+static uint8_t g_filled_storage[PIPELINE_BUFFER_COUNT];
+static uint8_t g_returned_storage[PIPELINE_BUFFER_COUNT];
+
+static struct {
+    bool initialized;
+    bool running;
+    volatile uint32_t stopping;  // Core1 returns when set
+    SerialRing filled;
+    SerialRing returned;
+
+    // Core0 only
+    uint8_t free_stack[PIPELINE_BUFFER_COUNT];
+    uint8_t free_count;
+    PipelineSink sink;
+    void *context;
+    uint32_t submitted;
+    uint32_t producer_waits;
+    uint32_t producer_misses;
+    uint16_t queue_high_water;
+
+    // Written by whichever side decodes
+    volatile uint32_t consumed;
+    volatile uint32_t failures;
+    volatile uint32_t failed;  // Since pipeline_begin
+} g_pipeline;
+
+static inline uint32_t load_acquire(const volatile uint32_t *value) {
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+}
+
+static inline void store_release(volatile uint32_t *value, uint32_t new_value) {
+    __atomic_store_n(value, new_value, __ATOMIC_RELEASE);
+}
+
+bool pipeline_init(void) {
+    if (g_pipeline.running) {
+        return false;
+    }
+
+    memset(&g_pipeline, 0, sizeof(g_pipeline));
+    serial_ring_init(&g_pipeline.filled, g_filled_storage, sizeof(g_filled_storage));
+    serial_ring_init(&g_pipeline.returned, g_returned_storage, sizeof(g_returned_storage));
+
+    // Hand out low buffers first
+    for (int i = 0; i < PIPELINE_BUFFER_COUNT; i++) {
+        g_buffers[i].index = (uint8_t)i;
+        g_pipeline.free_stack[i] = (uint8_t)(PIPELINE_BUFFER_COUNT - 1 - i);
+    }
+    g_pipeline.free_count = PIPELINE_BUFFER_COUNT;
+    g_pipeline.initialized = true;
+    return true;
+}
+
+static void pipeline_ensure_init(void) {
+    if (!g_pipeline.initialized) {
+        pipeline_init();
+    }
+}
+
+// Run the sink unless an earlier chunk already failed, then account for it
+static void pipeline_decode(PipelineBuffer *buffer) {
+    if (!load_acquire(&g_pipeline.failed)) {
+        TRACE_BEGIN(CHUNK_DECODE, buffer->chunk);
+        bool decoded = g_pipeline.sink &&
+                       g_pipeline.sink(buffer->data, buffer->length, g_pipeline.context);
+        TRACE_END(CHUNK_DECODE, decoded);
+        stats_latency_record(STATS_LATENCY_CHUNK, deskthang_time_get_us() - buffer->queued_us);
+        if (!decoded) {
+            store_release(&g_pipeline.failures, g_pipeline.failures + 1);
+            store_release(&g_pipeline.failed, 1);
+        }
+    }
+}
+
+bool pipeline_service(void) {
+    uint8_t index;
+    if (serial_ring_read(&g_pipeline.filled, &index, 1) != 1) {
+        return false;
+    }
+
+    pipeline_decode(&g_buffers[index]);
+
+    serial_ring_write(&g_pipeline.returned, &index, 1);
+    store_release(&g_pipeline.consumed, g_pipeline.consumed + 1);
+    platform_core_signal();
+    return true;
+}
+
+// Core1 entry: decode until told to stop, sleeping while the queue is empty
+static void pipeline_core_main(void) {
+    while (!load_acquire(&g_pipeline.stopping)) {
+        if (!pipeline_service()) {
+            platform_core_wait();
+        }
+    }
+}
+
+bool pipeline_start(void) {
+    pipeline_ensure_init();
+    if (g_pipeline.running) {
+        return false;
+    }
+
+    // Set first so submits made from here on are queued
+    g_pipeline.running = true;
+    if (!platform_core_launch(pipeline_core_main)) {
+        g_pipeline.running = false;
+        return false;
+    }
+    return true;
+}
+
+void pipeline_stop(void) {
+    if (!g_pipeline.running) {
+        return;
+    }
+
+    pipeline_flush();
+    store_release(&g_pipeline.stopping, 1);
+    platform_core_signal();
+    platform_core_join();
+    g_pipeline.running = false;
+    store_release(&g_pipeline.stopping, 0);
+}
+
+bool pipeline_is_running(void) {
+    return g_pipeline.running;
+}
+
+bool pipeline_begin(PipelineSink sink, void *context) {
+    pipeline_ensure_init();
+    pipeline_flush();
+
+    // Core1 is idle, and sees these before the next index it reads
+    g_pipeline.sink = sink;
+    g_pipeline.context = context;
+    store_release(&g_pipeline.failed, 0);
+    return sink != NULL;
+}
+
+// Take back everything core1 has returned
+static void pipeline_reclaim(void) {
+    uint8_t index;
+    while (serial_ring_read(&g_pipeline.returned, &index, 1) == 1) {
+        g_pipeline.free_stack[g_pipeline.free_count++] = index;
+    }
+}
+
+PipelineBuffer *pipeline_acquire(void) {
+    pipeline_ensure_init();
+    pipeline_reclaim();
+
+    if (g_pipeline.free_count == 0) {
+        // Every buffer is parked or queued: wait for core1, if it has any
+        if (!g_pipeline.running || load_acquire(&g_pipeline.consumed) == g_pipeline.submitted) {
+            return NULL;
+        }
+        g_pipeline.producer_waits++;
+        while (g_pipeline.free_count == 0) {
+            platform_core_wait();
+            pipeline_reclaim();
+        }
+    }
+
+    return &g_buffers[g_pipeline.free_stack[--g_pipeline.free_count]];
+}
+
+PipelineBuffer *pipeline_try_acquire(void) {
+    pipeline_ensure_init();
+    pipeline_reclaim();
+
+    if (g_pipeline.free_count == 0) {
+        g_pipeline.producer_misses++;
+        return NULL;
+    }
+    return &g_buffers[g_pipeline.free_stack[--g_pipeline.free_count]];
+}
+
+void pipeline_release(PipelineBuffer *buffer) {
+    if (!buffer || g_pipeline.free_count >= PIPELINE_BUFFER_COUNT) {
+        return;
+    }
+    g_pipeline.free_stack[g_pipeline.free_count++] = buffer->index;
+}
+
+bool pipeline_submit(PipelineBuffer *buffer) {
+    if (!buffer) {
+        return false;
+    }
+    g_pipeline.submitted++;
+    buffer->queued_us = deskthang_time_get_us();
+
+    // No second core: decode here and now
+    if (!g_pipeline.running) {
+        pipeline_decode(buffer);
+        g_pipeline.consumed++;
+        pipeline_release(buffer);
+        return !g_pipeline.failed;
+    }
+
+    uint8_t index = buffer->index;
+    serial_ring_write(&g_pipeline.filled, &index, 1);
+    platform_core_signal();
+
+    uint32_t depth = g_pipeline.submitted - load_acquire(&g_pipeline.consumed);
+    if (depth > g_pipeline.queue_high_water) {
+        g_pipeline.queue_high_water = (uint16_t)depth;
+    }
+    return !load_acquire(&g_pipeline.failed);
+}
+
+bool pipeline_flush(void) {
+    if (g_pipeline.running) {
+        while (load_acquire(&g_pipeline.consumed) != g_pipeline.submitted) {
+            platform_core_wait();
+        }
+    }
+    return !load_acquire(&g_pipeline.failed);
+}
+
+bool pipeline_failed(void) {
+    return load_acquire(&g_pipeline.failed) != 0;
+}
+
+void pipeline_get_stats(PipelineStats *stats) {
+    if (!stats) {
+        return;
+    }
+    pipeline_ensure_init();
+
+    stats->submitted = g_pipeline.submitted;
+    stats->consumed = load_acquire(&g_pipeline.consumed);
+    stats->failures = load_acquire(&g_pipeline.failures);
+    stats->producer_waits = g_pipeline.producer_waits;
+    stats->producer_misses = g_pipeline.producer_misses;
+    stats->buffers_free = g_pipeline.free_count + (uint16_t)serial_ring_count(&g_pipeline.returned);
+    stats->queue_high_water = g_pipeline.queue_high_water;
+}
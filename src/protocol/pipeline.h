@@ -0,0 +1,88 @@
+#ifndef DESKTHANG_PIPELINE_H
+#define DESKTHANG_PIPELINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../common/deskthang_constants.h"
+
+// Chunk pipeline between the cores. Core0 owns USB, parsing, validation and
+// ACKs; it copies each in-order chunk into a pooled buffer and queues the
+// buffer's index for core1, which decodes it onto the panel and queues the
+// index back. Both queues are SPSC rings, so neither side takes a lock.
+//
+// The panel belongs to core1 while chunks are queued. Core0 may only touch
+// it (opening or finishing a transfer, commands) after pipeline_flush has
+// seen core1 drain the queue.
+//
+// Until pipeline_start runs, pipeline_submit decodes inline on the caller,
+// so single-core builds and tests see the same results synchronously.
+#ifndef PIPELINE_BUFFER_COUNT
+#define PIPELINE_BUFFER_COUNT 16  // Reorder slots plus chunks queued for core1
+#endif
+
+typedef struct {
+    uint8_t data[CHUNK_SIZE];
+    uint16_t length;
+    uint16_t chunk;   // Chunk index, for tracing and ordering checks
+    uint8_t index;    // Own slot in the pool
+    uint32_t queued_us;  // When pipeline_submit took it, for chunk latency
+} PipelineBuffer;
+
+// Decodes one chunk, on core1. Returns false to fail the transfer.
+typedef bool (*PipelineSink)(const uint8_t *data, uint16_t length, void *context);
+
+typedef struct {
+    uint32_t submitted;       // Buffers queued (or decoded inline)
+    uint32_t consumed;        // Buffers decoded and returned
+    uint32_t failures;        // Sink calls that returned false
+    uint32_t producer_waits;  // Acquires that waited for core1 to return a buffer
+    uint32_t producer_misses; // Try-acquires that found no buffer free
+    uint16_t buffers_free;    // Buffers core0 could acquire now
+    uint16_t queue_high_water;  // Most buffers queued for core1 at once
+} PipelineStats;
+
+// Return every buffer to the pool and clear the statistics. Runs on first
+// use if not called; fails while core1 is running.
+bool pipeline_init(void);
+
+// Launch the consumer on core1. False if already running.
+bool pipeline_start(void);
+
+// Drain the queue, then stop core1 and wait for it to exit
+void pipeline_stop(void);
+
+bool pipeline_is_running(void);
+
+// Core0: wait for core1 to drain the queue, then route the next chunks to
+// sink with a cleared error. Call before each transfer.
+bool pipeline_begin(PipelineSink sink, void *context);
+
+// Core0: a free buffer. Waits for core1 to return one when the pool is
+// empty; NULL only if none can come back.
+PipelineBuffer *pipeline_acquire(void);
+
+// Core0: a free buffer, or NULL at once if core1 still holds them all.
+// Windowed transfers use this and hold back the chunk's ACK instead, so a
+// slow decode throttles the host without stalling USB and the scheduler.
+PipelineBuffer *pipeline_try_acquire(void);
+
+// Core0: hand back a buffer that won't be submitted
+void pipeline_release(PipelineBuffer *buffer);
+
+// Core0: queue buffer for the sink; ownership passes with it. False if this
+// chunk (inline) or an earlier one (on core1) failed.
+bool pipeline_submit(PipelineBuffer *buffer);
+
+// Core0: wait until core1 has decoded everything queued. False if any chunk
+// failed since pipeline_begin.
+bool pipeline_flush(void);
+
+// A chunk failed since pipeline_begin
+bool pipeline_failed(void);
+
+// Core1: decode one queued buffer. False if the queue was empty.
+bool pipeline_service(void);
+
+void pipeline_get_stats(PipelineStats *stats);
+
+#endif // DESKTHANG_PIPELINE_H
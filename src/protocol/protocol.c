@@ -162,8 +162,8 @@ bool protocol_validate_packet(const Packet *packet) {
     
     // Protocol-specific validation
     if (packet->header.type == PACKET_TYPE_SYNC) {
-        // Sync packets must have exactly 1 byte payload (version)
-        if (packet->header.length != 1) {
+        // Sync packets carry the version and optionally the requested framing
+        if (packet->header.length != 1 && packet->header.length != 2) {
             return false;
         }
         // Version must match
@@ -172,8 +172,10 @@ bool protocol_validate_packet(const Packet *packet) {
         }
     }
     
-    // Sequence validation (except for SYNC which can reset sequence)
-    if (packet->header.type != PACKET_TYPE_SYNC) {
+    // Sequence validation (except for SYNC which can reset sequence, and
+    // DATA which the transfer layer orders by chunk index)
+    if (packet->header.type != PACKET_TYPE_SYNC &&
+        packet->header.type != PACKET_TYPE_DATA) {
         uint8_t expected = g_protocol_config.sequence + 1;
         if (packet->header.sequence != expected) {
             return false;
@@ -185,7 +187,7 @@ bool protocol_validate_packet(const Packet *packet) {
 
 bool protocol_process_packet(const Packet *packet) {
     if (!protocol_validate_packet(packet)) {
-        packet_create_nack(packet, packet->header.sequence, "Invalid packet");
+        packet_send_nack(packet->header.sequence, "Invalid packet");
         return false;
     }
     
@@ -197,7 +199,7 @@ bool protocol_process_packet(const Packet *packet) {
             
         case PACKET_TYPE_COMMAND:
             if (!has_valid_sync) {
-                packet_create_nack(packet, packet->header.sequence, "Not synchronized");
+                packet_send_nack(packet->header.sequence, "Not synchronized");
                 return false;
             }
             result = handle_command_packet(packet);
@@ -205,7 +207,7 @@ bool protocol_process_packet(const Packet *packet) {
             
         case PACKET_TYPE_DATA:
             if (!has_valid_sync) {
-                packet_create_nack(packet, packet->header.sequence, "Not synchronized");
+                packet_send_nack(packet->header.sequence, "Not synchronized");
                 return false;
             }
             result = handle_data_packet(packet);
@@ -216,11 +218,11 @@ bool protocol_process_packet(const Packet *packet) {
             break;
             
         default:
-            packet_create_nack(packet, packet->header.sequence, "Unknown packet type");
+            packet_send_nack(packet->header.sequence, "Unknown packet type");
             return false;
     }
     
-    if (result) {
+    if (result && packet->header.type != PACKET_TYPE_DATA) {
         g_protocol_config.sequence = packet->header.sequence;
     }
     
@@ -234,35 +236,88 @@ static bool handle_sync_packet(const Packet *packet) {
     protocol_reset();
     has_valid_sync = true;
     
-    // Send ACK
+    // A host that asks for v2 framing gets it; anything else stays on v1
+    uint8_t framing = PACKET_FRAMING_V1;
+    if (packet->header.length >= 2 && packet->payload[1] == PACKET_FRAMING_V2) {
+        framing = PACKET_FRAMING_V2;
+    }
+    
+    // ACK with the chosen framing, still in the framing the SYNC arrived in
     Packet response;
-    if (!packet_create_ack(&response, packet->header.sequence)) {
+    if (!packet_create(&response, PACKET_TYPE_ACK, packet->header.sequence, &framing, 1)) {
         return false;
     }
     
-    return packet_transmit(&response);
+    bool sent = packet_transmit(&response);
+    packet_free(&response);
+    if (!sent) {
+        return false;
+    }
+    packet_set_framing(framing);
+    
+    // The first SYNC takes the device from IDLE to READY; a host that
+    // re-syncs later only gets its ACK
+    if (state_machine_get_current() == STATE_IDLE) {
+        return state_machine_transition(STATE_SYNCING, CONDITION_SYNC_RECEIVED) &&
+               state_machine_transition(STATE_READY, CONDITION_SYNC_VALID);
+    }
+    return true;
 }
 
 static bool handle_command_packet(const Packet *packet) {
-    // Command processing would go here
-    // For now, just ACK
+    // The first payload byte names the command, the rest are its arguments
+    if (!packet->payload || packet->header.length == 0) {
+        return packet_send_nack(packet->header.sequence, "Empty command");
+    }
+    
+    // A command that fails is answered with a NACK but leaves the link up;
+    // the host sees why and can carry on
+    if (!command_process(packet->payload, packet->header.length)) {
+        const char *reason = command_get_status()->message;
+        return packet_send_nack(packet->header.sequence,
+                                reason[0] ? reason : "Command failed");
+    }
+    
+    // Commands that answer with data (T, G, S) have sent it already
     Packet response;
     if (!packet_create_ack(&response, packet->header.sequence)) {
         return false;
     }
     
-    return packet_transmit(&response);
+    bool sent = packet_transmit(&response);
+    packet_free(&response);
+    return sent;
 }
 
 static bool handle_data_packet(const Packet *packet) {
-    // Data processing would go here
-    // For now, just ACK
+    // Hand chunks of an active transfer to the transfer layer
+    TransferContext *transfer = transfer_get_context();
+    if (transfer->state != TRANSFER_STATE_IDLE) {
+        if (!transfer_process_chunk(packet)) {
+            packet_send_nack(packet->header.sequence, "Chunk rejected");
+            return false;
+        }
+    }
+    
+    // Windowed chunks are answered with the cumulative/selective ACK so the
+    // host only retransmits what is actually missing
     Packet response;
-    if (!packet_create_ack(&response, packet->header.sequence)) {
+    bool created;
+    if (transfer_is_windowed()) {
+        TransferAck ack;
+        transfer_get_ack(&ack);
+        created = packet_create_window_ack(&response, packet->header.sequence,
+                                           ack.next_chunk, ack.sack_bitmap);
+    } else {
+        created = packet_create_ack(&response, packet->header.sequence);
+    }
+    if (!created) {
         return false;
     }
     
-    return packet_transmit(&response);
+    bool sent = packet_transmit(&response);
+    packet_free(&response);
+    return sent;
 }
 
 static bool handle_error_packet(const Packet *packet) {
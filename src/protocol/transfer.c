@@ -6,15 +6,40 @@
 #include "../error/logging.h"
 #include "../error/error.h"
 #include "packet.h"
+#include "pipeline.h"
 #include "../hardware/GC9A01.h"
 #include "../hardware/display.h"
 #include "../common/deskthang_constants.h"
+#include "../codec/delta.h"
+#include "../codec/qoi.h"
+#include "../codec/bc1.h"
+#include "../codec/palette.h"
+#include "../debug/trace.h"
+#include "../debug/stats.h"
 
 // External declarations
-extern const uint32_t crc32_table[256];
 
 // Forward declarations of static functions
 static bool transfer_process_image(void);
+static bool transfer_accept_chunk(const Packet *packet);
+static bool transfer_open_stream(uint32_t total_size);
+static bool transfer_finish_stream(void);
+static bool transfer_open_regions(uint32_t total_size);
+static bool transfer_write_region_data(const uint8_t *data, uint16_t length);
+static bool transfer_finish_regions(void);
+static bool transfer_open_delta(uint32_t total_size);
+static bool transfer_finish_delta(void);
+static bool transfer_open_qoi(uint32_t total_size);
+static bool transfer_finish_qoi(void);
+static bool transfer_open_bc1(uint32_t total_size);
+static bool transfer_finish_bc1(void);
+static bool transfer_open_indexed(uint32_t total_size);
+static bool transfer_finish_indexed(void);
+static bool transfer_open_round(uint32_t total_size);
+static bool transfer_finish_round(void);
+static bool transfer_decode_chunk(const uint8_t *data, uint16_t length, void *context);
+static bool transfer_process_window_chunk(const Packet *packet);
+static void transfer_release_window_slots(void);
 static void transfer_cleanup(void);
 
 // Global transfer context
@@ -22,14 +47,43 @@ static TransferContext g_transfer_context;
 static TransferStatus g_transfer_status;
 static bool transfer_initialized = false;
 
+// Reorder slots for windowed chunks that arrive ahead of a gap. Parked
+// chunks sit in pipeline buffers, so draining them queues them for core1
+// without another copy.
+#if TRANSFER_WINDOW_SIZE > 32
+#error "TRANSFER_WINDOW_SIZE must fit the 32-bit window mask"
+#endif
+#if TRANSFER_WINDOW_SIZE >= PIPELINE_BUFFER_COUNT
+#error "PIPELINE_BUFFER_COUNT must leave buffers for core1 beyond the reorder slots"
+#endif
+static PipelineBuffer *g_window_slots[TRANSFER_WINDOW_SIZE];
+
+// Delta mode: run decoder and the bytes left in the display window it has open
+static DeltaDecoder g_delta_decoder;
+static uint32_t g_delta_window_remaining;
+
+// QOI mode: decoder state, 64-entry index plus one line of pixels
+static QoiDecoder g_qoi_decoder;
+
+// BC1 mode: block gatherer plus the four scanlines of one block row
+static Bc1Decoder g_bc1_decoder;
+
+// Indexed mode: LUT plus the packed indices of the last indexed image, which
+// outlive the transfer for palette-only updates
+static PaletteDecoder g_palette_decoder;
+static uint8_t g_palette_indices[PALETTE_INDEX_SIZE(TRANSFER_INDEXED_PIXELS, 8)];
+
 // Helper macro
 #define MIN(a,b) ((a) < (b) ? (a) : (b))
 
 // Initialize transfer system
 bool transfer_init(void) {
+    transfer_release_window_slots();
     memset(&g_transfer_context, 0, sizeof(TransferContext));
     g_transfer_context.mode = TRANSFER_MODE_NONE;
     g_transfer_context.state = TRANSFER_STATE_IDLE;
+    palette_decoder_init(&g_palette_decoder, DISPLAY_WIDTH, DISPLAY_HEIGHT,
+                         g_palette_indices, sizeof(g_palette_indices));
     transfer_initialized = true;
     return true;
 }
@@ -41,6 +95,7 @@ bool transfer_is_initialized(void) {
 // Reset transfer state
 void transfer_reset(void) {
     transfer_free_buffer();
+    transfer_release_window_slots();
     memset(&g_transfer_context, 0, sizeof(TransferContext));
     memset(&g_transfer_status, 0, sizeof(TransferStatus));
 }
@@ -56,8 +111,40 @@ bool transfer_start(TransferMode mode, uint32_t total_size) {
         return false;
     }
     
-    // Allocate transfer buffer
-    if (!transfer_allocate_buffer(total_size)) {
+    // The panel is core0's again once core1 has drained the last transfer
+    pipeline_begin(transfer_decode_chunk, NULL);
+    
+    // Streaming writes chunks straight to the panel, everything else is
+    // staged in a transfer buffer first
+    if (mode == TRANSFER_MODE_STREAM) {
+        if (!transfer_open_stream(total_size)) {
+            return false;
+        }
+    } else if (mode == TRANSFER_MODE_REGION) {
+        if (!transfer_open_regions(total_size)) {
+            return false;
+        }
+    } else if (mode == TRANSFER_MODE_DELTA) {
+        if (!transfer_open_delta(total_size)) {
+            return false;
+        }
+    } else if (mode == TRANSFER_MODE_QOI) {
+        if (!transfer_open_qoi(total_size)) {
+            return false;
+        }
+    } else if (mode == TRANSFER_MODE_BC1) {
+        if (!transfer_open_bc1(total_size)) {
+            return false;
+        }
+    } else if (mode == TRANSFER_MODE_INDEXED) {
+        if (!transfer_open_indexed(total_size)) {
+            return false;
+        }
+    } else if (mode == TRANSFER_MODE_ROUND) {
+        if (!transfer_open_round(total_size)) {
+            return false;
+        }
+    } else if (!transfer_allocate_buffer(total_size)) {
         return false;
     }
     
@@ -65,8 +152,14 @@ bool transfer_start(TransferMode mode, uint32_t total_size) {
     g_transfer_context.mode = mode;
     g_transfer_context.state = TRANSFER_STATE_STARTING;
     g_transfer_context.start_time = deskthang_time_get_ms();
+    g_transfer_context.start_us = deskthang_time_get_us();
     g_transfer_context.bytes_expected = total_size;
     g_transfer_context.chunks_expected = (total_size + CHUNK_SIZE - 1) / CHUNK_SIZE;
+    g_transfer_context.next_chunk = 0;
+    g_transfer_context.window_mask = 0;
+    g_transfer_context.region_header_length = 0;
+    g_transfer_context.region_remaining = 0;
+    g_transfer_context.regions_completed = 0;
     
     // Initialize status
     g_transfer_status.active = true;
@@ -74,15 +167,36 @@ bool transfer_start(TransferMode mode, uint32_t total_size) {
     g_transfer_status.speed_bps = 0;
     g_transfer_status.errors = 0;
     
+    TRACE_INSTANT(TRANSFER_START, mode);
     return true;
 }
 
 // Process incoming data chunk
 bool transfer_process_chunk(const Packet *packet) {
-    if (!packet || g_transfer_context.state != TRANSFER_STATE_IN_PROGRESS) {
+    if (!packet) {
+        return false;
+    }
+    
+    TRACE_BEGIN(TRANSFER_CHUNK, packet_get_length(packet));
+    bool accepted = transfer_accept_chunk(packet);
+    TRACE_END(TRANSFER_CHUNK, accepted);
+    return accepted;
+}
+
+static bool transfer_accept_chunk(const Packet *packet) {
+    // First chunk moves a started transfer into progress
+    if (g_transfer_context.state == TRANSFER_STATE_STARTING) {
+        g_transfer_context.state = TRANSFER_STATE_IN_PROGRESS;
+    }
+    if (g_transfer_context.state != TRANSFER_STATE_IN_PROGRESS) {
         return false;
     }
     
+    // Streamed chunks are ordered by their own 16-bit index
+    if (transfer_is_windowed()) {
+        return transfer_process_window_chunk(packet);
+    }
+    
     // Validate packet
     if (!transfer_validate_chunk(packet)) {
         g_transfer_status.errors++;
@@ -113,6 +227,169 @@ bool transfer_process_chunk(const Packet *packet) {
     return true;
 }
 
+// Length a windowed chunk must have; only the last one may be short
+static uint16_t transfer_chunk_length(uint16_t index) {
+    uint32_t offset = (uint32_t)index * CHUNK_SIZE;
+    return (uint16_t)MIN(CHUNK_SIZE, g_transfer_context.bytes_expected - offset);
+}
+
+// Pipeline sink: decode the next in-order chunk onto the panel. Runs on
+// core1 while a transfer streams, so it touches only the decoders and the
+// region parser, never the window bookkeeping.
+static bool transfer_decode_chunk(const uint8_t *data, uint16_t length, void *context) {
+    (void)context;
+    switch (g_transfer_context.mode) {
+        case TRANSFER_MODE_REGION:
+            return transfer_write_region_data(data, length);
+        case TRANSFER_MODE_DELTA:
+            return delta_decoder_feed(&g_delta_decoder, data, length);
+        case TRANSFER_MODE_QOI:
+            return qoi_decoder_feed(&g_qoi_decoder, data, length);
+        case TRANSFER_MODE_BC1:
+            return bc1_decoder_feed(&g_bc1_decoder, data, length);
+        case TRANSFER_MODE_INDEXED:
+            return palette_decoder_feed(&g_palette_decoder, data, length);
+        case TRANSFER_MODE_ROUND:
+            return display_write_round_data(data, length);
+        default:
+            return display_write_data(data, length);
+    }
+}
+
+// Hand the next in-order chunk to the pipeline. A decoder can't resynchronise
+// after a bad chunk, and on core1 the failure may surface a few chunks late,
+// so any failure fails the transfer.
+static bool transfer_write_stream_chunk(PipelineBuffer *buffer) {
+    uint16_t length = buffer->length;
+    if (!pipeline_submit(buffer)) {
+        g_transfer_context.state = TRANSFER_STATE_ERROR;
+        g_transfer_status.errors++;
+        return false;
+    }
+    
+    g_transfer_context.bytes_received += length;
+    g_transfer_context.chunks_received++;
+    g_transfer_context.next_chunk++;
+    g_transfer_context.window_mask >>= 1;
+    return true;
+}
+
+// Copy a chunk's data into a pipeline buffer
+static PipelineBuffer *transfer_fill_buffer(uint16_t index, const uint8_t *data, uint16_t length) {
+    PipelineBuffer *buffer = pipeline_try_acquire();
+    if (!buffer) {
+        return NULL;
+    }
+    memcpy(buffer->data, data, length);
+    buffer->length = length;
+    buffer->chunk = index;
+    return buffer;
+}
+
+// Accept a windowed chunk: write it if it is next in line, park it in a
+// reorder slot if it arrived ahead of a gap, ignore it if already written
+static bool transfer_process_window_chunk(const Packet *packet) {
+    const uint8_t *payload = packet_get_payload(packet);
+    uint16_t length = packet_get_length(packet);
+    
+    // Core1 failed an earlier chunk since the last one came in
+    if (pipeline_failed()) {
+        g_transfer_context.state = TRANSFER_STATE_ERROR;
+        g_transfer_status.errors++;
+        return false;
+    }
+    
+    // A damaged or malformed chunk is dropped and counted, not failed: the
+    // ACK still names the next chunk needed, so the host resends it. Only
+    // the decoder or pipeline failing ends the transfer.
+    if (packet_get_type(packet) != PACKET_TYPE_DATA ||
+        length <= TRANSFER_CHUNK_INDEX_SIZE ||
+        !packet_checksum_valid(packet)) {
+        g_transfer_status.errors++;
+        return true;
+    }
+    
+    uint16_t index = payload[0] | (payload[1] << 8);
+    const uint8_t *data = payload + TRANSFER_CHUNK_INDEX_SIZE;
+    uint16_t data_length = length - TRANSFER_CHUNK_INDEX_SIZE;
+    
+    if (index >= g_transfer_context.chunks_expected ||
+        data_length != transfer_chunk_length(index)) {
+        g_transfer_status.errors++;
+        return true;
+    }
+    
+    // Already written: a retransmit whose ACK was lost, just re-ACK
+    if (index < g_transfer_context.next_chunk) {
+        g_transfer_context.retry_count++;
+        return true;
+    }
+    
+    // Past the window: drop it, the ACK tells the host where we are
+    uint16_t offset = index - g_transfer_context.next_chunk;
+    if (offset >= TRANSFER_WINDOW_SIZE) {
+        return true;
+    }
+    
+    if (offset > 0 && (g_transfer_context.window_mask & (1u << offset))) {
+        return true;  // Already parked
+    }
+    
+    // No buffer to copy it into: leave it out of the ACK, so the host's
+    // window holds back and resends it once buffers come back
+    PipelineBuffer *buffer = transfer_fill_buffer(index, data, data_length);
+    if (!buffer) {
+        return true;
+    }
+    
+    if (offset > 0) {
+        g_window_slots[index % TRANSFER_WINDOW_SIZE] = buffer;
+        g_transfer_context.window_mask |= 1u << offset;
+        return true;
+    }
+    
+    if (!transfer_write_stream_chunk(buffer)) {
+        return false;
+    }
+    
+    // Drain chunks that were parked behind the gap this one filled
+    while (g_transfer_context.window_mask & 1u) {
+        uint16_t slot = g_transfer_context.next_chunk % TRANSFER_WINDOW_SIZE;
+        PipelineBuffer *parked = g_window_slots[slot];
+        g_window_slots[slot] = NULL;
+        if (!transfer_write_stream_chunk(parked)) {
+            return false;
+        }
+    }
+    
+    // Update status
+    g_transfer_status.progress = transfer_get_progress();
+    g_transfer_status.speed_bps = transfer_get_elapsed_time() > 0 ?
+        (g_transfer_context.bytes_received * 1000) / transfer_get_elapsed_time() : 0;
+    
+    return true;
+}
+
+bool transfer_is_windowed(void) {
+    return (g_transfer_context.mode == TRANSFER_MODE_STREAM ||
+            g_transfer_context.mode == TRANSFER_MODE_REGION ||
+            g_transfer_context.mode == TRANSFER_MODE_DELTA ||
+            g_transfer_context.mode == TRANSFER_MODE_QOI ||
+            g_transfer_context.mode == TRANSFER_MODE_BC1 ||
+            g_transfer_context.mode == TRANSFER_MODE_INDEXED ||
+            g_transfer_context.mode == TRANSFER_MODE_ROUND) &&
+           g_transfer_context.state != TRANSFER_STATE_IDLE;
+}
+
+void transfer_get_ack(TransferAck *ack) {
+    if (!ack) {
+        return;
+    }
+    
+    ack->next_chunk = g_transfer_context.next_chunk;
+    ack->sack_bitmap = g_transfer_context.window_mask >> 1;
+}
+
 // Complete transfer
 bool transfer_complete(void) {
     if (g_transfer_context.state != TRANSFER_STATE_IN_PROGRESS) {
@@ -126,22 +403,58 @@ bool transfer_complete(void) {
     
     g_transfer_context.state = TRANSFER_STATE_COMPLETING;
     
+    // Everything is in; wait for core1 to get it onto the panel
+    if (!pipeline_flush()) {
+        logging_write("Transfer", "Chunk decode failed");
+        TRACE_INSTANT(TRANSFER_END, 0);
+        transfer_abort();
+        return false;
+    }
+    
     // Process complete transfer buffer based on mode
     bool success = false;
     switch (g_transfer_context.mode) {
         case TRANSFER_MODE_IMAGE:
             success = transfer_process_image();
             break;
+        case TRANSFER_MODE_STREAM:
+            success = transfer_finish_stream();
+            break;
+        case TRANSFER_MODE_REGION:
+            success = transfer_finish_regions();
+            break;
+        case TRANSFER_MODE_DELTA:
+            success = transfer_finish_delta();
+            break;
+        case TRANSFER_MODE_QOI:
+            success = transfer_finish_qoi();
+            break;
+        case TRANSFER_MODE_BC1:
+            success = transfer_finish_bc1();
+            break;
+        case TRANSFER_MODE_INDEXED:
+            success = transfer_finish_indexed();
+            break;
+        case TRANSFER_MODE_ROUND:
+            success = transfer_finish_round();
+            break;
         default:
             success = false;
             break;
     }
     
+    TRACE_INSTANT(TRANSFER_END, success);
     if (!success) {
         transfer_abort();
         return false;
     }
     
+    uint32_t frame_us = deskthang_time_get_us() - g_transfer_context.start_us;
+    stats_latency_record(STATS_LATENCY_FRAME, frame_us);
+    if (frame_us > 0) {
+        stats_set_transfer_speed((uint32_t)((uint64_t)g_transfer_context.bytes_received * 1000000u / frame_us));
+    }
+    
     // Update status
     g_transfer_status.active = false;
     g_transfer_status.progress = 1.0f;
@@ -175,24 +488,29 @@ static bool transfer_process_image(void) {
         return false;
     }
     
-    // Set up frame for full display update
-    struct GC9A01_frame frame = {
-        .start = {0, 0},
-        .end = {DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1}
-    };
-    GC9A01_set_frame(frame);
-    
-    // Write image data directly to display
+    // Only the visible span of each row goes to the panel, one window per
+    // band of rows that share a span
     uint32_t bytes_written = 0;
-    while (bytes_written < g_transfer_context.buffer_size) {
-        uint32_t chunk_size = MIN(CHUNK_SIZE, g_transfer_context.buffer_size - bytes_written);
-        if (!display_write_data(g_transfer_context.buffer + bytes_written, chunk_size)) {
-            char msg[64];
-            snprintf(msg, sizeof(msg), "Display write failed at offset %u", bytes_written);
-            logging_write("Transfer", msg);
+    for (uint16_t y = 0; y < DISPLAY_HEIGHT; y += panel_span_band_height(y)) {
+        uint16_t start = panel_span_start(y);
+        uint16_t width = panel_span_width(y);
+        uint16_t rows = panel_span_band_height(y);
+        if (!display_begin_write(start, y, width, rows)) {
+            logging_write("Transfer", "Failed to open display window");
             return false;
         }
-        bytes_written += chunk_size;
+        
+        for (uint16_t row = y; row < y + rows; row++) {
+            uint32_t offset = ((uint32_t)row * DISPLAY_WIDTH + start) * 2;
+            if (!display_write_data(g_transfer_context.buffer + offset, width * 2)) {
+                char msg[64];
+                snprintf(msg, sizeof(msg), "Display write failed at offset %u", offset);
+                logging_write("Transfer", msg);
+                display_end_write();
+                return false;
+            }
+            bytes_written += width * 2;
+        }
     }
     
     // Finalize display update
@@ -204,16 +522,422 @@ static bool transfer_process_image(void) {
     // Clear the buffer since we're done with it
     memset(g_transfer_context.buffer, 0, g_transfer_context.buffer_size);
     
-    char msg[64];
-    snprintf(msg, sizeof(msg), "Image transfer complete: %u bytes written", bytes_written);
-    logging_write("Transfer", msg);
+    LOG_EVENT(TRANSFER_IMAGE_DONE, bytes_written);
     return true;
 }
 
+// Open the full-screen write window that streamed chunks are pushed into
+static bool transfer_open_stream(uint32_t total_size) {
+    const uint32_t expected_size = DISPLAY_WIDTH * DISPLAY_HEIGHT * 2; // 2 bytes per pixel (RGB565)
+    if (total_size != expected_size) {
+        char msg[64];
+        snprintf(msg, sizeof(msg), "Invalid stream size: got %u, expected %u",
+                 total_size, expected_size);
+        logging_write("Transfer", msg);
+        return false;
+    }
+    
+    if (!display_ready()) {
+        logging_write("Transfer", "Display not ready for stream");
+        return false;
+    }
+    
+    return display_begin_write(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+}
+
+// Close out a streamed image once every byte has reached the panel
+static bool transfer_finish_stream(void) {
+    if (!display_end_write()) {
+        logging_write("Transfer", "Display failed to process update");
+        return false;
+    }
+    
+    LOG_EVENT(TRANSFER_STREAM_DONE, g_transfer_context.bytes_received);
+    return true;
+}
+
+// Region streams are only bounded here; each rectangle is checked against
+// the panel as its header arrives
+static bool transfer_open_regions(uint32_t total_size) {
+    if (total_size <= TRANSFER_REGION_HEADER_SIZE || total_size > TRANSFER_REGION_MAX_SIZE) {
+        char msg[64];
+        snprintf(msg, sizeof(msg), "Invalid region stream size: %u", total_size);
+        logging_write("Transfer", msg);
+        return false;
+    }
+    
+    if (!display_ready()) {
+        logging_write("Transfer", "Display not ready for region update");
+        return false;
+    }
+    
+    return true;
+}
+
+// Header complete: validate the rectangle and open its window
+static bool transfer_open_region(void) {
+    const uint8_t *header = g_transfer_context.region_header;
+    uint16_t x = header[0] | (header[1] << 8);
+    uint16_t y = header[2] | (header[3] << 8);
+    uint16_t width = header[4] | (header[5] << 8);
+    uint16_t height = header[6] | (header[7] << 8);
+    
+    if (g_transfer_context.regions_completed >= TRANSFER_REGION_MAX_COUNT ||
+        !display_begin_write(x, y, width, height)) {
+        char msg[64];
+        snprintf(msg, sizeof(msg), "Invalid region %u: %ux%u at %u,%u",
+                 g_transfer_context.regions_completed, width, height, x, y);
+        logging_write("Transfer", msg);
+        return false;
+    }
+    
+    g_transfer_context.region_remaining = (uint32_t)width * height * 2;
+    return true;
+}
+
+// Split in-order stream bytes into region headers and pixel runs. A bad
+// header leaves the rest of the stream unparseable, so it fails the transfer.
+static bool transfer_write_region_data(const uint8_t *data, uint16_t length) {
+    while (length > 0) {
+        if (g_transfer_context.region_remaining == 0) {
+            uint8_t needed = TRANSFER_REGION_HEADER_SIZE - g_transfer_context.region_header_length;
+            uint8_t take = (uint8_t)MIN(needed, length);
+            memcpy(g_transfer_context.region_header + g_transfer_context.region_header_length, data, take);
+            g_transfer_context.region_header_length += take;
+            data += take;
+            length -= take;
+            
+            if (g_transfer_context.region_header_length < TRANSFER_REGION_HEADER_SIZE) {
+                return true;  // Rest of the header is in the next chunk
+            }
+            g_transfer_context.region_header_length = 0;
+            
+            if (!transfer_open_region()) {
+                return false;
+            }
+            continue;
+        }
+        
+        uint16_t take = (uint16_t)MIN(g_transfer_context.region_remaining, length);
+        if (!display_write_data(data, take)) {
+            return false;
+        }
+        data += take;
+        length -= take;
+        g_transfer_context.region_remaining -= take;
+        
+        if (g_transfer_context.region_remaining == 0) {
+            if (!display_end_write()) {
+                return false;
+            }
+            g_transfer_context.regions_completed++;
+        }
+    }
+    return true;
+}
+
+// Every byte is in, so every region must have closed
+static bool transfer_finish_regions(void) {
+    if (g_transfer_context.region_remaining != 0 ||
+        g_transfer_context.region_header_length != 0 ||
+        g_transfer_context.regions_completed == 0) {
+        logging_write("Transfer", "Region stream ended mid-region");
+        return false;
+    }
+    
+    LOG_EVENT(TRANSFER_REGIONS_DONE, g_transfer_context.regions_completed,
+              g_transfer_context.bytes_received);
+    return true;
+}
+
+// Open a window at a byte offset into the frame. RAMWR wraps inside the
+// column range, so a run starting mid-row first gets a window to the end of
+// its row; after that one window covers the rest of the frame.
+static bool transfer_delta_open_window(uint32_t position) {
+    uint32_t pixel = position / DELTA_PIXEL_SIZE;
+    uint16_t x = pixel % DISPLAY_WIDTH;
+    uint16_t y = pixel / DISPLAY_WIDTH;
+    
+    if (x != 0) {
+        g_delta_window_remaining = (uint32_t)(DISPLAY_WIDTH - x) * DELTA_PIXEL_SIZE;
+        return display_begin_write(x, y, DISPLAY_WIDTH - x, 1);
+    }
+    g_delta_window_remaining = (uint32_t)(DISPLAY_HEIGHT - y) * DISPLAY_WIDTH * DELTA_PIXEL_SIZE;
+    return display_begin_write(0, y, DISPLAY_WIDTH, DISPLAY_HEIGHT - y);
+}
+
+static bool transfer_delta_close_window(void) {
+    if (g_delta_window_remaining == 0) {
+        return true;
+    }
+    g_delta_window_remaining = 0;
+    return display_end_write();
+}
+
+// Unchanged pixels: the panel already has them. Close the window; the next
+// copy reopens one where it lands.
+static bool transfer_delta_skip(uint32_t position, uint32_t length, void *context) {
+    return transfer_delta_close_window();
+}
+
+static bool transfer_delta_copy(uint32_t position, const uint8_t *data, uint32_t length, void *context) {
+    while (length > 0) {
+        if (g_delta_window_remaining == 0 && !transfer_delta_open_window(position)) {
+            return false;
+        }
+        
+        uint32_t take = MIN(length, g_delta_window_remaining);
+        if (!display_write_data(data, take)) {
+            return false;
+        }
+        data += take;
+        length -= take;
+        position += take;
+        g_delta_window_remaining -= take;
+        
+        if (g_delta_window_remaining == 0 && !display_end_write()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static bool transfer_open_delta(uint32_t total_size) {
+    if (total_size < DELTA_OP_SIZE || total_size > TRANSFER_DELTA_MAX_SIZE) {
+        char msg[64];
+        snprintf(msg, sizeof(msg), "Invalid delta stream size: %u", total_size);
+        logging_write("Transfer", msg);
+        return false;
+    }
+    
+    if (!display_ready()) {
+        logging_write("Transfer", "Display not ready for delta update");
+        return false;
+    }
+    
+    const DeltaSink sink = {
+        .skip = transfer_delta_skip,
+        .copy = transfer_delta_copy,
+        .context = NULL
+    };
+    delta_decoder_init(&g_delta_decoder, TRANSFER_MAX_SIZE, &sink);
+    g_delta_window_remaining = 0;
+    return true;
+}
+
+// The runs must have covered the whole frame
+static bool transfer_finish_delta(void) {
+    if (!delta_decoder_complete(&g_delta_decoder)) {
+        logging_write("Transfer", "Delta stream did not cover the frame");
+        return false;
+    }
+    if (!transfer_delta_close_window()) {
+        logging_write("Transfer", "Display failed to process update");
+        return false;
+    }
+    
+    LOG_EVENT(TRANSFER_DELTA_DONE, g_transfer_context.bytes_received, g_delta_decoder.copied);
+    return true;
+}
+
+static bool transfer_qoi_write(const uint8_t *data, uint32_t length, void *context) {
+    return display_write_data(data, length);
+}
+
+// Decoded pixels go straight into one full-screen window, like a stream
+static bool transfer_open_qoi(uint32_t total_size) {
+    if (total_size == 0 || total_size > TRANSFER_QOI_MAX_SIZE) {
+        char msg[64];
+        snprintf(msg, sizeof(msg), "Invalid QOI stream size: %u", total_size);
+        logging_write("Transfer", msg);
+        return false;
+    }
+    
+    if (!display_ready()) {
+        logging_write("Transfer", "Display not ready for QOI image");
+        return false;
+    }
+    
+    const QoiSink sink = {
+        .write = transfer_qoi_write,
+        .context = NULL
+    };
+    qoi_decoder_init(&g_qoi_decoder, DISPLAY_WIDTH * DISPLAY_HEIGHT, &sink);
+    return display_begin_write(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+}
+
+// The ops must have decoded to exactly one frame
+static bool transfer_finish_qoi(void) {
+    if (!qoi_decoder_complete(&g_qoi_decoder)) {
+        logging_write("Transfer", "QOI stream did not fill the frame");
+        return false;
+    }
+    if (!display_end_write()) {
+        logging_write("Transfer", "Display failed to process update");
+        return false;
+    }
+    
+    LOG_EVENT(TRANSFER_QOI_DONE, g_transfer_context.bytes_received, TRANSFER_MAX_SIZE);
+    return true;
+}
+
+static bool transfer_bc1_write(const uint8_t *data, uint32_t length, void *context) {
+    return display_write_data(data, length);
+}
+
+// Fixed rate: the size is known up front and every block row lands in the
+// full-screen window in order
+static bool transfer_open_bc1(uint32_t total_size) {
+    if (total_size != TRANSFER_BC1_SIZE) {
+        char msg[64];
+        snprintf(msg, sizeof(msg), "Invalid BC1 size: got %u, expected %u",
+                 total_size, TRANSFER_BC1_SIZE);
+        logging_write("Transfer", msg);
+        return false;
+    }
+    
+    if (!display_ready()) {
+        logging_write("Transfer", "Display not ready for BC1 image");
+        return false;
+    }
+    
+    const Bc1Sink sink = {
+        .write = transfer_bc1_write,
+        .context = NULL
+    };
+    if (!bc1_decoder_init(&g_bc1_decoder, DISPLAY_WIDTH, DISPLAY_HEIGHT, &sink)) {
+        return false;
+    }
+    return display_begin_write(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+}
+
+static bool transfer_finish_bc1(void) {
+    if (!bc1_decoder_complete(&g_bc1_decoder)) {
+        logging_write("Transfer", "BC1 stream ended mid-row");
+        return false;
+    }
+    if (!display_end_write()) {
+        logging_write("Transfer", "Display failed to process update");
+        return false;
+    }
+    
+    LOG_EVENT(TRANSFER_BC1_DONE, g_bc1_decoder.block_row);
+    return true;
+}
+
+static bool transfer_palette_write(const uint8_t *data, uint32_t length, void *context) {
+    return display_write_data(data, length);
+}
+
+static const PaletteSink g_palette_sink = {
+    .write = transfer_palette_write,
+    .context = NULL
+};
+
+// The header is checked against the size when it arrives; here the size
+// only needs to be plausible
+static bool transfer_open_indexed(uint32_t total_size) {
+    if (total_size <= PALETTE_HEADER_SIZE || total_size > TRANSFER_INDEXED_MAX_SIZE) {
+        char msg[64];
+        snprintf(msg, sizeof(msg), "Invalid indexed stream size: %u", total_size);
+        logging_write("Transfer", msg);
+        return false;
+    }
+    
+    if (!display_ready()) {
+        logging_write("Transfer", "Display not ready for indexed image");
+        return false;
+    }
+    
+    palette_decoder_start(&g_palette_decoder, total_size, &g_palette_sink);
+    return display_begin_write(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+}
+
+static bool transfer_finish_indexed(void) {
+    if (!palette_decoder_complete(&g_palette_decoder)) {
+        logging_write("Transfer", "Indexed stream ended early");
+        return false;
+    }
+    if (!display_end_write()) {
+        logging_write("Transfer", "Display failed to process update");
+        return false;
+    }
+    
+    LOG_EVENT(TRANSFER_INDEXED_DONE, g_palette_decoder.bits, g_palette_decoder.colors);
+    return true;
+}
+
+// Fixed size: every visible pixel once, in row order
+static bool transfer_open_round(uint32_t total_size) {
+    if (total_size != TRANSFER_ROUND_SIZE) {
+        char msg[64];
+        snprintf(msg, sizeof(msg), "Invalid round size: got %u, expected %u",
+                 total_size, TRANSFER_ROUND_SIZE);
+        logging_write("Transfer", msg);
+        return false;
+    }
+    
+    if (!display_ready()) {
+        logging_write("Transfer", "Display not ready for round image");
+        return false;
+    }
+    
+    return display_begin_round_write();
+}
+
+static bool transfer_finish_round(void) {
+    if (!display_end_round_write()) {
+        logging_write("Transfer", "Display failed to process update");
+        return false;
+    }
+    
+    LOG_EVENT(TRANSFER_ROUND_DONE, g_transfer_context.bytes_received, TRANSFER_MAX_SIZE);
+    return true;
+}
+
+bool transfer_recolor(const uint8_t *data, size_t length) {
+    if (g_transfer_context.state != TRANSFER_STATE_IDLE || !data ||
+        length <= PALETTE_HEADER_SIZE) {
+        return false;
+    }
+    
+    uint8_t first = data[0];
+    uint16_t count = data[1] + 1;
+    if (length != PALETTE_HEADER_SIZE + (size_t)count * PALETTE_ENTRY_SIZE ||
+        !palette_decoder_set_colors(&g_palette_decoder, first, data + PALETTE_HEADER_SIZE, count)) {
+        logging_write("Transfer", "Invalid palette update");
+        return false;
+    }
+    
+    if (!display_ready() || !display_begin_write(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT)) {
+        logging_write("Transfer", "Display not ready for palette update");
+        return false;
+    }
+    bool rendered = palette_decoder_render(&g_palette_decoder, &g_palette_sink);
+    if (!display_end_write() || !rendered) {
+        logging_write("Transfer", "Display failed to process update");
+        return false;
+    }
+    
+    LOG_EVENT(TRANSFER_PALETTE_DONE, count, first);
+    return true;
+}
+
+// Hand parked chunks back to the pipeline
+static void transfer_release_window_slots(void) {
+    for (int slot = 0; slot < TRANSFER_WINDOW_SIZE; slot++) {
+        if (g_window_slots[slot]) {
+            pipeline_release(g_window_slots[slot]);
+            g_window_slots[slot] = NULL;
+        }
+    }
+}
+
 // Cleanup after transfer completion
 static void transfer_cleanup(void) {
     // Free transfer buffer
     transfer_free_buffer();
+    transfer_release_window_slots();
     
     // Reset transfer context
     g_transfer_context.mode = TRANSFER_MODE_NONE;
@@ -226,6 +950,11 @@ static void transfer_cleanup(void) {
     g_transfer_context.retry_count = 0;
     g_transfer_context.last_sequence = 0;
     g_transfer_context.last_checksum = 0;
+    g_transfer_context.next_chunk = 0;
+    g_transfer_context.window_mask = 0;
+    g_transfer_context.region_header_length = 0;
+    g_transfer_context.region_remaining = 0;
+    g_transfer_context.regions_completed = 0;
     
     // Clear status
     memset(&g_transfer_status, 0, sizeof(TransferStatus));
@@ -237,6 +966,20 @@ bool transfer_abort(void) {
         return false;
     }
     
+    // Let core1 finish what it holds, then release the panel so a
+    // half-written stream doesn't hold CS low
+    pipeline_flush();
+    if (g_transfer_context.mode == TRANSFER_MODE_STREAM ||
+        g_transfer_context.mode == TRANSFER_MODE_QOI ||
+        g_transfer_context.mode == TRANSFER_MODE_BC1 ||
+        g_transfer_context.mode == TRANSFER_MODE_INDEXED ||
+        g_transfer_context.mode == TRANSFER_MODE_ROUND ||
+        (g_transfer_context.mode == TRANSFER_MODE_REGION && g_transfer_context.region_remaining > 0)) {
+        display_end_write();
+    } else if (g_transfer_context.mode == TRANSFER_MODE_DELTA) {
+        transfer_delta_close_window();
+    }
+    
     g_transfer_context.state = TRANSFER_STATE_ERROR;
     g_transfer_status.active = false;
     
@@ -313,10 +1056,8 @@ bool transfer_validate_chunk(const Packet *packet) {
         return false;
     }
     
-    // Validate checksum
-    if (!transfer_validate_checksum(packet_get_payload(packet),
-                                  packet_get_length(packet),
-                                  packet_get_checksum(packet))) {
+    // Validate checksum, unless packet receive already did
+    if (!packet_checksum_valid(packet)) {
         return false;
     }
     
@@ -345,15 +1086,7 @@ bool transfer_validate_checksum(const uint8_t *data, uint16_t length, uint32_t c
         return false;
     }
     
-    uint32_t crc = 0xFFFFFFFF;
-    
-    for (uint16_t i = 0; i < length; i++) {
-        crc = (crc >> 8) ^ crc32_table[(crc ^ data[i]) & 0xFF];
-    }
-    
-    crc = crc ^ 0xFFFFFFFF;
-    
-    return crc == checksum;
+    return crc32_compute(data, length) == checksum;
 }
 
 // Error handling
@@ -407,6 +1140,13 @@ const char *transfer_mode_to_string(TransferMode mode) {
     switch (mode) {
         case TRANSFER_MODE_NONE:     return "NONE";
         case TRANSFER_MODE_IMAGE:    return "IMAGE";
+        case TRANSFER_MODE_STREAM:   return "STREAM";
+        case TRANSFER_MODE_REGION:   return "REGION";
+        case TRANSFER_MODE_DELTA:    return "DELTA";
+        case TRANSFER_MODE_QOI:      return "QOI";
+        case TRANSFER_MODE_BC1:      return "BC1";
+        case TRANSFER_MODE_INDEXED:  return "INDEXED";
+        case TRANSFER_MODE_ROUND:    return "ROUND";
         default:                     return "UNKNOWN";
     }
 }
@@ -424,6 +1164,12 @@ const char *transfer_state_to_string(TransferState state) {
 
 // Add these implementations
 bool transfer_buffer_available(void) {
+    // A stream has room for as long as the display window isn't full
+    if (transfer_is_windowed()) {
+        return g_transfer_context.state != TRANSFER_STATE_IDLE &&
+               g_transfer_context.bytes_received < g_transfer_context.bytes_expected;
+    }
+    
     return g_transfer_context.buffer != NULL && 
            g_transfer_context.buffer_size > 0 && 
            g_transfer_context.buffer_offset < g_transfer_context.buffer_size;
@@ -450,14 +1196,7 @@ bool transfer_checksum_valid(void) {
         return false;
     }
     
-    // Calculate CRC32 of entire buffer
-    uint32_t crc = 0xFFFFFFFF;
-    for (uint32_t i = 0; i < g_transfer_context.buffer_offset; i++) {
-        uint8_t byte = g_transfer_context.buffer[i];
-        crc = (crc >> 8) ^ crc32_table[(crc & 0xFF) ^ byte];
-    }
-    crc = crc ^ 0xFFFFFFFF;
-    
-    // Compare with stored checksum
+    // Compare CRC32 of entire buffer with stored checksum
+    uint32_t crc = crc32_compute(g_transfer_context.buffer, g_transfer_context.buffer_offset);
     return crc == g_transfer_context.last_checksum;
 }
@@ -5,11 +5,65 @@
 #include <stdbool.h>
 #include "protocol.h"
 #include "packet.h"
+#include "../codec/palette.h"
+#include "../hardware/panel_span.h"
+
+// Sliding window. Streamed DATA payloads start with a little-endian 16-bit
+// chunk index so the host can keep several chunks in flight; chunks that
+// arrive ahead of a gap wait in a reorder slot until the gap is filled.
+#define TRANSFER_WINDOW_SIZE      8   // Chunks in flight (at most 32)
+#define TRANSFER_CHUNK_INDEX_SIZE 2   // Chunk index prefix on windowed DATA
+#define TRANSFER_ACK_SIZE         6   // next_chunk (u16) + sack_bitmap (u32), LE
+
+// Region mode. The windowed byte stream is a run of rectangles, each an
+// 8-byte header (x, y, width, height as LE u16) followed by width * height
+// RGB565 pixels, and each is written into its own CASET/RASET window.
+// Headers may straddle chunk boundaries.
+#define TRANSFER_REGION_HEADER_SIZE 8
+#define TRANSFER_REGION_MAX_COUNT   64
+#define TRANSFER_REGION_MAX_SIZE    (TRANSFER_MAX_SIZE + TRANSFER_REGION_MAX_COUNT * TRANSFER_REGION_HEADER_SIZE)
+
+// Delta mode. The windowed byte stream is a skip/copy run stream over the
+// whole frame (see codec/delta.h); copied runs are written into windows
+// opened where they land. The host only picks delta when it beats a raw
+// frame, so a delta stream is never larger than one.
+#define TRANSFER_DELTA_MAX_SIZE     TRANSFER_MAX_SIZE
+
+// QOI mode. The windowed byte stream is a full frame compressed with the
+// codec in codec/qoi.h, decoded chunk by chunk into the full-screen window.
+// The host sends raw frames that don't compress, so the stream is bounded
+// by a raw frame as well.
+#define TRANSFER_QOI_MAX_SIZE       TRANSFER_MAX_SIZE
+
+// BC1 mode. The windowed byte stream is a full frame of 4x4 blocks at a
+// fixed 4 bits per pixel (see codec/bc1.h), a quarter of a raw frame. Each
+// block row is expanded into four scanlines and written to the full-screen
+// window, so every chunk costs the same to decode.
+#define TRANSFER_BC1_SIZE           (TRANSFER_MAX_SIZE / 4)
+
+// Indexed mode. The windowed byte stream is a palette plus packed 2/4/8-bit
+// indices (see codec/palette.h). The indices stay resident after the
+// transfer, so transfer_recolor can redraw the screen with a new palette.
+#define TRANSFER_INDEXED_PIXELS     (DISPLAY_WIDTH * DISPLAY_HEIGHT)
+#define TRANSFER_INDEXED_MAX_SIZE   PALETTE_STREAM_SIZE(TRANSFER_INDEXED_PIXELS, 8, PALETTE_MAX_COLORS)
+#define TRANSFER_RECOLOR_MAX_SIZE   (PALETTE_HEADER_SIZE + PALETTE_MAX_COLORS * PALETTE_ENTRY_SIZE)
+
+// Round mode. The windowed byte stream is a full frame of only the pixels
+// the round panel shows (see hardware/panel_span.h), row by row, so the
+// corners cost nothing over USB or SPI.
+#define TRANSFER_ROUND_SIZE         PANEL_SPAN_SIZE
 
 // Transfer modes
 typedef enum {
     TRANSFER_MODE_NONE,
     TRANSFER_MODE_IMAGE,      // RGB565 image transfer
+    TRANSFER_MODE_STREAM,     // RGB565 image streamed straight into the display window
+    TRANSFER_MODE_REGION,     // Dirty rectangles, each streamed into its own window
+    TRANSFER_MODE_DELTA,      // Skip/copy runs against the frame already on the panel
+    TRANSFER_MODE_QOI,        // QOI-compressed image decoded into the display window
+    TRANSFER_MODE_BC1,        // Block-compressed image, expanded a block row at a time
+    TRANSFER_MODE_INDEXED,    // Palette plus packed indices, expanded through a LUT
+    TRANSFER_MODE_ROUND,      // RGB565 visible spans streamed into per-band windows
 } TransferMode;
 
 // Transfer state
@@ -27,6 +81,7 @@ typedef struct {
     TransferMode mode;          // Current transfer mode
     TransferState state;        // Current transfer state
     uint32_t start_time;        // Transfer start timestamp
+    uint32_t start_us;          // Same, in microseconds, for frame latency
     
     // Progress tracking
     uint32_t bytes_received;    // Bytes received so far
@@ -44,11 +99,27 @@ typedef struct {
     uint32_t last_checksum;    // Last valid checksum
     bool checksum_valid;       // Last chunk checksum valid
     
+    // Sliding window (stream mode)
+    uint16_t next_chunk;       // Every chunk below this has been queued for the panel
+    uint32_t window_mask;      // Bit n set: chunk next_chunk + n is buffered
+    
+    // Region mode
+    uint8_t region_header[TRANSFER_REGION_HEADER_SIZE];  // Header being gathered
+    uint8_t region_header_length;  // Header bytes gathered so far
+    uint32_t region_remaining;     // Pixel bytes left in the open region, 0 between regions
+    uint16_t regions_completed;    // Regions fully written
+    
     // Error tracking
     uint32_t error_count;      // Number of errors
     uint32_t retry_count;      // Number of retries
 } TransferContext;
 
+// Windowed ACK: cumulative position plus selective bitmap of chunks past it
+typedef struct {
+    uint16_t next_chunk;       // Cumulative: all chunks below have arrived
+    uint32_t sack_bitmap;      // Bit n set: chunk next_chunk + 1 + n has arrived
+} TransferAck;
+
 // Core transfer functions
 bool transfer_init(void);
 void transfer_reset(void);
@@ -60,6 +131,13 @@ bool transfer_start(TransferMode mode, uint32_t total_size);
 bool transfer_process_chunk(const Packet *packet);
 bool transfer_complete(void);
 bool transfer_abort(void);
+bool transfer_is_windowed(void);
+
+// Palette-only update: first entry (u8), count - 1 (u8), then count RGB565
+// entries (u16 LE). Redraws the resident indexed image; no transfer may be
+// in progress.
+bool transfer_recolor(const uint8_t *data, size_t length);
+void transfer_get_ack(TransferAck *ack);
 
 // Buffer management
 bool transfer_allocate_buffer(uint32_t size);
@@ -0,0 +1,208 @@
+#include "dispatch.h"
+#include "transition.h"
+#include "../error/logging.h"
+#include "../system/time.h"
+#include "../debug/trace.h"
+#include "../debug/stats.h"
+#include <string.h>
+
+#if (STATE_TRACE_ENTRIES & (STATE_TRACE_ENTRIES - 1)) != 0
+#error "STATE_TRACE_ENTRIES must be a power of two"
+#endif
+
+typedef struct {
+    uint8_t next;
+    uint8_t condition;
+} StateEvent;
+
+static struct {
+    const StateActions *actions;
+    SystemState current;
+    SystemState previous;
+    StateCondition last_condition;
+    uint32_t entered_ms;
+    uint32_t entered_us;  // For the residence histogram
+    bool dispatching;
+
+    // Events waiting for the running transition to finish
+    StateEvent queue[STATE_EVENT_QUEUE_SIZE];
+    uint8_t head;
+    uint8_t count;
+
+    StateDispatchStats stats;
+} g_dispatch;
+
+static StateTraceEntry g_trace[STATE_TRACE_ENTRIES];
+static uint32_t g_trace_written;
+
+static void state_trace_record(SystemState from, SystemState to, StateCondition condition,
+                               uint8_t result, uint32_t start_us) {
+    uint32_t elapsed = deskthang_time_get_us() - start_us;
+    StateTraceEntry *entry = &g_trace[g_trace_written++ & (STATE_TRACE_ENTRIES - 1)];
+    entry->timestamp_us = start_us;
+    entry->duration_us = elapsed > UINT16_MAX ? UINT16_MAX : (uint16_t)elapsed;
+    entry->from = (uint8_t)from;
+    entry->to = (uint8_t)to;
+    entry->condition = (uint8_t)condition;
+    entry->result = result;
+    entry->queued = g_dispatch.count;
+    entry->reserved = 0;
+}
+
+static bool state_dispatch_push(SystemState next, StateCondition condition) {
+    if (g_dispatch.count == STATE_EVENT_QUEUE_SIZE) {
+        g_dispatch.stats.queue_full++;
+        return false;
+    }
+
+    StateEvent *event = &g_dispatch.queue[(g_dispatch.head + g_dispatch.count) % STATE_EVENT_QUEUE_SIZE];
+    event->next = (uint8_t)next;
+    event->condition = (uint8_t)condition;
+    g_dispatch.count++;
+    if (g_dispatch.count > g_dispatch.stats.queue_high_water) {
+        g_dispatch.stats.queue_high_water = g_dispatch.count;
+    }
+    return true;
+}
+
+static bool state_dispatch_pop(StateEvent *event) {
+    if (g_dispatch.count == 0) {
+        return false;
+    }
+    *event = g_dispatch.queue[g_dispatch.head];
+    g_dispatch.head = (g_dispatch.head + 1) % STATE_EVENT_QUEUE_SIZE;
+    g_dispatch.count--;
+    return true;
+}
+
+// One transition: exit, switch, entry. Entry actions that post only queue.
+static bool state_dispatch_step(SystemState next, StateCondition condition) {
+    SystemState from = g_dispatch.current;
+    uint32_t start_us = deskthang_time_get_us();
+
+    if (!state_dispatch_allowed(from, next, condition)) {
+        g_dispatch.stats.rejected++;
+        state_trace_record(from, next, condition, STATE_TRACE_REJECTED, start_us);
+        LOG_EVENT(STATE_TRANSITION_INVALID, state_to_string(from), state_to_string(next));
+        return false;
+    }
+
+    const StateActions *actions = g_dispatch.actions;
+    if (actions && actions[from].on_exit) {
+        actions[from].on_exit();
+    }
+
+    uint32_t now_us = deskthang_time_get_us();
+    stats_latency_record(STATS_LATENCY_STATE, now_us - g_dispatch.entered_us);
+
+    g_dispatch.previous = from;
+    g_dispatch.current = next;
+    g_dispatch.last_condition = condition;
+    g_dispatch.entered_ms = deskthang_time_get_ms();
+    g_dispatch.entered_us = now_us;
+
+    if (actions && actions[next].on_entry) {
+        actions[next].on_entry();
+    }
+
+    g_dispatch.stats.taken++;
+    state_trace_record(from, next, condition, STATE_TRACE_TAKEN, start_us);
+    return true;
+}
+
+static bool state_dispatch_run(SystemState next, StateCondition condition) {
+    TRACE_BEGIN(STATE, ((uint32_t)g_dispatch.current << 8) | (uint8_t)next);
+    bool taken = state_dispatch_step(next, condition);
+    TRACE_END(STATE, taken);
+    return taken;
+}
+
+// Run queued events until none are left
+static void state_dispatch_drain(void) {
+    StateEvent event;
+    while (state_dispatch_pop(&event)) {
+        state_dispatch_run((SystemState)event.next, (StateCondition)event.condition);
+    }
+}
+
+bool state_dispatch_init(SystemState initial, const StateActions *actions) {
+    if ((unsigned)initial >= STATE_COUNT) {
+        return false;
+    }
+
+    memset(&g_dispatch, 0, sizeof(g_dispatch));
+    memset(g_trace, 0, sizeof(g_trace));
+    g_trace_written = 0;
+
+    g_dispatch.actions = actions;
+    g_dispatch.current = initial;
+    g_dispatch.previous = initial;
+    g_dispatch.last_condition = CONDITION_NONE;
+    g_dispatch.entered_ms = deskthang_time_get_ms();
+    g_dispatch.entered_us = deskthang_time_get_us();
+
+    g_dispatch.dispatching = true;
+    if (actions && actions[initial].on_entry) {
+        actions[initial].on_entry();
+    }
+    state_dispatch_drain();
+    g_dispatch.dispatching = false;
+    return true;
+}
+
+bool state_dispatch_post(SystemState next, StateCondition condition) {
+    if (g_dispatch.dispatching) {
+        g_dispatch.stats.deferred++;
+        return state_dispatch_push(next, condition) &&
+               state_dispatch_allowed(g_dispatch.current, next, condition);
+    }
+
+    g_dispatch.dispatching = true;
+    bool taken = state_dispatch_run(next, condition);
+    state_dispatch_drain();
+    g_dispatch.dispatching = false;
+    return taken;
+}
+
+SystemState state_dispatch_current(void) {
+    return g_dispatch.current;
+}
+
+SystemState state_dispatch_previous(void) {
+    return g_dispatch.previous;
+}
+
+StateCondition state_dispatch_last_condition(void) {
+    return g_dispatch.last_condition;
+}
+
+uint32_t state_dispatch_entered_ms(void) {
+    return g_dispatch.entered_ms;
+}
+
+bool state_dispatch_allowed(SystemState from, SystemState to, StateCondition condition) {
+    if (condition == CONDITION_RECOVERED && to != g_dispatch.previous) {
+        return false;
+    }
+    return transition_allowed(from, to, condition);
+}
+
+uint16_t state_trace_count(void) {
+    return g_trace_written < STATE_TRACE_ENTRIES ? (uint16_t)g_trace_written : STATE_TRACE_ENTRIES;
+}
+
+bool state_trace_get(uint16_t index, StateTraceEntry *entry) {
+    if (!entry || index >= state_trace_count()) {
+        return false;
+    }
+    uint32_t oldest = g_trace_written - state_trace_count();
+    *entry = g_trace[(oldest + index) & (STATE_TRACE_ENTRIES - 1)];
+    return true;
+}
+
+void state_dispatch_get_stats(StateDispatchStats *stats) {
+    if (!stats) {
+        return;
+    }
+    *stats = g_dispatch.stats;
+}
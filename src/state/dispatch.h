@@ -0,0 +1,71 @@
+#ifndef DESKTHANG_DISPATCH_H
+#define DESKTHANG_DISPATCH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "state.h"
+
+// Run-to-completion dispatch for the state machine. A transition is an
+// event, (target, condition), checked against the transition table with
+// one lookup. Events posted while a transition's actions run (an on_entry
+// that moves straight on, say) are queued and run after it returns, in
+// order, instead of nesting inside it.
+//
+// Each transition leaves a fixed-size binary record in a trace ring rather
+// than formatted log lines. Only rejected transitions are logged.
+#ifndef STATE_EVENT_QUEUE_SIZE
+#define STATE_EVENT_QUEUE_SIZE 8   // Events posted from inside one transition
+#endif
+
+#ifndef STATE_TRACE_ENTRIES
+#define STATE_TRACE_ENTRIES 32     // Power of two; the oldest are overwritten
+#endif
+
+// Trace record results
+#define STATE_TRACE_TAKEN     0
+#define STATE_TRACE_REJECTED  1
+
+typedef struct {
+    uint32_t timestamp_us;   // When the transition started
+    uint16_t duration_us;    // Exit and entry actions, saturating
+    uint8_t from;
+    uint8_t to;
+    uint8_t condition;
+    uint8_t result;          // STATE_TRACE_*
+    uint8_t queued;          // Events still waiting behind it
+    uint8_t reserved;
+} StateTraceEntry;
+
+typedef struct {
+    uint32_t taken;
+    uint32_t rejected;
+    uint32_t deferred;        // Posted from inside a transition
+    uint32_t queue_full;      // Posts dropped for want of room
+    uint8_t queue_high_water;
+} StateDispatchStats;
+
+// Clear the queue, trace and statistics, then enter initial and run its
+// entry action. actions is indexed by state and must outlive the machine.
+bool state_dispatch_init(SystemState initial, const StateActions *actions);
+
+// Post a transition. Outside a transition it runs now, along with anything
+// its actions post, and returns whether it was taken. Inside one it is
+// queued, and returns whether the table allows it from the state being
+// entered.
+bool state_dispatch_post(SystemState next, StateCondition condition);
+
+SystemState state_dispatch_current(void);
+SystemState state_dispatch_previous(void);
+StateCondition state_dispatch_last_condition(void);
+uint32_t state_dispatch_entered_ms(void);
+
+// The table, plus RECOVERED only leading back to the state before ERROR
+bool state_dispatch_allowed(SystemState from, SystemState to, StateCondition condition);
+
+// Trace records held, and one of them; index 0 is the oldest
+uint16_t state_trace_count(void);
+bool state_trace_get(uint16_t index, StateTraceEntry *entry);
+
+void state_dispatch_get_stats(StateDispatchStats *stats);
+
+#endif // DESKTHANG_DISPATCH_H
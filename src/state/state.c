@@ -2,6 +2,7 @@
 #include "state.h"
 #include "context.h"
 #include "transition.h"
+#include "dispatch.h"
 #include "../error/logging.h"
 #include "../error/recovery.h"
 #include "../system/time.h"
@@ -246,142 +247,53 @@ static void error_error(void *ctx) {
     // Handle errors in error state
 }
 
-// Global state context
-static StateContext g_state_context;
-
 bool state_machine_init(void) {
     // Initialize context
     state_context_init();
     
-    // Set initial state
-    g_state_context.current_state = STATE_HARDWARE_INIT;
-    g_state_context.previous_state = STATE_HARDWARE_INIT;
-    g_state_context.last_condition = CONDITION_NONE;
-    g_state_context.last_update = deskthang_time_get_ms();
-    
-    // Execute entry action for initial state
-    if (STATE_ACTIONS[STATE_HARDWARE_INIT].on_entry) {
-        STATE_ACTIONS[STATE_HARDWARE_INIT].on_entry();
-    }
-    
-    return true;
+    // Enter the initial state; its entry action's transitions queue up
+    // and run once it returns
+    return state_dispatch_init(STATE_HARDWARE_INIT, STATE_ACTIONS);
 }
 
 bool state_machine_transition(SystemState next_state, StateCondition condition) {
-    // Get current state
-    SystemState current = state_machine_get_current();
-
-    char transition_msg[256];
-    snprintf(transition_msg, sizeof(transition_msg), "Attempting transition from %s to %s (condition: %s)",
-           state_to_string(current),
-           state_to_string(next_state),
-           condition_to_string(condition));
-    logging_write("State", transition_msg);
-
-    // Validate transition
-    if (!state_machine_validate_transition(current, next_state, condition)) {
-        char error_msg[256];
-        snprintf(error_msg, sizeof(error_msg), "Invalid state transition from %s to %s",
-               state_to_string(current),
-               state_to_string(next_state));
-        logging_write("State", error_msg);
-        return false;
-    }
-
-    // Execute exit actions for current state
-    if (STATE_ACTIONS[current].on_exit) {
-        char exit_msg[256];
-        snprintf(exit_msg, sizeof(exit_msg), "Executing exit actions for %s", state_to_string(current));
-        logging_write("State", exit_msg);
-        STATE_ACTIONS[current].on_exit();
-    }
-
-    // Update state
-    g_state_context.previous_state = current;
-    g_state_context.current_state = next_state;
-    g_state_context.last_condition = condition;
-    g_state_context.last_update = deskthang_time_get_ms();
-
-    // Execute entry actions for new state
-    if (STATE_ACTIONS[next_state].on_entry) {
-        char entry_msg[256];
-        snprintf(entry_msg, sizeof(entry_msg), "Executing entry actions for %s", state_to_string(next_state));
-        logging_write("State", entry_msg);
-        STATE_ACTIONS[next_state].on_entry();
-    }
-
-    char success_msg[256];
-    snprintf(success_msg, sizeof(success_msg), "Successfully transitioned to %s", state_to_string(next_state));
-    logging_write("State", success_msg);
-    return true;
+    return state_dispatch_post(next_state, condition);
 }
 
 bool state_machine_handle_error(void) {
-    if (g_state_context.current_state == STATE_ERROR) {
+    SystemState current = state_dispatch_current();
+    if (current == STATE_ERROR) {
         return false;  // Already in error state
     }
     
-    debug_log_transition(g_state_context.current_state, STATE_ERROR, CONDITION_ERROR, true);
+    debug_log_transition(current, STATE_ERROR, CONDITION_ERROR, true);
     return state_machine_transition(STATE_ERROR, CONDITION_ERROR);
 }
 
 bool state_machine_attempt_recovery(void) {
-    if (g_state_context.current_state != STATE_ERROR) {
+    if (state_dispatch_current() != STATE_ERROR) {
         return false;
     }
     
     if (state_context_can_retry()) {
         state_context_increment_retry();
         debug_log_retry("state_recovery");
-        return state_machine_transition(g_state_context.previous_state, CONDITION_RECOVERED);
+        return state_machine_transition(state_dispatch_previous(), CONDITION_RECOVERED);
     }
     
     return state_machine_transition(STATE_IDLE, CONDITION_RESET);
 }
 
 SystemState state_machine_get_current(void) {
-    return g_state_context.current_state;
+    return state_dispatch_current();
 }
 
 SystemState state_machine_get_previous(void) {
-    return g_state_context.previous_state;
+    return state_dispatch_previous();
 }
 
 bool state_machine_is_in_error(void) {
-    return g_state_context.current_state == STATE_ERROR;
-}
-
-// Debug support
-const char *state_to_string(SystemState state) {
-    switch (state) {
-        case STATE_HARDWARE_INIT:     return "HARDWARE_INIT";
-        case STATE_DISPLAY_INIT:      return "DISPLAY_INIT";
-        case STATE_IDLE:             return "IDLE";
-        case STATE_SYNCING:          return "SYNCING";
-        case STATE_READY:            return "READY";
-        case STATE_COMMAND_PROCESSING:return "COMMAND_PROCESSING";
-        case STATE_DATA_TRANSFER:    return "DATA_TRANSFER";
-        case STATE_ERROR:            return "ERROR";
-        default:                     return "UNKNOWN";
-    }
-}
-
-const char *condition_to_string(StateCondition condition) {
-    switch (condition) {
-        case CONDITION_NONE:           return "NONE";
-        case CONDITION_HARDWARE_READY: return "HARDWARE_READY";
-        case CONDITION_DISPLAY_READY:  return "DISPLAY_READY";
-        case CONDITION_SYNC_RECEIVED:  return "SYNC_RECEIVED";
-        case CONDITION_SYNC_VALID:     return "SYNC_VALID";
-        case CONDITION_COMMAND_VALID:  return "COMMAND_VALID";
-        case CONDITION_TRANSFER_START: return "TRANSFER_START";
-        case CONDITION_TRANSFER_COMPLETE: return "TRANSFER_COMPLETE";
-        case CONDITION_ERROR:          return "ERROR";
-        case CONDITION_RECOVERED:      return "RECOVERED";
-        case CONDITION_RESET:          return "RESET";
-        case CONDITION_RETRY:          return "RETRY";
-        default:                       return "UNKNOWN";
-    }
+    return state_dispatch_current() == STATE_ERROR;
 }
 
 // State validation functions implementation
@@ -542,41 +454,7 @@ bool state_machine_handle_recovery(const ErrorDetails *error) {
     }
 }
 
-bool state_machine_validate_state(SystemState state) {
-    return state >= STATE_HARDWARE_INIT && state <= STATE_ERROR;
-}
-
 bool state_machine_validate_transition(SystemState current, SystemState next, StateCondition condition) {
-    // First validate the states themselves
-    if (!state_machine_validate_state(current) || !state_machine_validate_state(next)) {
-        logging_write("State", "Invalid state value(s) in transition");
-        return false;
-    }
-
-    // Define valid transitions
-    switch (current) {
-        case STATE_HARDWARE_INIT:
-            // Can only go to DISPLAY_INIT or ERROR
-            return (next == STATE_DISPLAY_INIT && condition == CONDITION_HARDWARE_READY) ||
-                   (next == STATE_ERROR && condition == CONDITION_ERROR);
-
-        case STATE_DISPLAY_INIT:
-            // Can go to IDLE or ERROR
-            return (next == STATE_IDLE && condition == CONDITION_DISPLAY_READY) ||
-                   (next == STATE_ERROR && condition == CONDITION_ERROR);
-
-        case STATE_IDLE:
-            // Can go to SYNCING or ERROR
-            return (next == STATE_SYNCING && condition == CONDITION_SYNC_RECEIVED) ||
-                   (next == STATE_ERROR && condition == CONDITION_ERROR);
-
-        case STATE_ERROR:
-            // Can attempt recovery to previous state or reset to IDLE
-            return (next == g_state_context.previous_state && condition == CONDITION_RECOVERED) ||
-                   (next == STATE_IDLE && condition == CONDITION_RESET);
-
-        default:
-            logging_write("State", "Unhandled current state in transition validation");
-            return false;
-    }
+    // One table lookup; see TRANSITION_TABLE in transition.c
+    return state_dispatch_allowed(current, next, condition);
 }
@@ -30,7 +30,8 @@ typedef enum {
     CONDITION_ERROR,
     CONDITION_RESET,
     CONDITION_RETRY,
-    CONDITION_RECOVERED
+    CONDITION_RECOVERED,
+    CONDITION_COUNT
 } StateCondition;
 
 // Function pointer types for state actions
@@ -66,6 +67,10 @@ const char *condition_to_string(StateCondition condition);
 bool state_machine_handle_error(void);
 SystemState state_machine_get_current_state(void);
 
+// From ERROR: back to the state before it while retries last, else IDLE
+bool state_machine_attempt_recovery(void);
+bool state_machine_is_in_error(void);
+
 // Use STATE_* constants for validation flags
 typedef struct {
     uint8_t flags;          // Use STATE_VALID_* flags
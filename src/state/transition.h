@@ -5,13 +5,20 @@
 #include "state.h"
 #include "context.h"
 
-// State transition definition
+// Run after the table allows a transition; false vetoes it
+typedef bool (*TransitionGuard)(void);
+
+// One [state][condition] cell of the transition table: the states it may
+// lead to, as a bitmask. No bits means the condition is invalid there.
 typedef struct {
-    SystemState from_state;
-    SystemState to_state;
-    StateCondition condition;
-    bool (*validator)(void);
-} StateTransition;
+    uint8_t targets;
+    TransitionGuard guard;
+} TransitionRule;
+
+#define STATE_BIT(state) (1u << (state))
+
+// O(1): one table cell and its guard
+bool transition_allowed(SystemState from, SystemState to, StateCondition condition);
 
 // Transition validation
 bool transition_is_valid(const StateContext *ctx, SystemState next, StateCondition condition);
@@ -0,0 +1,73 @@
+#include "boot.h"
+#include "time.h"
+#include <stdio.h>
+#include <string.h>
+
+static struct {
+    uint32_t phase_us[BOOT_PHASE_COUNT];
+    bool marked[BOOT_PHASE_COUNT];
+} boot_timeline = {0};
+
+void boot_mark(BootPhase phase) {
+    if (phase >= BOOT_PHASE_COUNT || boot_timeline.marked[phase]) {
+        return;
+    }
+
+    boot_timeline.phase_us[phase] = deskthang_time_get_us();
+    boot_timeline.marked[phase] = true;
+}
+
+uint32_t boot_phase_us(BootPhase phase) {
+    if (phase >= BOOT_PHASE_COUNT || !boot_timeline.marked[phase]) {
+        return 0;
+    }
+    return boot_timeline.phase_us[phase];
+}
+
+bool boot_is_ready(void) {
+    return boot_timeline.marked[BOOT_PHASE_READY];
+}
+
+const char *boot_phase_to_string(BootPhase phase) {
+    switch (phase) {
+        case BOOT_PHASE_STDIO:    return "stdio";
+        case BOOT_PHASE_ERROR:    return "error";
+        case BOOT_PHASE_SERIAL:   return "serial";
+        case BOOT_PHASE_LOGGING:  return "logging";
+        case BOOT_PHASE_RECOVERY: return "recovery";
+        case BOOT_PHASE_HARDWARE: return "hardware";
+        case BOOT_PHASE_PANEL:    return "panel";
+        case BOOT_PHASE_DISPLAY:  return "display";
+        case BOOT_PHASE_READY:    return "ready";
+        default:                  return "unknown";
+    }
+}
+
+size_t boot_timeline_format(char *out, size_t size) {
+    if (!out || size == 0) {
+        return 0;
+    }
+
+    size_t length = 0;
+    out[0] = '\0';
+    for (int phase = 0; phase < BOOT_PHASE_COUNT; phase++) {
+        if (!boot_timeline.marked[phase]) {
+            continue;
+        }
+
+        int written = snprintf(out + length, size - length, "%s%s=%lu",
+                               length > 0 ? " " : "",
+                               boot_phase_to_string((BootPhase)phase),
+                               (unsigned long)boot_timeline.phase_us[phase]);
+        if (written < 0 || (size_t)written >= size - length) {
+            break;  // Keep the pairs that fit whole
+        }
+        length += written;
+    }
+    out[length] = '\0';
+    return length;
+}
+
+void boot_reset(void) {
+    memset(&boot_timeline, 0, sizeof(boot_timeline));
+}
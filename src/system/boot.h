@@ -0,0 +1,41 @@
+#ifndef DESKTHANG_BOOT_H
+#define DESKTHANG_BOOT_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Boot timeline: the time each init phase finished, in microseconds since
+// power-on. Phases are marked once, in any order; the host reads the
+// timeline with the 'T' command.
+typedef enum {
+    BOOT_PHASE_STDIO,      // USB stdio up
+    BOOT_PHASE_ERROR,      // Error handling
+    BOOT_PHASE_SERIAL,     // Serial rings
+    BOOT_PHASE_LOGGING,    // Logging and debug packets
+    BOOT_PHASE_RECOVERY,   // Recovery handlers
+    BOOT_PHASE_HARDWARE,   // GPIO and SPI
+    BOOT_PHASE_PANEL,      // GC9A01 reset and init sequence
+    BOOT_PHASE_DISPLAY,    // Panel cleared (and self-test, if enabled)
+    BOOT_PHASE_READY,      // Main loop accepting packets
+    BOOT_PHASE_COUNT
+} BootPhase;
+
+// Record the end of phase, unless it was already marked
+void boot_mark(BootPhase phase);
+
+// Microseconds since power-on at which phase finished, 0 if not reached
+uint32_t boot_phase_us(BootPhase phase);
+
+bool boot_is_ready(void);
+
+const char *boot_phase_to_string(BootPhase phase);
+
+// Write the timeline as "name=us" pairs, for example
+// "stdio=1830 error=1851 ... ready=196412". Returns the length written.
+size_t boot_timeline_format(char *out, size_t size);
+
+// Forget every mark (tests)
+void boot_reset(void);
+
+#endif // DESKTHANG_BOOT_H
@@ -0,0 +1,32 @@
+#ifndef DESKTHANG_PLATFORM_H
+#define DESKTHANG_PLATFORM_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// The second core. On the RP2040 it is core1; the host test build stands a
+// thread in for it, so code shared between the cores runs under both.
+// Cross-core data goes through SPSC rings (hardware/serial_ring.h), whose
+// acquire/release counters carry the ordering on either platform.
+typedef void (*PlatformCoreEntry)(void);
+
+// Run entry on the second core. False if it is already running.
+bool platform_core_launch(PlatformCoreEntry entry);
+
+// Wait for entry to return and free the core for another launch
+void platform_core_join(void);
+
+// 0 on core0, 1 on the second core
+unsigned platform_core_index(void);
+
+// Idle until the other core signals (or briefly, if it already has)
+void platform_core_wait(void);
+
+// Wake the other core out of platform_core_wait
+void platform_core_signal(void);
+
+// Sleep this core for up to timeout_us, or until an interrupt or event;
+// UINT32_MAX waits for one with no timeout. May return early.
+void platform_idle(uint32_t timeout_us);
+
+#endif // DESKTHANG_PLATFORM_H
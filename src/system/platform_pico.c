@@ -0,0 +1,47 @@
+#include "platform.h"
+#include "pico/stdlib.h"
+#include "pico/multicore.h"
+
+static bool core1_running = false;
+
+bool platform_core_launch(PlatformCoreEntry entry) {
+    if (core1_running || !entry) {
+        return false;
+    }
+
+    multicore_launch_core1(entry);
+    core1_running = true;
+    return true;
+}
+
+void platform_core_join(void) {
+    if (!core1_running) {
+        return;
+    }
+
+    // Core1 has no join; once its entry has returned it is held in reset
+    multicore_reset_core1();
+    core1_running = false;
+}
+
+unsigned platform_core_index(void) {
+    return get_core_num();
+}
+
+void platform_core_wait(void) {
+    __wfe();
+}
+
+void platform_core_signal(void) {
+    __sev();
+}
+
+void platform_idle(uint32_t timeout_us) {
+    // An interrupt taken since the caller last looked sets the event
+    // register, so this returns at once rather than sleeping through it
+    if (timeout_us == UINT32_MAX) {
+        __wfe();
+        return;
+    }
+    best_effort_wfe_or_timeout(make_timeout_time_us(timeout_us));
+}
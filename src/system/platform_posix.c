@@ -0,0 +1,57 @@
+#include "platform.h"
+#include <pthread.h>
+#include <sched.h>
+
+// Host build: a thread stands in for core1
+static pthread_t core_thread;
+static bool core_running = false;
+
+// Set on the stand-in thread itself, so it is right from its first
+// instruction rather than once launch has stored the thread id
+static __thread bool on_core1 = false;
+
+static void *platform_core_trampoline(void *arg) {
+    PlatformCoreEntry entry = (PlatformCoreEntry)arg;
+    on_core1 = true;
+    entry();
+    return NULL;
+}
+
+bool platform_core_launch(PlatformCoreEntry entry) {
+    if (core_running || !entry) {
+        return false;
+    }
+
+    if (pthread_create(&core_thread, NULL, platform_core_trampoline, (void*)entry) != 0) {
+        return false;
+    }
+    core_running = true;
+    return true;
+}
+
+void platform_core_join(void) {
+    if (!core_running) {
+        return;
+    }
+
+    pthread_join(core_thread, NULL);
+    core_running = false;
+}
+
+unsigned platform_core_index(void) {
+    return on_core1 ? 1 : 0;
+}
+
+void platform_core_wait(void) {
+    // No WFE to sleep on; give the other thread the CPU
+    sched_yield();
+}
+
+void platform_core_signal(void) {
+}
+
+void platform_idle(uint32_t timeout_us) {
+    // Mock time doesn't pass while we sleep; just let other threads run
+    (void)timeout_us;
+    sched_yield();
+}
@@ -0,0 +1,304 @@
+#include "scheduler.h"
+#include "platform.h"
+#include "time.h"
+#include "../debug/trace.h"
+#include <stddef.h>
+#include <string.h>
+
+#define SCHED_WHEEL_MASK   (SCHED_WHEEL_SLOTS - 1)
+#define SCHED_WHEEL_SPAN   (1u << (SCHED_WHEEL_BITS * SCHED_WHEEL_LEVELS))
+
+typedef struct {
+    const char *name;
+    SchedTaskFn fn;
+    void *context;
+    uint32_t wake_on;
+    bool ready;
+} SchedTask;
+
+static struct {
+    bool initialized;
+
+    SchedTask tasks[SCHED_MAX_TASKS];
+    uint8_t task_count;
+
+    // Set by interrupt handlers, cleared by the pass that wakes the tasks.
+    // One byte each so setting one never races with clearing another.
+    volatile uint8_t pending[SCHED_EVENT_COUNT];
+
+    SchedTimer *wheel[SCHED_WHEEL_LEVELS][SCHED_WHEEL_SLOTS];
+    uint16_t level_count[SCHED_WHEEL_LEVELS];
+    uint32_t base;      // Next tick the wheel will expire
+    uint32_t now;       // Ticks since init, extended past the us clock's wrap
+    uint32_t last_us;   // Clock reading now was counted up to
+
+    SchedulerStats stats;
+} g_sched;
+
+// Bring the tick count up to the clock
+static uint32_t scheduler_now(void) {
+    uint32_t ticks = (deskthang_time_get_us() - g_sched.last_us) / SCHED_TICK_US;
+    g_sched.last_us += ticks * SCHED_TICK_US;
+    g_sched.now += ticks;
+    return g_sched.now;
+}
+
+static void wheel_unlink(SchedTimer *timer) {
+    if (timer->next) {
+        timer->next->pprev = timer->pprev;
+    }
+    *timer->pprev = timer->next;
+    timer->next = NULL;
+    timer->pprev = NULL;
+    g_sched.level_count[timer->level]--;
+}
+
+// File the timer by how far its deadline is from base: level 0 holds the
+// next 64 ticks one per slot, each level above 64 times coarser. A level's
+// slot is moved down a level when base reaches it.
+static void wheel_insert(SchedTimer *timer) {
+    uint32_t expires = timer->expires;
+    uint32_t delta = expires - g_sched.base;
+
+    if ((int32_t)delta < 0) {
+        expires = g_sched.base;  // Already due: the next tick
+        delta = 0;
+    } else if (delta >= SCHED_WHEEL_SPAN) {
+        expires = g_sched.base + SCHED_WHEEL_SPAN - 1;  // Refiled when reached
+        delta = SCHED_WHEEL_SPAN - 1;
+    }
+
+    uint8_t level = 0;
+    while (delta >= (1u << (SCHED_WHEEL_BITS * (level + 1)))) {
+        level++;
+    }
+
+    SchedTimer **slot = &g_sched.wheel[level][(expires >> (SCHED_WHEEL_BITS * level)) & SCHED_WHEEL_MASK];
+    timer->next = *slot;
+    if (timer->next) {
+        timer->next->pprev = &timer->next;
+    }
+    timer->pprev = slot;
+    *slot = timer;
+    timer->level = level;
+    g_sched.level_count[level]++;
+}
+
+// Take a slot's list off the wheel. Callers pop from head one timer at a
+// time, so a callback may cancel or restart any timer still on it.
+static void wheel_detach(uint8_t level, uint32_t index, SchedTimer **head) {
+    *head = g_sched.wheel[level][index];
+    g_sched.wheel[level][index] = NULL;
+    if (*head) {
+        (*head)->pprev = head;
+    }
+}
+
+static void wheel_cascade(uint8_t level, uint32_t index) {
+    SchedTimer *head;
+    wheel_detach(level, index, &head);
+    while (head) {
+        SchedTimer *timer = head;
+        wheel_unlink(timer);
+        wheel_insert(timer);
+    }
+}
+
+static void wheel_expire(uint32_t tick) {
+    uint32_t index = tick & SCHED_WHEEL_MASK;
+    for (uint8_t level = 1; level < SCHED_WHEEL_LEVELS && index == 0; level++) {
+        index = (tick >> (SCHED_WHEEL_BITS * level)) & SCHED_WHEEL_MASK;
+        wheel_cascade(level, index);
+    }
+
+    SchedTimer *head;
+    wheel_detach(0, tick & SCHED_WHEEL_MASK, &head);
+    g_sched.base = tick + 1;  // Anything started from a callback lands after this tick
+
+    while (head) {
+        SchedTimer *timer = head;
+        wheel_unlink(timer);
+
+        if ((int32_t)(g_sched.now - timer->expires) > 0) {
+            g_sched.stats.timers_late++;
+        }
+        g_sched.stats.timers_fired++;
+
+        if (timer->period) {
+            timer->expires += timer->period;
+            if ((int32_t)(timer->expires - g_sched.now) <= 0) {
+                timer->expires = g_sched.now + timer->period;  // Skip missed periods
+            }
+            wheel_insert(timer);
+        }
+        timer->fn(timer->context);
+    }
+}
+
+void scheduler_init(void) {
+    memset(&g_sched, 0, sizeof(g_sched));
+    g_sched.last_us = deskthang_time_get_us();
+    g_sched.initialized = true;
+}
+
+int scheduler_task_add(const char *name, SchedTaskFn fn, void *context, uint32_t wake_on) {
+    if (!fn || g_sched.task_count >= SCHED_MAX_TASKS) {
+        return -1;
+    }
+
+    SchedTask *task = &g_sched.tasks[g_sched.task_count];
+    task->name = name;
+    task->fn = fn;
+    task->context = context;
+    task->wake_on = wake_on;
+    task->ready = false;
+    return g_sched.task_count++;
+}
+
+void scheduler_task_wake(int task) {
+    if (task >= 0 && task < g_sched.task_count) {
+        g_sched.tasks[task].ready = true;
+    }
+}
+
+void scheduler_signal(SchedEvent event) {
+    if ((unsigned)event < SCHED_EVENT_COUNT) {
+        g_sched.pending[event] = 1;
+    }
+}
+
+void scheduler_timer_start(SchedTimer *timer, uint32_t delay_us, uint32_t period_us,
+                           SchedTimerFn fn, void *context) {
+    if (!timer || !fn) {
+        return;
+    }
+    if (!g_sched.initialized) {
+        scheduler_init();
+    }
+
+    scheduler_timer_cancel(timer);
+    timer->fn = fn;
+    timer->context = context;
+    // Count from the start of the current tick so it never fires early
+    uint32_t now = scheduler_now();
+    uint32_t from_tick = deskthang_time_get_us() - g_sched.last_us + delay_us;
+    timer->expires = now + (from_tick + SCHED_TICK_US - 1) / SCHED_TICK_US;
+    timer->period = period_us ? (period_us + SCHED_TICK_US - 1) / SCHED_TICK_US : 0;
+    wheel_insert(timer);
+}
+
+void scheduler_timer_cancel(SchedTimer *timer) {
+    if (!timer || !timer->pprev) {
+        return;
+    }
+
+    wheel_unlink(timer);
+}
+
+bool scheduler_timer_armed(const SchedTimer *timer) {
+    return timer && timer->pprev != NULL;
+}
+
+bool scheduler_run_once(void) {
+    g_sched.stats.passes++;
+
+    // Timers first, so a task woken by one runs in this pass
+    uint32_t now = scheduler_now();
+    while ((int32_t)(now - g_sched.base) >= 0) {
+        wheel_expire(g_sched.base);
+    }
+
+    uint32_t events = 0;
+    for (uint8_t event = 0; event < SCHED_EVENT_COUNT; event++) {
+        if (g_sched.pending[event]) {
+            g_sched.pending[event] = 0;
+            events |= SCHED_EVENT_BIT(event);
+        }
+    }
+
+    bool busy = false;
+    for (uint8_t i = 0; i < g_sched.task_count; i++) {
+        SchedTask *task = &g_sched.tasks[i];
+        if (!task->ready && !(task->wake_on & (events | SCHED_WAKE_ALWAYS))) {
+            continue;
+        }
+        task->ready = task->fn(task->context);
+        g_sched.stats.task_runs++;
+        busy |= task->ready;
+    }
+
+    return busy;
+}
+
+uint32_t scheduler_idle_budget_us(void) {
+    for (uint8_t i = 0; i < g_sched.task_count; i++) {
+        if (g_sched.tasks[i].ready) {
+            return 0;
+        }
+    }
+    for (uint8_t event = 0; event < SCHED_EVENT_COUNT; event++) {
+        if (g_sched.pending[event]) {
+            return 0;
+        }
+    }
+
+    // The first occupied level-0 slot, or the next cascade if sooner
+    uint32_t due = 0;
+    bool found = false;
+    if (g_sched.level_count[0] > 0) {
+        for (uint32_t ahead = 0; ahead < SCHED_WHEEL_SLOTS; ahead++) {
+            if (g_sched.wheel[0][(g_sched.base + ahead) & SCHED_WHEEL_MASK]) {
+                due = g_sched.base + ahead;
+                found = true;
+                break;
+            }
+        }
+    }
+    for (uint8_t level = 1; level < SCHED_WHEEL_LEVELS; level++) {
+        if (g_sched.level_count[level] > 0) {
+            uint32_t cascade = (g_sched.base | SCHED_WHEEL_MASK) + 1;
+            if (!found || (int32_t)(cascade - due) < 0) {
+                due = cascade;
+                found = true;
+            }
+            break;
+        }
+    }
+    if (!found) {
+        return UINT32_MAX;
+    }
+
+    uint32_t now = scheduler_now();
+    if ((int32_t)(due - now) <= 0) {
+        return 0;
+    }
+    uint32_t into_tick = deskthang_time_get_us() - g_sched.last_us;
+    uint32_t budget = (due - now) * SCHED_TICK_US;
+    return budget > into_tick ? budget - into_tick : 0;
+}
+
+void scheduler_run(void) {
+    while (1) {
+        if (scheduler_run_once()) {
+            continue;
+        }
+        uint32_t budget = scheduler_idle_budget_us();
+        if (budget > 0) {
+            g_sched.stats.idles++;
+            TRACE_BEGIN(SCHED_IDLE, budget);
+            platform_idle(budget);
+            TRACE_END(SCHED_IDLE, 0);
+        }
+    }
+}
+
+void scheduler_get_stats(SchedulerStats *stats) {
+    if (!stats) {
+        return;
+    }
+    *stats = g_sched.stats;
+    stats->timers_armed = 0;
+    for (uint8_t level = 0; level < SCHED_WHEEL_LEVELS; level++) {
+        stats->timers_armed += g_sched.level_count[level];
+    }
+}
@@ -0,0 +1,99 @@
+#ifndef DESKTHANG_SCHEDULER_H
+#define DESKTHANG_SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Cooperative scheduler for core0. Tasks run to completion, in the order
+// they were added, when an event they wait on is signalled or something
+// wakes them. Deadlines live on a hierarchical timer wheel: three levels of
+// 64 slots, so starting, cancelling and expiring a timer is O(1) whatever
+// the number armed. When nothing is runnable the core sleeps until the
+// next timer or an interrupt, instead of polling.
+//
+// Everything here is core0-only except scheduler_signal, which interrupt
+// handlers and core1 may call.
+#ifndef SCHED_MAX_TASKS
+#define SCHED_MAX_TASKS 8
+#endif
+
+#ifndef SCHED_TICK_US
+#define SCHED_TICK_US 250          // Timer resolution
+#endif
+
+#define SCHED_WHEEL_BITS   6
+#define SCHED_WHEEL_SLOTS  (1u << SCHED_WHEEL_BITS)
+#define SCHED_WHEEL_LEVELS 3       // Reaches 2^18 ticks, 65 s at 250 us
+
+// Interrupt sources that wake tasks
+typedef enum {
+    SCHED_EVENT_USB_RX,     // Bytes arrived in the serial RX ring
+    SCHED_EVENT_SPI_DONE,   // A panel DMA transfer finished
+    SCHED_EVENT_COUNT
+} SchedEvent;
+
+#define SCHED_EVENT_BIT(event) (1u << (event))
+
+// Runs every pass, whether woken or not (services that only poll)
+#define SCHED_WAKE_ALWAYS 0x80000000u
+
+// A task step. Return true if it did work and may have more: it stays
+// runnable and the scheduler won't sleep. False waits for the next wake.
+typedef bool (*SchedTaskFn)(void *context);
+
+typedef void (*SchedTimerFn)(void *context);
+
+// Caller-owned timer; zero it (or leave it static) before first use
+typedef struct SchedTimer {
+    struct SchedTimer *next;
+    struct SchedTimer **pprev;   // Link pointing at this timer, NULL when idle
+    uint32_t expires;            // Tick
+    uint32_t period;             // Ticks, 0 for one-shot
+    uint8_t level;               // Wheel level it is filed on
+    SchedTimerFn fn;
+    void *context;
+} SchedTimer;
+
+typedef struct {
+    uint32_t passes;         // scheduler_run_once calls
+    uint32_t idles;          // Times the core slept
+    uint32_t task_runs;
+    uint32_t timers_fired;
+    uint32_t timers_late;    // Fired a tick or more after their deadline
+    uint16_t timers_armed;
+} SchedulerStats;
+
+// Forget every task and timer. Call before anything arms a timer.
+void scheduler_init(void);
+
+// Add a task woken by the SCHED_EVENT_BIT events in wake_on (and/or
+// SCHED_WAKE_ALWAYS). Returns its id, -1 if the table is full.
+int scheduler_task_add(const char *name, SchedTaskFn fn, void *context, uint32_t wake_on);
+
+// Make a task runnable on the next pass
+void scheduler_task_wake(int task);
+
+// Interrupt-safe: mark event pending; the tasks waiting on it run next pass
+void scheduler_signal(SchedEvent event);
+
+// Arm timer to call fn delay_us from now, then every period_us if that is
+// non-zero. Restarting an armed timer moves it. Rounded up to whole ticks.
+void scheduler_timer_start(SchedTimer *timer, uint32_t delay_us, uint32_t period_us,
+                           SchedTimerFn fn, void *context);
+void scheduler_timer_cancel(SchedTimer *timer);
+bool scheduler_timer_armed(const SchedTimer *timer);
+
+// Expire due timers and run runnable tasks once. Returns true if there may
+// be more to do right away.
+bool scheduler_run_once(void);
+
+// Microseconds until the earliest timer may be due, 0 if work is waiting,
+// UINT32_MAX if only an event can wake anything
+uint32_t scheduler_idle_budget_us(void);
+
+// run_once forever, sleeping for the idle budget whenever it returns false
+void scheduler_run(void);
+
+void scheduler_get_stats(SchedulerStats *stats);
+
+#endif // DESKTHANG_SCHEDULER_H
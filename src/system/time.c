@@ -7,6 +7,10 @@ uint32_t deskthang_time_get_ms(void) {
     return to_ms_since_boot(get_absolute_time());
 }
 
+uint32_t deskthang_time_get_us(void) {
+    return time_us_32();
+}
+
 void deskthang_delay_ms(uint32_t ms) {
     sleep_ms(ms);
 }
@@ -10,6 +10,12 @@
  */
 uint32_t deskthang_time_get_ms(void);
 
+/**
+ * Get current system time in microseconds since boot
+ * @return Current time in microseconds (wraps after ~71 minutes)
+ */
+uint32_t deskthang_time_get_us(void);
+
 /**
  * Delay execution for specified milliseconds
  * @param ms Number of milliseconds to delay
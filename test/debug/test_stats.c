@@ -0,0 +1,140 @@
+#include <unity.h>
+#include <string.h>
+#include "../../src/debug/stats.h"
+#include "../mocks/mock_time.h"
+
+static uint8_t payload[STATS_PAYLOAD_SIZE];
+
+static uint32_t get_u32(const uint8_t *in) {
+    return in[0] | (in[1] << 8) | (in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+// Offset of a histogram's max_us in the payload
+static size_t histogram_offset(StatsLatency which) {
+    return STATS_HEADER_SIZE + STATS_COUNTER_COUNT * 4 + which * (1 + STATS_BUCKETS) * 4;
+}
+
+void setUp(void) {
+    mock_time_set(1000);
+    stats_reset();
+    memset(payload, 0, sizeof(payload));
+}
+
+void tearDown(void) {
+}
+
+void test_buckets_are_powers_of_two(void) {
+    TEST_ASSERT_EQUAL(0, stats_bucket(0));
+    TEST_ASSERT_EQUAL(1, stats_bucket(1));
+    TEST_ASSERT_EQUAL(2, stats_bucket(2));
+    TEST_ASSERT_EQUAL(2, stats_bucket(3));
+    TEST_ASSERT_EQUAL(3, stats_bucket(4));
+    TEST_ASSERT_EQUAL(10, stats_bucket(1023));
+    TEST_ASSERT_EQUAL(11, stats_bucket(1024));
+    TEST_ASSERT_EQUAL(STATS_BUCKETS - 1, stats_bucket(1u << (STATS_BUCKETS - 2)));
+    TEST_ASSERT_EQUAL(STATS_BUCKETS - 1, stats_bucket(UINT32_MAX));
+}
+
+void test_latency_fills_buckets_and_max(void) {
+    stats_latency_record(STATS_LATENCY_CRC, 5);
+    stats_latency_record(STATS_LATENCY_CRC, 7);
+    stats_latency_record(STATS_LATENCY_CRC, 300);
+    stats_latency_record(STATS_LATENCY_COUNT, 9);  // Ignored
+
+    StatsHistogram histogram;
+    stats_get_histogram(STATS_LATENCY_CRC, &histogram);
+    TEST_ASSERT_EQUAL_UINT32(300, histogram.max_us);
+    TEST_ASSERT_EQUAL_UINT32(2, histogram.buckets[3]);
+    TEST_ASSERT_EQUAL_UINT32(1, histogram.buckets[9]);
+
+    stats_get_histogram(STATS_LATENCY_PARSE, &histogram);
+    TEST_ASSERT_EQUAL_UINT32(0, histogram.max_us);
+    TEST_ASSERT_EQUAL_UINT32(0, histogram.buckets[3]);
+}
+
+void test_ack_times_the_first_ack_after_a_frame(void) {
+    stats_ack_sent();  // No frame yet
+
+    stats_mark_rx_frame();
+    mock_time_advance(2);
+    stats_ack_sent();
+    mock_time_advance(5);
+    stats_ack_sent();  // Already answered
+
+    StatsHistogram histogram;
+    stats_get_histogram(STATS_LATENCY_ACK, &histogram);
+    TEST_ASSERT_EQUAL_UINT32(2000, histogram.max_us);
+    uint32_t samples = 0;
+    for (int b = 0; b < STATS_BUCKETS; b++) {
+        samples += histogram.buckets[b];
+    }
+    TEST_ASSERT_EQUAL_UINT32(1, samples);
+    TEST_ASSERT_EQUAL_UINT32(1, histogram.buckets[stats_bucket(2000)]);
+}
+
+void test_counters_per_direction(void) {
+    stats_count_rx(100);
+    stats_count_rx(28);
+    stats_count_rx_packet(true);
+    stats_count_rx_packet(true);
+    stats_count_rx_packet(false);
+    stats_count_tx_packet(14);
+    stats_set_transfer_speed(512000);
+
+    StatsCounters counters;
+    stats_get_counters(&counters);
+    TEST_ASSERT_EQUAL_UINT32(128, counters.rx_bytes);
+    TEST_ASSERT_EQUAL_UINT32(2, counters.rx_packets);
+    TEST_ASSERT_EQUAL_UINT32(1, counters.rx_dropped);
+    TEST_ASSERT_EQUAL_UINT32(14, counters.tx_bytes);
+    TEST_ASSERT_EQUAL_UINT32(1, counters.tx_packets);
+    TEST_ASSERT_EQUAL_UINT32(512000, counters.transfer_bps);
+}
+
+void test_encode_layout(void) {
+    stats_count_rx(64);
+    stats_count_tx_packet(20);
+    stats_latency_record(STATS_LATENCY_FRAME, 40000);
+    stats_latency_record(STATS_LATENCY_STATE, 0);
+
+    TEST_ASSERT_TRUE(stats_encode(payload, sizeof(payload)));
+    TEST_ASSERT_EQUAL_UINT32(1000000, get_u32(&payload[0]));
+    TEST_ASSERT_EQUAL(STATS_LATENCY_COUNT, payload[4]);
+    TEST_ASSERT_EQUAL(STATS_BUCKETS, payload[5]);
+
+    const uint8_t *counters = &payload[STATS_HEADER_SIZE];
+    TEST_ASSERT_EQUAL_UINT32(64, get_u32(&counters[0]));
+    TEST_ASSERT_EQUAL_UINT32(20, get_u32(&counters[12]));
+    TEST_ASSERT_EQUAL_UINT32(1, get_u32(&counters[16]));
+
+    const uint8_t *frame = &payload[histogram_offset(STATS_LATENCY_FRAME)];
+    TEST_ASSERT_EQUAL_UINT32(40000, get_u32(&frame[0]));
+    TEST_ASSERT_EQUAL_UINT32(1, get_u32(&frame[4 + stats_bucket(40000) * 4]));
+
+    const uint8_t *state = &payload[histogram_offset(STATS_LATENCY_STATE)];
+    TEST_ASSERT_EQUAL_UINT32(1, get_u32(&state[4]));
+
+    // The last histogram ends the payload
+    TEST_ASSERT_EQUAL(STATS_PAYLOAD_SIZE, histogram_offset(STATS_LATENCY_COUNT));
+}
+
+void test_encode_needs_room(void) {
+    TEST_ASSERT_FALSE(stats_encode(payload, sizeof(payload) - 1));
+    TEST_ASSERT_FALSE(stats_encode(NULL, sizeof(payload)));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    // Histograms
+    RUN_TEST(test_buckets_are_powers_of_two);
+    RUN_TEST(test_latency_fills_buckets_and_max);
+    RUN_TEST(test_ack_times_the_first_ack_after_a_frame);
+
+    // Counters and payload
+    RUN_TEST(test_counters_per_direction);
+    RUN_TEST(test_encode_layout);
+    RUN_TEST(test_encode_needs_room);
+
+    return UNITY_END();
+}
@@ -0,0 +1,179 @@
+#include <unity.h>
+#include <string.h>
+#include "../../src/debug/trace.h"
+#include "../../src/system/platform.h"
+#include "../mocks/mock_time.h"
+
+#define MAX_PARTS 8
+
+static TraceRecord snapshot[TRACE_RING_RECORDS];
+
+// Dump payloads as the host would receive them
+static struct {
+    uint8_t data[TRACE_DUMP_HEADER_SIZE + TRACE_DUMP_RECORDS * TRACE_RECORD_SIZE];
+    size_t length;
+} parts[MAX_PARTS];
+static int part_count;
+static int fail_at;  // Refuse this part (0 = never)
+
+static uint32_t get_u32(const uint8_t *in) {
+    return in[0] | (in[1] << 8) | (in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+static uint16_t get_u16(const uint8_t *in) {
+    return (uint16_t)(in[0] | (in[1] << 8));
+}
+
+static bool capture(const uint8_t *payload, size_t length, void *context) {
+    (void)context;
+    if (part_count >= MAX_PARTS || part_count + 1 == fail_at) {
+        return false;
+    }
+    memcpy(parts[part_count].data, payload, length);
+    parts[part_count].length = length;
+    part_count++;
+    return true;
+}
+
+void setUp(void) {
+    mock_time_set(1000);
+    trace_reset();
+    memset(parts, 0, sizeof(parts));
+    part_count = 0;
+    fail_at = 0;
+}
+
+void tearDown(void) {
+}
+
+void test_spans_nest_in_order(void) {
+    TRACE_BEGIN(RX_POLL, 0);
+    mock_time_advance(1);
+    TRACE_BEGIN(PACKET_DECODE, 530);
+    TRACE_BEGIN(CRC, 512);
+    mock_time_advance(2);
+    TRACE_END(CRC, 1);
+    TRACE_END(PACKET_DECODE, 1);
+    TRACE_INSTANT(TRANSFER_START, 4);
+    TRACE_END(RX_POLL, 100000);  // Saturates
+
+    uint32_t lost;
+    TEST_ASSERT_EQUAL(7, trace_snapshot(0, snapshot, &lost));
+    TEST_ASSERT_EQUAL(0, lost);
+
+    const struct { uint8_t event, phase; uint32_t at_us; uint16_t arg; } expected[7] = {
+        {TRACE_EVENT_RX_POLL,        TRACE_PHASE_BEGIN,   1000000, 0},
+        {TRACE_EVENT_PACKET_DECODE,  TRACE_PHASE_BEGIN,   1001000, 530},
+        {TRACE_EVENT_CRC,            TRACE_PHASE_BEGIN,   1001000, 512},
+        {TRACE_EVENT_CRC,            TRACE_PHASE_END,     1003000, 1},
+        {TRACE_EVENT_PACKET_DECODE,  TRACE_PHASE_END,     1003000, 1},
+        {TRACE_EVENT_TRANSFER_START, TRACE_PHASE_INSTANT, 1003000, 4},
+        {TRACE_EVENT_RX_POLL,        TRACE_PHASE_END,     1003000, UINT16_MAX},
+    };
+    for (int i = 0; i < 7; i++) {
+        TEST_ASSERT_EQUAL(expected[i].event, snapshot[i].event);
+        TEST_ASSERT_EQUAL(expected[i].phase, snapshot[i].phase);
+        TEST_ASSERT_EQUAL_UINT32(expected[i].at_us, snapshot[i].timestamp_us);
+        TEST_ASSERT_EQUAL(expected[i].arg, snapshot[i].arg);
+    }
+}
+
+void test_ring_keeps_the_newest_events(void) {
+    for (uint32_t i = 0; i < TRACE_RING_RECORDS + 44; i++) {
+        TRACE_INSTANT(SPI_DMA, i);
+    }
+
+    uint32_t lost;
+    TEST_ASSERT_EQUAL(TRACE_RING_RECORDS, trace_snapshot(0, snapshot, &lost));
+    TEST_ASSERT_EQUAL(44, lost);
+    TEST_ASSERT_EQUAL(44, snapshot[0].arg);
+    TEST_ASSERT_EQUAL(TRACE_RING_RECORDS + 43, snapshot[TRACE_RING_RECORDS - 1].arg);
+}
+
+static void core1_events(void) {
+    TRACE_BEGIN(CHUNK_DECODE, 7);
+    TRACE_END(CHUNK_DECODE, 1);
+}
+
+void test_each_core_has_its_own_ring(void) {
+    TRACE_BEGIN(PACKET_HANDLE, 2);
+    TEST_ASSERT_TRUE(platform_core_launch(core1_events));
+    platform_core_join();
+    TRACE_END(PACKET_HANDLE, 0);
+
+    uint32_t lost;
+    TEST_ASSERT_EQUAL(2, trace_snapshot(0, snapshot, &lost));
+    TEST_ASSERT_EQUAL(TRACE_EVENT_PACKET_HANDLE, snapshot[0].event);
+    TEST_ASSERT_EQUAL(TRACE_EVENT_PACKET_HANDLE, snapshot[1].event);
+
+    TEST_ASSERT_EQUAL(2, trace_snapshot(1, snapshot, &lost));
+    TEST_ASSERT_EQUAL(TRACE_EVENT_CHUNK_DECODE, snapshot[0].event);
+    TEST_ASSERT_EQUAL(7, snapshot[0].arg);
+    TEST_ASSERT_EQUAL(TRACE_PHASE_END, snapshot[1].phase);
+}
+
+void test_dump_splits_each_core_into_packets(void) {
+    for (uint32_t i = 0; i < TRACE_RING_RECORDS + 10; i++) {
+        mock_time_advance(1);
+        TRACE_INSTANT(SPI_DMA, i);
+    }
+
+    TEST_ASSERT_TRUE(trace_dump(capture, NULL));
+
+    // 256 records at 126 a packet, then an empty one for core1
+    TEST_ASSERT_EQUAL(4, part_count);
+    const uint16_t counts[4] = {126, 126, 4, 0};
+    uint16_t arg = 10;
+    for (int i = 0; i < 4; i++) {
+        const uint8_t *part = parts[i].data;
+        TEST_ASSERT_EQUAL(TRACE_DUMP_HEADER_SIZE + counts[i] * TRACE_RECORD_SIZE, parts[i].length);
+        TEST_ASSERT_EQUAL_UINT32(1266000, get_u32(&part[0]));
+        TEST_ASSERT_EQUAL(i < 3 ? 10 : 0, get_u32(&part[4]));
+        TEST_ASSERT_EQUAL(i < 3 ? 0 : 1, part[8]);
+        TEST_ASSERT_EQUAL(i == 3 ? TRACE_DUMP_FLAG_LAST : 0, part[9]);
+        TEST_ASSERT_EQUAL(counts[i], get_u16(&part[10]));
+
+        // Records in order, little-endian
+        for (uint16_t r = 0; r < counts[i]; r++, arg++) {
+            const uint8_t *record = &part[TRACE_DUMP_HEADER_SIZE + r * TRACE_RECORD_SIZE];
+            TEST_ASSERT_EQUAL_UINT32(1001000 + arg * 1000, get_u32(&record[0]));
+            TEST_ASSERT_EQUAL(TRACE_EVENT_SPI_DMA, record[4]);
+            TEST_ASSERT_EQUAL(TRACE_PHASE_INSTANT, record[5]);
+            TEST_ASSERT_EQUAL(arg, get_u16(&record[6]));
+        }
+    }
+}
+
+void test_dump_of_empty_rings(void) {
+    TEST_ASSERT_TRUE(trace_dump(capture, NULL));
+    TEST_ASSERT_EQUAL(2, part_count);
+    TEST_ASSERT_EQUAL(TRACE_DUMP_HEADER_SIZE, parts[0].length);
+    TEST_ASSERT_EQUAL(0, parts[0].data[9]);
+    TEST_ASSERT_EQUAL(TRACE_DUMP_FLAG_LAST, parts[1].data[9]);
+}
+
+void test_failed_send_stops_the_dump(void) {
+    for (int i = 0; i < 200; i++) {
+        TRACE_INSTANT(SPI_DMA, i);
+    }
+    fail_at = 2;
+    TEST_ASSERT_FALSE(trace_dump(capture, NULL));
+    TEST_ASSERT_EQUAL(1, part_count);
+    TEST_ASSERT_FALSE(trace_dump(NULL, NULL));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    // Recording
+    RUN_TEST(test_spans_nest_in_order);
+    RUN_TEST(test_ring_keeps_the_newest_events);
+    RUN_TEST(test_each_core_has_its_own_ring);
+
+    // Dump
+    RUN_TEST(test_dump_splits_each_core_into_packets);
+    RUN_TEST(test_dump_of_empty_rings);
+    RUN_TEST(test_failed_send_stops_the_dump);
+
+    return UNITY_END();
+}
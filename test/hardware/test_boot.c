@@ -0,0 +1,109 @@
+#include <unity.h>
+#include <string.h>
+#include "../../src/system/boot.h"
+#include "../../src/system/time.h"
+#include "../../src/hardware/display.h"
+#include "../../src/common/deskthang_constants.h"
+#include "../mocks/mock_time.h"
+#include "../mocks/mock_spi.h"
+
+// Power-on to READY, panel bring-up included
+#define BOOT_BUDGET_MS 300
+
+static const HardwareConfig hw_config = {
+    .spi_port = DISPLAY_SPI_PORT,
+    .spi_baud = DISPLAY_SPI_BAUD,
+};
+
+static const DisplayConfig disp_config = {
+    .orientation = DISPLAY_ORIENTATION_0,
+    .brightness = 255,
+    .inverted = false,
+};
+
+void setUp(void) {
+    mock_time_set(0);
+    mock_spi_reset();
+    GC9A01_window_invalidate();
+    boot_reset();
+}
+
+void tearDown(void) {
+}
+
+void test_phase_is_marked_once(void) {
+    mock_time_set(2);
+    boot_mark(BOOT_PHASE_STDIO);
+    mock_time_advance(5);
+    boot_mark(BOOT_PHASE_STDIO);
+
+    TEST_ASSERT_EQUAL_UINT32(2000, boot_phase_us(BOOT_PHASE_STDIO));
+    TEST_ASSERT_EQUAL_UINT32(0, boot_phase_us(BOOT_PHASE_ERROR));
+    TEST_ASSERT_FALSE(boot_is_ready());
+
+    boot_mark(BOOT_PHASE_READY);
+    TEST_ASSERT_TRUE(boot_is_ready());
+}
+
+void test_timeline_lists_marked_phases_in_order(void) {
+    mock_time_set(1);
+    boot_mark(BOOT_PHASE_STDIO);
+    mock_time_set(3);
+    boot_mark(BOOT_PHASE_HARDWARE);
+    mock_time_set(150);
+    boot_mark(BOOT_PHASE_READY);
+
+    char out[DEBUG_MESSAGE_MAX];
+    size_t length = boot_timeline_format(out, sizeof(out));
+    TEST_ASSERT_EQUAL_STRING("stdio=1000 hardware=3000 ready=150000", out);
+    TEST_ASSERT_EQUAL(strlen(out), length);
+}
+
+void test_timeline_keeps_whole_pairs(void) {
+    mock_time_set(1);
+    boot_mark(BOOT_PHASE_STDIO);
+    boot_mark(BOOT_PHASE_ERROR);
+
+    char out[16];
+    TEST_ASSERT_EQUAL(10, boot_timeline_format(out, sizeof(out)));
+    TEST_ASSERT_EQUAL_STRING("stdio=1000", out);
+}
+
+void test_every_phase_fits_a_debug_message(void) {
+    mock_time_set(4000000);  // Over an hour, so every value is 10 digits
+    for (int phase = 0; phase < BOOT_PHASE_COUNT; phase++) {
+        boot_mark((BootPhase)phase);
+    }
+
+    char out[DEBUG_MESSAGE_MAX];
+    boot_timeline_format(out, sizeof(out));
+    TEST_ASSERT_NOT_NULL(strstr(out, "ready="));
+}
+
+void test_display_init_is_within_budget(void) {
+    TEST_ASSERT_TRUE(display_init(&hw_config, &disp_config));
+
+    // Delays move the mock clock; SPI time is counted by the SPI mock
+    uint32_t elapsed_ms = deskthang_time_get_ms() + (uint32_t)(mock_spi_get_time_ns() / 1000000);
+    TEST_ASSERT_TRUE(elapsed_ms < BOOT_BUDGET_MS);
+
+    // No self-test patterns or their pauses by default
+    TEST_ASSERT_TRUE(deskthang_time_get_ms() < 2000);
+    TEST_ASSERT_TRUE(boot_phase_us(BOOT_PHASE_PANEL) > 0);
+    TEST_ASSERT_TRUE(boot_phase_us(BOOT_PHASE_DISPLAY) >= boot_phase_us(BOOT_PHASE_PANEL));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    // Timeline
+    RUN_TEST(test_phase_is_marked_once);
+    RUN_TEST(test_timeline_lists_marked_phases_in_order);
+    RUN_TEST(test_timeline_keeps_whole_pairs);
+    RUN_TEST(test_every_phase_fits_a_debug_message);
+
+    // Display bring-up
+    RUN_TEST(test_display_init_is_within_budget);
+
+    return UNITY_END();
+}
@@ -0,0 +1,173 @@
+#include <unity.h>
+#include <string.h>
+#include "../../src/hardware/GC9A01.h"
+#include "../../src/common/deskthang_constants.h"
+#include "../../src/system/time.h"
+#include "../mocks/mock_time.h"
+#include "../mocks/mock_spi.h"
+
+static struct GC9A01_frame full_screen = {
+    .start = {0, 0},
+    .end = {DISPLAY_WIDTH - 1, DISPLAY_HEIGHT - 1}
+};
+
+static GC9A01Stats stats(void) {
+    GC9A01Stats current;
+    TEST_ASSERT_TRUE(GC9A01_get_stats(&current));
+    return current;
+}
+
+void setUp(void) {
+    mock_time_set(1000);
+    mock_spi_reset();
+    GC9A01_window_invalidate();
+    GC9A01_reset_stats();
+}
+
+void tearDown(void) {
+}
+
+void test_transaction_sends_commands_in_order(void) {
+    const uint8_t madctl[] = {0x18};
+    const uint8_t gamma[] = {0x08, 0x08, 0x08, 0x08};
+    const GC9A01_command commands[] = {
+        {0xEF, 0, NULL},
+        {0x36, sizeof(madctl), madctl},
+        {0x90, sizeof(gamma), gamma},
+    };
+    TEST_ASSERT_TRUE(GC9A01_transaction(commands, 3));
+
+    const uint8_t expected[] = {0xEF, 0x36, 0x18, 0x90, 0x08, 0x08, 0x08, 0x08};
+    TEST_ASSERT_EQUAL(sizeof(expected), mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_MEMORY(expected, mock_spi_get_written_data(), sizeof(expected));
+
+    // One CS assertion for all three
+    GC9A01Stats s = stats();
+    TEST_ASSERT_EQUAL(1, s.transactions);
+    TEST_ASSERT_EQUAL(3, s.commands);
+    TEST_ASSERT_EQUAL(5, s.param_bytes);
+}
+
+void test_commands_do_not_sleep(void) {
+    GC9A01_write_command(GC9A01_MEM_WR);
+    GC9A01_write_command_data(0x51, (const uint8_t[]){0x80}, 1);
+    GC9A01_start_write(full_screen);
+
+    TEST_ASSERT_EQUAL_UINT64(0, mock_time_get_delay_us());
+}
+
+void test_start_write_is_one_transaction(void) {
+    GC9A01_start_write(full_screen);
+
+    const uint8_t expected[] = {
+        GC9A01_COL_ADDR_SET, 0, 0, 0, DISPLAY_WIDTH - 1,
+        GC9A01_ROW_ADDR_SET, 0, 0, 0, DISPLAY_HEIGHT - 1,
+        GC9A01_MEM_WR
+    };
+    TEST_ASSERT_EQUAL(sizeof(expected), mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_MEMORY(expected, mock_spi_get_written_data(), sizeof(expected));
+    TEST_ASSERT_EQUAL(1, stats().transactions);
+    TEST_ASSERT_EQUAL(0, stats().address_sets_skipped);
+}
+
+void test_same_window_skips_address_sets(void) {
+    GC9A01_start_write(full_screen);
+    mock_spi_reset();
+
+    // MEM_WR alone rewinds to the start of the current window
+    GC9A01_start_write(full_screen);
+    TEST_ASSERT_EQUAL(1, mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_HEX8(GC9A01_MEM_WR, mock_spi_get_written_data()[0]);
+    TEST_ASSERT_EQUAL(2, stats().address_sets_skipped);
+
+    // Nothing at all for set_frame
+    mock_spi_reset();
+    GC9A01_set_frame(full_screen);
+    TEST_ASSERT_EQUAL(0, mock_spi_get_written_length());
+}
+
+void test_only_changed_axis_is_sent(void) {
+    GC9A01_start_write(full_screen);
+    mock_spi_reset();
+
+    struct GC9A01_frame rows = full_screen;
+    rows.start.Y = 100;
+    GC9A01_start_write(rows);
+
+    const uint8_t expected[] = {GC9A01_ROW_ADDR_SET, 0, 100, 0, DISPLAY_HEIGHT - 1, GC9A01_MEM_WR};
+    TEST_ASSERT_EQUAL(sizeof(expected), mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_MEMORY(expected, mock_spi_get_written_data(), sizeof(expected));
+}
+
+void test_invalidate_resends_window(void) {
+    GC9A01_start_write(full_screen);
+    GC9A01_window_invalidate();
+    mock_spi_reset();
+
+    GC9A01_start_write(full_screen);
+    TEST_ASSERT_EQUAL(11, mock_spi_get_written_length());
+}
+
+void test_failed_transaction_forgets_window(void) {
+    mock_spi_set_initialized(false);
+    GC9A01_start_write(full_screen);
+    mock_spi_set_initialized(true);
+
+    GC9A01_start_write(full_screen);
+    TEST_ASSERT_EQUAL(11, mock_spi_get_written_length());
+}
+
+void test_init_sequence_is_one_transaction(void) {
+    GC9A01_init();
+
+    // Vendor sequence, then sleep out and display on after their delays
+    GC9A01Stats s = stats();
+    TEST_ASSERT_EQUAL(3, s.transactions);
+    TEST_ASSERT_TRUE(s.commands > 40);
+
+    // Only the datasheet minimums: the reset pulse, then the Sleep Out
+    // lockout (which the init table runs inside) and the wake settle
+    TEST_ASSERT_EQUAL_UINT64(DISPLAY_RESET_PULSE_US, mock_time_get_delay_us());
+    TEST_ASSERT_EQUAL(1000 + DISPLAY_INIT_DELAY_MS + DISPLAY_WAKE_DELAY_MS, deskthang_time_get_ms());
+
+    const uint8_t *written = mock_spi_get_written_data();
+    size_t length = mock_spi_get_written_length();
+    const uint8_t start[] = {0xEF, 0xEB, 0x14, 0xFE, 0xEF};
+    TEST_ASSERT_EQUAL_MEMORY(start, written, sizeof(start));
+    TEST_ASSERT_EQUAL_HEX8(0x11, written[length - 2]);
+    TEST_ASSERT_EQUAL_HEX8(0x29, written[length - 1]);
+}
+
+void test_draw_pixel_sends_color_big_endian(void) {
+    GC9A01_draw_pixel(10, 20, 0xF81F);
+
+    const uint8_t expected[] = {
+        GC9A01_COL_ADDR_SET, 0, 10, 0, 10,
+        GC9A01_ROW_ADDR_SET, 0, 20, 0, 20,
+        GC9A01_MEM_WR,
+        0xF8, 0x1F
+    };
+    TEST_ASSERT_EQUAL(sizeof(expected), mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_MEMORY(expected, mock_spi_get_written_data(), sizeof(expected));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    // Transactions
+    RUN_TEST(test_transaction_sends_commands_in_order);
+    RUN_TEST(test_commands_do_not_sleep);
+    RUN_TEST(test_start_write_is_one_transaction);
+    RUN_TEST(test_init_sequence_is_one_transaction);
+
+    // Window cache
+    RUN_TEST(test_same_window_skips_address_sets);
+    RUN_TEST(test_only_changed_axis_is_sent);
+    RUN_TEST(test_invalidate_resends_window);
+    RUN_TEST(test_failed_transaction_forgets_window);
+
+    // Drawing
+    RUN_TEST(test_draw_pixel_sends_color_big_endian);
+
+    return UNITY_END();
+}
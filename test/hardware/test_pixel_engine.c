@@ -0,0 +1,216 @@
+#include <unity.h>
+#include <string.h>
+#include "../../src/hardware/GC9A01.h"
+#include "../../src/hardware/display.h"
+#include "../../src/common/deskthang_constants.h"
+#include "../mocks/mock_time.h"
+#include "../mocks/mock_spi.h"
+
+#define BYTE_TIME_NS 800                                // 10 MHz SCK
+#define CHUNK_TIME_NS ((uint64_t)CHUNK_SIZE * BYTE_TIME_NS)
+#define PARSE_TIME_NS 150000                            // Simulated USB parse per chunk
+#define TEST_CHUNKS 8
+#define WINDOW_SETUP_BYTES 11                           // CASET + RASET + MEM_WR
+#define WINDOW_SETUP_WRITES 5                           // Command and data per address set, then MEM_WR
+#define FILL_COLOR 0x1234
+
+static uint8_t pixels[TEST_CHUNKS * CHUNK_SIZE];
+
+void setUp(void) {
+    mock_time_set(1000);
+    mock_spi_reset();
+    GC9A01_window_invalidate();  // Fresh panel: no window cached
+    mock_spi_set_byte_time_ns(BYTE_TIME_NS);
+
+    for (uint32_t i = 0; i < sizeof(pixels); i++) {
+        pixels[i] = (uint8_t)(i * 13 + (i >> 8));
+    }
+}
+
+void tearDown(void) {
+    GC9A01_pixels_end();
+}
+
+void test_push_without_begin_fails(void) {
+    TEST_ASSERT_FALSE(GC9A01_pixels_push(pixels, CHUNK_SIZE));
+    TEST_ASSERT_EQUAL(0, mock_spi_get_written_length());
+}
+
+void test_push_returns_while_transfer_in_flight(void) {
+    GC9A01_pixels_begin();
+    TEST_ASSERT_TRUE(GC9A01_pixels_push(pixels, CHUNK_SIZE));
+
+    // Nothing waited on the bus; the chunk is still draining
+    TEST_ASSERT_TRUE(GC9A01_pixels_busy());
+    TEST_ASSERT_EQUAL_UINT64(0, mock_spi_get_time_ns());
+    TEST_ASSERT_EQUAL_UINT64(0, mock_spi_get_stall_ns());
+
+    mock_spi_advance_ns(CHUNK_TIME_NS);
+    TEST_ASSERT_FALSE(GC9A01_pixels_busy());
+}
+
+void test_pixels_use_16_bit_frames(void) {
+    GC9A01_pixels_begin();
+    TEST_ASSERT_TRUE(GC9A01_pixels_push(pixels, CHUNK_SIZE));
+
+    TEST_ASSERT_EQUAL(16, mock_spi_get_last_frame_bits());
+    TEST_ASSERT_EQUAL(1, mock_spi_get_async_count());
+}
+
+void test_wire_bytes_match_input(void) {
+    GC9A01_pixels_begin();
+    for (uint32_t i = 0; i < TEST_CHUNKS; i++) {
+        TEST_ASSERT_TRUE(GC9A01_pixels_push(pixels + i * CHUNK_SIZE, CHUNK_SIZE));
+    }
+    GC9A01_pixels_end();
+
+    TEST_ASSERT_EQUAL(sizeof(pixels), mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_MEMORY(pixels, mock_spi_get_written_data(), sizeof(pixels));
+}
+
+void test_pixel_split_across_pushes(void) {
+    GC9A01_pixels_begin();
+    TEST_ASSERT_TRUE(GC9A01_pixels_push(pixels, 3));
+    TEST_ASSERT_TRUE(GC9A01_pixels_push(pixels + 3, 5));
+    GC9A01_pixels_end();
+
+    TEST_ASSERT_EQUAL(8, mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_MEMORY(pixels, mock_spi_get_written_data(), 8);
+}
+
+void test_large_push_is_split_into_buffers(void) {
+    GC9A01_pixels_begin();
+    TEST_ASSERT_TRUE(GC9A01_pixels_push(pixels, sizeof(pixels)));
+    GC9A01_pixels_end();
+
+    TEST_ASSERT_EQUAL(TEST_CHUNKS, mock_spi_get_async_count());
+    TEST_ASSERT_EQUAL_MEMORY(pixels, mock_spi_get_written_data(), sizeof(pixels));
+}
+
+void test_parsing_overlaps_transfer(void) {
+    GC9A01_pixels_begin();
+    for (uint32_t i = 0; i < TEST_CHUNKS; i++) {
+        mock_spi_advance_ns(PARSE_TIME_NS);  // Core0 parses the next chunk
+        TEST_ASSERT_TRUE(GC9A01_pixels_push(pixels + i * CHUNK_SIZE, CHUNK_SIZE));
+    }
+    GC9A01_pixels_end();
+
+    // Only the first parse is exposed; every later one hides behind DMA
+    TEST_ASSERT_EQUAL_UINT64(PARSE_TIME_NS + TEST_CHUNKS * CHUNK_TIME_NS,
+                             mock_spi_get_time_ns());
+    TEST_ASSERT_TRUE(mock_spi_get_time_ns() <
+                     TEST_CHUNKS * (PARSE_TIME_NS + CHUNK_TIME_NS));
+}
+
+void test_in_flight_buffer_never_overwritten(void) {
+    GC9A01_pixels_begin();
+
+    // Back-to-back pushes with no CPU time in between
+    for (uint32_t i = 0; i < TEST_CHUNKS; i++) {
+        TEST_ASSERT_TRUE(GC9A01_pixels_push(pixels + i * CHUNK_SIZE, CHUNK_SIZE));
+    }
+    GC9A01_pixels_end();
+
+    TEST_ASSERT_EQUAL(0, mock_spi_get_buffer_overwrites());
+    TEST_ASSERT_EQUAL_UINT64(TEST_CHUNKS * CHUNK_TIME_NS, mock_spi_get_time_ns());
+}
+
+void test_command_waits_for_pixels_to_drain(void) {
+    GC9A01_pixels_begin();
+    TEST_ASSERT_TRUE(GC9A01_pixels_push(pixels, CHUNK_SIZE));
+    GC9A01_pixels_end();
+    GC9A01_write_command(GC9A01_MEM_WR);
+
+    const uint8_t *written = mock_spi_get_written_data();
+    TEST_ASSERT_EQUAL(CHUNK_SIZE + 1, mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_MEMORY(pixels, written, CHUNK_SIZE);
+    TEST_ASSERT_EQUAL_HEX8(GC9A01_MEM_WR, written[CHUNK_SIZE]);
+    TEST_ASSERT_EQUAL_UINT64(CHUNK_TIME_NS, mock_spi_get_stall_ns());
+}
+
+// Window setup, then nothing but the colour: no per-pixel commands
+static void expect_fill(uint16_t x, uint16_t y, uint16_t w, uint16_t h) {
+    const uint8_t setup[] = {
+        GC9A01_COL_ADDR_SET, 0, x, 0, x + w - 1,
+        GC9A01_ROW_ADDR_SET, 0, y, 0, y + h - 1,
+        GC9A01_MEM_WR
+    };
+    const uint8_t *written = mock_spi_get_written_data();
+    TEST_ASSERT_EQUAL(WINDOW_SETUP_BYTES + (size_t)w * h * 2, mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_MEMORY(setup, written, sizeof(setup));
+
+    for (uint32_t i = 0; i < (uint32_t)w * h; i++) {
+        TEST_ASSERT_EQUAL_HEX8(FILL_COLOR >> 8, written[WINDOW_SETUP_BYTES + 2 * i]);
+        TEST_ASSERT_EQUAL_HEX8(FILL_COLOR & 0xFF, written[WINDOW_SETUP_BYTES + 2 * i + 1]);
+    }
+
+    // One transfer for every pixel, whatever the size
+    TEST_ASSERT_EQUAL(WINDOW_SETUP_WRITES + 1, mock_spi_get_write_count());
+    TEST_ASSERT_EQUAL(1, mock_spi_get_fill_count());
+}
+
+void test_fill_rect_is_one_transfer(void) {
+    GC9A01_fill_rect(10, 20, 30, 40, FILL_COLOR);
+    expect_fill(10, 20, 30, 40);
+}
+
+void test_fill_region_is_one_transfer(void) {
+    TEST_ASSERT_TRUE(display_fill_region(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, FILL_COLOR));
+    expect_fill(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT);
+}
+
+void test_fill_runs_at_bus_speed(void) {
+    GC9A01_fill_rect(0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, FILL_COLOR);
+
+    // Every nanosecond is a byte on the wire
+    TEST_ASSERT_EQUAL_UINT64((WINDOW_SETUP_BYTES + TRANSFER_MAX_SIZE) * (uint64_t)BYTE_TIME_NS,
+                             mock_spi_get_time_ns());
+    TEST_ASSERT_EQUAL(0, mock_spi_get_buffer_overwrites());
+}
+
+void test_fill_follows_pushed_pixels(void) {
+    GC9A01_pixels_begin();
+    TEST_ASSERT_TRUE(GC9A01_pixels_push(pixels, 4));
+    TEST_ASSERT_TRUE(GC9A01_pixels_fill(FILL_COLOR, 2));
+    GC9A01_pixels_end();
+
+    const uint8_t expected[] = {pixels[0], pixels[1], pixels[2], pixels[3], 0x12, 0x34, 0x12, 0x34};
+    TEST_ASSERT_EQUAL(sizeof(expected), mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_MEMORY(expected, mock_spi_get_written_data(), sizeof(expected));
+}
+
+void test_fill_rejects_split_pixel(void) {
+    TEST_ASSERT_FALSE(GC9A01_pixels_fill(FILL_COLOR, 1));
+
+    GC9A01_pixels_begin();
+    TEST_ASSERT_TRUE(GC9A01_pixels_push(pixels, 1));
+    TEST_ASSERT_FALSE(GC9A01_pixels_fill(FILL_COLOR, 1));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    // API contract
+    RUN_TEST(test_push_without_begin_fails);
+    RUN_TEST(test_push_returns_while_transfer_in_flight);
+    RUN_TEST(test_pixels_use_16_bit_frames);
+
+    // Byte stream
+    RUN_TEST(test_wire_bytes_match_input);
+    RUN_TEST(test_pixel_split_across_pushes);
+    RUN_TEST(test_large_push_is_split_into_buffers);
+
+    // Overlap
+    RUN_TEST(test_parsing_overlaps_transfer);
+    RUN_TEST(test_in_flight_buffer_never_overwritten);
+    RUN_TEST(test_command_waits_for_pixels_to_drain);
+
+    // Fills
+    RUN_TEST(test_fill_rect_is_one_transfer);
+    RUN_TEST(test_fill_region_is_one_transfer);
+    RUN_TEST(test_fill_runs_at_bus_speed);
+    RUN_TEST(test_fill_follows_pushed_pixels);
+    RUN_TEST(test_fill_rejects_split_pixel);
+
+    return UNITY_END();
+}
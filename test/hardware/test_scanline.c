@@ -0,0 +1,170 @@
+#include <unity.h>
+#include <string.h>
+#include "../../src/hardware/scanline.h"
+#include "../../src/hardware/display.h"
+#include "../../src/hardware/panel_span.h"
+#include "../../src/common/deskthang_constants.h"
+#include "../mocks/mock_time.h"
+#include "../mocks/mock_spi.h"
+
+#define BYTE_TIME_NS 800          // 10 MHz SCK
+#define WINDOW_SETUP_BYTES 11     // CASET + RASET + MEM_WR
+#define WINDOW_SETUP_WRITES 5     // Command and data per address set, then MEM_WR
+#define GENERATE_TIME_NS 100000   // Simulated CPU time per row
+
+static struct {
+    uint16_t rows;
+    uint16_t next_row;
+    bool in_order;
+    bool spans_match;
+    uint64_t row_cost_ns;
+} generated;
+
+// Each pixel carries its own (x, y)
+static void coordinate_row(uint16_t y, uint16_t x, uint16_t width, uint16_t *line, void *context) {
+    generated.in_order &= y == generated.next_row;
+    generated.spans_match &= x == panel_span_start(y) && width == panel_span_width(y);
+    generated.next_row = y + 1;
+    generated.rows++;
+
+    for (uint16_t i = 0; i < width; i++) {
+        line[i] = (uint16_t)((x + i) << 8) | y;
+    }
+    mock_spi_advance_ns(generated.row_cost_ns);
+}
+
+// Start the next frame on a fresh panel and bus
+static void next_frame(void) {
+    mock_spi_reset();
+    GC9A01_window_invalidate();
+}
+
+static uint16_t band_count(void) {
+    uint16_t bands = 0;
+    for (uint16_t y = 0; y < DISPLAY_HEIGHT; y += panel_span_band_height(y)) {
+        bands++;
+    }
+    return bands;
+}
+
+// Pixel (x, y) of a frame rendered by scanline_render, as sent on the wire
+static uint16_t wire_pixel(uint16_t x, uint16_t y) {
+    const uint8_t *spi = mock_spi_get_written_data();
+    for (uint16_t row = 0; row < DISPLAY_HEIGHT; row += panel_span_band_height(row)) {
+        spi += WINDOW_SETUP_BYTES;
+        uint16_t rows = panel_span_band_height(row);
+        if (y < row + rows) {
+            spi += ((uint32_t)(y - row) * panel_span_width(row) + x - panel_span_start(row)) * 2;
+            return (uint16_t)(spi[0] << 8) | spi[1];
+        }
+        spi += (uint32_t)panel_span_width(row) * rows * 2;
+    }
+    return 0;
+}
+
+void setUp(void) {
+    mock_time_set(1000);
+    mock_spi_reset();
+    GC9A01_window_invalidate();  // Fresh panel: no window cached
+    mock_spi_set_byte_time_ns(BYTE_TIME_NS);
+    memset(&generated, 0, sizeof(generated));
+    generated.in_order = true;
+    generated.spans_match = true;
+}
+
+void tearDown(void) {
+}
+
+void test_render_generates_every_visible_row(void) {
+    TEST_ASSERT_TRUE(scanline_render(coordinate_row, NULL));
+
+    TEST_ASSERT_EQUAL(DISPLAY_HEIGHT, generated.rows);
+    TEST_ASSERT_TRUE(generated.in_order);
+    TEST_ASSERT_TRUE(generated.spans_match);
+}
+
+void test_render_writes_one_window_per_band(void) {
+    TEST_ASSERT_TRUE(scanline_render(coordinate_row, NULL));
+
+    // One window per band and one transfer per row, nothing per pixel
+    TEST_ASSERT_EQUAL(band_count() * WINDOW_SETUP_BYTES + PANEL_SPAN_SIZE,
+                      mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL(band_count() * WINDOW_SETUP_WRITES + DISPLAY_HEIGHT,
+                      mock_spi_get_write_count());
+    TEST_ASSERT_EQUAL(DISPLAY_HEIGHT, mock_spi_get_async_count());
+}
+
+void test_rows_reach_the_wire_intact(void) {
+    TEST_ASSERT_TRUE(scanline_render(coordinate_row, NULL));
+
+    TEST_ASSERT_EQUAL_HEX16((panel_span_start(0) << 8) | 0, wire_pixel(panel_span_start(0), 0));
+    TEST_ASSERT_EQUAL_HEX16((0 << 8) | 119, wire_pixel(0, 119));
+    TEST_ASSERT_EQUAL_HEX16((239 << 8) | 120, wire_pixel(239, 120));
+    TEST_ASSERT_EQUAL_HEX16((130 << 8) | 239, wire_pixel(130, 239));
+}
+
+void test_generation_overlaps_transfer(void) {
+    // A row takes longer to send than to generate, so only the first row
+    // of each band is exposed
+    generated.row_cost_ns = GENERATE_TIME_NS;
+    TEST_ASSERT_TRUE(scanline_render(coordinate_row, NULL));
+
+    uint64_t bus_ns = (uint64_t)(band_count() * WINDOW_SETUP_BYTES + PANEL_SPAN_SIZE) * BYTE_TIME_NS;
+    uint64_t serial_ns = bus_ns + (uint64_t)DISPLAY_HEIGHT * GENERATE_TIME_NS;
+    TEST_ASSERT_TRUE(mock_spi_get_time_ns() < serial_ns);
+    TEST_ASSERT_TRUE(mock_spi_get_time_ns() - bus_ns <= (uint64_t)band_count() * GENERATE_TIME_NS);
+    TEST_ASSERT_EQUAL(0, mock_spi_get_buffer_overwrites());
+}
+
+void test_render_needs_generator(void) {
+    TEST_ASSERT_FALSE(scanline_render(NULL, NULL));
+    TEST_ASSERT_EQUAL(0, mock_spi_get_written_length());
+}
+
+void test_patterns_write_visible_spans_once(void) {
+    TEST_ASSERT_TRUE(display_draw_test_pattern(TEST_PATTERN_COLOR_BARS, 0));
+    TEST_ASSERT_EQUAL(band_count() * WINDOW_SETUP_BYTES + PANEL_SPAN_SIZE,
+                      mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_HEX16(COLOR_RED, wire_pixel(15, 120));
+    TEST_ASSERT_EQUAL_HEX16(COLOR_BLACK, wire_pixel(225, 120));
+
+    next_frame();
+    TEST_ASSERT_TRUE(display_draw_test_pattern(TEST_PATTERN_GRADIENT, 0));
+    TEST_ASSERT_EQUAL(band_count() * WINDOW_SETUP_BYTES + PANEL_SPAN_SIZE,
+                      mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_HEX16(RGB565(127, 127, 127), wire_pixel(120, 120));
+
+    next_frame();
+    TEST_ASSERT_TRUE(display_draw_test_pattern(TEST_PATTERN_CHECKERBOARD, 0));
+    TEST_ASSERT_EQUAL(band_count() * WINDOW_SETUP_BYTES + PANEL_SPAN_SIZE,
+                      mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_HEX16(COLOR_WHITE, wire_pixel(100, 100));
+    TEST_ASSERT_EQUAL_HEX16(COLOR_BLACK, wire_pixel(120, 100));
+
+    next_frame();
+    TEST_ASSERT_TRUE(display_draw_test_pattern(TEST_PATTERN_SOLID, COLOR_BLUE));
+    TEST_ASSERT_EQUAL(band_count() * WINDOW_SETUP_BYTES + PANEL_SPAN_SIZE,
+                      mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_HEX16(COLOR_BLUE, wire_pixel(0, 120));
+}
+
+void test_checkerboard_needs_square_size(void) {
+    TEST_ASSERT_FALSE(display_draw_checkerboard(0));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    // Renderer
+    RUN_TEST(test_render_generates_every_visible_row);
+    RUN_TEST(test_render_writes_one_window_per_band);
+    RUN_TEST(test_rows_reach_the_wire_intact);
+    RUN_TEST(test_generation_overlaps_transfer);
+    RUN_TEST(test_render_needs_generator);
+
+    // Test patterns
+    RUN_TEST(test_patterns_write_visible_spans_once);
+    RUN_TEST(test_checkerboard_needs_square_size);
+
+    return UNITY_END();
+}
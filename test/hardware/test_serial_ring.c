@@ -0,0 +1,123 @@
+#include <unity.h>
+#include <string.h>
+#include "../../src/hardware/serial_ring.h"
+
+#define RING_SIZE 64
+
+static uint8_t storage[RING_SIZE];
+static SerialRing ring;
+static uint8_t input[4 * RING_SIZE];
+static uint8_t output[4 * RING_SIZE];
+
+void setUp(void) {
+    TEST_ASSERT_TRUE(serial_ring_init(&ring, storage, sizeof(storage)));
+    for (uint32_t i = 0; i < sizeof(input); i++) {
+        input[i] = (uint8_t)(i * 7 + 3);
+    }
+    memset(output, 0, sizeof(output));
+}
+
+void tearDown(void) {
+}
+
+void test_size_must_be_power_of_two(void) {
+    SerialRing other;
+    TEST_ASSERT_FALSE(serial_ring_init(&other, storage, 48));
+    TEST_ASSERT_FALSE(serial_ring_init(&other, storage, 0));
+    TEST_ASSERT_TRUE(serial_ring_init(&other, storage, 32));
+}
+
+void test_write_stops_when_full(void) {
+    TEST_ASSERT_EQUAL(RING_SIZE, serial_ring_write(&ring, input, RING_SIZE + 10));
+    TEST_ASSERT_EQUAL(RING_SIZE, serial_ring_count(&ring));
+    TEST_ASSERT_EQUAL(0, serial_ring_space(&ring));
+    TEST_ASSERT_EQUAL(0, serial_ring_write(&ring, input, 1));
+
+    TEST_ASSERT_EQUAL(RING_SIZE, serial_ring_read(&ring, output, sizeof(output)));
+    TEST_ASSERT_EQUAL_MEMORY(input, output, RING_SIZE);
+    TEST_ASSERT_EQUAL(0, serial_ring_count(&ring));
+}
+
+void test_data_survives_wraparound(void) {
+    // Walk the positions round the ring several times with odd-sized steps
+    uint32_t written = 0;
+    uint32_t read = 0;
+    while (read < sizeof(input)) {
+        size_t step = 1 + (written % 23);
+        if (step > sizeof(input) - written) {
+            step = sizeof(input) - written;
+        }
+        written += serial_ring_write(&ring, input + written, step);
+        read += serial_ring_read(&ring, output + read, 1 + (read % 17));
+    }
+    TEST_ASSERT_EQUAL_MEMORY(input, output, sizeof(input));
+}
+
+void test_spans_split_at_the_end_of_storage(void) {
+    serial_ring_write(&ring, input, 40);
+    serial_ring_read(&ring, output, 40);
+
+    // 24 bytes to the end of storage, then the rest from the start
+    size_t span;
+    uint8_t *dst = serial_ring_write_span(&ring, &span);
+    TEST_ASSERT_EQUAL(24, span);
+    TEST_ASSERT_EQUAL_PTR(storage + 40, dst);
+    memcpy(dst, input, span);
+    serial_ring_commit(&ring, span);
+
+    dst = serial_ring_write_span(&ring, &span);
+    TEST_ASSERT_EQUAL(40, span);
+    TEST_ASSERT_EQUAL_PTR(storage, dst);
+    memcpy(dst, input + 24, 10);
+    serial_ring_commit(&ring, 10);
+
+    const uint8_t *src = serial_ring_read_span(&ring, &span);
+    TEST_ASSERT_EQUAL(24, span);
+    serial_ring_consume(&ring, span);
+    src = serial_ring_read_span(&ring, &span);
+    TEST_ASSERT_EQUAL(10, span);
+    TEST_ASSERT_EQUAL_MEMORY(input + 24, src, 10);
+}
+
+void test_peek_does_not_consume(void) {
+    TEST_ASSERT_EQUAL(-1, serial_ring_peek(&ring));
+    serial_ring_write(&ring, input, 2);
+
+    TEST_ASSERT_EQUAL(input[0], serial_ring_peek(&ring));
+    TEST_ASSERT_EQUAL(2, serial_ring_count(&ring));
+    serial_ring_read(&ring, output, 1);
+    TEST_ASSERT_EQUAL(input[1], serial_ring_peek(&ring));
+}
+
+void test_counters_wrap_past_32_bits(void) {
+    ring.head = 0xFFFFFFF0u;
+    ring.tail = 0xFFFFFFF0u;
+
+    TEST_ASSERT_EQUAL(32, serial_ring_write(&ring, input, 32));
+    TEST_ASSERT_EQUAL(32, serial_ring_count(&ring));
+    TEST_ASSERT_EQUAL(32, serial_ring_read(&ring, output, 64));
+    TEST_ASSERT_EQUAL_MEMORY(input, output, 32);
+    TEST_ASSERT_EQUAL(RING_SIZE, serial_ring_space(&ring));
+}
+
+void test_clear_drops_unread_bytes(void) {
+    serial_ring_write(&ring, input, 20);
+    serial_ring_clear(&ring);
+
+    TEST_ASSERT_EQUAL(0, serial_ring_count(&ring));
+    TEST_ASSERT_EQUAL(RING_SIZE, serial_ring_space(&ring));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_size_must_be_power_of_two);
+    RUN_TEST(test_write_stops_when_full);
+    RUN_TEST(test_data_survives_wraparound);
+    RUN_TEST(test_spans_split_at_the_end_of_storage);
+    RUN_TEST(test_peek_does_not_consume);
+    RUN_TEST(test_counters_wrap_past_32_bits);
+    RUN_TEST(test_clear_drops_unread_bytes);
+
+    return UNITY_END();
+}
@@ -46,10 +46,42 @@ bool serial_read(uint8_t* data, size_t length) {
     return true;
 }
 
+int serial_read_byte(void) {
+    uint8_t byte;
+    if (!serial_read(&byte, 1)) {
+        return -1;
+    }
+    return byte;
+}
+
+size_t serial_read_available(uint8_t* data, size_t max_length) {
+    if (!data || max_length == 0) return 0;
+    
+    uint16_t available = mock_serial_state.read_buffer_size - mock_serial_state.read_position;
+    size_t to_read = (max_length < available) ? max_length : available;
+    if (to_read > 0) {
+        memcpy(data, mock_serial_state.read_buffer + mock_serial_state.read_position, to_read);
+        mock_serial_state.read_position += to_read;
+        mock_serial_state.read_count++;
+    }
+    return to_read;
+}
+
+bool serial_available(void) {
+    return mock_serial_state.read_position < mock_serial_state.read_buffer_size;
+}
+
 void serial_flush(void) {
     mock_serial_state.flush_count++;
 }
 
+size_t serial_write_space(void) {
+    return MAX_BUFFER_SIZE - mock_serial_state.write_buffer_size;
+}
+
+void serial_service(void) {
+}
+
 // Mock control functions
 void mock_serial_reset(void) {
     memset(&mock_serial_state, 0, sizeof(mock_serial_state));
@@ -0,0 +1,275 @@
+#include "mock_spi.h"
+#include "../../src/hardware/deskthang_spi.h"
+#include "../../src/hardware/deskthang_gpio.h"
+#include "../../src/common/deskthang_constants.h"
+#include <string.h>
+
+// Room for a full RGB565 frame plus the commands around it
+#define MAX_BUFFER_SIZE (TRANSFER_MAX_SIZE + 4096)
+
+// Largest async transfer whose source buffer is snapshotted
+#define MAX_SNAPSHOT_SIZE 4096
+
+// 10 MHz SCK, 8 bits per byte
+#define DEFAULT_BYTE_TIME_NS 800
+
+static struct {
+    uint8_t write_buffer[MAX_BUFFER_SIZE];
+    size_t write_length;
+    uint32_t write_count;
+    uint32_t dropped_bytes;
+    bool initialized;
+
+    // Simulated bus
+    uint32_t byte_time_ns;
+    uint64_t now_ns;
+    uint64_t stall_ns;
+
+    // In-flight async transfer
+    const uint8_t *async_source;
+    uint8_t async_snapshot[MAX_SNAPSHOT_SIZE];
+    size_t async_length;
+    uint64_t async_done_ns;
+    bool async_pending;
+    uint32_t async_count;
+    uint32_t fill_count;
+    uint8_t last_frame_bits;
+    uint32_t buffer_overwrites;
+} mock_spi_state = {
+    .initialized = true,
+    .byte_time_ns = DEFAULT_BYTE_TIME_NS
+};
+
+static void mock_spi_record(const uint8_t *data, size_t len) {
+    // Record every byte that would have gone out on MOSI
+    size_t space = MAX_BUFFER_SIZE - mock_spi_state.write_length;
+    size_t copy = len < space ? len : space;
+    memcpy(mock_spi_state.write_buffer + mock_spi_state.write_length, data, copy);
+    mock_spi_state.write_length += copy;
+    mock_spi_state.dropped_bytes += len - copy;
+}
+
+// Retire the in-flight transfer once the clock has passed its end. A source
+// buffer that changed while DMA still owned it counts as an overwrite.
+static void mock_spi_retire_async(void) {
+    if (!mock_spi_state.async_pending ||
+        mock_spi_state.now_ns < mock_spi_state.async_done_ns) {
+        return;
+    }
+
+    if (mock_spi_state.async_length <= MAX_SNAPSHOT_SIZE &&
+        memcmp(mock_spi_state.async_source, mock_spi_state.async_snapshot,
+               mock_spi_state.async_length) != 0) {
+        mock_spi_state.buffer_overwrites++;
+    }
+    mock_spi_state.async_pending = false;
+}
+
+// SPI interface
+bool deskthang_spi_init(const DeskthangSPIConfig *config) {
+    mock_spi_state.initialized = config != NULL;
+    return mock_spi_state.initialized;
+}
+
+void deskthang_spi_deinit(void) {
+    deskthang_spi_wait();
+    mock_spi_state.initialized = false;
+}
+
+bool deskthang_spi_write(const uint8_t *data, size_t len) {
+    if (!mock_spi_state.initialized || !data) {
+        return false;
+    }
+
+    // Blocking writes drain any DMA first and hold the CPU for the transfer
+    deskthang_spi_wait();
+    mock_spi_record(data, len);
+    mock_spi_state.now_ns += (uint64_t)len * mock_spi_state.byte_time_ns;
+    mock_spi_state.write_count++;
+    return true;
+}
+
+bool deskthang_spi_read(uint8_t *data, size_t len) {
+    return false;
+}
+
+bool deskthang_spi_transfer(const uint8_t *tx_data, uint8_t *rx_data, size_t len) {
+    return false;
+}
+
+void deskthang_spi_chip_select(bool select) {
+}
+
+bool deskthang_spi_write_async(const void *data, size_t len, uint8_t frame_bits) {
+    if (!mock_spi_state.initialized || !data ||
+        (frame_bits != 8 && frame_bits != 16) ||
+        (frame_bits == 16 && (len & 1))) {
+        return false;
+    }
+
+    deskthang_spi_wait();
+
+    // Bytes hit the wire in frame order: 16-bit frames go MSB first
+    const uint8_t *bytes = (const uint8_t *)data;
+    if (frame_bits == 16) {
+        const uint16_t *frames = (const uint16_t *)data;
+        for (size_t i = 0; i < len / 2; i++) {
+            uint8_t wire[2] = {frames[i] >> 8, frames[i] & 0xFF};
+            mock_spi_record(wire, sizeof(wire));
+        }
+    } else {
+        mock_spi_record(bytes, len);
+    }
+
+    mock_spi_state.async_source = bytes;
+    mock_spi_state.async_length = len;
+    if (len <= MAX_SNAPSHOT_SIZE) {
+        memcpy(mock_spi_state.async_snapshot, bytes, len);
+    }
+    mock_spi_state.async_done_ns = mock_spi_state.now_ns +
+                                   (uint64_t)len * mock_spi_state.byte_time_ns;
+    mock_spi_state.async_pending = true;
+    mock_spi_state.last_frame_bits = frame_bits;
+    mock_spi_state.async_count++;
+    mock_spi_state.write_count++;
+    return true;
+}
+
+bool deskthang_spi_fill_async(const uint16_t *value, uint32_t count) {
+    if (!mock_spi_state.initialized || !value || count == 0) {
+        return false;
+    }
+
+    deskthang_spi_wait();
+
+    // The same frame repeated, MSB first
+    uint8_t wire[2] = {*value >> 8, *value & 0xFF};
+    for (uint32_t i = 0; i < count; i++) {
+        mock_spi_record(wire, sizeof(wire));
+    }
+
+    // Only the one source pixel is owned by DMA
+    mock_spi_state.async_source = (const uint8_t *)value;
+    mock_spi_state.async_length = sizeof(*value);
+    memcpy(mock_spi_state.async_snapshot, value, sizeof(*value));
+    mock_spi_state.async_done_ns = mock_spi_state.now_ns +
+                                   (uint64_t)count * 2 * mock_spi_state.byte_time_ns;
+    mock_spi_state.async_pending = true;
+    mock_spi_state.last_frame_bits = 16;
+    mock_spi_state.fill_count++;
+    mock_spi_state.async_count++;
+    mock_spi_state.write_count++;
+    return true;
+}
+
+bool deskthang_spi_busy(void) {
+    mock_spi_retire_async();
+    return mock_spi_state.async_pending;
+}
+
+void deskthang_spi_wait(void) {
+    if (mock_spi_state.async_pending &&
+        mock_spi_state.now_ns < mock_spi_state.async_done_ns) {
+        mock_spi_state.stall_ns += mock_spi_state.async_done_ns - mock_spi_state.now_ns;
+        mock_spi_state.now_ns = mock_spi_state.async_done_ns;
+    }
+    mock_spi_retire_async();
+}
+
+bool deskthang_spi_is_initialized(void) {
+    return mock_spi_state.initialized;
+}
+
+// GPIO interface (display control lines)
+bool deskthang_gpio_init(const HardwareConfig *config) {
+    return config != NULL;
+}
+
+void deskthang_gpio_deinit(void) {
+}
+
+void deskthang_gpio_set(uint8_t pin, bool value) {
+}
+
+bool deskthang_gpio_get(uint8_t pin) {
+    return false;
+}
+
+bool deskthang_gpio_is_output(uint8_t pin) {
+    return true;
+}
+
+bool deskthang_gpio_is_initialized(void) {
+    return true;
+}
+
+// Mock control functions
+void mock_spi_reset(void) {
+    mock_spi_state.write_length = 0;
+    mock_spi_state.write_count = 0;
+    mock_spi_state.dropped_bytes = 0;
+    mock_spi_state.initialized = true;
+    mock_spi_state.byte_time_ns = DEFAULT_BYTE_TIME_NS;
+    mock_spi_state.now_ns = 0;
+    mock_spi_state.stall_ns = 0;
+    mock_spi_state.async_pending = false;
+    mock_spi_state.async_count = 0;
+    mock_spi_state.fill_count = 0;
+    mock_spi_state.last_frame_bits = 0;
+    mock_spi_state.buffer_overwrites = 0;
+}
+
+void mock_spi_set_initialized(bool initialized) {
+    mock_spi_state.initialized = initialized;
+}
+
+// Test helper functions
+const uint8_t* mock_spi_get_written_data(void) {
+    return mock_spi_state.write_buffer;
+}
+
+size_t mock_spi_get_written_length(void) {
+    return mock_spi_state.write_length;
+}
+
+// Simulated bus timing
+void mock_spi_set_byte_time_ns(uint32_t byte_time_ns) {
+    mock_spi_state.byte_time_ns = byte_time_ns;
+}
+
+void mock_spi_advance_ns(uint64_t delta_ns) {
+    mock_spi_state.now_ns += delta_ns;
+}
+
+uint64_t mock_spi_get_time_ns(void) {
+    return mock_spi_state.now_ns;
+}
+
+uint64_t mock_spi_get_stall_ns(void) {
+    return mock_spi_state.stall_ns;
+}
+
+// Statistics
+uint32_t mock_spi_get_write_count(void) {
+    return mock_spi_state.write_count;
+}
+
+uint32_t mock_spi_get_dropped_bytes(void) {
+    return mock_spi_state.dropped_bytes;
+}
+
+uint32_t mock_spi_get_async_count(void) {
+    return mock_spi_state.async_count;
+}
+
+uint32_t mock_spi_get_fill_count(void) {
+    return mock_spi_state.fill_count;
+}
+
+uint8_t mock_spi_get_last_frame_bits(void) {
+    return mock_spi_state.last_frame_bits;
+}
+
+uint32_t mock_spi_get_buffer_overwrites(void) {
+    return mock_spi_state.buffer_overwrites;
+}
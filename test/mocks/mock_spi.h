@@ -0,0 +1,32 @@
+#ifndef MOCK_SPI_H
+#define MOCK_SPI_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+// Mock control functions
+void mock_spi_reset(void);
+void mock_spi_set_initialized(bool initialized);
+
+// Test helper functions
+const uint8_t* mock_spi_get_written_data(void);
+size_t mock_spi_get_written_length(void);
+
+// Simulated bus timing. The mock keeps its own nanosecond clock: writes
+// occupy the bus for len * byte_time_ns, blocking writes and waits move the
+// clock forward, and tests call mock_spi_advance_ns to model CPU work.
+void mock_spi_set_byte_time_ns(uint32_t byte_time_ns);
+void mock_spi_advance_ns(uint64_t delta_ns);
+uint64_t mock_spi_get_time_ns(void);
+uint64_t mock_spi_get_stall_ns(void);
+
+// Statistics
+uint32_t mock_spi_get_write_count(void);
+uint32_t mock_spi_get_dropped_bytes(void);
+uint32_t mock_spi_get_async_count(void);
+uint32_t mock_spi_get_fill_count(void);
+uint8_t mock_spi_get_last_frame_bits(void);
+uint32_t mock_spi_get_buffer_overwrites(void);
+
+#endif // MOCK_SPI_H
@@ -0,0 +1,24 @@
+#include "mock_state.h"
+#include "../../src/state/dispatch.h"
+
+const StateActions STATE_ACTIONS[STATE_COUNT] = {0};
+
+bool state_machine_transition(SystemState next_state, StateCondition condition) {
+    return state_dispatch_post(next_state, condition);
+}
+
+SystemState state_machine_get_current(void) {
+    return state_dispatch_current();
+}
+
+SystemState state_machine_get_previous(void) {
+    return state_dispatch_previous();
+}
+
+bool state_machine_is_in_error(void) {
+    return state_dispatch_current() == STATE_ERROR;
+}
+
+void mock_state_set(SystemState state) {
+    state_dispatch_init(state, STATE_ACTIONS);
+}
@@ -0,0 +1,12 @@
+#ifndef MOCK_STATE_H
+#define MOCK_STATE_H
+
+#include "../../src/state/state.h"
+
+// Runs the real dispatch table with no entry/exit actions, so tests see the
+// same transitions main would without the hardware behind them
+
+// Test helper functions
+void mock_state_set(SystemState state);
+
+#endif // MOCK_STATE_H
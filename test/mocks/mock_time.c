@@ -2,20 +2,31 @@
 
 static uint32_t mock_current_time_ms = 0;
 static uint32_t mock_delay_calls = 0;
+static uint64_t mock_delay_us_total = 0;
 
 uint32_t deskthang_time_get_ms(void) {
     return mock_current_time_ms;
 }
 
+uint32_t deskthang_time_get_us(void) {
+    return mock_current_time_ms * 1000;
+}
+
 void deskthang_delay_ms(uint32_t delay_ms) {
     mock_current_time_ms += delay_ms;
     mock_delay_calls++;
 }
 
+void deskthang_delay_us(uint32_t delay_us) {
+    // Sub-millisecond delays don't move the mock clock, but are tallied
+    mock_delay_us_total += delay_us;
+}
+
 // Test helper functions
 void mock_time_set(uint32_t time_ms) {
     mock_current_time_ms = time_ms;
     mock_delay_calls = 0;
+    mock_delay_us_total = 0;
 }
 
 void mock_time_advance(uint32_t delta_ms) {
@@ -24,4 +35,8 @@ void mock_time_advance(uint32_t delta_ms) {
 
 uint32_t mock_time_get_delay_calls(void) {
     return mock_delay_calls;
+}
+
+uint64_t mock_time_get_delay_us(void) {
+    return mock_delay_us_total;
 } 
\ No newline at end of file
@@ -7,5 +7,6 @@
 void mock_time_set(uint32_t time_ms);
 void mock_time_advance(uint32_t delta_ms);
 uint32_t mock_time_get_delay_calls(void);
+uint64_t mock_time_get_delay_us(void);  // Total deskthang_delay_us time
 
 #endif // MOCK_TIME_H 
\ No newline at end of file
@@ -0,0 +1,62 @@
+// CRC32 backend microbenchmark. Runs on the host, so only the software
+// kernels are measured; the DMA sniffer backend exists on device builds only.
+//
+// Usage: ./bench_crc32 [iterations-scale]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../../src/protocol/crc32.h"
+#include "../../src/common/deskthang_constants.h"
+
+static uint8_t buffer[TRANSFER_MAX_SIZE];
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static void bench(const char *name, Crc32Backend backend, size_t length, unsigned iterations) {
+    if (!crc32_set_backend(backend)) {
+        printf("%-10s %7zu B  (not available on this build)\n", name, length);
+        return;
+    }
+
+    // Warm up tables and caches
+    volatile uint32_t sink = crc32_compute(buffer, length);
+
+    double start = now_ns();
+    for (unsigned i = 0; i < iterations; i++) {
+        sink ^= crc32_compute(buffer, length);
+    }
+    double elapsed = now_ns() - start;
+    (void)sink;
+
+    double ns_per_call = elapsed / iterations;
+    double mb_per_s = (double)length * iterations / (elapsed / 1e9) / (1024.0 * 1024.0);
+    printf("%-10s %7zu B  %10.1f ns/call  %8.1f MB/s\n", name, length, ns_per_call, mb_per_s);
+}
+
+int main(int argc, char **argv) {
+    unsigned scale = argc > 1 ? (unsigned)atoi(argv[1]) : 1;
+    if (scale == 0) {
+        scale = 1;
+    }
+
+    for (size_t i = 0; i < sizeof(buffer); i++) {
+        buffer[i] = (uint8_t)rand();
+    }
+    crc32_init();
+
+    const size_t sizes[] = {CHUNK_SIZE, TRANSFER_MAX_SIZE};
+    const unsigned iterations[] = {200000, 200};
+
+    for (size_t i = 0; i < sizeof(sizes) / sizeof(sizes[0]); i++) {
+        bench("bytewise", CRC32_BACKEND_BYTEWISE, sizes[i], iterations[i] * scale);
+        bench("slice8", CRC32_BACKEND_SLICE8, sizes[i], iterations[i] * scale);
+        bench("dma", CRC32_BACKEND_DMA, sizes[i], iterations[i] * scale);
+    }
+
+    return 0;
+}
@@ -0,0 +1,109 @@
+// QOI decoder microbenchmark. Decodes whole frames into a sink that drops
+// the pixels and compares decoded throughput with what the panel's SPI
+// clock can take. Numbers are for the host CPU; the RP2040 at 125 MHz is
+// roughly an order of magnitude slower per byte, so the margin over the
+// SPI rate is what matters.
+//
+// Usage: ./bench_qoi [iterations-scale]
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "../../src/codec/qoi.h"
+#include "../../src/common/deskthang_constants.h"
+
+#define FRAME_PIXELS (DISPLAY_WIDTH * DISPLAY_HEIGHT)
+
+static uint8_t frame[TRANSFER_MAX_SIZE];
+static uint8_t stream[QOI_MAX_ENCODED_SIZE(FRAME_PIXELS)];
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static bool discard(const uint8_t *data, uint32_t length, void *context) {
+    return true;
+}
+
+static void set_pixel(uint32_t i, uint16_t value) {
+    frame[2 * i] = value & 0xFF;
+    frame[2 * i + 1] = value >> 8;
+}
+
+// Mostly flat status screen with a few bars of text-like detail
+static void fill_dashboard(void) {
+    for (uint32_t i = 0; i < FRAME_PIXELS; i++) {
+        uint16_t x = i % DISPLAY_WIDTH;
+        uint16_t y = i / DISPLAY_WIDTH;
+        bool glyph = (y / 20) % 3 == 1 && ((x * 7 + y * 3) % 11) < 4;
+        set_pixel(i, glyph ? 0xFFFF : 0x18E3);
+    }
+}
+
+// Smooth two-axis gradient, the DIFF/LUMA heavy case
+static void fill_gradient(void) {
+    for (uint32_t i = 0; i < FRAME_PIXELS; i++) {
+        uint16_t x = i % DISPLAY_WIDTH;
+        uint16_t y = i / DISPLAY_WIDTH;
+        set_pixel(i, ((x * 31 / DISPLAY_WIDTH) << 11) | ((y * 63 / DISPLAY_HEIGHT) << 5) | ((x + y) * 31 / 480));
+    }
+}
+
+// Photo-like: gradient with low-bit noise
+static void fill_photo(void) {
+    fill_gradient();
+    for (uint32_t i = 0; i < FRAME_PIXELS; i++) {
+        uint16_t value = frame[2 * i] | (frame[2 * i + 1] << 8);
+        set_pixel(i, value ^ (rand() & 0x0843));
+    }
+}
+
+static void bench(const char *name, unsigned iterations) {
+    size_t length = qoi_encode(frame, FRAME_PIXELS, stream, sizeof(stream));
+    const QoiSink sink = {.write = discard, .context = NULL};
+    QoiDecoder decoder;
+
+    double start = now_ns();
+    for (unsigned i = 0; i < iterations; i++) {
+        qoi_decoder_init(&decoder, FRAME_PIXELS, &sink);
+        // Fed a chunk at a time, as the transfer does
+        for (size_t offset = 0; offset < length; offset += CHUNK_SIZE) {
+            size_t take = length - offset < CHUNK_SIZE ? length - offset : CHUNK_SIZE;
+            qoi_decoder_feed(&decoder, stream + offset, take);
+        }
+    }
+    double elapsed = now_ns() - start;
+    if (!qoi_decoder_complete(&decoder)) {
+        printf("%-10s decode failed\n", name);
+        return;
+    }
+
+    double us_per_frame = elapsed / iterations / 1e3;
+    double mb_per_s = (double)TRANSFER_MAX_SIZE * iterations / (elapsed / 1e9) / (1024.0 * 1024.0);
+    double spi_mb_per_s = DISPLAY_SPI_BAUD / 8.0 / (1024.0 * 1024.0);
+    printf("%-10s %6zu B (%4.1f:1)  %8.1f us/frame  %8.1f MB/s  %6.1fx SPI\n",
+           name, length, (double)TRANSFER_MAX_SIZE / length, us_per_frame, mb_per_s,
+           mb_per_s / spi_mb_per_s);
+}
+
+int main(int argc, char **argv) {
+    unsigned scale = argc > 1 ? (unsigned)atoi(argv[1]) : 1;
+    if (scale == 0) {
+        scale = 1;
+    }
+
+    printf("SPI at %u Hz: %.2f MB/s of pixels\n", DISPLAY_SPI_BAUD,
+           DISPLAY_SPI_BAUD / 8.0 / (1024.0 * 1024.0));
+
+    fill_dashboard();
+    bench("dashboard", 500 * scale);
+    fill_gradient();
+    bench("gradient", 500 * scale);
+    srand(1);
+    fill_photo();
+    bench("photo", 500 * scale);
+
+    return 0;
+}
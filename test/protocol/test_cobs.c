@@ -0,0 +1,118 @@
+#include <unity.h>
+#include <string.h>
+#include "../../src/protocol/cobs.h"
+
+static uint8_t input[1024];
+static uint8_t encoded[COBS_MAX_ENCODED_SIZE(1024)];
+static uint8_t decoded[1024];
+
+static void assert_round_trip(const uint8_t *data, size_t length) {
+    size_t encoded_length = cobs_encode(data, length, encoded, sizeof(encoded));
+    TEST_ASSERT_TRUE(encoded_length > 0);
+    TEST_ASSERT_TRUE(encoded_length <= COBS_MAX_ENCODED_SIZE(length));
+    TEST_ASSERT_NULL(memchr(encoded, COBS_DELIMITER, encoded_length));
+
+    size_t decoded_length = 0;
+    TEST_ASSERT_TRUE(cobs_decode(encoded, encoded_length, decoded, &decoded_length));
+    TEST_ASSERT_EQUAL(length, decoded_length);
+    TEST_ASSERT_EQUAL_MEMORY(data, decoded, length);
+}
+
+void setUp(void) {
+    memset(encoded, 0xAA, sizeof(encoded));
+    memset(decoded, 0, sizeof(decoded));
+}
+
+void tearDown(void) {
+}
+
+void test_encode_known_vectors(void) {
+    const uint8_t data[] = {0x11, 0x22, 0x00, 0x33};
+    const uint8_t expected[] = {0x03, 0x11, 0x22, 0x02, 0x33};
+
+    TEST_ASSERT_EQUAL(sizeof(expected), cobs_encode(data, sizeof(data), encoded, sizeof(encoded)));
+    TEST_ASSERT_EQUAL_MEMORY(expected, encoded, sizeof(expected));
+}
+
+void test_round_trip_zeros(void) {
+    memset(input, 0, 300);
+    assert_round_trip(input, 300);
+}
+
+void test_round_trip_long_nonzero_run(void) {
+    // Crosses the 254-byte block boundary several times
+    for (size_t i = 0; i < sizeof(input); i++) {
+        input[i] = (uint8_t)(i % 255) + 1;
+    }
+    assert_round_trip(input, 254);
+    assert_round_trip(input, 255);
+    assert_round_trip(input, sizeof(input));
+}
+
+void test_framing_bytes_are_not_inflated(void) {
+    // v1 escaping doubles these; COBS adds one byte per 254
+    memset(input, '~', 512);
+    memset(input + 512, '\n', 256);
+    memset(input + 768, '\\', 256);
+
+    size_t encoded_length = cobs_encode(input, sizeof(input), encoded, sizeof(encoded));
+    TEST_ASSERT_EQUAL(COBS_MAX_ENCODED_SIZE(sizeof(input)), encoded_length);
+    assert_round_trip(input, sizeof(input));
+}
+
+void test_incremental_encoder_matches_one_shot(void) {
+    for (size_t i = 0; i < 600; i++) {
+        input[i] = (uint8_t)(i * 7);
+    }
+    size_t one_shot = cobs_encode(input, 600, decoded, sizeof(decoded));
+
+    CobsEncoder encoder;
+    cobs_encoder_init(&encoder, encoded, sizeof(encoded));
+    cobs_encoder_update(&encoder, input, 4);
+    cobs_encoder_update(&encoder, input + 4, 500);
+    cobs_encoder_update(&encoder, input + 504, 96);
+    TEST_ASSERT_EQUAL(one_shot, cobs_encoder_finish(&encoder));
+    TEST_ASSERT_EQUAL_MEMORY(decoded, encoded, one_shot);
+}
+
+void test_encode_overflow_fails(void) {
+    memset(input, 0x55, 100);
+    TEST_ASSERT_EQUAL(0, cobs_encode(input, 100, encoded, 50));
+}
+
+void test_decode_in_place(void) {
+    const uint8_t data[] = {0x00, 0x01, 0x02, 0x00, 0x00, 0x7E};
+    size_t length = cobs_encode(data, sizeof(data), encoded, sizeof(encoded));
+
+    size_t decoded_length = 0;
+    TEST_ASSERT_TRUE(cobs_decode(encoded, length, encoded, &decoded_length));
+    TEST_ASSERT_EQUAL(sizeof(data), decoded_length);
+    TEST_ASSERT_EQUAL_MEMORY(data, encoded, sizeof(data));
+}
+
+void test_decode_rejects_malformed(void) {
+    const uint8_t embedded_zero[] = {0x03, 0x11, 0x00, 0x01};
+    const uint8_t truncated[] = {0x05, 0x11, 0x22};
+    size_t length;
+
+    TEST_ASSERT_FALSE(cobs_decode(embedded_zero, sizeof(embedded_zero), decoded, &length));
+    TEST_ASSERT_FALSE(cobs_decode(truncated, sizeof(truncated), decoded, &length));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    // Encoding
+    RUN_TEST(test_encode_known_vectors);
+    RUN_TEST(test_round_trip_zeros);
+    RUN_TEST(test_round_trip_long_nonzero_run);
+    RUN_TEST(test_framing_bytes_are_not_inflated);
+    RUN_TEST(test_incremental_encoder_matches_one_shot);
+    RUN_TEST(test_encode_overflow_fails);
+
+    // Decoding
+    RUN_TEST(test_decode_in_place);
+    RUN_TEST(test_decode_rejects_malformed);
+
+    return UNITY_END();
+}
@@ -0,0 +1,89 @@
+#include <unity.h>
+#include <string.h>
+#include "../../src/protocol/crc32.h"
+
+static uint8_t data[1024 + 8];
+static uint8_t copy[1024 + 8];
+
+void setUp(void) {
+    crc32_set_backend(CRC32_BACKEND_SLICE8);
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = (uint8_t)(i * 31 + (i >> 5));
+    }
+    memset(copy, 0, sizeof(copy));
+}
+
+void tearDown(void) {
+}
+
+void test_check_value(void) {
+    const char *check = "123456789";
+
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, crc32_compute(check, 9));
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, crc32_finalize(crc32_update_bytewise(CRC32_INIT, check, 9)));
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, crc32_finalize(crc32_update_slice8(CRC32_INIT, check, 9)));
+}
+
+void test_empty_input_is_identity(void) {
+    TEST_ASSERT_EQUAL_HEX32(0x00000000, crc32_compute(data, 0));
+    TEST_ASSERT_EQUAL_HEX32(0x12345678, crc32_update(0x12345678, NULL, 0));
+}
+
+void test_slice8_matches_bytewise_at_every_alignment(void) {
+    for (size_t offset = 0; offset < 8; offset++) {
+        for (size_t length = 0; length <= 64; length++) {
+            TEST_ASSERT_EQUAL_HEX32(crc32_update_bytewise(CRC32_INIT, data + offset, length),
+                                    crc32_update_slice8(CRC32_INIT, data + offset, length));
+        }
+        TEST_ASSERT_EQUAL_HEX32(crc32_update_bytewise(CRC32_INIT, data + offset, 1024),
+                                crc32_update_slice8(CRC32_INIT, data + offset, 1024));
+    }
+}
+
+void test_incremental_matches_one_shot(void) {
+    uint32_t expected = crc32_compute(data, 1024);
+
+    for (size_t split = 0; split <= 1024; split += 37) {
+        uint32_t crc = crc32_update(CRC32_INIT, data, split);
+        crc = crc32_update(crc, data + split, 1024 - split);
+        TEST_ASSERT_EQUAL_HEX32(expected, crc32_finalize(crc));
+    }
+}
+
+void test_copy_moves_data_and_checksums_it(void) {
+    uint32_t crc = crc32_copy(CRC32_INIT, copy, data, 1024);
+
+    TEST_ASSERT_EQUAL_MEMORY(data, copy, 1024);
+    TEST_ASSERT_EQUAL_HEX32(crc32_compute(data, 1024), crc32_finalize(crc));
+}
+
+void test_backend_selection(void) {
+    TEST_ASSERT_TRUE(crc32_set_backend(CRC32_BACKEND_BYTEWISE));
+    TEST_ASSERT_EQUAL(CRC32_BACKEND_BYTEWISE, crc32_get_backend());
+    TEST_ASSERT_EQUAL_HEX32(0xCBF43926, crc32_compute("123456789", 9));
+
+    // No DMA sniffer off-target; the current backend must survive the attempt
+    TEST_ASSERT_FALSE(crc32_set_backend(CRC32_BACKEND_DMA));
+    TEST_ASSERT_EQUAL(CRC32_BACKEND_BYTEWISE, crc32_get_backend());
+
+    crc32_init();
+    TEST_ASSERT_EQUAL(CRC32_BACKEND_SLICE8, crc32_get_backend());
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    // Known values
+    RUN_TEST(test_check_value);
+    RUN_TEST(test_empty_input_is_identity);
+
+    // Kernels agree
+    RUN_TEST(test_slice8_matches_bytewise_at_every_alignment);
+    RUN_TEST(test_incremental_matches_one_shot);
+    RUN_TEST(test_copy_moves_data_and_checksums_it);
+
+    // Backends
+    RUN_TEST(test_backend_selection);
+
+    return UNITY_END();
+}
@@ -0,0 +1,234 @@
+#define _GNU_SOURCE  // memmem
+// Strip DEBUG sites here, as a release build would
+#define DESKTHANG_LOG_LEVEL LOG_LEVEL_INFO
+#include <unity.h>
+#include <string.h>
+#include "../../src/error/logging.h"
+#include "../../src/protocol/packet.h"
+#include "../../src/system/platform.h"
+#include "../mocks/mock_serial.h"
+#include "../mocks/mock_time.h"
+
+static uint8_t written[1024];
+
+static LoggingStats stats(void) {
+    LoggingStats current;
+    logging_get_stats(&current);
+    return current;
+}
+
+// Whether text went out over serial since the last reset
+static bool sent_text(const char *text) {
+    uint16_t length = 0;
+    mock_serial_get_written_data(written, &length);
+    return memmem(written, length, text, strlen(text)) != NULL;
+}
+
+// Whether these bytes went out over serial since the last reset
+static bool sent_bytes(const uint8_t *bytes, size_t count) {
+    uint16_t length = 0;
+    mock_serial_get_written_data(written, &length);
+    return memmem(written, length, bytes, count) != NULL;
+}
+
+static int evaluated;
+
+static const char *counted(const char *text) {
+    evaluated++;
+    return text;
+}
+
+void setUp(void) {
+    mock_time_set(1000);
+    mock_serial_reset();
+    packet_init();
+    logging_init();
+}
+
+void tearDown(void) {
+}
+
+void test_write_queues_without_sending(void) {
+    logging_write("Init", "hello");
+
+    TEST_ASSERT_EQUAL(0, mock_serial_get_write_count());
+    TEST_ASSERT_EQUAL(1, stats().pending);
+
+    TEST_ASSERT_EQUAL(1, logging_service());
+    TEST_ASSERT_TRUE(sent_text("Init: hello"));
+    TEST_ASSERT_EQUAL(0, stats().pending);
+    TEST_ASSERT_EQUAL(1, stats().sent);
+}
+
+void test_service_sends_a_batch(void) {
+    for (int i = 0; i < LOG_DRAIN_BATCH + 2; i++) {
+        logging_write("Init", "line");
+    }
+
+    TEST_ASSERT_EQUAL(LOG_DRAIN_BATCH, logging_service());
+    TEST_ASSERT_EQUAL(2, stats().pending);
+    TEST_ASSERT_EQUAL(2, logging_service());
+    TEST_ASSERT_EQUAL(0, logging_service());
+}
+
+void test_full_ring_counts_and_reports_drops(void) {
+    // A second apart, so the rate limiter stays out of it
+    for (int i = 0; i < LOG_RING_RECORDS + 5; i++) {
+        logging_write("Init", "line");
+        mock_time_advance(1000);
+    }
+    TEST_ASSERT_EQUAL(LOG_RING_RECORDS, stats().queued);
+    TEST_ASSERT_EQUAL(5, stats().dropped_full);
+
+    // The report follows the records that made it
+    while (stats().pending > 0) {
+        logging_service();
+        mock_serial_reset();
+    }
+    logging_service();
+    TEST_ASSERT_TRUE(sent_text("Log: 5 records dropped, queue full"));
+
+    // Reported once
+    mock_serial_reset();
+    TEST_ASSERT_EQUAL(0, logging_service());
+}
+
+void test_module_rate_is_limited(void) {
+    for (int i = 0; i < 20; i++) {
+        logging_write("Spam", "again");
+    }
+    logging_write("Init", "still here");
+
+    TEST_ASSERT_EQUAL(LOG_RATE_BURST + 1, stats().queued);
+    TEST_ASSERT_EQUAL(20 - LOG_RATE_BURST, stats().dropped_rate);
+
+    logging_flush();
+    TEST_ASSERT_TRUE(sent_text("Init: still here"));
+    TEST_ASSERT_TRUE(sent_text("Log: 12 Spam records over rate limit"));
+}
+
+void test_rate_refills_over_time(void) {
+    for (int i = 0; i < LOG_RATE_BURST; i++) {
+        logging_write("Spam", "again");
+    }
+    logging_write("Spam", "limited");
+    TEST_ASSERT_EQUAL(1, stats().dropped_rate);
+
+    // One more record a 1 / LOG_RATE_PER_SEC second later
+    mock_time_advance((1000 + LOG_RATE_PER_SEC - 1) / LOG_RATE_PER_SEC);
+    logging_write("Spam", "allowed");
+    TEST_ASSERT_EQUAL(LOG_RATE_BURST + 1, stats().queued);
+    TEST_ASSERT_EQUAL(1, stats().dropped_rate);
+}
+
+void test_long_message_is_truncated(void) {
+    char message[200];
+    memset(message, 'x', sizeof(message) - 1);
+    message[sizeof(message) - 1] = '\0';
+    logging_write("Init", message);
+
+    logging_flush();
+    char expected[LOG_MESSAGE_SIZE + 8];
+    snprintf(expected, sizeof(expected), "Init: %.*s ", LOG_MESSAGE_SIZE - 1, message);
+    TEST_ASSERT_TRUE(sent_text(expected));  // Then the checksum
+}
+
+void test_context_is_appended(void) {
+    logging_write_with_context("State", "Invalid transition", "IDLE -> SYNCING");
+    logging_flush();
+    TEST_ASSERT_TRUE(sent_text("State: Invalid transition (IDLE -> SYNCING)"));
+}
+
+void test_event_sends_timestamp_site_and_raw_args(void) {
+    LOG_EVENT(TRANSFER_REGIONS_DONE, 3, 0x01020304);
+    TEST_ASSERT_EQUAL(1, stats().pending);
+    logging_flush();
+
+    // 1000 ms in us, site, then each argument as a u32
+    const uint8_t payload[] = {
+        0x40, 0x42, 0x0F, 0x00,
+        LOG_SITE_TRANSFER_REGIONS_DONE, 0,
+        3, 0, 0, 0,
+        0x04, 0x03, 0x02, 0x01
+    };
+    TEST_ASSERT_TRUE(sent_bytes(payload, sizeof(payload)));
+    TEST_ASSERT_FALSE(sent_text("Region update complete"));
+}
+
+void test_event_strings_are_length_prefixed(void) {
+    LOG_EVENT(STATE_CHANGED, "IDLE", "READY");
+    logging_flush();
+
+    const uint8_t args[] = {
+        LOG_SITE_STATE_CHANGED, 0,
+        4, 'I', 'D', 'L', 'E',
+        5, 'R', 'E', 'A', 'D', 'Y'
+    };
+    TEST_ASSERT_TRUE(sent_bytes(args, sizeof(args)));
+}
+
+void test_disabled_level_is_compiled_out(void) {
+    evaluated = 0;
+    LOG_EVENT(STATE_ENTRY_ACTIONS, counted("READY"));
+    LOG_EVENT(STATE_TRANSITIONED, counted("READY"));
+
+    // The DEBUG site didn't even evaluate its argument
+    TEST_ASSERT_EQUAL(1, evaluated);
+    TEST_ASSERT_EQUAL(1, stats().queued);
+}
+
+void test_arguments_that_do_not_fit_are_left_out(void) {
+    char text[200];
+    memset(text, 'x', sizeof(text) - 1);
+    text[sizeof(text) - 1] = '\0';
+
+    LogArgs args = {.length = 0, .full = false};
+    log_args_string(&args, text);
+    TEST_ASSERT_EQUAL(LOG_EVENT_ARGS_SIZE, args.length);
+    TEST_ASSERT_EQUAL(LOG_EVENT_ARGS_SIZE - 1, args.data[0]);
+
+    // A later argument can't land where the host expects something else
+    log_args_u32(&args, 7);
+    log_args_string(&args, "");
+    TEST_ASSERT_TRUE(args.full);
+    TEST_ASSERT_EQUAL(LOG_EVENT_ARGS_SIZE, args.length);
+}
+
+static void core1_logs(void) {
+    logging_write("Core1", "decode failed");
+}
+
+void test_second_core_logs_through_its_own_ring(void) {
+    TEST_ASSERT_TRUE(platform_core_launch(core1_logs));
+    platform_core_join();
+
+    logging_write("Core0", "first");
+    logging_flush();
+    TEST_ASSERT_TRUE(sent_text("Core0: first"));
+    TEST_ASSERT_TRUE(sent_text("Core1: decode failed"));
+    TEST_ASSERT_EQUAL(2, stats().sent);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    // Deferred sending
+    RUN_TEST(test_write_queues_without_sending);
+    RUN_TEST(test_service_sends_a_batch);
+    RUN_TEST(test_long_message_is_truncated);
+    RUN_TEST(test_context_is_appended);
+    RUN_TEST(test_second_core_logs_through_its_own_ring);
+
+    // Binary events
+    RUN_TEST(test_event_sends_timestamp_site_and_raw_args);
+    RUN_TEST(test_event_strings_are_length_prefixed);
+    RUN_TEST(test_disabled_level_is_compiled_out);
+    RUN_TEST(test_arguments_that_do_not_fit_are_left_out);
+
+    // Loss accounting
+    RUN_TEST(test_full_ring_counts_and_reports_drops);
+    RUN_TEST(test_module_rate_is_limited);
+    RUN_TEST(test_rate_refills_over_time);
+
+    return UNITY_END();
+}
@@ -0,0 +1,189 @@
+#include <unity.h>
+#include <string.h>
+#include <stdlib.h>
+#include "../../src/protocol/packet.h"
+#include "../../src/protocol/cobs.h"
+#include "../mocks/mock_serial.h"
+#include "../mocks/mock_time.h"
+
+static uint8_t frame[PACKET_V2_MAX_FRAME_SIZE];
+static uint8_t written[1024];
+static uint8_t payload[CHUNK_SIZE + 2];
+
+void setUp(void) {
+    mock_time_set(1000);
+    mock_serial_reset();
+    packet_init();
+
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i * 3);
+    }
+}
+
+void tearDown(void) {
+    packet_set_framing(PACKET_FRAMING_V1);
+}
+
+void test_boots_in_v1(void) {
+    TEST_ASSERT_EQUAL(PACKET_FRAMING_V1, packet_get_framing());
+}
+
+void test_v2_round_trip(void) {
+    Packet sent, received;
+    TEST_ASSERT_TRUE(packet_create(&sent, PACKET_TYPE_DATA, 42, payload, sizeof(payload)));
+
+    size_t length = packet_encode_v2(&sent, frame, sizeof(frame));
+    TEST_ASSERT_TRUE(length > 0);
+    TEST_ASSERT_EQUAL_HEX8(COBS_DELIMITER, frame[length - 1]);
+    TEST_ASSERT_NULL(memchr(frame, COBS_DELIMITER, length - 1));
+
+    TEST_ASSERT_TRUE(packet_decode_v2(frame, length - 1, &received));
+    TEST_ASSERT_EQUAL(PACKET_TYPE_DATA, received.header.type);
+    TEST_ASSERT_EQUAL(42, received.header.sequence);
+    TEST_ASSERT_EQUAL(sizeof(payload), received.header.length);
+    TEST_ASSERT_EQUAL_MEMORY(payload, received.payload, sizeof(payload));
+    TEST_ASSERT_TRUE(packet_validate(&received));
+
+    packet_free(&sent);
+    packet_free(&received);
+}
+
+void test_v2_header_is_packed_little_endian(void) {
+    Packet sent;
+    TEST_ASSERT_TRUE(packet_create(&sent, PACKET_TYPE_DATA, 7, payload, 0x0102));
+
+    size_t length = packet_encode_v2(&sent, frame, sizeof(frame));
+    size_t raw_length;
+    TEST_ASSERT_TRUE(cobs_decode(frame, length - 1, frame, &raw_length));
+
+    TEST_ASSERT_EQUAL(PACKET_V2_HEADER_SIZE + 0x0102 + PACKET_V2_CRC_SIZE, raw_length);
+    TEST_ASSERT_EQUAL_HEX8(PACKET_TYPE_DATA, frame[0]);
+    TEST_ASSERT_EQUAL_HEX8(7, frame[1]);
+    TEST_ASSERT_EQUAL_HEX8(0x02, frame[2]);
+    TEST_ASSERT_EQUAL_HEX8(0x01, frame[3]);
+
+    packet_free(&sent);
+}
+
+void test_v2_rejects_corrupted_frame(void) {
+    Packet sent, received;
+    TEST_ASSERT_TRUE(packet_create(&sent, PACKET_TYPE_DATA, 1, payload, sizeof(payload)));
+
+    size_t length = packet_encode_v2(&sent, frame, sizeof(frame));
+    frame[length / 2] ^= 0x01;
+    if (frame[length / 2] == COBS_DELIMITER) {
+        frame[length / 2] = 0x03;
+    }
+    TEST_ASSERT_FALSE(packet_decode_v2(frame, length - 1, &received));
+
+    packet_free(&sent);
+}
+
+void test_v2_transmit_is_one_write(void) {
+    Packet sent;
+    TEST_ASSERT_TRUE(packet_create(&sent, PACKET_TYPE_DATA, 1, payload, sizeof(payload)));
+
+    packet_set_framing(PACKET_FRAMING_V2);
+    TEST_ASSERT_TRUE(packet_transmit(&sent));
+    TEST_ASSERT_EQUAL(1, mock_serial_get_write_count());
+
+    packet_free(&sent);
+}
+
+void test_v1_transmit_is_one_write(void) {
+    Packet sent;
+    TEST_ASSERT_TRUE(packet_create(&sent, PACKET_TYPE_DATA, 1, payload, sizeof(payload)));
+
+    TEST_ASSERT_TRUE(packet_transmit(&sent));
+    TEST_ASSERT_EQUAL(1, mock_serial_get_write_count());
+
+    packet_free(&sent);
+}
+
+void test_v1_refused_frame_leaves_nothing_behind(void) {
+    Packet sent;
+    TEST_ASSERT_TRUE(packet_create(&sent, PACKET_TYPE_DATA, 1, payload, sizeof(payload)));
+
+    // Fill the port until the frame no longer fits
+    uint16_t length = 0;
+    while (serial_write(payload, 64)) {
+        length += 64;
+    }
+    TEST_ASSERT_FALSE(packet_transmit(&sent));
+
+    uint16_t after;
+    mock_serial_get_written_data(written, &after);
+    TEST_ASSERT_EQUAL(length, after);
+
+    packet_free(&sent);
+}
+
+void test_v2_framing_bytes_cost_no_escapes(void) {
+    // Image data full of v1 framing characters
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = "~\n\\"[i % 3];
+    }
+    Packet sent;
+    TEST_ASSERT_TRUE(packet_create(&sent, PACKET_TYPE_DATA, 1, payload, sizeof(payload)));
+
+    uint16_t v1_length, v2_length;
+    TEST_ASSERT_TRUE(packet_transmit(&sent));
+    mock_serial_get_written_data(written, &v1_length);
+
+    mock_serial_reset();
+    packet_set_framing(PACKET_FRAMING_V2);
+    TEST_ASSERT_TRUE(packet_transmit(&sent));
+    mock_serial_get_written_data(written, &v2_length);
+
+    TEST_ASSERT_TRUE(v1_length > 2 * sizeof(payload));
+    TEST_ASSERT_TRUE(v2_length <= COBS_MAX_ENCODED_SIZE(PACKET_V2_HEADER_SIZE + sizeof(payload) + PACKET_V2_CRC_SIZE) + 1);
+
+    packet_free(&sent);
+}
+
+void test_v2_receive_from_serial(void) {
+    Packet sent, received;
+    TEST_ASSERT_TRUE(packet_create(&sent, PACKET_TYPE_COMMAND, 9, payload, 16));
+    size_t length = packet_encode_v2(&sent, frame, sizeof(frame));
+    mock_serial_set_read_data(frame, length);
+
+    packet_set_framing(PACKET_FRAMING_V2);
+    TEST_ASSERT_TRUE(packet_receive(&received));
+    TEST_ASSERT_EQUAL(PACKET_TYPE_COMMAND, received.header.type);
+    TEST_ASSERT_EQUAL_MEMORY(payload, received.payload, 16);
+
+    packet_free(&sent);
+    packet_free(&received);
+}
+
+void test_v1_frame_drops_back_to_v1(void) {
+    // A v1 header holds zero bytes, so v2 sees a short frame opening with
+    // the escaped start marker
+    const uint8_t v1_start[] = {'\\', '~' ^ 0x20, PACKET_TYPE_SYNC, COBS_DELIMITER};
+    mock_serial_set_read_data(v1_start, sizeof(v1_start));
+
+    Packet received;
+    packet_set_framing(PACKET_FRAMING_V2);
+    TEST_ASSERT_FALSE(packet_receive(&received));
+    TEST_ASSERT_EQUAL(PACKET_FRAMING_V1, packet_get_framing());
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    // Encoding
+    RUN_TEST(test_boots_in_v1);
+    RUN_TEST(test_v2_round_trip);
+    RUN_TEST(test_v2_header_is_packed_little_endian);
+    RUN_TEST(test_v2_rejects_corrupted_frame);
+
+    // Transmission
+    RUN_TEST(test_v1_transmit_is_one_write);
+    RUN_TEST(test_v1_refused_frame_leaves_nothing_behind);
+    RUN_TEST(test_v2_transmit_is_one_write);
+    RUN_TEST(test_v2_framing_bytes_cost_no_escapes);
+    RUN_TEST(test_v2_receive_from_serial);
+    RUN_TEST(test_v1_frame_drops_back_to_v1);
+
+    return UNITY_END();
+}
@@ -0,0 +1,286 @@
+#include <unity.h>
+#include <string.h>
+#include <stdio.h>
+#include <time.h>
+#include "../../src/protocol/packet.h"
+#include "../../src/protocol/packet_parser.h"
+#include "../mocks/mock_serial.h"
+#include "../mocks/mock_time.h"
+
+#define STREAM_PACKETS 64
+#define STREAM_SIZE (STREAM_PACKETS * (2 * PACKET_PARSER_V1_MAX_SIZE + 32))
+
+static PacketParser parser;
+static uint8_t stream[STREAM_SIZE];
+static size_t stream_length;
+static uint8_t payload[MAX_PAYLOAD_SIZE];
+static uint8_t frame[PACKET_V2_MAX_FRAME_SIZE];
+
+// What the callback saw
+static uint32_t received_count;
+static uint8_t received_sequences[STREAM_PACKETS * 2];
+static bool payloads_intact;
+
+static uint32_t rng_state;
+
+static uint32_t next_random(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 17;
+    rng_state ^= rng_state << 5;
+    return rng_state;
+}
+
+// Payload contents are derived from the sequence so the callback can check them
+static uint16_t payload_length_for(uint8_t sequence) {
+    return (uint16_t)((sequence * 37u) % 300u);
+}
+
+static void fill_payload(uint8_t sequence, uint16_t length) {
+    for (uint16_t i = 0; i < length; i++) {
+        payload[i] = (uint8_t)(sequence + i * 7);
+    }
+    // Make sure delimiters and escapes show up inside payloads
+    if (length > 3) {
+        payload[0] = 0x00;
+        payload[1] = '\n';
+        payload[2] = '~';
+        payload[3] = '\\';
+    }
+}
+
+static void on_packet(Packet *packet, void *context) {
+    (void)context;
+    uint8_t sequence = packet->header.sequence;
+    uint16_t length = payload_length_for(sequence);
+
+    fill_payload(sequence, length);
+    if (packet->header.length != length ||
+        (length > 0 && memcmp(packet->payload, payload, length) != 0)) {
+        payloads_intact = false;
+    }
+    received_sequences[received_count++] = sequence;
+}
+
+// Append a packet in the active framing, as the host would send it
+static void append_packet(uint8_t sequence) {
+    uint16_t length = payload_length_for(sequence);
+    fill_payload(sequence, length);
+
+    Packet packet;
+    TEST_ASSERT_TRUE(packet_create(&packet, PACKET_TYPE_DATA, sequence, payload, length));
+
+    if (packet_get_framing() == PACKET_FRAMING_V2) {
+        size_t frame_length = packet_encode_v2(&packet, frame, sizeof(frame));
+        TEST_ASSERT_TRUE(frame_length > 0);
+        memcpy(stream + stream_length, frame, frame_length);
+        stream_length += frame_length;
+    } else {
+        // v1: capture what packet_transmit writes
+        uint8_t written[2 * PACKET_PARSER_V1_MAX_SIZE];
+        uint16_t written_length = 0;
+        mock_serial_reset();
+        TEST_ASSERT_TRUE(packet_transmit(&packet));
+        mock_serial_get_written_data(written, &written_length);
+        memcpy(stream + stream_length, written, written_length);
+        stream_length += written_length;
+    }
+    packet_free(&packet);
+}
+
+static void append_garbage(size_t length, uint8_t delimiter) {
+    for (size_t i = 0; i < length; i++) {
+        uint8_t byte = (uint8_t)next_random();
+        stream[stream_length++] = (byte == delimiter) ? 0x55 : byte;
+    }
+    stream[stream_length++] = delimiter;
+}
+
+// Feed the stream in random fragments of 1..max_fragment bytes
+static void feed_fragmented(size_t max_fragment) {
+    size_t offset = 0;
+    while (offset < stream_length) {
+        size_t fragment = 1 + next_random() % max_fragment;
+        if (fragment > stream_length - offset) {
+            fragment = stream_length - offset;
+        }
+        packet_parser_feed(&parser, stream + offset, fragment);
+        offset += fragment;
+    }
+}
+
+void setUp(void) {
+    mock_time_set(1000);
+    mock_serial_reset();
+    packet_init();
+    packet_parser_init(&parser, on_packet, NULL);
+
+    stream_length = 0;
+    received_count = 0;
+    payloads_intact = true;
+    rng_state = 0x12345678;
+}
+
+void tearDown(void) {
+    packet_set_framing(PACKET_FRAMING_V1);
+}
+
+void test_v1_packet_split_at_every_byte(void) {
+    append_packet(5);
+    feed_fragmented(1);
+
+    TEST_ASSERT_EQUAL(1, received_count);
+    TEST_ASSERT_EQUAL(5, received_sequences[0]);
+    TEST_ASSERT_TRUE(payloads_intact);
+    TEST_ASSERT_FALSE(packet_parser_in_frame(&parser));
+}
+
+void test_partial_frame_survives_between_feeds(void) {
+    packet_set_framing(PACKET_FRAMING_V2);
+    append_packet(9);
+
+    packet_parser_feed(&parser, stream, stream_length - 1);
+    TEST_ASSERT_EQUAL(0, received_count);
+    TEST_ASSERT_TRUE(packet_parser_in_frame(&parser));
+
+    packet_parser_feed(&parser, stream + stream_length - 1, 1);
+    TEST_ASSERT_EQUAL(1, received_count);
+}
+
+void test_many_packets_in_one_span(void) {
+    packet_set_framing(PACKET_FRAMING_V2);
+    for (int i = 0; i < STREAM_PACKETS; i++) {
+        append_packet((uint8_t)i);
+    }
+
+    TEST_ASSERT_EQUAL(STREAM_PACKETS, packet_parser_feed(&parser, stream, stream_length));
+    TEST_ASSERT_TRUE(payloads_intact);
+    for (int i = 0; i < STREAM_PACKETS; i++) {
+        TEST_ASSERT_EQUAL(i, received_sequences[i]);
+    }
+}
+
+void test_fuzz_fragmented_stream_with_garbage(void) {
+    uint8_t framings[] = {PACKET_FRAMING_V1, PACKET_FRAMING_V2};
+
+    for (size_t f = 0; f < sizeof(framings); f++) {
+        setUp();
+        packet_set_framing(framings[f]);
+        uint8_t delimiter = framings[f] == PACKET_FRAMING_V2 ? COBS_DELIMITER : '\n';
+
+        // Garbage between every packet: the packet after it must still arrive
+        for (int i = 0; i < STREAM_PACKETS; i++) {
+            append_garbage(next_random() % 40, delimiter);
+            append_packet((uint8_t)i);
+        }
+
+        for (size_t max_fragment = 1; max_fragment <= 512; max_fragment *= 8) {
+            received_count = 0;
+            feed_fragmented(max_fragment);
+
+            TEST_ASSERT_EQUAL(STREAM_PACKETS, received_count);
+            TEST_ASSERT_TRUE(payloads_intact);
+            for (int i = 0; i < STREAM_PACKETS; i++) {
+                TEST_ASSERT_EQUAL(i, received_sequences[i]);
+            }
+        }
+        tearDown();
+    }
+}
+
+void test_corrupted_packet_costs_only_itself(void) {
+    packet_set_framing(PACKET_FRAMING_V2);
+    append_packet(1);
+    size_t second = stream_length;
+    append_packet(2);
+    append_packet(3);
+
+    stream[second + 3] ^= 0x10;
+    packet_parser_feed(&parser, stream, stream_length);
+
+    TEST_ASSERT_EQUAL(2, received_count);
+    TEST_ASSERT_EQUAL(1, received_sequences[0]);
+    TEST_ASSERT_EQUAL(3, received_sequences[1]);
+    TEST_ASSERT_EQUAL(1, packet_parser_get_stats(&parser)->frames_dropped);
+}
+
+void test_oversized_frame_is_skipped(void) {
+    packet_set_framing(PACKET_FRAMING_V2);
+    memset(stream, 0x42, PACKET_PARSER_BUFFER_SIZE + 100);
+    stream_length = PACKET_PARSER_BUFFER_SIZE + 100;
+    stream[stream_length++] = COBS_DELIMITER;
+    append_packet(7);
+
+    packet_parser_feed(&parser, stream, stream_length);
+
+    TEST_ASSERT_EQUAL(1, received_count);
+    TEST_ASSERT_EQUAL(7, received_sequences[0]);
+    TEST_ASSERT_EQUAL(1, packet_parser_get_stats(&parser)->overflows);
+}
+
+void test_poll_reads_serial_without_blocking(void) {
+    packet_set_framing(PACKET_FRAMING_V2);
+    append_packet(4);
+
+    // Only the first half is available yet
+    mock_serial_set_read_data(stream, stream_length / 2);
+    TEST_ASSERT_EQUAL(0, packet_parser_poll(&parser));
+    TEST_ASSERT_TRUE(packet_parser_in_frame(&parser));
+
+    mock_serial_set_read_data(stream + stream_length / 2, stream_length - stream_length / 2);
+    TEST_ASSERT_EQUAL(1, packet_parser_poll(&parser));
+    TEST_ASSERT_EQUAL(0, packet_parser_poll(&parser));
+}
+
+void test_parser_leaves_no_slabs_held(void) {
+    packet_set_framing(PACKET_FRAMING_V2);
+    for (int i = 0; i < STREAM_PACKETS; i++) {
+        append_packet((uint8_t)i);
+    }
+    feed_fragmented(100);
+
+    PacketPoolStats stats;
+    packet_pool_get_stats(&stats);
+    TEST_ASSERT_EQUAL(0, stats.slabs_in_use);
+}
+
+void test_throughput(void) {
+    packet_set_framing(PACKET_FRAMING_V2);
+    for (int i = 0; i < STREAM_PACKETS; i++) {
+        append_packet((uint8_t)i);
+    }
+
+    const int rounds = 200;
+    clock_t start = clock();
+    for (int round = 0; round < rounds; round++) {
+        received_count = 0;
+        feed_fragmented(64);
+    }
+    double seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+    char message[96];
+    snprintf(message, sizeof(message), "Parser throughput: %.1f MB/s (64-byte fragments)",
+             seconds > 0 ? (double)stream_length * rounds / seconds / (1024.0 * 1024.0) : 0.0);
+    TEST_MESSAGE(message);
+    TEST_ASSERT_EQUAL(STREAM_PACKETS, received_count);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    // Resumable parsing
+    RUN_TEST(test_v1_packet_split_at_every_byte);
+    RUN_TEST(test_partial_frame_survives_between_feeds);
+    RUN_TEST(test_many_packets_in_one_span);
+
+    // Resynchronisation
+    RUN_TEST(test_fuzz_fragmented_stream_with_garbage);
+    RUN_TEST(test_corrupted_packet_costs_only_itself);
+    RUN_TEST(test_oversized_frame_is_skipped);
+
+    // Serial and resources
+    RUN_TEST(test_poll_reads_serial_without_blocking);
+    RUN_TEST(test_parser_leaves_no_slabs_held);
+    RUN_TEST(test_throughput);
+
+    return UNITY_END();
+}
@@ -0,0 +1,161 @@
+#include <unity.h>
+#include <string.h>
+#include "../../src/protocol/packet.h"
+#include "../../src/protocol/packet_pool.h"
+#include "../mocks/mock_serial.h"
+#include "../mocks/mock_time.h"
+
+static uint8_t payload[MAX_PAYLOAD_SIZE];
+static uint8_t frame[PACKET_V2_MAX_FRAME_SIZE];
+
+static PacketPoolStats pool_stats(void) {
+    PacketPoolStats stats;
+    packet_pool_get_stats(&stats);
+    return stats;
+}
+
+void setUp(void) {
+    mock_time_set(1000);
+    mock_serial_reset();
+    packet_init();
+
+    for (size_t i = 0; i < sizeof(payload); i++) {
+        payload[i] = (uint8_t)(i * 5 + 1);
+    }
+}
+
+void tearDown(void) {
+    packet_set_framing(PACKET_FRAMING_V1);
+}
+
+void test_acquire_release_reuses_slabs(void) {
+    uint8_t *first = packet_pool_acquire();
+    TEST_ASSERT_NOT_NULL(first);
+    TEST_ASSERT_EQUAL(0, (uintptr_t)first % 4);
+    TEST_ASSERT_TRUE(packet_pool_owns(first));
+
+    TEST_ASSERT_TRUE(packet_pool_release(first));
+    TEST_ASSERT_EQUAL_PTR(first, packet_pool_acquire());
+}
+
+void test_exhaustion_is_counted(void) {
+    uint8_t *slabs[PACKET_POOL_SLAB_COUNT];
+    for (int i = 0; i < PACKET_POOL_SLAB_COUNT; i++) {
+        slabs[i] = packet_pool_acquire();
+        TEST_ASSERT_NOT_NULL(slabs[i]);
+    }
+
+    TEST_ASSERT_NULL(packet_pool_acquire());
+    TEST_ASSERT_EQUAL(1, pool_stats().exhausted);
+    TEST_ASSERT_EQUAL(PACKET_POOL_SLAB_COUNT, pool_stats().high_water);
+
+    for (int i = 0; i < PACKET_POOL_SLAB_COUNT; i++) {
+        TEST_ASSERT_TRUE(packet_pool_release(slabs[i]));
+    }
+    TEST_ASSERT_EQUAL(0, pool_stats().slabs_in_use);
+    TEST_ASSERT_EQUAL(PACKET_POOL_SLAB_COUNT, pool_stats().high_water);
+}
+
+void test_double_and_foreign_release_rejected(void) {
+    uint8_t *slab = packet_pool_acquire();
+    TEST_ASSERT_TRUE(packet_pool_release(slab));
+    TEST_ASSERT_FALSE(packet_pool_release(slab));
+    TEST_ASSERT_FALSE(packet_pool_release(payload));
+    TEST_ASSERT_FALSE(packet_pool_release(slab + 1));
+
+    TEST_ASSERT_EQUAL(3, pool_stats().invalid_releases);
+    TEST_ASSERT_EQUAL(0, pool_stats().slabs_in_use);
+}
+
+void test_small_payload_stays_inline(void) {
+    Packet packet;
+    TEST_ASSERT_TRUE(packet_create_ack(&packet, 1));
+
+    TEST_ASSERT_EQUAL_PTR(packet.inline_payload, packet.payload);
+    TEST_ASSERT_EQUAL_MEMORY("OK", packet.payload, 2);
+    TEST_ASSERT_EQUAL(0, pool_stats().acquired);
+
+    packet_free(&packet);
+    TEST_ASSERT_NULL(packet.payload);
+}
+
+void test_large_payload_uses_slab_and_returns_it(void) {
+    Packet packet;
+    TEST_ASSERT_TRUE(packet_create(&packet, PACKET_TYPE_DATA, 1, payload, MAX_PAYLOAD_SIZE));
+
+    TEST_ASSERT_TRUE(packet_pool_owns(packet.payload));
+    TEST_ASSERT_EQUAL_MEMORY(payload, packet.payload, MAX_PAYLOAD_SIZE);
+    TEST_ASSERT_EQUAL(1, pool_stats().slabs_in_use);
+
+    packet_free(&packet);
+    TEST_ASSERT_EQUAL(0, pool_stats().slabs_in_use);
+}
+
+void test_create_fails_cleanly_when_exhausted(void) {
+    Packet packets[PACKET_POOL_SLAB_COUNT];
+    for (int i = 0; i < PACKET_POOL_SLAB_COUNT; i++) {
+        TEST_ASSERT_TRUE(packet_create(&packets[i], PACKET_TYPE_DATA, i, payload, CHUNK_SIZE));
+    }
+
+    Packet extra;
+    TEST_ASSERT_FALSE(packet_create(&extra, PACKET_TYPE_DATA, 0, payload, CHUNK_SIZE));
+    TEST_ASSERT_EQUAL(1, pool_stats().exhausted);
+
+    // Small packets still go out while the pool is empty
+    TEST_ASSERT_TRUE(packet_create_ack(&extra, 0));
+
+    for (int i = 0; i < PACKET_POOL_SLAB_COUNT; i++) {
+        packet_free(&packets[i]);
+    }
+    TEST_ASSERT_EQUAL(0, pool_stats().slabs_in_use);
+}
+
+void test_nack_is_sent_without_leaking(void) {
+    TEST_ASSERT_TRUE(packet_send_nack(3, "Chunk rejected"));
+    TEST_ASSERT_TRUE(mock_serial_get_write_count() > 0);
+    TEST_ASSERT_EQUAL(0, pool_stats().slabs_in_use);
+}
+
+void test_received_packet_slab_returned_on_free(void) {
+    Packet sent, received;
+    TEST_ASSERT_TRUE(packet_create(&sent, PACKET_TYPE_DATA, 9, payload, CHUNK_SIZE));
+    size_t length = packet_encode_v2(&sent, frame, sizeof(frame));
+    packet_free(&sent);
+
+    TEST_ASSERT_TRUE(packet_decode_v2(frame, length - 1, &received));
+    TEST_ASSERT_TRUE(packet_pool_owns(received.payload));
+    TEST_ASSERT_EQUAL_MEMORY(payload, received.payload, CHUNK_SIZE);
+
+    packet_free(&received);
+    TEST_ASSERT_EQUAL(0, pool_stats().slabs_in_use);
+}
+
+void test_corrupt_frame_releases_slab(void) {
+    Packet sent, received;
+    TEST_ASSERT_TRUE(packet_create(&sent, PACKET_TYPE_DATA, 9, payload, CHUNK_SIZE));
+    size_t length = packet_encode_v2(&sent, frame, sizeof(frame));
+    packet_free(&sent);
+
+    frame[length / 2] ^= 0x40;
+    TEST_ASSERT_FALSE(packet_decode_v2(frame, length - 1, &received));
+    TEST_ASSERT_EQUAL(0, pool_stats().slabs_in_use);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    // Pool
+    RUN_TEST(test_acquire_release_reuses_slabs);
+    RUN_TEST(test_exhaustion_is_counted);
+    RUN_TEST(test_double_and_foreign_release_rejected);
+
+    // Packet layer
+    RUN_TEST(test_small_payload_stays_inline);
+    RUN_TEST(test_large_payload_uses_slab_and_returns_it);
+    RUN_TEST(test_create_fails_cleanly_when_exhausted);
+    RUN_TEST(test_nack_is_sent_without_leaking);
+    RUN_TEST(test_received_packet_slab_returned_on_free);
+    RUN_TEST(test_corrupt_frame_releases_slab);
+
+    return UNITY_END();
+}
@@ -0,0 +1,212 @@
+#include <unity.h>
+#include <string.h>
+#include "../../src/protocol/pipeline.h"
+
+// Chunks pushed through the threaded pipeline in the stress test
+#define STRESS_CHUNKS 200000
+
+// What the sink saw, checked against what was submitted
+static struct {
+    uint32_t decoded;
+    uint32_t out_of_order;
+    uint32_t corrupt;
+    uint32_t fail_at;   // Fail this decode (0 = never)
+    uint32_t spin;      // Busy work per decode, to let the queue fill
+    uint32_t hold;      // Core1 waits in the sink while set
+} sink_state;
+
+static uint8_t pattern_byte(uint32_t sequence, uint16_t offset) {
+    return (uint8_t)(sequence * 31 + offset);
+}
+
+static uint16_t pattern_length(uint32_t sequence) {
+    return (uint16_t)(1 + sequence % CHUNK_SIZE);
+}
+
+static bool checking_sink(const uint8_t *data, uint16_t length, void *context) {
+    (void)context;
+    uint32_t sequence = sink_state.decoded++;
+
+    if (length != pattern_length(sequence)) {
+        sink_state.out_of_order++;
+    }
+    for (uint16_t i = 0; i < length; i++) {
+        if (data[i] != pattern_byte(sequence, i)) {
+            sink_state.corrupt++;
+            break;
+        }
+    }
+
+    for (volatile uint32_t i = 0; i < sink_state.spin; i++) {
+    }
+    while (__atomic_load_n(&sink_state.hold, __ATOMIC_ACQUIRE)) {
+    }
+    return sink_state.fail_at == 0 || sink_state.decoded != sink_state.fail_at;
+}
+
+static bool submit(uint32_t sequence) {
+    PipelineBuffer *buffer = pipeline_acquire();
+    TEST_ASSERT_NOT_NULL(buffer);
+    buffer->length = pattern_length(sequence);
+    buffer->chunk = (uint16_t)sequence;
+    for (uint16_t i = 0; i < buffer->length; i++) {
+        buffer->data[i] = pattern_byte(sequence, i);
+    }
+    return pipeline_submit(buffer);
+}
+
+static PipelineStats stats(void) {
+    PipelineStats current;
+    pipeline_get_stats(&current);
+    return current;
+}
+
+void setUp(void) {
+    memset(&sink_state, 0, sizeof(sink_state));
+    TEST_ASSERT_TRUE(pipeline_init());
+    TEST_ASSERT_TRUE(pipeline_begin(checking_sink, NULL));
+}
+
+void tearDown(void) {
+    __atomic_store_n(&sink_state.hold, 0, __ATOMIC_RELEASE);
+    pipeline_stop();
+}
+
+void test_inline_decodes_on_submit(void) {
+    TEST_ASSERT_FALSE(pipeline_is_running());
+    TEST_ASSERT_TRUE(submit(0));
+    TEST_ASSERT_EQUAL(1, sink_state.decoded);
+    TEST_ASSERT_EQUAL(PIPELINE_BUFFER_COUNT, stats().buffers_free);
+}
+
+void test_inline_failure_is_sticky_until_begin(void) {
+    sink_state.fail_at = 2;
+    TEST_ASSERT_TRUE(submit(0));
+    TEST_ASSERT_FALSE(submit(1));
+    TEST_ASSERT_FALSE(submit(2));  // Not decoded once failed
+    TEST_ASSERT_EQUAL(2, sink_state.decoded);
+    TEST_ASSERT_TRUE(pipeline_failed());
+    TEST_ASSERT_FALSE(pipeline_flush());
+
+    TEST_ASSERT_TRUE(pipeline_begin(checking_sink, NULL));
+    TEST_ASSERT_FALSE(pipeline_failed());
+}
+
+void test_held_buffers_exhaust_the_pool(void) {
+    PipelineBuffer *held[PIPELINE_BUFFER_COUNT];
+    for (int i = 0; i < PIPELINE_BUFFER_COUNT; i++) {
+        held[i] = pipeline_acquire();
+        TEST_ASSERT_NOT_NULL(held[i]);
+    }
+
+    // Nothing queued, so nothing will come back
+    TEST_ASSERT_NULL(pipeline_acquire());
+
+    pipeline_release(held[3]);
+    TEST_ASSERT_EQUAL_PTR(held[3], pipeline_acquire());
+    for (int i = 0; i < PIPELINE_BUFFER_COUNT; i++) {
+        pipeline_release(held[i]);
+    }
+    TEST_ASSERT_EQUAL(PIPELINE_BUFFER_COUNT, stats().buffers_free);
+}
+
+void test_cannot_init_while_running(void) {
+    TEST_ASSERT_TRUE(pipeline_start());
+    TEST_ASSERT_FALSE(pipeline_start());
+    TEST_ASSERT_FALSE(pipeline_init());
+    pipeline_stop();
+    TEST_ASSERT_TRUE(pipeline_init());
+}
+
+void test_threaded_stress_keeps_order_and_buffers(void) {
+    TEST_ASSERT_TRUE(pipeline_start());
+
+    for (uint32_t sequence = 0; sequence < STRESS_CHUNKS; sequence++) {
+        TEST_ASSERT_TRUE(submit(sequence));
+    }
+    TEST_ASSERT_TRUE(pipeline_flush());
+
+    TEST_ASSERT_EQUAL(STRESS_CHUNKS, sink_state.decoded);
+    TEST_ASSERT_EQUAL(0, sink_state.out_of_order);
+    TEST_ASSERT_EQUAL(0, sink_state.corrupt);
+
+    // Every buffer found its way home
+    PipelineStats s = stats();
+    TEST_ASSERT_EQUAL(STRESS_CHUNKS, s.submitted);
+    TEST_ASSERT_EQUAL(STRESS_CHUNKS, s.consumed);
+    TEST_ASSERT_EQUAL(PIPELINE_BUFFER_COUNT, s.buffers_free);
+}
+
+void test_slow_consumer_applies_backpressure(void) {
+    sink_state.spin = 20000;
+    TEST_ASSERT_TRUE(pipeline_start());
+
+    for (uint32_t sequence = 0; sequence < 2000; sequence++) {
+        TEST_ASSERT_TRUE(submit(sequence));
+    }
+    TEST_ASSERT_TRUE(pipeline_flush());
+
+    // The producer ran ahead until the pool ran dry, then waited
+    PipelineStats s = stats();
+    TEST_ASSERT_EQUAL(2000, sink_state.decoded);
+    TEST_ASSERT_EQUAL(0, sink_state.out_of_order);
+    TEST_ASSERT_TRUE(s.producer_waits > 0);
+    TEST_ASSERT_TRUE(s.queue_high_water <= PIPELINE_BUFFER_COUNT);
+    TEST_ASSERT_EQUAL(PIPELINE_BUFFER_COUNT, s.buffers_free);
+}
+
+void test_try_acquire_does_not_wait_for_core1(void) {
+    sink_state.hold = 1;
+    TEST_ASSERT_TRUE(pipeline_start());
+    for (uint32_t sequence = 0; sequence < PIPELINE_BUFFER_COUNT; sequence++) {
+        TEST_ASSERT_TRUE(submit(sequence));
+    }
+
+    // Core1 is stuck on the first chunk, so nothing comes back yet
+    TEST_ASSERT_NULL(pipeline_try_acquire());
+    TEST_ASSERT_EQUAL(1, stats().producer_misses);
+    TEST_ASSERT_EQUAL(0, stats().producer_waits);
+
+    __atomic_store_n(&sink_state.hold, 0, __ATOMIC_RELEASE);
+    TEST_ASSERT_TRUE(pipeline_flush());
+    PipelineBuffer *buffer = pipeline_try_acquire();
+    TEST_ASSERT_NOT_NULL(buffer);
+    pipeline_release(buffer);
+    TEST_ASSERT_EQUAL(PIPELINE_BUFFER_COUNT, sink_state.decoded);
+}
+
+void test_threaded_failure_reaches_core0(void) {
+    sink_state.fail_at = 100;
+    TEST_ASSERT_TRUE(pipeline_start());
+
+    for (uint32_t sequence = 0; sequence < 1000; sequence++) {
+        submit(sequence);
+    }
+    TEST_ASSERT_FALSE(pipeline_flush());
+    TEST_ASSERT_TRUE(pipeline_failed());
+
+    // Later chunks are skipped, but their buffers still come back
+    PipelineStats s = stats();
+    TEST_ASSERT_EQUAL(100, sink_state.decoded);
+    TEST_ASSERT_EQUAL(1, s.failures);
+    TEST_ASSERT_EQUAL(1000, s.consumed);
+    TEST_ASSERT_EQUAL(PIPELINE_BUFFER_COUNT, s.buffers_free);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    // Single core
+    RUN_TEST(test_inline_decodes_on_submit);
+    RUN_TEST(test_inline_failure_is_sticky_until_begin);
+    RUN_TEST(test_held_buffers_exhaust_the_pool);
+    RUN_TEST(test_cannot_init_while_running);
+
+    // Second core on a thread
+    RUN_TEST(test_threaded_stress_keeps_order_and_buffers);
+    RUN_TEST(test_slow_consumer_applies_backpressure);
+    RUN_TEST(test_try_acquire_does_not_wait_for_core1);
+    RUN_TEST(test_threaded_failure_reaches_core0);
+
+    return UNITY_END();
+}
@@ -0,0 +1,516 @@
+#include <unity.h>
+#include <string.h>
+#include "../../src/protocol/protocol.h"
+#include "../../src/protocol/command.h"
+#include "../../src/protocol/transfer.h"
+#include "../../src/protocol/packet.h"
+#include "../../src/hardware/GC9A01.h"
+#include "../../src/hardware/panel_span.h"
+#include "../../src/codec/delta.h"
+#include "../../src/codec/qoi.h"
+#include "../../src/codec/bc1.h"
+#include "../../src/codec/palette.h"
+#include "../../src/debug/stats.h"
+#include "../../src/debug/trace.h"
+#include "../../src/system/boot.h"
+#include "../../src/common/deskthang_constants.h"
+#include "../mocks/mock_time.h"
+#include "../mocks/mock_spi.h"
+#include "../mocks/mock_serial.h"
+#include "../mocks/mock_state.h"
+#include "transfer_test_util.h"
+
+// Window setup a full-screen transfer emits once: CASET 0..239, RASET 0..239, MEM_WR
+static const uint8_t window_bytes[] = {
+    GC9A01_COL_ADDR_SET, 0x00, 0x00, 0x00, DISPLAY_WIDTH - 1,
+    GC9A01_ROW_ADDR_SET, 0x00, 0x00, 0x00, DISPLAY_HEIGHT - 1,
+    GC9A01_MEM_WR
+};
+
+static uint8_t frame[TRANSFER_MAX_SIZE];
+static uint8_t sequence;
+
+// Device output captured from mock serial, handed out one v2 frame at a time
+static uint8_t written[1024];
+static uint16_t written_length;
+static uint16_t written_offset;
+
+// Feed one packet to the protocol layer as main would
+static bool receive(PacketType type, const uint8_t *payload, uint16_t length) {
+    Packet packet;
+    TEST_ASSERT_TRUE(packet_create(&packet, type, ++sequence, payload, length));
+    bool processed = protocol_process_packet(&packet);
+    packet_free(&packet);
+    return processed;
+}
+
+// Next packet the device sent; false once there are none left
+static bool next_reply(Packet *reply) {
+    if (written_offset >= written_length) {
+        mock_serial_get_written_data(written, &written_length);
+        mock_serial_reset();
+        written_offset = 0;
+    }
+
+    for (uint16_t end = written_offset; end < written_length; end++) {
+        if (written[end] == 0x00) {
+            uint16_t start = written_offset;
+            written_offset = end + 1;
+            return packet_decode_v2(&written[start], end - start, reply);
+        }
+    }
+    return false;
+}
+
+static PacketType reply_type(void) {
+    Packet reply;
+    TEST_ASSERT_TRUE(next_reply(&reply));
+    PacketType type = reply.header.type;
+    packet_free(&reply);
+    return type;
+}
+
+static bool command(const uint8_t *payload, uint16_t length) {
+    return receive(PACKET_TYPE_COMMAND, payload, length);
+}
+
+// DATA chunks carry no protocol sequence; the chunk index orders them
+static bool send_chunk(const uint8_t *stream, uint32_t length, uint16_t index) {
+    Packet packet;
+    transfer_test_make_chunk(&packet, stream, length, index);
+    return protocol_process_packet(&packet);
+}
+
+// Every chunk is answered with the cumulative ACK that covers it
+static void expect_window_ack(uint16_t next_chunk) {
+    Packet reply;
+    TEST_ASSERT_TRUE(next_reply(&reply));
+    TEST_ASSERT_EQUAL(PACKET_TYPE_ACK, reply.header.type);
+    TEST_ASSERT_EQUAL(6, reply.header.length);
+    TEST_ASSERT_EQUAL(next_chunk, reply.payload[0] | (reply.payload[1] << 8));
+    packet_free(&reply);
+}
+
+// Start command carrying the u32 LE stream size the sized modes take
+static bool start_sized(uint8_t command_byte, uint32_t size) {
+    const uint8_t start[] = {command_byte, size & 0xFF, (size >> 8) & 0xFF, (size >> 16) & 0xFF, size >> 24};
+    return command(start, sizeof(start));
+}
+
+// Stream a transfer already started by a command, then end it with 'E'
+static void stream_and_end(const uint8_t *stream, uint32_t length) {
+    TEST_ASSERT_EQUAL(PACKET_TYPE_ACK, reply_type());
+    TEST_ASSERT_EQUAL(STATE_DATA_TRANSFER, state_machine_get_current());
+
+    uint16_t chunks = transfer_test_chunk_count(length);
+    for (uint16_t index = 0; index < chunks; index++) {
+        TEST_ASSERT_TRUE(send_chunk(stream, length, index));
+        expect_window_ack(index + 1);
+    }
+
+    const uint8_t end[] = {CMD_IMAGE_END};
+    TEST_ASSERT_TRUE(command(end, sizeof(end)));
+    TEST_ASSERT_EQUAL(PACKET_TYPE_ACK, reply_type());
+    TEST_ASSERT_EQUAL(STATE_READY, state_machine_get_current());
+}
+
+void setUp(void) {
+    static const ProtocolConfig config = {0};
+
+    mock_time_set(1000);
+    mock_spi_reset();
+    mock_serial_reset();
+    mock_state_set(STATE_IDLE);
+    GC9A01_window_invalidate();  // Fresh panel: no window cached
+    packet_set_framing(PACKET_FRAMING_V1);
+    protocol_init(&config);
+    command_init();
+    transfer_init();
+    sequence = 0;
+    written_length = 0;
+    written_offset = 0;
+
+    for (uint32_t i = 0; i < sizeof(frame); i++) {
+        frame[i] = (uint8_t)(i * 7 + (i >> 8));
+    }
+
+    // Sync the way the host does, asking for v2 so replies can be decoded
+    const uint8_t sync[] = {PROTOCOL_VERSION, PACKET_FRAMING_V2};
+    TEST_ASSERT_TRUE(receive(PACKET_TYPE_SYNC, sync, sizeof(sync)));
+    mock_serial_reset();  // The SYNC ACK still goes out in v1
+}
+
+void tearDown(void) {
+    transfer_reset();
+}
+
+void test_sync_makes_device_ready(void) {
+    TEST_ASSERT_EQUAL(STATE_READY, state_machine_get_current());
+    TEST_ASSERT_EQUAL(PACKET_FRAMING_V2, packet_get_framing());
+}
+
+void test_command_before_sync_is_nacked(void) {
+    static const ProtocolConfig config = {0};
+    protocol_init(&config);
+    mock_state_set(STATE_IDLE);
+    sequence = 0;
+
+    const uint8_t ping[] = {CMD_PING};
+    TEST_ASSERT_FALSE(command(ping, sizeof(ping)));
+    TEST_ASSERT_EQUAL(PACKET_TYPE_NACK, reply_type());
+}
+
+void test_image_command_streams_data_to_spi(void) {
+    const uint8_t start[] = {CMD_IMAGE_START};
+    TEST_ASSERT_TRUE(command(start, sizeof(start)));
+    stream_and_end(frame, sizeof(frame));
+
+    const uint8_t *spi = mock_spi_get_written_data();
+    TEST_ASSERT_EQUAL(sizeof(window_bytes) + sizeof(frame), mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_MEMORY(window_bytes, spi, sizeof(window_bytes));
+    TEST_ASSERT_EQUAL_MEMORY(frame, spi + sizeof(window_bytes), sizeof(frame));
+}
+
+void test_region_command_streams_rectangle_to_spi(void) {
+    // One 4x3 rectangle at (10, 20): header, then its pixels
+    uint8_t stream[TRANSFER_REGION_HEADER_SIZE + 4 * 3 * 2] = {10, 0, 20, 0, 4, 0, 3, 0};
+    memcpy(stream + TRANSFER_REGION_HEADER_SIZE, frame, sizeof(stream) - TRANSFER_REGION_HEADER_SIZE);
+
+    TEST_ASSERT_TRUE(start_sized(CMD_REGION_START, sizeof(stream)));
+    stream_and_end(stream, sizeof(stream));
+
+    const uint8_t window[] = {
+        GC9A01_COL_ADDR_SET, 0x00, 10, 0x00, 13,
+        GC9A01_ROW_ADDR_SET, 0x00, 20, 0x00, 22,
+        GC9A01_MEM_WR
+    };
+    const uint8_t *spi = mock_spi_get_written_data();
+    TEST_ASSERT_EQUAL(sizeof(window) + 4 * 3 * 2, mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_MEMORY(window, spi, sizeof(window));
+    TEST_ASSERT_EQUAL_MEMORY(frame, spi + sizeof(window), 4 * 3 * 2);
+}
+
+void test_delta_command_writes_changed_run_to_spi(void) {
+    // Skip 10 rows, copy 300 pixels, skip the rest of the frame
+    const uint32_t rest = DISPLAY_WIDTH * DISPLAY_HEIGHT - 10 * DISPLAY_WIDTH - 300;
+    const uint16_t ops[] = {10 * DISPLAY_WIDTH, DELTA_OP_COPY | 300, DELTA_MAX_RUN, rest - DELTA_MAX_RUN};
+    uint8_t stream[sizeof(ops) + 300 * DELTA_PIXEL_SIZE];
+    uint32_t length = 0;
+    for (size_t i = 0; i < sizeof(ops) / sizeof(ops[0]); i++) {
+        stream[length++] = ops[i] & 0xFF;
+        stream[length++] = ops[i] >> 8;
+        if (i == 1) {
+            memcpy(stream + length, frame, 300 * DELTA_PIXEL_SIZE);
+            length += 300 * DELTA_PIXEL_SIZE;
+        }
+    }
+
+    TEST_ASSERT_TRUE(start_sized(CMD_DELTA_START, length));
+    stream_and_end(stream, length);
+
+    const uint8_t window[] = {
+        GC9A01_COL_ADDR_SET, 0x00, 0x00, 0x00, DISPLAY_WIDTH - 1,
+        GC9A01_ROW_ADDR_SET, 0x00, 10, 0x00, DISPLAY_HEIGHT - 1,
+        GC9A01_MEM_WR
+    };
+    const uint8_t *spi = mock_spi_get_written_data();
+    TEST_ASSERT_EQUAL(sizeof(window) + 300 * DELTA_PIXEL_SIZE, mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_MEMORY(window, spi, sizeof(window));
+    TEST_ASSERT_EQUAL_MEMORY(frame, spi + sizeof(window), 300 * DELTA_PIXEL_SIZE);
+}
+
+void test_qoi_command_decodes_frame_to_spi(void) {
+    static uint8_t stream[QOI_MAX_ENCODED_SIZE(DISPLAY_WIDTH * DISPLAY_HEIGHT)];
+
+    // One shade per row, so the frame compresses to runs
+    for (uint32_t i = 0; i < DISPLAY_WIDTH * DISPLAY_HEIGHT; i++) {
+        uint16_t value = (uint16_t)((i / DISPLAY_WIDTH) * 0x0821);
+        frame[2 * i] = value & 0xFF;
+        frame[2 * i + 1] = value >> 8;
+    }
+    uint32_t length = qoi_encode(frame, DISPLAY_WIDTH * DISPLAY_HEIGHT, stream, sizeof(stream));
+    TEST_ASSERT_TRUE(length > 0 && length < TRANSFER_QOI_MAX_SIZE);
+
+    TEST_ASSERT_TRUE(start_sized(CMD_QOI_START, length));
+    stream_and_end(stream, length);
+
+    const uint8_t *spi = mock_spi_get_written_data();
+    TEST_ASSERT_EQUAL(sizeof(window_bytes) + sizeof(frame), mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_MEMORY(window_bytes, spi, sizeof(window_bytes));
+    TEST_ASSERT_EQUAL_MEMORY(frame, spi + sizeof(window_bytes), sizeof(frame));
+}
+
+void test_bc1_command_expands_blocks_to_spi(void) {
+    static uint8_t stream[TRANSFER_BC1_SIZE];
+
+    // Every block solid color0 (0x1234, indices all 0)
+    for (uint32_t n = 0; n < TRANSFER_BC1_SIZE; n += BC1_BLOCK_SIZE) {
+        const uint8_t block[BC1_BLOCK_SIZE] = {0x34, 0x12};
+        memcpy(stream + n, block, sizeof(block));
+    }
+
+    // Fixed size, so the start command takes no arguments
+    const uint8_t start[] = {CMD_BC1_START};
+    TEST_ASSERT_TRUE(command(start, sizeof(start)));
+    stream_and_end(stream, sizeof(stream));
+
+    const uint8_t *spi = mock_spi_get_written_data();
+    TEST_ASSERT_EQUAL(sizeof(window_bytes) + TRANSFER_MAX_SIZE, mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_MEMORY(window_bytes, spi, sizeof(window_bytes));
+    for (uint32_t i = sizeof(window_bytes); i < mock_spi_get_written_length(); i += BC1_PIXEL_SIZE) {
+        TEST_ASSERT_EQUAL_HEX8(0x34, spi[i]);
+        TEST_ASSERT_EQUAL_HEX8(0x12, spi[i + 1]);
+    }
+}
+
+// Full frame where row y shows palette entry y % 4
+static void expect_indexed_frame(const uint16_t *colors, size_t setup_bytes) {
+    const uint8_t *spi = mock_spi_get_written_data();
+    TEST_ASSERT_EQUAL(setup_bytes + TRANSFER_MAX_SIZE, mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_MEMORY(window_bytes + sizeof(window_bytes) - setup_bytes, spi, setup_bytes);
+
+    spi += setup_bytes;
+    for (uint32_t pixel = 0; pixel < DISPLAY_WIDTH * DISPLAY_HEIGHT; pixel += 97) {
+        uint16_t expected = colors[(pixel / DISPLAY_WIDTH) % 4];
+        TEST_ASSERT_EQUAL_HEX16(expected, spi[2 * pixel] | (spi[2 * pixel + 1] << 8));
+    }
+}
+
+void test_indexed_command_and_palette_update_reach_spi(void) {
+    static uint8_t stream[PALETTE_STREAM_SIZE(DISPLAY_WIDTH * DISPLAY_HEIGHT, 2, 4)];
+    uint16_t colors[4] = {0x0001, 0x07E0, 0x001F, 0xFFFF};
+
+    // 2 bits per pixel, 4 colours, then a row's four indices per byte
+    uint32_t length = 0;
+    stream[length++] = 2;
+    stream[length++] = 4 - 1;
+    for (int i = 0; i < 4; i++) {
+        stream[length++] = colors[i] & 0xFF;
+        stream[length++] = colors[i] >> 8;
+    }
+    for (uint32_t pixel = 0; pixel < DISPLAY_WIDTH * DISPLAY_HEIGHT; pixel += 4) {
+        stream[length++] = ((pixel / DISPLAY_WIDTH) % 4) * 0x55;
+    }
+    TEST_ASSERT_EQUAL(sizeof(stream), length);
+
+    TEST_ASSERT_TRUE(start_sized(CMD_INDEXED_START, length));
+    stream_and_end(stream, length);
+    expect_indexed_frame(colors, sizeof(window_bytes));
+
+    // 'L' swaps entry 1 and redraws from the resident indices
+    mock_spi_reset();
+    colors[1] = 0xF800;
+    const uint8_t update[] = {CMD_PALETTE_UPDATE, 1, 1 - 1, 0x00, 0xF8};
+    TEST_ASSERT_TRUE(command(update, sizeof(update)));
+    TEST_ASSERT_EQUAL(PACKET_TYPE_ACK, reply_type());
+    expect_indexed_frame(colors, 1);  // Window still cached: MEM_WR only
+}
+
+void test_round_command_writes_visible_spans_to_spi(void) {
+    // Fixed size, so the start command takes no arguments
+    const uint8_t start[] = {CMD_ROUND_START};
+    TEST_ASSERT_TRUE(command(start, sizeof(start)));
+    stream_and_end(frame, TRANSFER_ROUND_SIZE);
+
+    // A window per band, then that band's visible pixels
+    uint16_t bands = 0;
+    for (uint16_t y = 0; y < DISPLAY_HEIGHT; y += panel_span_band_height(y)) {
+        bands++;
+    }
+    TEST_ASSERT_EQUAL(bands * sizeof(window_bytes) + PANEL_SPAN_SIZE, mock_spi_get_written_length());
+
+    // First band: row 0 alone, centred
+    uint16_t end = panel_span_start(0) + panel_span_width(0) - 1;
+    const uint8_t window[] = {
+        GC9A01_COL_ADDR_SET, 0x00, panel_span_start(0), 0x00, end,
+        GC9A01_ROW_ADDR_SET, 0x00, 0x00, 0x00, 0x00,
+        GC9A01_MEM_WR
+    };
+    const uint8_t *spi = mock_spi_get_written_data();
+    TEST_ASSERT_EQUAL_MEMORY(window, spi, sizeof(window));
+    TEST_ASSERT_EQUAL_MEMORY(frame, spi + sizeof(window), panel_span_width(0) * 2);
+}
+
+void test_malformed_chunk_is_dropped_and_reacked(void) {
+    const uint8_t start[] = {CMD_IMAGE_START};
+    TEST_ASSERT_TRUE(command(start, sizeof(start)));
+    TEST_ASSERT_EQUAL(PACKET_TYPE_ACK, reply_type());
+
+    TEST_ASSERT_TRUE(send_chunk(frame, sizeof(frame), 0));
+    expect_window_ack(1);
+
+    // Chunk 1 cut short: dropped, and the ACK still asks for chunk 1
+    TEST_ASSERT_TRUE(send_chunk(frame, CHUNK_SIZE + 10, 1));
+    expect_window_ack(1);
+    TEST_ASSERT_EQUAL(STATE_DATA_TRANSFER, state_machine_get_current());
+    TEST_ASSERT_EQUAL(1, transfer_get_status()->errors);
+
+    TEST_ASSERT_TRUE(send_chunk(frame, sizeof(frame), 1));
+    expect_window_ack(2);
+}
+
+void test_pattern_mid_transfer_aborts_it(void) {
+    const uint8_t start[] = {CMD_IMAGE_START};
+    TEST_ASSERT_TRUE(command(start, sizeof(start)));
+    TEST_ASSERT_EQUAL(PACKET_TYPE_ACK, reply_type());
+    TEST_ASSERT_TRUE(send_chunk(frame, sizeof(frame), 0));
+    expect_window_ack(1);
+
+    const uint8_t pattern[] = {CMD_PATTERN_CHECKER};
+    TEST_ASSERT_TRUE(command(pattern, sizeof(pattern)));
+    TEST_ASSERT_EQUAL(PACKET_TYPE_ACK, reply_type());
+    TEST_ASSERT_EQUAL(STATE_READY, state_machine_get_current());
+    TEST_ASSERT_EQUAL(TRANSFER_STATE_IDLE, transfer_get_context()->state);
+
+    // A fresh transfer opens its own window over the pattern
+    mock_spi_reset();
+    TEST_ASSERT_TRUE(command(start, sizeof(start)));
+    stream_and_end(frame, sizeof(frame));
+    const uint8_t *spi = mock_spi_get_written_data();
+    TEST_ASSERT_EQUAL(sizeof(window_bytes) + sizeof(frame), mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_MEMORY(window_bytes, spi, sizeof(window_bytes));
+    TEST_ASSERT_EQUAL_MEMORY(frame, spi + sizeof(window_bytes), sizeof(frame));
+}
+
+void test_unknown_command_is_nacked_and_link_stays_up(void) {
+    const uint8_t unknown[] = {'Z'};
+    TEST_ASSERT_TRUE(command(unknown, sizeof(unknown)));
+    TEST_ASSERT_EQUAL(PACKET_TYPE_NACK, reply_type());
+    TEST_ASSERT_EQUAL(STATE_READY, state_machine_get_current());
+
+    // The next command in sequence still goes through
+    const uint8_t ping[] = {CMD_PING};
+    TEST_ASSERT_TRUE(command(ping, sizeof(ping)));
+    TEST_ASSERT_EQUAL(PACKET_TYPE_ACK, reply_type());
+}
+
+void test_end_after_short_stream_is_nacked_and_ready(void) {
+    const uint8_t start[] = {CMD_IMAGE_START};
+    TEST_ASSERT_TRUE(command(start, sizeof(start)));
+    TEST_ASSERT_EQUAL(PACKET_TYPE_ACK, reply_type());
+    TEST_ASSERT_TRUE(send_chunk(frame, sizeof(frame), 0));
+    expect_window_ack(1);
+
+    const uint8_t end[] = {CMD_IMAGE_END};
+    TEST_ASSERT_TRUE(command(end, sizeof(end)));
+    TEST_ASSERT_EQUAL(PACKET_TYPE_NACK, reply_type());
+    TEST_ASSERT_EQUAL(STATE_READY, state_machine_get_current());
+    TEST_ASSERT_EQUAL(TRANSFER_STATE_IDLE, transfer_get_context()->state);
+}
+
+void test_end_without_transfer_is_nacked(void) {
+    const uint8_t end[] = {CMD_IMAGE_END};
+    TEST_ASSERT_TRUE(command(end, sizeof(end)));
+    TEST_ASSERT_EQUAL(PACKET_TYPE_NACK, reply_type());
+    TEST_ASSERT_EQUAL(STATE_READY, state_machine_get_current());
+}
+
+static uint32_t get_u32(const uint8_t *in) {
+    return in[0] | (in[1] << 8) | (in[2] << 16) | ((uint32_t)in[3] << 24);
+}
+
+void test_stats_command_sends_stats_packet(void) {
+    stats_reset();
+    const uint8_t ping[] = {CMD_PING};
+    TEST_ASSERT_TRUE(command(ping, sizeof(ping)));
+    TEST_ASSERT_EQUAL(PACKET_TYPE_ACK, reply_type());
+
+    const uint8_t query[] = {CMD_STATS};
+    TEST_ASSERT_TRUE(command(query, sizeof(query)));
+
+    // The STATS packet goes out ahead of the command's ACK
+    Packet reply;
+    TEST_ASSERT_TRUE(next_reply(&reply));
+    TEST_ASSERT_EQUAL(PACKET_TYPE_STATS, reply.header.type);
+    TEST_ASSERT_EQUAL(STATS_PAYLOAD_SIZE, reply.header.length);
+    TEST_ASSERT_EQUAL(STATS_LATENCY_COUNT, reply.payload[4]);
+    TEST_ASSERT_EQUAL(STATS_BUCKETS, reply.payload[5]);
+    TEST_ASSERT_EQUAL_UINT32(1, get_u32(&reply.payload[STATS_HEADER_SIZE + 16]));  // tx_packets: the PING ACK
+    packet_free(&reply);
+    TEST_ASSERT_EQUAL(PACKET_TYPE_ACK, reply_type());
+}
+
+void test_trace_command_dumps_both_cores(void) {
+    trace_reset();  // Keep the dump inside the mock serial buffer
+    const uint8_t query[] = {CMD_TRACE_DUMP};
+    TEST_ASSERT_TRUE(command(query, sizeof(query)));
+
+    // Core0's ring, then core1's closing the dump, then the command's ACK
+    for (uint8_t core = 0; core < TRACE_CORES; core++) {
+        Packet reply;
+        TEST_ASSERT_TRUE(next_reply(&reply));
+        TEST_ASSERT_EQUAL(PACKET_TYPE_TRACE, reply.header.type);
+        TEST_ASSERT_TRUE(reply.header.length >= TRACE_DUMP_HEADER_SIZE);
+        uint16_t count = reply.payload[10] | (reply.payload[11] << 8);
+        TEST_ASSERT_EQUAL(TRACE_DUMP_HEADER_SIZE + count * TRACE_RECORD_SIZE, reply.header.length);
+        TEST_ASSERT_EQUAL(core, reply.payload[8]);
+        TEST_ASSERT_EQUAL(core == TRACE_CORES - 1 ? TRACE_DUMP_FLAG_LAST : 0, reply.payload[9]);
+        packet_free(&reply);
+    }
+    TEST_ASSERT_EQUAL(PACKET_TYPE_ACK, reply_type());
+}
+
+void test_boot_timeline_command_sends_debug_packet(void) {
+    boot_reset();
+    mock_time_set(2);
+    boot_mark(BOOT_PHASE_STDIO);
+    mock_time_set(150);
+    boot_mark(BOOT_PHASE_READY);
+
+    const uint8_t query[] = {CMD_BOOT_TIMELINE};
+    TEST_ASSERT_TRUE(command(query, sizeof(query)));
+
+    Packet reply;
+    TEST_ASSERT_TRUE(next_reply(&reply));
+    TEST_ASSERT_EQUAL(PACKET_TYPE_DEBUG, reply.header.type);
+    const char expected[] = "  Boot: stdio=2000 ready=150000";
+    TEST_ASSERT_EQUAL(sizeof(expected) - 1, reply.header.length);
+    TEST_ASSERT_EQUAL_MEMORY(expected, reply.payload, sizeof(expected) - 1);
+    packet_free(&reply);
+    TEST_ASSERT_EQUAL(PACKET_TYPE_ACK, reply_type());
+}
+
+void test_help_command_sends_whole_help(void) {
+    const uint8_t query[] = {CMD_HELP};
+    TEST_ASSERT_TRUE(command(query, sizeof(query)));
+
+    Packet reply;
+    TEST_ASSERT_TRUE(next_reply(&reply));
+    TEST_ASSERT_EQUAL(PACKET_TYPE_DEBUG, reply.header.type);
+    const char prefix[] = "  Help: ";
+    const char last[] = "H help";
+    TEST_ASSERT_EQUAL_MEMORY(prefix, reply.payload, sizeof(prefix) - 1);
+    TEST_ASSERT_EQUAL_MEMORY(last, reply.payload + reply.header.length - (sizeof(last) - 1), sizeof(last) - 1);
+    packet_free(&reply);
+    TEST_ASSERT_EQUAL(PACKET_TYPE_ACK, reply_type());
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    // Link setup
+    RUN_TEST(test_sync_makes_device_ready);
+    RUN_TEST(test_command_before_sync_is_nacked);
+
+    // Commands
+    RUN_TEST(test_image_command_streams_data_to_spi);
+    RUN_TEST(test_region_command_streams_rectangle_to_spi);
+    RUN_TEST(test_delta_command_writes_changed_run_to_spi);
+    RUN_TEST(test_qoi_command_decodes_frame_to_spi);
+    RUN_TEST(test_bc1_command_expands_blocks_to_spi);
+    RUN_TEST(test_indexed_command_and_palette_update_reach_spi);
+    RUN_TEST(test_round_command_writes_visible_spans_to_spi);
+    RUN_TEST(test_malformed_chunk_is_dropped_and_reacked);
+    RUN_TEST(test_pattern_mid_transfer_aborts_it);
+    RUN_TEST(test_unknown_command_is_nacked_and_link_stays_up);
+    RUN_TEST(test_end_after_short_stream_is_nacked_and_ready);
+    RUN_TEST(test_end_without_transfer_is_nacked);
+
+    // Queries
+    RUN_TEST(test_stats_command_sends_stats_packet);
+    RUN_TEST(test_trace_command_dumps_both_cores);
+    RUN_TEST(test_boot_timeline_command_sends_debug_packet);
+    RUN_TEST(test_help_command_sends_whole_help);
+
+    return UNITY_END();
+}
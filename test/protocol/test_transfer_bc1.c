@@ -0,0 +1,183 @@
+#include <unity.h>
+#include <string.h>
+#include "../../src/protocol/transfer.h"
+#include "../../src/protocol/packet.h"
+#include "../../src/codec/bc1.h"
+#include "../../src/hardware/GC9A01.h"
+#include "../../src/common/deskthang_constants.h"
+#include "../mocks/mock_time.h"
+#include "../mocks/mock_spi.h"
+#include "transfer_test_util.h"
+
+// CASET + RASET + MEM_WR emitted when a window opens
+#define WINDOW_SETUP_BYTES 11
+#define BLOCKS_PER_ROW (DISPLAY_WIDTH / BC1_BLOCK_DIM)
+#define ROW_BYTES (BC1_BLOCK_DIM * DISPLAY_WIDTH * BC1_PIXEL_SIZE)
+
+static uint8_t stream[TRANSFER_BC1_SIZE];
+
+// Decoder output collected by the test sink
+static uint8_t decoded[TRANSFER_MAX_SIZE];
+static uint32_t decoded_length;
+static uint32_t sink_writes;
+
+static bool collect(const uint8_t *data, uint32_t length, void *context) {
+    memcpy(decoded + decoded_length, data, length);
+    decoded_length += length;
+    sink_writes++;
+    return true;
+}
+
+static const Bc1Sink collect_sink = {.write = collect, .context = NULL};
+
+static void make_block(uint8_t *block, uint16_t color0, uint16_t color1, uint32_t indices) {
+    block[0] = color0 & 0xFF;
+    block[1] = color0 >> 8;
+    block[2] = color1 & 0xFF;
+    block[3] = color1 >> 8;
+    block[4] = indices & 0xFF;
+    block[5] = (indices >> 8) & 0xFF;
+    block[6] = (indices >> 16) & 0xFF;
+    block[7] = indices >> 24;
+}
+
+// Block n is a solid colour n, so every block's placement can be checked
+static void fill_numbered_blocks(void) {
+    for (uint32_t n = 0; n < TRANSFER_BC1_SIZE / BC1_BLOCK_SIZE; n++) {
+        make_block(stream + n * BC1_BLOCK_SIZE, (uint16_t)(n + 1), 0, 0);
+    }
+}
+
+static uint16_t pixel_at(const uint8_t *pixels, uint16_t x, uint16_t y) {
+    uint32_t offset = ((uint32_t)y * DISPLAY_WIDTH + x) * BC1_PIXEL_SIZE;
+    return pixels[offset] | (pixels[offset + 1] << 8);
+}
+
+void setUp(void) {
+    mock_time_set(1000);
+    mock_spi_reset();
+    GC9A01_window_invalidate();  // Fresh panel: no window cached
+    transfer_init();
+    decoded_length = 0;
+    sink_writes = 0;
+}
+
+void tearDown(void) {
+    transfer_reset();
+}
+
+void test_four_colour_block(void) {
+    uint8_t block[BC1_BLOCK_SIZE];
+    uint16_t pixels[16];
+    // White to black; pixel i takes index i % 4
+    make_block(block, 0xFFFF, 0x0000, 0xE4E4E4E4);
+    bc1_decode_block(block, pixels);
+
+    TEST_ASSERT_EQUAL_HEX16(0xFFFF, pixels[0]);
+    TEST_ASSERT_EQUAL_HEX16(0x0000, pixels[1]);
+    TEST_ASSERT_EQUAL_HEX16((21 << 11) | (42 << 5) | 21, pixels[2]);  // Two thirds white
+    TEST_ASSERT_EQUAL_HEX16((10 << 11) | (21 << 5) | 10, pixels[3]);  // One third white
+    TEST_ASSERT_EQUAL_HEX16(pixels[3], pixels[15]);
+}
+
+void test_three_colour_block_has_black(void) {
+    uint8_t block[BC1_BLOCK_SIZE];
+    uint16_t pixels[16];
+    // color0 <= color1 selects midpoint + black
+    make_block(block, 0x0010, 0x0018, 0xE4E4E4E4);
+    bc1_decode_block(block, pixels);
+
+    TEST_ASSERT_EQUAL_HEX16(0x0010, pixels[0]);
+    TEST_ASSERT_EQUAL_HEX16(0x0018, pixels[1]);
+    TEST_ASSERT_EQUAL_HEX16(0x0014, pixels[2]);
+    TEST_ASSERT_EQUAL_HEX16(0x0000, pixels[3]);
+}
+
+void test_rows_go_out_whole(void) {
+    fill_numbered_blocks();
+    Bc1Decoder decoder;
+    TEST_ASSERT_TRUE(bc1_decoder_init(&decoder, DISPLAY_WIDTH, DISPLAY_HEIGHT, &collect_sink));
+
+    // One block short of a row: nothing written yet
+    TEST_ASSERT_TRUE(bc1_decoder_feed(&decoder, stream, (BLOCKS_PER_ROW - 1) * BC1_BLOCK_SIZE));
+    TEST_ASSERT_EQUAL(0, sink_writes);
+
+    TEST_ASSERT_TRUE(bc1_decoder_feed(&decoder, stream + (BLOCKS_PER_ROW - 1) * BC1_BLOCK_SIZE,
+                                      BC1_BLOCK_SIZE));
+    TEST_ASSERT_EQUAL(1, sink_writes);
+    TEST_ASSERT_EQUAL(ROW_BYTES, decoded_length);
+    TEST_ASSERT_EQUAL_HEX16(1, pixel_at(decoded, 0, 3));
+    TEST_ASSERT_EQUAL_HEX16(BLOCKS_PER_ROW, pixel_at(decoded, DISPLAY_WIDTH - 1, 0));
+}
+
+void test_blocks_split_across_feeds(void) {
+    fill_numbered_blocks();
+    Bc1Decoder decoder;
+    TEST_ASSERT_TRUE(bc1_decoder_init(&decoder, DISPLAY_WIDTH, DISPLAY_HEIGHT, &collect_sink));
+
+    // Odd-sized feeds split nearly every block
+    uint32_t offset = 0;
+    while (offset < TRANSFER_BC1_SIZE) {
+        uint32_t take = TRANSFER_BC1_SIZE - offset < 13 ? TRANSFER_BC1_SIZE - offset : 13;
+        TEST_ASSERT_TRUE(bc1_decoder_feed(&decoder, stream + offset, take));
+        offset += take;
+    }
+    TEST_ASSERT_TRUE(bc1_decoder_complete(&decoder));
+    TEST_ASSERT_EQUAL(DISPLAY_HEIGHT / BC1_BLOCK_DIM, sink_writes);
+    TEST_ASSERT_EQUAL_HEX16(BLOCKS_PER_ROW + 2, pixel_at(decoded, 5, 6));
+}
+
+void test_bad_dimensions_rejected(void) {
+    Bc1Decoder decoder;
+    TEST_ASSERT_FALSE(bc1_decoder_init(&decoder, 238, 240, NULL));
+    TEST_ASSERT_FALSE(bc1_decoder_init(&decoder, BC1_MAX_WIDTH + 4, 240, NULL));
+}
+
+void test_transfer_is_fixed_size(void) {
+    TEST_ASSERT_EQUAL(BC1_ENCODED_SIZE(DISPLAY_WIDTH, DISPLAY_HEIGHT), TRANSFER_BC1_SIZE);
+    TEST_ASSERT_FALSE(transfer_start(TRANSFER_MODE_BC1, TRANSFER_BC1_SIZE + 8));
+}
+
+void test_transfer_expands_into_full_window(void) {
+    fill_numbered_blocks();
+
+    TEST_ASSERT_TRUE(transfer_start(TRANSFER_MODE_BC1, TRANSFER_BC1_SIZE));
+    for (uint16_t index = 0; index < TRANSFER_BC1_SIZE / CHUNK_SIZE + 1; index++) {
+        TEST_ASSERT_TRUE(transfer_test_send_chunk(stream, TRANSFER_BC1_SIZE, index));
+    }
+    TEST_ASSERT_TRUE(transfer_complete());
+
+    const uint8_t setup[] = {
+        GC9A01_COL_ADDR_SET, 0, 0, 0, DISPLAY_WIDTH - 1,
+        GC9A01_ROW_ADDR_SET, 0, 0, 0, DISPLAY_HEIGHT - 1,
+        GC9A01_MEM_WR
+    };
+    const uint8_t *spi = mock_spi_get_written_data();
+    TEST_ASSERT_EQUAL(WINDOW_SETUP_BYTES + TRANSFER_MAX_SIZE, mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_MEMORY(setup, spi, sizeof(setup));
+
+    spi += WINDOW_SETUP_BYTES;
+    for (uint16_t y = 0; y < DISPLAY_HEIGHT; y += 7) {
+        for (uint16_t x = 0; x < DISPLAY_WIDTH; x += 5) {
+            uint16_t block = (y / BC1_BLOCK_DIM) * BLOCKS_PER_ROW + x / BC1_BLOCK_DIM;
+            TEST_ASSERT_EQUAL_HEX16(block + 1, pixel_at(spi, x, y));
+        }
+    }
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    // Codec
+    RUN_TEST(test_four_colour_block);
+    RUN_TEST(test_three_colour_block_has_black);
+    RUN_TEST(test_rows_go_out_whole);
+    RUN_TEST(test_blocks_split_across_feeds);
+    RUN_TEST(test_bad_dimensions_rejected);
+
+    // Transfer
+    RUN_TEST(test_transfer_is_fixed_size);
+    RUN_TEST(test_transfer_expands_into_full_window);
+
+    return UNITY_END();
+}
@@ -0,0 +1,194 @@
+#include <unity.h>
+#include <string.h>
+#include "../../src/protocol/transfer.h"
+#include "../../src/protocol/packet.h"
+#include "../../src/codec/delta.h"
+#include "../../src/hardware/GC9A01.h"
+#include "../../src/common/deskthang_constants.h"
+#include "../mocks/mock_time.h"
+#include "../mocks/mock_spi.h"
+#include "transfer_test_util.h"
+
+// CASET + RASET + MEM_WR emitted when a window opens
+#define WINDOW_SETUP_BYTES 11
+#define FRAME_PIXELS (DISPLAY_WIDTH * DISPLAY_HEIGHT)
+
+static uint8_t stream[TRANSFER_DELTA_MAX_SIZE];
+static uint32_t stream_length;
+static uint32_t stream_pixels;  // Frame position the stream has reached
+
+static void put_op(uint16_t op) {
+    stream[stream_length++] = op & 0xFF;
+    stream[stream_length++] = op >> 8;
+}
+
+static void add_skip(uint32_t pixels) {
+    while (pixels > 0) {
+        uint16_t run = pixels > DELTA_MAX_RUN ? DELTA_MAX_RUN : pixels;
+        put_op(run);
+        pixels -= run;
+        stream_pixels += run;
+    }
+}
+
+// Copied pixels carry their frame position so the panel output can be checked
+static void add_copy(uint16_t pixels) {
+    put_op(DELTA_OP_COPY | pixels);
+    for (uint16_t i = 0; i < pixels; i++) {
+        uint16_t value = (uint16_t)(stream_pixels + i);
+        stream[stream_length++] = value >> 8;
+        stream[stream_length++] = value & 0xFF;
+    }
+    stream_pixels += pixels;
+}
+
+static void skip_to_end(void) {
+    add_skip(FRAME_PIXELS - stream_pixels);
+}
+
+// Check a window setup and the pixels written into it
+static const uint8_t *expect_window(const uint8_t *spi, uint16_t x, uint16_t y,
+                                    uint16_t width, uint16_t height, uint32_t first_pixel,
+                                    uint32_t pixels) {
+    uint16_t x_end = x + width - 1;
+    uint16_t y_end = y + height - 1;
+    const uint8_t setup[] = {
+        GC9A01_COL_ADDR_SET, x >> 8, x & 0xFF, x_end >> 8, x_end & 0xFF,
+        GC9A01_ROW_ADDR_SET, y >> 8, y & 0xFF, y_end >> 8, y_end & 0xFF,
+        GC9A01_MEM_WR
+    };
+    TEST_ASSERT_EQUAL_MEMORY(setup, spi, sizeof(setup));
+    spi += WINDOW_SETUP_BYTES;
+
+    for (uint32_t i = 0; i < pixels; i++) {
+        uint16_t value = (uint16_t)(first_pixel + i);
+        TEST_ASSERT_EQUAL_HEX8(value >> 8, spi[2 * i]);
+        TEST_ASSERT_EQUAL_HEX8(value & 0xFF, spi[2 * i + 1]);
+    }
+    return spi + 2 * pixels;
+}
+
+void setUp(void) {
+    mock_time_set(1000);
+    mock_spi_reset();
+    GC9A01_window_invalidate();  // Fresh panel: no window cached
+    transfer_init();
+    stream_length = 0;
+    stream_pixels = 0;
+}
+
+void tearDown(void) {
+    transfer_reset();
+}
+
+void test_unchanged_frame_writes_nothing(void) {
+    skip_to_end();
+
+    TEST_ASSERT_TRUE(transfer_test_send_all(TRANSFER_MODE_DELTA, stream, stream_length));
+    TEST_ASSERT_EQUAL(4, stream_length);
+    TEST_ASSERT_EQUAL(0, mock_spi_get_written_length());
+}
+
+void test_run_from_row_start_uses_one_window(void) {
+    add_skip(10 * DISPLAY_WIDTH);
+    add_copy(300);
+    skip_to_end();
+
+    TEST_ASSERT_TRUE(transfer_test_send_all(TRANSFER_MODE_DELTA, stream, stream_length));
+    const uint8_t *spi = expect_window(mock_spi_get_written_data(),
+                                       0, 10, DISPLAY_WIDTH, DISPLAY_HEIGHT - 10,
+                                       10 * DISPLAY_WIDTH, 300);
+    TEST_ASSERT_EQUAL(spi - mock_spi_get_written_data(), mock_spi_get_written_length());
+}
+
+void test_run_from_mid_row_finishes_its_row_first(void) {
+    add_skip(5 * DISPLAY_WIDTH + 200);
+    add_copy(100);  // 40 pixels to the row end, 60 on the next row
+    skip_to_end();
+
+    TEST_ASSERT_TRUE(transfer_test_send_all(TRANSFER_MODE_DELTA, stream, stream_length));
+    uint32_t first = 5 * DISPLAY_WIDTH + 200;
+    const uint8_t *spi = expect_window(mock_spi_get_written_data(),
+                                       200, 5, DISPLAY_WIDTH - 200, 1, first, 40);
+    spi = expect_window(spi, 0, 6, DISPLAY_WIDTH, DISPLAY_HEIGHT - 6, first + 40, 60);
+    TEST_ASSERT_EQUAL(spi - mock_spi_get_written_data(), mock_spi_get_written_length());
+}
+
+void test_several_runs_each_land_in_place(void) {
+    add_skip(3);
+    add_copy(2);
+    add_skip(DISPLAY_WIDTH);
+    add_copy(4);
+    skip_to_end();
+
+    TEST_ASSERT_TRUE(transfer_test_send_all(TRANSFER_MODE_DELTA, stream, stream_length));
+    const uint8_t *spi = expect_window(mock_spi_get_written_data(),
+                                       3, 0, DISPLAY_WIDTH - 3, 1, 3, 2);
+    spi = expect_window(spi, 5, 1, DISPLAY_WIDTH - 5, 1, DISPLAY_WIDTH + 5, 4);
+    TEST_ASSERT_EQUAL(spi - mock_spi_get_written_data(), mock_spi_get_written_length());
+}
+
+void test_runs_continue_across_chunks(void) {
+    // The third op starts the second chunk and its pixels span into the third
+    add_copy((CHUNK_SIZE - 2 * DELTA_OP_SIZE) / 2);
+    uint32_t first = stream_pixels;
+    add_skip(1);
+    add_copy(200);
+    skip_to_end();
+
+    TEST_ASSERT_TRUE(transfer_test_send_all(TRANSFER_MODE_DELTA, stream, stream_length));
+    const uint8_t *spi = expect_window(mock_spi_get_written_data(),
+                                       0, 0, DISPLAY_WIDTH, DISPLAY_HEIGHT, 0, first);
+    expect_window(spi, first + 1, 0, DISPLAY_WIDTH - first - 1, 1, first + 1, DISPLAY_WIDTH - first - 1);
+}
+
+void test_run_past_frame_end_fails_transfer(void) {
+    add_skip(FRAME_PIXELS - 10);
+    add_copy(20);
+
+    TEST_ASSERT_TRUE(transfer_start(TRANSFER_MODE_DELTA, stream_length));
+    bool accepted = true;
+    for (uint16_t index = 0; index < transfer_test_chunk_count(stream_length); index++) {
+        accepted = accepted && transfer_test_send_chunk(stream, stream_length, index);
+    }
+    TEST_ASSERT_FALSE(accepted);
+    TEST_ASSERT_EQUAL(TRANSFER_STATE_ERROR, transfer_get_context()->state);
+}
+
+void test_stream_short_of_frame_fails(void) {
+    add_skip(100);
+    add_copy(4);
+
+    TEST_ASSERT_FALSE(transfer_test_send_all(TRANSFER_MODE_DELTA, stream, stream_length));
+}
+
+void test_delta_stream_size_is_bounded(void) {
+    TEST_ASSERT_FALSE(transfer_start(TRANSFER_MODE_DELTA, 1));
+    TEST_ASSERT_FALSE(transfer_start(TRANSFER_MODE_DELTA, TRANSFER_DELTA_MAX_SIZE + 1));
+}
+
+void test_decoder_rejects_zero_length_op(void) {
+    DeltaDecoder decoder;
+    delta_decoder_init(&decoder, TRANSFER_MAX_SIZE, NULL);
+    const uint8_t zero_skip[] = {0x00, 0x00};
+    TEST_ASSERT_FALSE(delta_decoder_feed(&decoder, zero_skip, sizeof(zero_skip)));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    // Window placement
+    RUN_TEST(test_unchanged_frame_writes_nothing);
+    RUN_TEST(test_run_from_row_start_uses_one_window);
+    RUN_TEST(test_run_from_mid_row_finishes_its_row_first);
+    RUN_TEST(test_several_runs_each_land_in_place);
+    RUN_TEST(test_runs_continue_across_chunks);
+
+    // Validation
+    RUN_TEST(test_run_past_frame_end_fails_transfer);
+    RUN_TEST(test_stream_short_of_frame_fails);
+    RUN_TEST(test_delta_stream_size_is_bounded);
+    RUN_TEST(test_decoder_rejects_zero_length_op);
+
+    return UNITY_END();
+}
@@ -0,0 +1,186 @@
+#include <unity.h>
+#include <string.h>
+#include "../../src/protocol/transfer.h"
+#include "../../src/protocol/packet.h"
+#include "../../src/codec/palette.h"
+#include "../../src/hardware/GC9A01.h"
+#include "../../src/common/deskthang_constants.h"
+#include "../mocks/mock_time.h"
+#include "../mocks/mock_spi.h"
+#include "transfer_test_util.h"
+
+// CASET + RASET + MEM_WR emitted when a window opens
+#define WINDOW_SETUP_BYTES 11
+#define FRAME_PIXELS TRANSFER_INDEXED_PIXELS
+
+static uint8_t stream[TRANSFER_INDEXED_MAX_SIZE];
+static uint32_t stream_length;
+static uint16_t palette[PALETTE_MAX_COLORS];
+
+// Index of each pixel: vertical bands, so every scanline is the same
+static uint8_t index_at(uint32_t pixel, uint16_t colors) {
+    return (pixel % DISPLAY_WIDTH) * colors / DISPLAY_WIDTH;
+}
+
+static void build_stream(uint8_t bits, uint16_t colors) {
+    stream_length = 0;
+    stream[stream_length++] = bits;
+    stream[stream_length++] = colors - 1;
+    for (uint16_t i = 0; i < colors; i++) {
+        palette[i] = (uint16_t)(0x1000 + i * 0x0101);
+        stream[stream_length++] = palette[i] & 0xFF;
+        stream[stream_length++] = palette[i] >> 8;
+    }
+
+    uint8_t per_byte = 8 / bits;
+    for (uint32_t pixel = 0; pixel < FRAME_PIXELS; pixel += per_byte) {
+        uint8_t packed = 0;
+        for (uint8_t i = 0; i < per_byte; i++) {
+            packed |= index_at(pixel + i, colors) << (i * bits);
+        }
+        stream[stream_length++] = packed;
+    }
+}
+
+// Full-screen window followed by every pixel through the given palette. A
+// window the panel already holds is just MEM_WR.
+static void expect_frame(const uint16_t *colors, uint16_t count, bool window_cached) {
+    const uint8_t setup[] = {
+        GC9A01_COL_ADDR_SET, 0, 0, 0, DISPLAY_WIDTH - 1,
+        GC9A01_ROW_ADDR_SET, 0, 0, 0, DISPLAY_HEIGHT - 1,
+        GC9A01_MEM_WR
+    };
+    const uint8_t *spi = mock_spi_get_written_data();
+    size_t setup_bytes = window_cached ? 1 : WINDOW_SETUP_BYTES;
+    TEST_ASSERT_EQUAL(setup_bytes + TRANSFER_MAX_SIZE, mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_MEMORY(setup + sizeof(setup) - setup_bytes, spi, setup_bytes);
+
+    spi += setup_bytes;
+    for (uint32_t pixel = 0; pixel < FRAME_PIXELS; pixel += 97) {
+        uint16_t expected = colors[index_at(pixel, count)];
+        TEST_ASSERT_EQUAL_HEX16(expected, spi[2 * pixel] | (spi[2 * pixel + 1] << 8));
+    }
+}
+
+void setUp(void) {
+    mock_time_set(1000);
+    mock_spi_reset();
+    GC9A01_window_invalidate();  // Fresh panel: no window cached
+    transfer_init();
+}
+
+void tearDown(void) {
+    transfer_reset();
+}
+
+void test_expand_unpacks_low_bits_first(void) {
+    const uint16_t lut[4] = {0x1111, 0x2222, 0x3333, 0x4444};
+    const uint8_t packed[] = {0xE4};  // Indices 0, 1, 2, 3
+    uint8_t out[8];
+    palette_expand(packed, 4, 2, lut, out);
+
+    const uint8_t expected[] = {0x11, 0x11, 0x22, 0x22, 0x33, 0x33, 0x44, 0x44};
+    TEST_ASSERT_EQUAL_MEMORY(expected, out, sizeof(expected));
+}
+
+void test_eight_bit_image(void) {
+    build_stream(8, 256);
+    TEST_ASSERT_EQUAL(TRANSFER_INDEXED_MAX_SIZE, stream_length);
+    TEST_ASSERT_TRUE(transfer_test_send_all(TRANSFER_MODE_INDEXED, stream, stream_length));
+    expect_frame(palette, 256, false);
+}
+
+void test_four_bit_image(void) {
+    build_stream(4, 16);
+    TEST_ASSERT_EQUAL(PALETTE_STREAM_SIZE(FRAME_PIXELS, 4, 16), stream_length);
+    TEST_ASSERT_TRUE(transfer_test_send_all(TRANSFER_MODE_INDEXED, stream, stream_length));
+    expect_frame(palette, 16, false);
+}
+
+void test_two_bit_image_is_an_eighth(void) {
+    build_stream(2, 3);
+    TEST_ASSERT_EQUAL(TRANSFER_MAX_SIZE / 8 + PALETTE_HEADER_SIZE + 3 * PALETTE_ENTRY_SIZE, stream_length);
+    TEST_ASSERT_TRUE(transfer_test_send_all(TRANSFER_MODE_INDEXED, stream, stream_length));
+    expect_frame(palette, 3, false);
+}
+
+void test_header_disagreeing_with_size_fails(void) {
+    build_stream(4, 16);
+    stream[0] = 8;  // Claims 8 bpp, but the size is for 4 bpp
+
+    TEST_ASSERT_TRUE(transfer_start(TRANSFER_MODE_INDEXED, stream_length));
+    TEST_ASSERT_FALSE(transfer_test_send_chunk(stream, stream_length, 0));
+    TEST_ASSERT_EQUAL(TRANSFER_STATE_ERROR, transfer_get_context()->state);
+}
+
+void test_too_many_colors_for_depth_fails(void) {
+    build_stream(2, 4);
+    stream[1] = 4;  // Five colours at 2 bpp
+
+    TEST_ASSERT_TRUE(transfer_start(TRANSFER_MODE_INDEXED, stream_length));
+    TEST_ASSERT_FALSE(transfer_test_send_chunk(stream, stream_length, 0));
+}
+
+void test_recolor_redraws_resident_indices(void) {
+    build_stream(4, 16);
+    TEST_ASSERT_TRUE(transfer_test_send_all(TRANSFER_MODE_INDEXED, stream, stream_length));
+    mock_spi_reset();
+
+    // Replace entries 2..4
+    uint8_t update[PALETTE_HEADER_SIZE + 3 * PALETTE_ENTRY_SIZE] = {2, 2};
+    uint16_t recolored[16];
+    memcpy(recolored, palette, sizeof(recolored));
+    for (int i = 0; i < 3; i++) {
+        recolored[2 + i] = 0xF800 | i;
+        update[PALETTE_HEADER_SIZE + 2 * i] = recolored[2 + i] & 0xFF;
+        update[PALETTE_HEADER_SIZE + 2 * i + 1] = recolored[2 + i] >> 8;
+    }
+
+    TEST_ASSERT_TRUE(transfer_recolor(update, sizeof(update)));
+    expect_frame(recolored, 16, true);
+}
+
+void test_recolor_needs_resident_image(void) {
+    const uint8_t update[] = {0, 0, 0x00, 0xF8};
+    TEST_ASSERT_FALSE(transfer_recolor(update, sizeof(update)));
+
+    // Past the resident palette
+    build_stream(2, 3);
+    TEST_ASSERT_TRUE(transfer_test_send_all(TRANSFER_MODE_INDEXED, stream, stream_length));
+    const uint8_t past_end[] = {3, 0, 0x00, 0xF8};
+    TEST_ASSERT_FALSE(transfer_recolor(past_end, sizeof(past_end)));
+}
+
+void test_aborted_image_is_not_resident(void) {
+    build_stream(8, 256);
+    TEST_ASSERT_TRUE(transfer_test_send_all(TRANSFER_MODE_INDEXED, stream, stream_length));
+
+    build_stream(8, 256);
+    TEST_ASSERT_TRUE(transfer_start(TRANSFER_MODE_INDEXED, stream_length));
+    TEST_ASSERT_TRUE(transfer_test_send_chunk(stream, stream_length, 0));
+    transfer_abort();
+
+    const uint8_t update[] = {0, 0, 0x00, 0xF8};
+    TEST_ASSERT_FALSE(transfer_recolor(update, sizeof(update)));
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    // Expansion
+    RUN_TEST(test_expand_unpacks_low_bits_first);
+    RUN_TEST(test_eight_bit_image);
+    RUN_TEST(test_four_bit_image);
+    RUN_TEST(test_two_bit_image_is_an_eighth);
+
+    // Validation
+    RUN_TEST(test_header_disagreeing_with_size_fails);
+    RUN_TEST(test_too_many_colors_for_depth_fails);
+
+    // Palette-only updates
+    RUN_TEST(test_recolor_redraws_resident_indices);
+    RUN_TEST(test_recolor_needs_resident_image);
+    RUN_TEST(test_aborted_image_is_not_resident);
+
+    return UNITY_END();
+}
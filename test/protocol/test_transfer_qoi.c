@@ -0,0 +1,204 @@
+#include <unity.h>
+#include <string.h>
+#include <stdlib.h>
+#include "../../src/protocol/transfer.h"
+#include "../../src/protocol/packet.h"
+#include "../../src/codec/qoi.h"
+#include "../../src/hardware/GC9A01.h"
+#include "../../src/common/deskthang_constants.h"
+#include "../mocks/mock_time.h"
+#include "../mocks/mock_spi.h"
+#include "transfer_test_util.h"
+
+// CASET + RASET + MEM_WR emitted when a window opens
+#define WINDOW_SETUP_BYTES 11
+#define FRAME_PIXELS (DISPLAY_WIDTH * DISPLAY_HEIGHT)
+
+static uint8_t frame[TRANSFER_MAX_SIZE];
+static uint8_t stream[QOI_MAX_ENCODED_SIZE(FRAME_PIXELS)];
+static uint32_t stream_length;
+
+// Decoder output collected by the test sink
+static uint8_t decoded[TRANSFER_MAX_SIZE];
+static uint32_t decoded_length;
+static uint32_t sink_writes;
+
+static bool collect(const uint8_t *data, uint32_t length, void *context) {
+    if (decoded_length + length > sizeof(decoded)) {
+        return false;
+    }
+    memcpy(decoded + decoded_length, data, length);
+    decoded_length += length;
+    sink_writes++;
+    return true;
+}
+
+static const QoiSink collect_sink = {.write = collect, .context = NULL};
+
+static void set_pixel(uint8_t *pixels, uint32_t i, uint16_t value) {
+    pixels[2 * i] = value & 0xFF;
+    pixels[2 * i + 1] = value >> 8;
+}
+
+// Flat background, a smooth gradient band and a noisy patch: every op kind
+static void fill_dashboard(void) {
+    srand(7);
+    for (uint32_t i = 0; i < FRAME_PIXELS; i++) {
+        uint16_t x = i % DISPLAY_WIDTH;
+        uint16_t y = i / DISPLAY_WIDTH;
+        uint16_t value = 0x0841;
+        if (y >= 60 && y < 120) {
+            value = ((x / 8) << 11) | ((y - 60) << 5) | (x / 8);
+        } else if (y >= 150 && y < 170 && x < 40) {
+            value = (uint16_t)rand();
+        }
+        set_pixel(frame, i, value);
+    }
+}
+
+static void encode_frame(void) {
+    stream_length = qoi_encode(frame, FRAME_PIXELS, stream, sizeof(stream));
+    TEST_ASSERT_TRUE(stream_length > 0);
+}
+
+void setUp(void) {
+    mock_time_set(1000);
+    mock_spi_reset();
+    GC9A01_window_invalidate();  // Fresh panel: no window cached
+    transfer_init();
+    memset(frame, 0, sizeof(frame));
+    stream_length = 0;
+    decoded_length = 0;
+    sink_writes = 0;
+}
+
+void tearDown(void) {
+    transfer_reset();
+}
+
+void test_round_trip_restores_frame(void) {
+    fill_dashboard();
+    encode_frame();
+    TEST_ASSERT_LESS_THAN(TRANSFER_MAX_SIZE / 4, stream_length);
+
+    QoiDecoder decoder;
+    qoi_decoder_init(&decoder, FRAME_PIXELS, &collect_sink);
+    TEST_ASSERT_TRUE(qoi_decoder_feed(&decoder, stream, stream_length));
+    TEST_ASSERT_TRUE(qoi_decoder_complete(&decoder));
+    TEST_ASSERT_EQUAL(TRANSFER_MAX_SIZE, decoded_length);
+    TEST_ASSERT_EQUAL_MEMORY(frame, decoded, TRANSFER_MAX_SIZE);
+}
+
+void test_byte_at_a_time_matches_whole_stream(void) {
+    fill_dashboard();
+    encode_frame();
+
+    QoiDecoder decoder;
+    qoi_decoder_init(&decoder, FRAME_PIXELS, &collect_sink);
+    for (uint32_t i = 0; i < stream_length; i++) {
+        TEST_ASSERT_TRUE(qoi_decoder_feed(&decoder, stream + i, 1));
+    }
+    TEST_ASSERT_TRUE(qoi_decoder_complete(&decoder));
+    TEST_ASSERT_EQUAL_MEMORY(frame, decoded, TRANSFER_MAX_SIZE);
+}
+
+void test_each_op_decodes(void) {
+    const uint8_t ops[] = {
+        QOI_OP_RGB, 0x34, 0x12,       // 0x1234
+        QOI_OP_RUN | 1,               // 0x1234 twice more
+        QOI_OP_DIFF | 0x3F,           // r+1 g+1 b+1: 0x1A55
+        QOI_OP_LUMA | (32 + 10), 0x88, // g+10, r and b +5: 0x439A
+        QOI_OP_INDEX | 0,             // Slot 0 is still the initial 0x0000
+    };
+    const uint16_t expected[] = {0x1234, 0x1234, 0x1234, 0x1A55, 0x439A, 0x0000};
+
+    QoiDecoder decoder;
+    qoi_decoder_init(&decoder, 6, &collect_sink);
+    TEST_ASSERT_TRUE(qoi_decoder_feed(&decoder, ops, sizeof(ops)));
+    TEST_ASSERT_TRUE(qoi_decoder_complete(&decoder));
+    for (int i = 0; i < 6; i++) {
+        TEST_ASSERT_EQUAL_HEX16(expected[i], decoded[2 * i] | (decoded[2 * i + 1] << 8));
+    }
+}
+
+void test_output_goes_out_a_line_at_a_time(void) {
+    const uint8_t run[] = {QOI_OP_RUN | (QOI_MAX_RUN - 1), QOI_OP_RUN | (QOI_MAX_RUN - 1)};
+
+    QoiDecoder decoder;
+    qoi_decoder_init(&decoder, 2 * QOI_MAX_RUN, &collect_sink);
+    TEST_ASSERT_TRUE(qoi_decoder_feed(&decoder, run, sizeof(run)));
+    TEST_ASSERT_EQUAL(2, sink_writes);  // One full line, then the tail
+    TEST_ASSERT_EQUAL(2 * QOI_MAX_RUN * QOI_PIXEL_SIZE, decoded_length);
+}
+
+void test_invalid_op_and_overrun_fail(void) {
+    QoiDecoder decoder;
+    const uint8_t invalid[] = {0xFF};
+    qoi_decoder_init(&decoder, 4, NULL);
+    TEST_ASSERT_FALSE(qoi_decoder_feed(&decoder, invalid, sizeof(invalid)));
+
+    const uint8_t overrun[] = {QOI_OP_RUN | 4};
+    qoi_decoder_init(&decoder, 4, NULL);
+    TEST_ASSERT_FALSE(qoi_decoder_feed(&decoder, overrun, sizeof(overrun)));
+}
+
+void test_noise_does_not_fit_a_raw_frame(void) {
+    srand(3);
+    for (uint32_t i = 0; i < FRAME_PIXELS; i++) {
+        set_pixel(frame, i, (uint16_t)rand());
+    }
+    TEST_ASSERT_EQUAL(0, qoi_encode(frame, FRAME_PIXELS, stream, TRANSFER_QOI_MAX_SIZE));
+}
+
+void test_transfer_decodes_into_full_window(void) {
+    fill_dashboard();
+    encode_frame();
+
+    TEST_ASSERT_TRUE(transfer_test_send_all(TRANSFER_MODE_QOI, stream, stream_length));
+    const uint8_t setup[] = {
+        GC9A01_COL_ADDR_SET, 0, 0, 0, DISPLAY_WIDTH - 1,
+        GC9A01_ROW_ADDR_SET, 0, 0, 0, DISPLAY_HEIGHT - 1,
+        GC9A01_MEM_WR
+    };
+    const uint8_t *spi = mock_spi_get_written_data();
+    TEST_ASSERT_EQUAL(WINDOW_SETUP_BYTES + TRANSFER_MAX_SIZE, mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_MEMORY(setup, spi, sizeof(setup));
+    TEST_ASSERT_EQUAL_MEMORY(frame, spi + WINDOW_SETUP_BYTES, TRANSFER_MAX_SIZE);
+}
+
+void test_short_stream_fails(void) {
+    fill_dashboard();
+    encode_frame();
+    stream_length /= 2;
+
+    TEST_ASSERT_FALSE(transfer_test_send_all(TRANSFER_MODE_QOI, stream, stream_length));
+}
+
+void test_corrupt_op_fails_transfer(void) {
+    fill_dashboard();
+    encode_frame();
+    stream[0] = 0xFF;
+
+    TEST_ASSERT_TRUE(transfer_start(TRANSFER_MODE_QOI, stream_length));
+    TEST_ASSERT_FALSE(transfer_test_send_chunk(stream, stream_length, 0));
+    TEST_ASSERT_EQUAL(TRANSFER_STATE_ERROR, transfer_get_context()->state);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    // Codec
+    RUN_TEST(test_round_trip_restores_frame);
+    RUN_TEST(test_byte_at_a_time_matches_whole_stream);
+    RUN_TEST(test_each_op_decodes);
+    RUN_TEST(test_output_goes_out_a_line_at_a_time);
+    RUN_TEST(test_invalid_op_and_overrun_fail);
+    RUN_TEST(test_noise_does_not_fit_a_raw_frame);
+
+    // Transfer
+    RUN_TEST(test_transfer_decodes_into_full_window);
+    RUN_TEST(test_short_stream_fails);
+    RUN_TEST(test_corrupt_op_fails_transfer);
+
+    return UNITY_END();
+}
@@ -0,0 +1,179 @@
+#include <unity.h>
+#include <string.h>
+#include "../../src/protocol/transfer.h"
+#include "../../src/protocol/packet.h"
+#include "../../src/hardware/GC9A01.h"
+#include "../../src/common/deskthang_constants.h"
+#include "../mocks/mock_time.h"
+#include "../mocks/mock_spi.h"
+#include "transfer_test_util.h"
+
+// CASET + RASET + MEM_WR emitted when each region's window opens
+#define WINDOW_SETUP_BYTES 11
+
+typedef struct {
+    uint16_t x, y, width, height;
+} Rect;
+
+static uint8_t stream[TRANSFER_REGION_MAX_SIZE];
+static uint32_t stream_length;
+
+static void put_u16(uint8_t *dst, uint16_t value) {
+    dst[0] = value & 0xFF;
+    dst[1] = value >> 8;
+}
+
+// Append a region header and a recognisable pixel pattern
+static void add_region(Rect rect) {
+    put_u16(stream + stream_length, rect.x);
+    put_u16(stream + stream_length + 2, rect.y);
+    put_u16(stream + stream_length + 4, rect.width);
+    put_u16(stream + stream_length + 6, rect.height);
+    stream_length += TRANSFER_REGION_HEADER_SIZE;
+
+    uint32_t bytes = (uint32_t)rect.width * rect.height * 2;
+    for (uint32_t i = 0; i < bytes; i++) {
+        stream[stream_length + i] = (uint8_t)(i * 13 + rect.x + rect.y);
+    }
+    stream_length += bytes;
+}
+
+// Check the SPI output for one region: its window, then its pixels
+static const uint8_t *expect_region(const uint8_t *spi, const uint8_t *region) {
+    uint16_t x = region[0] | (region[1] << 8);
+    uint16_t y = region[2] | (region[3] << 8);
+    uint16_t width = region[4] | (region[5] << 8);
+    uint16_t height = region[6] | (region[7] << 8);
+    uint16_t x_end = x + width - 1;
+    uint16_t y_end = y + height - 1;
+
+    const uint8_t caset[] = {GC9A01_COL_ADDR_SET, x >> 8, x & 0xFF, x_end >> 8, x_end & 0xFF};
+    const uint8_t raset[] = {GC9A01_ROW_ADDR_SET, y >> 8, y & 0xFF, y_end >> 8, y_end & 0xFF};
+    TEST_ASSERT_EQUAL_MEMORY(caset, spi, sizeof(caset));
+    TEST_ASSERT_EQUAL_MEMORY(raset, spi + sizeof(caset), sizeof(raset));
+
+    uint32_t bytes = (uint32_t)width * height * 2;
+    TEST_ASSERT_EQUAL_MEMORY(region + TRANSFER_REGION_HEADER_SIZE, spi + WINDOW_SETUP_BYTES, bytes);
+    return spi + WINDOW_SETUP_BYTES + bytes;
+}
+
+void setUp(void) {
+    mock_time_set(1000);
+    mock_spi_reset();
+    GC9A01_window_invalidate();  // Fresh panel: no window cached
+    transfer_init();
+    stream_length = 0;
+}
+
+void tearDown(void) {
+    transfer_reset();
+}
+
+void test_single_region_opens_its_own_window(void) {
+    add_region((Rect){100, 40, 16, 24});
+
+    TEST_ASSERT_TRUE(transfer_test_send_all(TRANSFER_MODE_REGION, stream, stream_length));
+    TEST_ASSERT_EQUAL(WINDOW_SETUP_BYTES + 16 * 24 * 2, mock_spi_get_written_length());
+    expect_region(mock_spi_get_written_data(), stream);
+}
+
+void test_several_regions_in_one_transfer(void) {
+    Rect rects[] = {{0, 0, 1, 1}, {200, 10, 30, 7}, {12, 220, 100, 20}, {239, 239, 1, 1}};
+    uint32_t offsets[4];
+    for (int i = 0; i < 4; i++) {
+        offsets[i] = stream_length;
+        add_region(rects[i]);
+    }
+
+    TEST_ASSERT_TRUE(transfer_test_send_all(TRANSFER_MODE_REGION, stream, stream_length));
+
+    const uint8_t *spi = mock_spi_get_written_data();
+    for (int i = 0; i < 4; i++) {
+        spi = expect_region(spi, stream + offsets[i]);
+    }
+    TEST_ASSERT_EQUAL(mock_spi_get_written_length(), spi - mock_spi_get_written_data());
+}
+
+void test_header_split_across_chunks(void) {
+    // First region ends 2 bytes short of the chunk boundary
+    add_region((Rect){0, 0, 1, (CHUNK_SIZE - TRANSFER_REGION_HEADER_SIZE - 2) / 2});
+    uint32_t second = stream_length;
+    add_region((Rect){50, 60, 4, 4});
+    TEST_ASSERT_TRUE(second < CHUNK_SIZE && second + TRANSFER_REGION_HEADER_SIZE > CHUNK_SIZE);
+
+    TEST_ASSERT_TRUE(transfer_test_send_all(TRANSFER_MODE_REGION, stream, stream_length));
+
+    const uint8_t *spi = expect_region(mock_spi_get_written_data(), stream);
+    expect_region(spi, stream + second);
+}
+
+void test_reordered_chunks_still_parse_in_order(void) {
+    add_region((Rect){10, 10, 40, 40});
+    add_region((Rect){120, 30, 50, 20});
+
+    TEST_ASSERT_TRUE(transfer_start(TRANSFER_MODE_REGION, stream_length));
+    TEST_ASSERT_TRUE(transfer_is_windowed());
+    for (uint16_t index = 0; index + 1 < transfer_test_chunk_count(stream_length); index += 2) {
+        TEST_ASSERT_TRUE(transfer_test_send_chunk(stream, stream_length, index + 1));
+        TEST_ASSERT_TRUE(transfer_test_send_chunk(stream, stream_length, index));
+    }
+    if (transfer_test_chunk_count(stream_length) % 2) {
+        TEST_ASSERT_TRUE(transfer_test_send_chunk(stream, stream_length, transfer_test_chunk_count(stream_length) - 1));
+    }
+    TEST_ASSERT_TRUE(transfer_complete());
+
+    const uint8_t *spi = expect_region(mock_spi_get_written_data(), stream);
+    expect_region(spi, stream + TRANSFER_REGION_HEADER_SIZE + 40 * 40 * 2);
+}
+
+void test_region_outside_panel_fails_transfer(void) {
+    add_region((Rect){230, 0, 20, 4});
+
+    TEST_ASSERT_TRUE(transfer_start(TRANSFER_MODE_REGION, stream_length));
+    TEST_ASSERT_FALSE(transfer_test_send_chunk(stream, stream_length, 0));
+
+    // The stream can't be parsed past a bad header, so later chunks are refused
+    TEST_ASSERT_EQUAL(TRANSFER_STATE_ERROR, transfer_get_context()->state);
+    TEST_ASSERT_FALSE(transfer_complete());
+}
+
+void test_stream_ending_mid_region_fails(void) {
+    add_region((Rect){0, 0, 10, 10});
+    stream_length -= 20;
+
+    TEST_ASSERT_FALSE(transfer_test_send_all(TRANSFER_MODE_REGION, stream, stream_length));
+}
+
+void test_region_stream_size_is_bounded(void) {
+    TEST_ASSERT_FALSE(transfer_start(TRANSFER_MODE_REGION, TRANSFER_REGION_HEADER_SIZE));
+    TEST_ASSERT_FALSE(transfer_start(TRANSFER_MODE_REGION, TRANSFER_REGION_MAX_SIZE + 1));
+}
+
+void test_small_update_is_far_cheaper_than_a_frame(void) {
+    // A small clock digit: 16x24 pixels
+    add_region((Rect){112, 108, 16, 24});
+
+    TEST_ASSERT_TRUE(transfer_test_send_all(TRANSFER_MODE_REGION, stream, stream_length));
+    TEST_ASSERT_TRUE(stream_length * 100 < TRANSFER_MAX_SIZE);
+    TEST_ASSERT_TRUE(mock_spi_get_written_length() * 100 < TRANSFER_MAX_SIZE);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    // Region windows
+    RUN_TEST(test_single_region_opens_its_own_window);
+    RUN_TEST(test_several_regions_in_one_transfer);
+    RUN_TEST(test_header_split_across_chunks);
+    RUN_TEST(test_reordered_chunks_still_parse_in_order);
+
+    // Validation
+    RUN_TEST(test_region_outside_panel_fails_transfer);
+    RUN_TEST(test_stream_ending_mid_region_fails);
+    RUN_TEST(test_region_stream_size_is_bounded);
+
+    // Cost
+    RUN_TEST(test_small_update_is_far_cheaper_than_a_frame);
+
+    return UNITY_END();
+}
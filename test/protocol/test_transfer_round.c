@@ -0,0 +1,176 @@
+#include <unity.h>
+#include <string.h>
+#include "../../src/protocol/transfer.h"
+#include "../../src/protocol/packet.h"
+#include "../../src/hardware/display.h"
+#include "../../src/hardware/panel_span.h"
+#include "../../src/common/deskthang_constants.h"
+#include "../mocks/mock_time.h"
+#include "../mocks/mock_spi.h"
+#include "transfer_test_util.h"
+
+// CASET + RASET + MEM_WR emitted when a window opens
+#define WINDOW_SETUP_BYTES 11
+
+static uint8_t stream[TRANSFER_MAX_SIZE];
+static uint32_t stream_length;
+
+static uint16_t band_count(void) {
+    uint16_t bands = 0;
+    for (uint16_t y = 0; y < DISPLAY_HEIGHT; y += panel_span_band_height(y)) {
+        bands++;
+    }
+    return bands;
+}
+
+// Visible pixels only, each one's value its own (x, y)
+static void build_round_stream(void) {
+    stream_length = 0;
+    for (uint16_t y = 0; y < DISPLAY_HEIGHT; y++) {
+        for (uint16_t x = panel_span_start(y); x < panel_span_start(y) + panel_span_width(y); x++) {
+            stream[stream_length++] = (uint8_t)x;
+            stream[stream_length++] = (uint8_t)y;
+        }
+    }
+}
+
+static bool send_chunks(uint16_t count) {
+    for (uint16_t index = 0; index < count; index++) {
+        if (!transfer_test_send_chunk(stream, stream_length, index)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void setUp(void) {
+    mock_time_set(1000);
+    mock_spi_reset();
+    GC9A01_window_invalidate();  // Fresh panel: no window cached
+    transfer_init();
+}
+
+void tearDown(void) {
+    transfer_reset();
+}
+
+void test_span_table_matches_circle(void) {
+    uint32_t visible = 0;
+    for (int32_t y = 0; y < DISPLAY_HEIGHT; y++) {
+        for (int32_t x = 0; x < DISPLAY_WIDTH; x++) {
+            int32_t dx = 2 * x - 239;
+            int32_t dy = 2 * y - 239;
+            bool inside = dx * dx + dy * dy <= 240 * 240;
+            bool in_span = x >= panel_span_start(y) && x < panel_span_start(y) + panel_span_width(y);
+            TEST_ASSERT_EQUAL(inside, in_span);
+            visible += inside;
+        }
+    }
+    TEST_ASSERT_EQUAL(PANEL_SPAN_PIXELS, visible);
+}
+
+void test_bands_cover_every_row_once(void) {
+    uint16_t rows = 0;
+    for (uint16_t y = 0; y < DISPLAY_HEIGHT; y += panel_span_band_height(y)) {
+        TEST_ASSERT_TRUE(panel_span_band_height(y) > 0);
+        rows += panel_span_band_height(y);
+    }
+    TEST_ASSERT_EQUAL(DISPLAY_HEIGHT, rows);
+    TEST_ASSERT_TRUE(band_count() < DISPLAY_HEIGHT);
+}
+
+void test_round_transfer_spi_bytes(void) {
+    build_round_stream();
+    TEST_ASSERT_EQUAL(TRANSFER_ROUND_SIZE, stream_length);
+
+    TEST_ASSERT_TRUE(transfer_start(TRANSFER_MODE_ROUND, stream_length));
+    TEST_ASSERT_TRUE(send_chunks((stream_length + CHUNK_SIZE - 1) / CHUNK_SIZE));
+    TEST_ASSERT_TRUE(transfer_complete());
+
+    // One window per band plus the visible pixels: a fifth less than a
+    // full-screen window and frame
+    uint32_t written = mock_spi_get_written_length();
+    TEST_ASSERT_EQUAL(band_count() * WINDOW_SETUP_BYTES + PANEL_SPAN_SIZE, written);
+    TEST_ASSERT_TRUE(written * 5 < (WINDOW_SETUP_BYTES + TRANSFER_MAX_SIZE) * 4);
+}
+
+void test_round_transfer_windows_follow_spans(void) {
+    build_round_stream();
+    TEST_ASSERT_TRUE(transfer_start(TRANSFER_MODE_ROUND, stream_length));
+    TEST_ASSERT_TRUE(send_chunks((stream_length + CHUNK_SIZE - 1) / CHUNK_SIZE));
+    TEST_ASSERT_TRUE(transfer_complete());
+
+    // First band: row 0 alone, centred
+    uint16_t end = panel_span_start(0) + panel_span_width(0) - 1;
+    const uint8_t setup[] = {
+        GC9A01_COL_ADDR_SET, 0, panel_span_start(0), 0, end,
+        GC9A01_ROW_ADDR_SET, 0, 0, 0, 0,
+        GC9A01_MEM_WR
+    };
+    const uint8_t *spi = mock_spi_get_written_data();
+    TEST_ASSERT_EQUAL_MEMORY(setup, spi, sizeof(setup));
+
+    // Its pixels follow, then the next band's window
+    spi += WINDOW_SETUP_BYTES;
+    TEST_ASSERT_EQUAL(panel_span_start(0), spi[0]);
+    TEST_ASSERT_EQUAL(0, spi[1]);
+    spi += panel_span_width(0) * 2;
+    TEST_ASSERT_EQUAL(GC9A01_COL_ADDR_SET, spi[0]);
+    TEST_ASSERT_EQUAL(panel_span_start(1), spi[2]);
+}
+
+void test_round_transfer_is_fixed_size(void) {
+    TEST_ASSERT_FALSE(transfer_start(TRANSFER_MODE_ROUND, TRANSFER_MAX_SIZE));
+}
+
+void test_short_round_transfer_fails(void) {
+    build_round_stream();
+    TEST_ASSERT_TRUE(transfer_start(TRANSFER_MODE_ROUND, stream_length));
+    TEST_ASSERT_TRUE(send_chunks(10));
+    TEST_ASSERT_FALSE(transfer_complete());
+}
+
+void test_full_image_writes_visible_spans(void) {
+    // A full square frame still goes in whole, but only its spans reach the panel
+    TEST_ASSERT_TRUE(transfer_start(TRANSFER_MODE_IMAGE, TRANSFER_MAX_SIZE));
+    Packet packet;
+    memset(&packet, 0, sizeof(Packet));
+    packet.header.type = PACKET_TYPE_DATA;
+    packet.payload = stream;
+    for (uint32_t offset = 0; offset < TRANSFER_MAX_SIZE; offset += CHUNK_SIZE) {
+        packet.header.sequence = (offset / CHUNK_SIZE + 1) & 0xFF;  // Follows on from 0
+        packet.header.length = CHUNK_SIZE;
+        packet.checksum = packet_calculate_checksum(&packet);
+        TEST_ASSERT_TRUE(transfer_process_chunk(&packet));
+    }
+    TEST_ASSERT_TRUE(transfer_complete());
+
+    TEST_ASSERT_EQUAL(band_count() * WINDOW_SETUP_BYTES + PANEL_SPAN_SIZE,
+                      mock_spi_get_written_length());
+}
+
+void test_clear_skips_corners(void) {
+    TEST_ASSERT_TRUE(display_clear());
+    TEST_ASSERT_EQUAL(band_count() * WINDOW_SETUP_BYTES + PANEL_SPAN_SIZE,
+                      mock_spi_get_written_length());
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    // Span table
+    RUN_TEST(test_span_table_matches_circle);
+    RUN_TEST(test_bands_cover_every_row_once);
+
+    // Round transfers
+    RUN_TEST(test_round_transfer_spi_bytes);
+    RUN_TEST(test_round_transfer_windows_follow_spans);
+    RUN_TEST(test_round_transfer_is_fixed_size);
+    RUN_TEST(test_short_round_transfer_fails);
+
+    // Full-screen writes
+    RUN_TEST(test_full_image_writes_visible_spans);
+    RUN_TEST(test_clear_skips_corners);
+
+    return UNITY_END();
+}
@@ -0,0 +1,174 @@
+#include <unity.h>
+#include <string.h>
+#include "../../src/protocol/transfer.h"
+#include "../../src/protocol/packet.h"
+#include "../../src/hardware/GC9A01.h"
+#include "../../src/common/deskthang_constants.h"
+#include "../mocks/mock_time.h"
+#include "../mocks/mock_spi.h"
+
+// Window setup the stream must emit once: CASET 0..239, RASET 0..239, MEM_WR
+static const uint8_t window_bytes[] = {
+    GC9A01_COL_ADDR_SET, 0x00, 0x00, 0x00, DISPLAY_WIDTH - 1,
+    GC9A01_ROW_ADDR_SET, 0x00, 0x00, 0x00, DISPLAY_HEIGHT - 1,
+    GC9A01_MEM_WR
+};
+
+static uint8_t frame[TRANSFER_MAX_SIZE];
+static uint8_t chunk_payload[TRANSFER_CHUNK_INDEX_SIZE + CHUNK_SIZE];
+static uint8_t sequence;
+
+// Windowed chunk: 16-bit LE index followed by that slice of the frame
+static void make_chunk(Packet *packet, uint16_t index) {
+    chunk_payload[0] = index & 0xFF;
+    chunk_payload[1] = index >> 8;
+    memcpy(chunk_payload + TRANSFER_CHUNK_INDEX_SIZE, frame + (uint32_t)index * CHUNK_SIZE, CHUNK_SIZE);
+
+    memset(packet, 0, sizeof(Packet));
+    packet->header.type = PACKET_TYPE_DATA;
+    packet->header.sequence = ++sequence;
+    packet->header.length = sizeof(chunk_payload);
+    packet->payload = chunk_payload;
+    packet->checksum = packet_calculate_checksum(packet);
+}
+
+static bool send_frame(void) {
+    Packet packet;
+    for (uint16_t index = 0; index < TRANSFER_MAX_SIZE / CHUNK_SIZE; index++) {
+        make_chunk(&packet, index);
+        if (!transfer_process_chunk(&packet)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void setUp(void) {
+    mock_time_set(1000);
+    mock_spi_reset();
+    GC9A01_window_invalidate();  // Fresh panel: no window cached
+    transfer_init();
+    sequence = 0;
+
+    for (uint32_t i = 0; i < sizeof(frame); i++) {
+        frame[i] = (uint8_t)(i * 7 + (i >> 8));
+    }
+}
+
+void tearDown(void) {
+    transfer_reset();
+}
+
+void test_stream_start_opens_window_once(void) {
+    TEST_ASSERT_TRUE(transfer_start(TRANSFER_MODE_STREAM, TRANSFER_MAX_SIZE));
+
+    TEST_ASSERT_EQUAL(sizeof(window_bytes), mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_MEMORY(window_bytes, mock_spi_get_written_data(), sizeof(window_bytes));
+}
+
+void test_stream_does_not_allocate_buffer(void) {
+    TEST_ASSERT_TRUE(transfer_start(TRANSFER_MODE_STREAM, TRANSFER_MAX_SIZE));
+
+    TEST_ASSERT_NULL(transfer_get_buffer());
+    TEST_ASSERT_EQUAL(0, transfer_get_buffer_size());
+    TEST_ASSERT_TRUE(transfer_buffer_available());
+}
+
+void test_stream_rejects_partial_frame_size(void) {
+    TEST_ASSERT_FALSE(transfer_start(TRANSFER_MODE_STREAM, TRANSFER_MAX_SIZE / 2));
+    TEST_ASSERT_EQUAL(0, mock_spi_get_written_length());
+}
+
+void test_stream_writes_exact_byte_stream(void) {
+    TEST_ASSERT_TRUE(transfer_start(TRANSFER_MODE_STREAM, TRANSFER_MAX_SIZE));
+    TEST_ASSERT_TRUE(send_frame());
+    TEST_ASSERT_TRUE(transfer_complete());
+
+    const uint8_t *written = mock_spi_get_written_data();
+    TEST_ASSERT_EQUAL(0, mock_spi_get_dropped_bytes());
+    TEST_ASSERT_EQUAL(sizeof(window_bytes) + sizeof(frame), mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_MEMORY(window_bytes, written, sizeof(window_bytes));
+    TEST_ASSERT_EQUAL_MEMORY(frame, written + sizeof(window_bytes), sizeof(frame));
+}
+
+void test_stream_chunks_reach_spi_as_they_arrive(void) {
+    Packet packet;
+    TEST_ASSERT_TRUE(transfer_start(TRANSFER_MODE_STREAM, TRANSFER_MAX_SIZE));
+
+    make_chunk(&packet, 0);
+    TEST_ASSERT_TRUE(transfer_process_chunk(&packet));
+
+    TEST_ASSERT_EQUAL(sizeof(window_bytes) + CHUNK_SIZE, mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL_MEMORY(frame, mock_spi_get_written_data() + sizeof(window_bytes), CHUNK_SIZE);
+}
+
+void test_stream_bad_chunk_is_dropped(void) {
+    Packet packet;
+    TEST_ASSERT_TRUE(transfer_start(TRANSFER_MODE_STREAM, TRANSFER_MAX_SIZE));
+
+    // Dropped and counted; the transfer carries on waiting for chunk 0
+    make_chunk(&packet, 0);
+    packet.checksum ^= 0x1;  // Corrupt
+    TEST_ASSERT_TRUE(transfer_process_chunk(&packet));
+
+    TEST_ASSERT_EQUAL(sizeof(window_bytes), mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL(TRANSFER_STATE_IN_PROGRESS, transfer_get_context()->state);
+    TEST_ASSERT_EQUAL(1, transfer_get_status()->errors);
+}
+
+void test_stream_trusts_validated_packet(void) {
+    Packet packet;
+    TEST_ASSERT_TRUE(transfer_start(TRANSFER_MODE_STREAM, TRANSFER_MAX_SIZE));
+
+    // Receive already checked the wire CRC; the checksum isn't looked at again
+    make_chunk(&packet, 0);
+    packet.checksum = 0;
+    packet.validated = true;
+    TEST_ASSERT_TRUE(transfer_process_chunk(&packet));
+    TEST_ASSERT_EQUAL(0, transfer_get_status()->errors);
+}
+
+void test_stream_drops_overrun(void) {
+    Packet packet;
+    TEST_ASSERT_TRUE(transfer_start(TRANSFER_MODE_STREAM, TRANSFER_MAX_SIZE));
+    TEST_ASSERT_TRUE(send_frame());
+
+    // One chunk past the end of the frame
+    make_chunk(&packet, 0);
+    chunk_payload[0] = (TRANSFER_MAX_SIZE / CHUNK_SIZE) & 0xFF;
+    chunk_payload[1] = (TRANSFER_MAX_SIZE / CHUNK_SIZE) >> 8;
+    packet.checksum = packet_calculate_checksum(&packet);
+    TEST_ASSERT_TRUE(transfer_process_chunk(&packet));
+    TEST_ASSERT_EQUAL(sizeof(window_bytes) + sizeof(frame), mock_spi_get_written_length());
+    TEST_ASSERT_EQUAL(1, transfer_get_status()->errors);
+}
+
+void test_stream_incomplete_frame_does_not_complete(void) {
+    Packet packet;
+    TEST_ASSERT_TRUE(transfer_start(TRANSFER_MODE_STREAM, TRANSFER_MAX_SIZE));
+
+    make_chunk(&packet, 0);
+    TEST_ASSERT_TRUE(transfer_process_chunk(&packet));
+    TEST_ASSERT_FALSE(transfer_complete());
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    // Window setup
+    RUN_TEST(test_stream_start_opens_window_once);
+    RUN_TEST(test_stream_does_not_allocate_buffer);
+    RUN_TEST(test_stream_rejects_partial_frame_size);
+
+    // Byte stream
+    RUN_TEST(test_stream_writes_exact_byte_stream);
+    RUN_TEST(test_stream_chunks_reach_spi_as_they_arrive);
+
+    // Error handling
+    RUN_TEST(test_stream_bad_chunk_is_dropped);
+    RUN_TEST(test_stream_trusts_validated_packet);
+    RUN_TEST(test_stream_drops_overrun);
+    RUN_TEST(test_stream_incomplete_frame_does_not_complete);
+
+    return UNITY_END();
+}
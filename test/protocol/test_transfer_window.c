@@ -0,0 +1,265 @@
+#include <unity.h>
+#include <string.h>
+#include "../../src/protocol/transfer.h"
+#include "../../src/protocol/packet.h"
+#include "../../src/protocol/pipeline.h"
+#include "../../src/hardware/GC9A01.h"
+#include "../../src/common/deskthang_constants.h"
+#include "../mocks/mock_time.h"
+#include "../mocks/mock_spi.h"
+#include "transfer_test_util.h"
+
+// CASET + RASET + MEM_WR emitted when the stream opens
+#define WINDOW_SETUP_BYTES 11
+#define FRAME_CHUNKS (TRANSFER_MAX_SIZE / CHUNK_SIZE)
+
+static uint8_t frame[TRANSFER_MAX_SIZE];
+
+// Buffers taken from the pool, as if a slow core1 still had them
+static PipelineBuffer *held[PIPELINE_BUFFER_COUNT];
+static int held_count;
+
+// Leave exactly free buffers in the pool, or as close as the parked ones allow
+static void leave_free_buffers(int free) {
+    while (held_count > 0) {
+        pipeline_release(held[--held_count]);
+    }
+    PipelineStats stats;
+    pipeline_get_stats(&stats);
+    for (int extra = stats.buffers_free - free; extra > 0; extra--) {
+        held[held_count++] = pipeline_acquire();
+    }
+}
+
+static TransferAck current_ack(void) {
+    TransferAck ack;
+    transfer_get_ack(&ack);
+    return ack;
+}
+
+// One round of the host's window: every chunk from next_chunk not yet
+// covered, with each pair swapped as a lossy link would. Returns how many
+// the device left out of its ACK.
+static uint16_t send_window_swapped(void) {
+    TransferAck ack = current_ack();
+    uint16_t end = ack.next_chunk + TRANSFER_WINDOW_SIZE;
+    end = end > FRAME_CHUNKS ? FRAME_CHUNKS : end;
+    uint16_t sent = 0;
+    for (uint16_t index = ack.next_chunk; index < end; index++) {
+        uint16_t swapped = index ^ 1;
+        if (swapped >= end) {
+            swapped = index;
+        }
+        uint16_t offset = swapped - ack.next_chunk;
+        if (offset > 0 && (ack.sack_bitmap & (1u << (offset - 1)))) {
+            continue;  // Parked already
+        }
+        TEST_ASSERT_TRUE(transfer_test_send_chunk(frame, sizeof(frame), swapped));
+        sent++;
+    }
+
+    TransferAck after = current_ack();
+    uint16_t covered = after.next_chunk - ack.next_chunk;
+    for (uint32_t bits = after.sack_bitmap; bits; bits &= bits - 1) {
+        covered++;
+    }
+    for (uint32_t bits = ack.sack_bitmap; bits; bits &= bits - 1) {
+        covered--;
+    }
+    return sent - covered;
+}
+
+static size_t pixels_written(void) {
+    return mock_spi_get_written_length() - WINDOW_SETUP_BYTES;
+}
+
+void setUp(void) {
+    mock_time_set(1000);
+    mock_spi_reset();
+    GC9A01_window_invalidate();  // Fresh panel: no window cached
+    transfer_init();
+    TEST_ASSERT_TRUE(transfer_start(TRANSFER_MODE_STREAM, TRANSFER_MAX_SIZE));
+
+    for (uint32_t i = 0; i < sizeof(frame); i++) {
+        frame[i] = (uint8_t)(i * 31 + (i >> 8));
+    }
+}
+
+void tearDown(void) {
+    leave_free_buffers(PIPELINE_BUFFER_COUNT);
+    transfer_reset();
+}
+
+void test_stream_is_windowed(void) {
+    TEST_ASSERT_TRUE(transfer_is_windowed());
+    TEST_ASSERT_EQUAL(0, current_ack().next_chunk);
+    TEST_ASSERT_EQUAL_HEX32(0, current_ack().sack_bitmap);
+}
+
+void test_in_order_chunks_advance_cumulative_ack(void) {
+    TEST_ASSERT_TRUE(transfer_test_send_chunk(frame, sizeof(frame), 0));
+    TEST_ASSERT_TRUE(transfer_test_send_chunk(frame, sizeof(frame), 1));
+    TEST_ASSERT_TRUE(transfer_test_send_chunk(frame, sizeof(frame), 2));
+
+    TEST_ASSERT_EQUAL(3, current_ack().next_chunk);
+    TEST_ASSERT_EQUAL_HEX32(0, current_ack().sack_bitmap);
+    TEST_ASSERT_EQUAL(3 * CHUNK_SIZE, pixels_written());
+}
+
+void test_gap_reported_in_sack_bitmap(void) {
+    TEST_ASSERT_TRUE(transfer_test_send_chunk(frame, sizeof(frame), 0));
+    TEST_ASSERT_TRUE(transfer_test_send_chunk(frame, sizeof(frame), 2));
+    TEST_ASSERT_TRUE(transfer_test_send_chunk(frame, sizeof(frame), 4));
+
+    // Chunk 1 missing: 2 and 4 are parked behind it
+    TEST_ASSERT_EQUAL(1, current_ack().next_chunk);
+    TEST_ASSERT_EQUAL_HEX32(0x5, current_ack().sack_bitmap);
+    TEST_ASSERT_EQUAL(CHUNK_SIZE, pixels_written());
+}
+
+void test_filling_gap_drains_parked_chunks_in_order(void) {
+    TEST_ASSERT_TRUE(transfer_test_send_chunk(frame, sizeof(frame), 0));
+    TEST_ASSERT_TRUE(transfer_test_send_chunk(frame, sizeof(frame), 3));
+    TEST_ASSERT_TRUE(transfer_test_send_chunk(frame, sizeof(frame), 2));
+    TEST_ASSERT_TRUE(transfer_test_send_chunk(frame, sizeof(frame), 1));
+
+    TEST_ASSERT_EQUAL(4, current_ack().next_chunk);
+    TEST_ASSERT_EQUAL_HEX32(0, current_ack().sack_bitmap);
+    TEST_ASSERT_EQUAL(4 * CHUNK_SIZE, pixels_written());
+    TEST_ASSERT_EQUAL_MEMORY(frame, mock_spi_get_written_data() + WINDOW_SETUP_BYTES, 4 * CHUNK_SIZE);
+}
+
+void test_duplicate_chunk_is_not_rewritten(void) {
+    TEST_ASSERT_TRUE(transfer_test_send_chunk(frame, sizeof(frame), 0));
+    TEST_ASSERT_TRUE(transfer_test_send_chunk(frame, sizeof(frame), 0));
+
+    TEST_ASSERT_EQUAL(1, current_ack().next_chunk);
+    TEST_ASSERT_EQUAL(CHUNK_SIZE, pixels_written());
+}
+
+void test_chunk_past_window_is_dropped(void) {
+    TEST_ASSERT_TRUE(transfer_test_send_chunk(frame, sizeof(frame), TRANSFER_WINDOW_SIZE));
+
+    TEST_ASSERT_EQUAL(0, current_ack().next_chunk);
+    TEST_ASSERT_EQUAL_HEX32(0, current_ack().sack_bitmap);
+    TEST_ASSERT_EQUAL(0, pixels_written());
+}
+
+void test_chunk_index_does_not_wrap_at_256(void) {
+    for (uint16_t index = 0; index < 300; index++) {
+        TEST_ASSERT_TRUE(transfer_test_send_chunk(frame, sizeof(frame), index));
+    }
+
+    // Index 256 shares its low byte with 0 but is a different chunk
+    TEST_ASSERT_EQUAL(300, current_ack().next_chunk);
+    TEST_ASSERT_EQUAL(300 * CHUNK_SIZE, pixels_written());
+}
+
+void test_reordered_frame_reaches_panel_in_order(void) {
+    // Swap every pair of chunks, as a lossy link with retransmits would
+    for (uint16_t index = 0; index < FRAME_CHUNKS; index += 2) {
+        TEST_ASSERT_TRUE(transfer_test_send_chunk(frame, sizeof(frame), index + 1));
+        TEST_ASSERT_TRUE(transfer_test_send_chunk(frame, sizeof(frame), index));
+    }
+    TEST_ASSERT_TRUE(transfer_complete());
+
+    TEST_ASSERT_EQUAL(sizeof(frame), pixels_written());
+    TEST_ASSERT_EQUAL_MEMORY(frame, mock_spi_get_written_data() + WINDOW_SETUP_BYTES, sizeof(frame));
+}
+
+void test_reordered_frame_decoded_on_second_core(void) {
+    // Core0 never waits for a buffer: what core1 hasn't returned yet is
+    // left out of the ACK, and resent once it catches up, as after the
+    // host's timeout
+    uint32_t rounds = 0;
+    TEST_ASSERT_TRUE(pipeline_start());
+    while (current_ack().next_chunk < FRAME_CHUNKS) {
+        TEST_ASSERT_TRUE(rounds++ < FRAME_CHUNKS * 3);
+        if (send_window_swapped() > 0) {
+            pipeline_flush();
+        }
+    }
+    TEST_ASSERT_TRUE(transfer_complete());
+    pipeline_stop();
+
+    TEST_ASSERT_EQUAL(sizeof(frame), pixels_written());
+    TEST_ASSERT_EQUAL_MEMORY(frame, mock_spi_get_written_data() + WINDOW_SETUP_BYTES, sizeof(frame));
+}
+
+void test_chunk_without_free_buffer_is_not_acked(void) {
+    leave_free_buffers(0);
+    TEST_ASSERT_TRUE(transfer_test_send_chunk(frame, sizeof(frame), 0));
+    TEST_ASSERT_TRUE(transfer_test_send_chunk(frame, sizeof(frame), 2));
+
+    // Neither is covered, and nothing failed
+    TEST_ASSERT_EQUAL(0, current_ack().next_chunk);
+    TEST_ASSERT_EQUAL_HEX32(0, current_ack().sack_bitmap);
+    TEST_ASSERT_EQUAL(0, pixels_written());
+    TEST_ASSERT_EQUAL(0, transfer_get_status()->errors);
+    TEST_ASSERT_EQUAL(TRANSFER_STATE_IN_PROGRESS, transfer_get_context()->state);
+
+    // Once a buffer comes back the resend goes through
+    leave_free_buffers(1);
+    TEST_ASSERT_TRUE(transfer_test_send_chunk(frame, sizeof(frame), 0));
+    TEST_ASSERT_EQUAL(1, current_ack().next_chunk);
+}
+
+void test_slow_consumer_throttles_window(void) {
+    uint32_t rounds = 0;
+    uint32_t held_back = 0;
+
+    // Each round the host sends its window while core1 frees 0, 1 or 2 buffers
+    while (current_ack().next_chunk < FRAME_CHUNKS) {
+        TEST_ASSERT_TRUE(rounds < FRAME_CHUNKS * 3);
+        leave_free_buffers(rounds++ % 3);
+
+        held_back += send_window_swapped();
+    }
+    TEST_ASSERT_TRUE(transfer_complete());
+
+    TEST_ASSERT_TRUE(held_back > 0);
+    TEST_ASSERT_EQUAL(0, transfer_get_status()->errors);
+    TEST_ASSERT_EQUAL(sizeof(frame), pixels_written());
+    TEST_ASSERT_EQUAL_MEMORY(frame, mock_spi_get_written_data() + WINDOW_SETUP_BYTES, sizeof(frame));
+}
+
+void test_abort_returns_parked_chunks(void) {
+    TEST_ASSERT_TRUE(transfer_test_send_chunk(frame, sizeof(frame), 1));
+    TEST_ASSERT_TRUE(transfer_test_send_chunk(frame, sizeof(frame), 2));
+
+    PipelineStats stats;
+    pipeline_get_stats(&stats);
+    TEST_ASSERT_EQUAL(PIPELINE_BUFFER_COUNT - 2, stats.buffers_free);
+
+    TEST_ASSERT_TRUE(transfer_abort());
+    pipeline_get_stats(&stats);
+    TEST_ASSERT_EQUAL(PIPELINE_BUFFER_COUNT, stats.buffers_free);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    // Cumulative ACK
+    RUN_TEST(test_stream_is_windowed);
+    RUN_TEST(test_in_order_chunks_advance_cumulative_ack);
+
+    // Selective ACK and reordering
+    RUN_TEST(test_gap_reported_in_sack_bitmap);
+    RUN_TEST(test_filling_gap_drains_parked_chunks_in_order);
+    RUN_TEST(test_duplicate_chunk_is_not_rewritten);
+    RUN_TEST(test_chunk_past_window_is_dropped);
+
+    // 16-bit chunk index
+    RUN_TEST(test_chunk_index_does_not_wrap_at_256);
+    RUN_TEST(test_reordered_frame_reaches_panel_in_order);
+
+    // Decoding on core1
+    RUN_TEST(test_reordered_frame_decoded_on_second_core);
+    RUN_TEST(test_abort_returns_parked_chunks);
+
+    // Backpressure
+    RUN_TEST(test_chunk_without_free_buffer_is_not_acked);
+    RUN_TEST(test_slow_consumer_throttles_window);
+
+    return UNITY_END();
+}
@@ -0,0 +1,45 @@
+#include "transfer_test_util.h"
+#include <string.h>
+#include "../../src/common/deskthang_constants.h"
+
+static uint8_t chunk_payload[TRANSFER_CHUNK_INDEX_SIZE + CHUNK_SIZE];
+
+void transfer_test_make_chunk(Packet *packet, const uint8_t *stream, uint32_t length, uint16_t index) {
+    uint32_t offset = (uint32_t)index * CHUNK_SIZE;
+    uint16_t slice = length - offset < CHUNK_SIZE ? length - offset : CHUNK_SIZE;
+
+    chunk_payload[0] = index & 0xFF;
+    chunk_payload[1] = index >> 8;
+    memcpy(chunk_payload + TRANSFER_CHUNK_INDEX_SIZE, stream + offset, slice);
+
+    memset(packet, 0, sizeof(Packet));
+    packet->header.start_marker = PACKET_V1_START_MARKER;
+    packet->header.type = PACKET_TYPE_DATA;
+    packet->header.sequence = index & 0xFF;
+    packet->header.length = TRANSFER_CHUNK_INDEX_SIZE + slice;
+    packet->payload = chunk_payload;
+    packet->end_marker = PACKET_V1_END_MARKER;
+    packet->checksum = packet_calculate_checksum(packet);
+}
+
+bool transfer_test_send_chunk(const uint8_t *stream, uint32_t length, uint16_t index) {
+    Packet packet;
+    transfer_test_make_chunk(&packet, stream, length, index);
+    return transfer_process_chunk(&packet);
+}
+
+uint16_t transfer_test_chunk_count(uint32_t length) {
+    return (length + CHUNK_SIZE - 1) / CHUNK_SIZE;
+}
+
+bool transfer_test_send_all(TransferMode mode, const uint8_t *stream, uint32_t length) {
+    if (!transfer_start(mode, length)) {
+        return false;
+    }
+    for (uint16_t index = 0; index < transfer_test_chunk_count(length); index++) {
+        if (!transfer_test_send_chunk(stream, length, index)) {
+            return false;
+        }
+    }
+    return transfer_complete();
+}
@@ -0,0 +1,24 @@
+#ifndef TRANSFER_TEST_UTIL_H
+#define TRANSFER_TEST_UTIL_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "../../src/protocol/transfer.h"
+#include "../../src/protocol/packet.h"
+
+// Windowed chunks of a test stream cut into CHUNK_SIZE slices, the last
+// one short. Each carries its 16-bit LE index, then its slice.
+
+// Build chunk index into packet. The payload lives in a buffer the next
+// call reuses, so send or copy the packet before building another.
+void transfer_test_make_chunk(Packet *packet, const uint8_t *stream, uint32_t length, uint16_t index);
+
+// Build chunk index and hand it to transfer_process_chunk
+bool transfer_test_send_chunk(const uint8_t *stream, uint32_t length, uint16_t index);
+
+uint16_t transfer_test_chunk_count(uint32_t length);
+
+// Start mode, send every chunk in order and complete the transfer
+bool transfer_test_send_all(TransferMode mode, const uint8_t *stream, uint32_t length);
+
+#endif // TRANSFER_TEST_UTIL_H
@@ -29,5 +29,80 @@ echo -e "\nRunning packet tests..."
 echo -e "\nRunning transfer validation tests..."
 ./test_transfer_validation
 
+echo -e "\nRunning transfer stream tests..."
+./test_transfer_stream
+
+echo -e "\nRunning transfer window tests..."
+./test_transfer_window
+
+echo -e "\nRunning transfer region tests..."
+./test_transfer_region
+
+echo -e "\nRunning transfer delta tests..."
+./test_transfer_delta
+
+echo -e "\nRunning transfer QOI tests..."
+./test_transfer_qoi
+
+echo -e "\nRunning transfer BC1 tests..."
+./test_transfer_bc1
+
+echo -e "\nRunning transfer indexed tests..."
+./test_transfer_indexed
+
+echo -e "\nRunning transfer round tests..."
+./test_transfer_round
+
+echo -e "\nRunning COBS tests..."
+./test_cobs
+
+echo -e "\nRunning CRC32 tests..."
+./test_crc32
+
+echo -e "\nRunning packet framing tests..."
+./test_packet_framing
+
+echo -e "\nRunning packet pool tests..."
+./test_packet_pool
+
+echo -e "\nRunning packet parser tests..."
+./test_packet_parser
+
+echo -e "\nRunning pixel engine tests..."
+./test_pixel_engine
+
+echo -e "\nRunning GC9A01 driver tests..."
+./test_gc9a01
+
+echo -e "\nRunning scanline renderer tests..."
+./test_scanline
+
+echo -e "\nRunning boot timeline tests..."
+./test_boot
+
+echo -e "\nRunning core pipeline tests..."
+./test_pipeline
+
+echo -e "\nRunning logging tests..."
+./test_logging
+
+echo -e "\nRunning state dispatch tests..."
+./test_dispatch
+
+echo -e "\nRunning scheduler tests..."
+./test_scheduler
+
+echo -e "\nRunning trace tests..."
+./test_trace
+
+echo -e "\nRunning stats tests..."
+./test_stats
+
+echo -e "\nRunning protocol command tests..."
+./test_protocol_commands
+
+echo -e "\nRunning serial ring tests..."
+./test_serial_ring
+
 # Print summary
 echo -e "\nAll tests completed!" 
\ No newline at end of file
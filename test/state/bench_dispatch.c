@@ -0,0 +1,125 @@
+// State machine dispatch microbenchmark. Times a READY -> DATA_TRANSFER ->
+// READY round trip through the table-driven dispatcher with its binary
+// trace, next to the text-logging transition it replaced: a linear scan of
+// the transition list plus four formatted 256-byte log lines. Numbers are
+// for the host CPU; the ratio is what carries over to the RP2040.
+//
+// Usage: ./bench_dispatch [iterations-scale]
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+#include "../../src/state/dispatch.h"
+#include "../../src/state/transition.h"
+#include "../../src/state/context.h"
+#include "../../src/error/logging.h"
+
+// No actions: the cost measured is the machine's own
+const StateActions STATE_ACTIONS[STATE_COUNT] = {0};
+
+// The transition list as it was scanned before the table
+static const struct {
+    SystemState from;
+    SystemState to;
+    StateCondition condition;
+} OLD_TRANSITIONS[] = {
+    {STATE_HARDWARE_INIT, STATE_DISPLAY_INIT, CONDITION_HARDWARE_READY},
+    {STATE_HARDWARE_INIT, STATE_ERROR, CONDITION_ERROR},
+    {STATE_DISPLAY_INIT, STATE_IDLE, CONDITION_DISPLAY_READY},
+    {STATE_DISPLAY_INIT, STATE_ERROR, CONDITION_ERROR},
+    {STATE_IDLE, STATE_SYNCING, CONDITION_SYNC_RECEIVED},
+    {STATE_IDLE, STATE_ERROR, CONDITION_ERROR},
+    {STATE_SYNCING, STATE_READY, CONDITION_SYNC_VALID},
+    {STATE_SYNCING, STATE_SYNCING, CONDITION_RETRY},
+    {STATE_SYNCING, STATE_ERROR, CONDITION_ERROR},
+    {STATE_READY, STATE_COMMAND_PROCESSING, CONDITION_COMMAND_VALID},
+    {STATE_READY, STATE_DATA_TRANSFER, CONDITION_TRANSFER_START},
+    {STATE_READY, STATE_IDLE, CONDITION_RESET},
+    {STATE_READY, STATE_ERROR, CONDITION_ERROR},
+    {STATE_COMMAND_PROCESSING, STATE_READY, CONDITION_TRANSFER_COMPLETE},
+    {STATE_COMMAND_PROCESSING, STATE_ERROR, CONDITION_ERROR},
+    {STATE_DATA_TRANSFER, STATE_DATA_TRANSFER, CONDITION_TRANSFER_START},
+    {STATE_DATA_TRANSFER, STATE_READY, CONDITION_TRANSFER_COMPLETE},
+    {STATE_DATA_TRANSFER, STATE_ERROR, CONDITION_ERROR},
+    {STATE_ERROR, STATE_IDLE, CONDITION_RESET},
+    {STATE_ERROR, STATE_SYNCING, CONDITION_RETRY},
+};
+
+#define OLD_TRANSITION_COUNT (sizeof(OLD_TRANSITIONS) / sizeof(OLD_TRANSITIONS[0]))
+
+static SystemState old_current = STATE_READY;
+
+static double now_ns(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (double)ts.tv_sec * 1e9 + (double)ts.tv_nsec;
+}
+
+static bool old_transition(SystemState next, StateCondition condition) {
+    char msg[256];
+    snprintf(msg, sizeof(msg), "Attempting transition from %s to %s (condition: %s)",
+             state_to_string(old_current), state_to_string(next), condition_to_string(condition));
+    logging_write("State", msg);
+
+    bool found = false;
+    for (size_t i = 0; i < OLD_TRANSITION_COUNT; i++) {
+        if (OLD_TRANSITIONS[i].from == old_current && OLD_TRANSITIONS[i].to == next &&
+            OLD_TRANSITIONS[i].condition == condition) {
+            found = true;
+            break;
+        }
+    }
+    if (!found) {
+        return false;
+    }
+
+    snprintf(msg, sizeof(msg), "Executing exit actions for %s", state_to_string(old_current));
+    logging_write("State", msg);
+    old_current = next;
+    snprintf(msg, sizeof(msg), "Executing entry actions for %s", state_to_string(next));
+    logging_write("State", msg);
+    snprintf(msg, sizeof(msg), "Successfully transitioned to %s", state_to_string(next));
+    logging_write("State", msg);
+    return true;
+}
+
+static void report(const char *name, double elapsed, unsigned transitions) {
+    printf("%-22s %8.1f ns/transition\n", name, elapsed / transitions);
+}
+
+int main(int argc, char **argv) {
+    unsigned scale = argc > 1 ? (unsigned)atoi(argv[1]) : 1;
+    unsigned rounds = 1000000 * (scale ? scale : 1);
+
+    logging_init();
+    state_context_init();
+    state_dispatch_init(STATE_READY, STATE_ACTIONS);
+
+    volatile bool sink = false;
+    double start = now_ns();
+    for (unsigned i = 0; i < rounds; i++) {
+        sink ^= transition_allowed(STATE_READY, STATE_DATA_TRANSFER, CONDITION_TRANSFER_START);
+        sink ^= transition_allowed(STATE_DATA_TRANSFER, STATE_READY, CONDITION_TRANSFER_COMPLETE);
+    }
+    report("table lookup", now_ns() - start, 2 * rounds);
+
+    start = now_ns();
+    for (unsigned i = 0; i < rounds; i++) {
+        state_dispatch_post(STATE_DATA_TRANSFER, CONDITION_TRANSFER_START);
+        state_dispatch_post(STATE_READY, CONDITION_TRANSFER_COMPLETE);
+    }
+    report("dispatch + trace", now_ns() - start, 2 * rounds);
+
+    // The log ring fills and drops after the first few; dropping is the
+    // cheap path, so this understates the old cost
+    start = now_ns();
+    for (unsigned i = 0; i < rounds; i++) {
+        old_transition(STATE_DATA_TRANSFER, CONDITION_TRANSFER_START);
+        old_transition(STATE_READY, CONDITION_TRANSFER_COMPLETE);
+    }
+    report("scan + text logs", now_ns() - start, 2 * rounds);
+
+    StateDispatchStats stats;
+    state_dispatch_get_stats(&stats);
+    printf("taken %lu, rejected %lu\n", (unsigned long)stats.taken, (unsigned long)stats.rejected);
+    return sink ? 0 : 0;
+}
@@ -0,0 +1,231 @@
+#include <unity.h>
+#include <string.h>
+#include "../../src/state/dispatch.h"
+#include "../../src/state/transition.h"
+#include "../../src/state/context.h"
+#include "../../src/error/logging.h"
+#include "../mocks/mock_time.h"
+#include "../mocks/mock_serial.h"
+
+// What each state's entry action posts, if anything
+static struct {
+    bool post;
+    SystemState next;
+    StateCondition condition;
+} on_entry_post[STATE_COUNT];
+
+static int entered[STATE_COUNT];
+static int flood;  // Copies of its post the next entry makes, then no more
+static int depth;
+static int max_depth;
+
+static void enter(SystemState state) {
+    entered[state]++;
+    if (++depth > max_depth) {
+        max_depth = depth;
+    }
+    if (on_entry_post[state].post) {
+        int copies = flood > 0 ? flood : 1;
+        if (flood > 0) {
+            flood = 0;
+            on_entry_post[state].post = false;
+        }
+        for (int i = 0; i < copies; i++) {
+            state_dispatch_post(on_entry_post[state].next, on_entry_post[state].condition);
+        }
+    }
+    depth--;
+}
+
+#define ENTRY(state) static void entry_##state(void) { enter(state); }
+ENTRY(STATE_HARDWARE_INIT)
+ENTRY(STATE_DISPLAY_INIT)
+ENTRY(STATE_IDLE)
+ENTRY(STATE_SYNCING)
+ENTRY(STATE_READY)
+ENTRY(STATE_COMMAND_PROCESSING)
+ENTRY(STATE_DATA_TRANSFER)
+ENTRY(STATE_ERROR)
+
+const StateActions STATE_ACTIONS[STATE_COUNT] = {
+    [STATE_HARDWARE_INIT] = {.on_entry = entry_STATE_HARDWARE_INIT},
+    [STATE_DISPLAY_INIT] = {.on_entry = entry_STATE_DISPLAY_INIT},
+    [STATE_IDLE] = {.on_entry = entry_STATE_IDLE},
+    [STATE_SYNCING] = {.on_entry = entry_STATE_SYNCING},
+    [STATE_READY] = {.on_entry = entry_STATE_READY},
+    [STATE_COMMAND_PROCESSING] = {.on_entry = entry_STATE_COMMAND_PROCESSING},
+    [STATE_DATA_TRANSFER] = {.on_entry = entry_STATE_DATA_TRANSFER},
+    [STATE_ERROR] = {.on_entry = entry_STATE_ERROR},
+};
+
+static void post_on_entry(SystemState state, SystemState next, StateCondition condition) {
+    on_entry_post[state].post = true;
+    on_entry_post[state].next = next;
+    on_entry_post[state].condition = condition;
+}
+
+static StateTraceEntry trace(uint16_t index) {
+    StateTraceEntry entry;
+    TEST_ASSERT_TRUE(state_trace_get(index, &entry));
+    return entry;
+}
+
+static StateDispatchStats stats(void) {
+    StateDispatchStats current;
+    state_dispatch_get_stats(&current);
+    return current;
+}
+
+void setUp(void) {
+    mock_time_set(1000);
+    mock_serial_reset();
+    logging_init();
+    state_context_init();
+    memset(on_entry_post, 0, sizeof(on_entry_post));
+    memset(entered, 0, sizeof(entered));
+    depth = 0;
+    max_depth = 0;
+    flood = 0;
+}
+
+void tearDown(void) {
+}
+
+// Boot as the firmware does: each init state's entry moves straight on
+static void boot_to_idle(void) {
+    post_on_entry(STATE_HARDWARE_INIT, STATE_DISPLAY_INIT, CONDITION_HARDWARE_READY);
+    post_on_entry(STATE_DISPLAY_INIT, STATE_IDLE, CONDITION_DISPLAY_READY);
+    TEST_ASSERT_TRUE(state_dispatch_init(STATE_HARDWARE_INIT, STATE_ACTIONS));
+}
+
+void test_table_lookup(void) {
+    TEST_ASSERT_TRUE(transition_allowed(STATE_READY, STATE_DATA_TRANSFER, CONDITION_TRANSFER_START));
+    TEST_ASSERT_TRUE(transition_allowed(STATE_IDLE, STATE_ERROR, CONDITION_ERROR));
+    TEST_ASSERT_FALSE(transition_allowed(STATE_IDLE, STATE_DATA_TRANSFER, CONDITION_TRANSFER_START));
+    TEST_ASSERT_FALSE(transition_allowed(STATE_READY, STATE_IDLE, CONDITION_ERROR));
+    TEST_ASSERT_FALSE(transition_allowed(STATE_COUNT, STATE_IDLE, CONDITION_RESET));
+    TEST_ASSERT_FALSE(transition_allowed(STATE_ERROR, STATE_IDLE, CONDITION_COUNT));
+}
+
+void test_entry_transitions_run_after_entry_returns(void) {
+    boot_to_idle();
+
+    TEST_ASSERT_EQUAL(STATE_IDLE, state_dispatch_current());
+    TEST_ASSERT_EQUAL(STATE_DISPLAY_INIT, state_dispatch_previous());
+    TEST_ASSERT_EQUAL(1, max_depth);  // No entry action ran inside another
+
+    TEST_ASSERT_EQUAL(2, state_trace_count());
+    TEST_ASSERT_EQUAL(STATE_HARDWARE_INIT, trace(0).from);
+    TEST_ASSERT_EQUAL(STATE_DISPLAY_INIT, trace(0).to);
+    TEST_ASSERT_EQUAL(CONDITION_HARDWARE_READY, trace(0).condition);
+    TEST_ASSERT_EQUAL(STATE_IDLE, trace(1).to);
+    TEST_ASSERT_EQUAL(STATE_TRACE_TAKEN, trace(1).result);
+    TEST_ASSERT_EQUAL(2, stats().deferred);
+}
+
+void test_rejected_transition_is_traced_not_taken(void) {
+    boot_to_idle();
+
+    TEST_ASSERT_FALSE(state_dispatch_post(STATE_READY, CONDITION_SYNC_VALID));
+    TEST_ASSERT_EQUAL(STATE_IDLE, state_dispatch_current());
+    TEST_ASSERT_EQUAL(0, entered[STATE_READY]);
+
+    TEST_ASSERT_EQUAL(1, stats().rejected);
+    StateTraceEntry last = trace(state_trace_count() - 1);
+    TEST_ASSERT_EQUAL(STATE_TRACE_REJECTED, last.result);
+    TEST_ASSERT_EQUAL(STATE_READY, last.to);
+}
+
+void test_deferred_event_is_checked_when_it_runs(void) {
+    boot_to_idle();
+
+    // SYNCING's entry asks for READY, and READY's for a transfer
+    post_on_entry(STATE_SYNCING, STATE_READY, CONDITION_SYNC_VALID);
+    post_on_entry(STATE_READY, STATE_DATA_TRANSFER, CONDITION_TRANSFER_START);
+    TEST_ASSERT_TRUE(state_dispatch_post(STATE_SYNCING, CONDITION_SYNC_RECEIVED));
+    TEST_ASSERT_EQUAL(STATE_DATA_TRANSFER, state_dispatch_current());
+    TEST_ASSERT_EQUAL(1, max_depth);
+
+    // One the table doesn't allow from where it lands is rejected there
+    post_on_entry(STATE_READY, STATE_SYNCING, CONDITION_SYNC_RECEIVED);
+    TEST_ASSERT_TRUE(state_dispatch_post(STATE_READY, CONDITION_TRANSFER_COMPLETE));
+    TEST_ASSERT_EQUAL(STATE_READY, state_dispatch_current());
+    TEST_ASSERT_EQUAL(1, stats().rejected);
+}
+
+void test_recovered_returns_only_to_previous(void) {
+    boot_to_idle();
+    TEST_ASSERT_TRUE(state_dispatch_post(STATE_ERROR, CONDITION_ERROR));
+
+    TEST_ASSERT_FALSE(state_dispatch_post(STATE_READY, CONDITION_RECOVERED));
+    TEST_ASSERT_TRUE(state_dispatch_post(STATE_IDLE, CONDITION_RECOVERED));
+    TEST_ASSERT_EQUAL(STATE_IDLE, state_dispatch_current());
+}
+
+void test_retry_is_guarded_by_the_retry_budget(void) {
+    boot_to_idle();
+    TEST_ASSERT_TRUE(state_dispatch_post(STATE_ERROR, CONDITION_ERROR));
+    TEST_ASSERT_TRUE(state_dispatch_allowed(STATE_ERROR, STATE_SYNCING, CONDITION_RETRY));
+
+    while (state_context_can_retry()) {
+        state_context_increment_retry();
+    }
+    TEST_ASSERT_FALSE(state_dispatch_post(STATE_SYNCING, CONDITION_RETRY));
+    TEST_ASSERT_EQUAL(STATE_ERROR, state_dispatch_current());
+}
+
+void test_trace_ring_keeps_the_newest(void) {
+    boot_to_idle();
+    TEST_ASSERT_TRUE(state_dispatch_post(STATE_SYNCING, CONDITION_SYNC_RECEIVED));
+    TEST_ASSERT_TRUE(state_dispatch_post(STATE_READY, CONDITION_SYNC_VALID));
+
+    // Two per round trip, well past the ring's size
+    for (int i = 0; i < STATE_TRACE_ENTRIES; i++) {
+        mock_time_advance(1);
+        TEST_ASSERT_TRUE(state_dispatch_post(STATE_DATA_TRANSFER, CONDITION_TRANSFER_START));
+        TEST_ASSERT_TRUE(state_dispatch_post(STATE_READY, CONDITION_TRANSFER_COMPLETE));
+    }
+
+    TEST_ASSERT_EQUAL(STATE_TRACE_ENTRIES, state_trace_count());
+    TEST_ASSERT_EQUAL(STATE_READY, trace(STATE_TRACE_ENTRIES - 1).to);
+    TEST_ASSERT_EQUAL(STATE_DATA_TRANSFER, trace(STATE_TRACE_ENTRIES - 2).to);
+    for (uint16_t i = 1; i < STATE_TRACE_ENTRIES; i++) {
+        TEST_ASSERT_TRUE(trace(i).timestamp_us >= trace(i - 1).timestamp_us);
+    }
+    StateTraceEntry entry;
+    TEST_ASSERT_FALSE(state_trace_get(STATE_TRACE_ENTRIES, &entry));
+}
+
+void test_queue_overflow_is_counted(void) {
+    boot_to_idle();
+
+    // SYNCING's entry posts more retries than the queue holds, once
+    post_on_entry(STATE_SYNCING, STATE_SYNCING, CONDITION_RETRY);
+    flood = STATE_EVENT_QUEUE_SIZE + 2;
+    TEST_ASSERT_TRUE(state_dispatch_post(STATE_SYNCING, CONDITION_SYNC_RECEIVED));
+
+    StateDispatchStats s = stats();
+    TEST_ASSERT_EQUAL(2, s.queue_full);
+    TEST_ASSERT_EQUAL(STATE_EVENT_QUEUE_SIZE, s.queue_high_water);
+    TEST_ASSERT_EQUAL(1 + STATE_EVENT_QUEUE_SIZE, entered[STATE_SYNCING]);
+    TEST_ASSERT_EQUAL(STATE_SYNCING, state_dispatch_current());
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    RUN_TEST(test_table_lookup);
+
+    // Run to completion
+    RUN_TEST(test_entry_transitions_run_after_entry_returns);
+    RUN_TEST(test_rejected_transition_is_traced_not_taken);
+    RUN_TEST(test_deferred_event_is_checked_when_it_runs);
+    RUN_TEST(test_recovered_returns_only_to_previous);
+    RUN_TEST(test_retry_is_guarded_by_the_retry_budget);
+
+    // Trace and queue
+    RUN_TEST(test_trace_ring_keeps_the_newest);
+    RUN_TEST(test_queue_overflow_is_counted);
+
+    return UNITY_END();
+}
@@ -0,0 +1,233 @@
+#include <unity.h>
+#include <string.h>
+#include "../../src/system/scheduler.h"
+#include "../../src/system/time.h"
+#include "../mocks/mock_time.h"
+
+#define MAX_FIRES 32
+
+static struct {
+    int id;
+    uint32_t at_ms;
+} fires[MAX_FIRES];
+static int fire_count;
+
+static int task_runs[4];
+static bool task_more[4];
+
+static void record(void *context) {
+    if (fire_count < MAX_FIRES) {
+        fires[fire_count].id = (int)(intptr_t)context;
+        fires[fire_count].at_ms = deskthang_time_get_ms();
+        fire_count++;
+    }
+}
+
+static bool task(void *context) {
+    int index = (int)(intptr_t)context;
+    task_runs[index]++;
+    return task_more[index];
+}
+
+// Step the mock clock a millisecond at a time, one pass per step
+static void run_for_ms(uint32_t ms) {
+    for (uint32_t i = 0; i < ms; i++) {
+        mock_time_advance(1);
+        scheduler_run_once();
+    }
+}
+
+void setUp(void) {
+    mock_time_set(5000);
+    scheduler_init();
+    memset(fires, 0, sizeof(fires));
+    fire_count = 0;
+    memset(task_runs, 0, sizeof(task_runs));
+    memset(task_more, 0, sizeof(task_more));
+}
+
+void tearDown(void) {
+}
+
+void test_timer_fires_at_its_deadline(void) {
+    SchedTimer timer = {0};
+    scheduler_timer_start(&timer, 10000, 0, record, (void *)1);
+    TEST_ASSERT_TRUE(scheduler_timer_armed(&timer));
+
+    run_for_ms(9);
+    TEST_ASSERT_EQUAL(0, fire_count);
+    run_for_ms(1);
+    TEST_ASSERT_EQUAL(1, fire_count);
+    TEST_ASSERT_EQUAL(5010, fires[0].at_ms);
+    TEST_ASSERT_FALSE(scheduler_timer_armed(&timer));
+
+    run_for_ms(50);
+    TEST_ASSERT_EQUAL(1, fire_count);
+}
+
+void test_timers_on_every_level_fire_in_order(void) {
+    // Level 0, 1 and 2, and one past the wheel's reach; started out of order
+    SchedTimer timers[4] = {{0}};
+    scheduler_timer_start(&timers[2], 2000000, 0, record, (void *)2);
+    scheduler_timer_start(&timers[0], 5000, 0, record, (void *)0);
+    scheduler_timer_start(&timers[3], 70000000, 0, record, (void *)3);
+    scheduler_timer_start(&timers[1], 100000, 0, record, (void *)1);
+
+    run_for_ms(70000);
+
+    TEST_ASSERT_EQUAL(4, fire_count);
+    uint32_t expected[4] = {5005, 5100, 7000, 75000};
+    for (int i = 0; i < 4; i++) {
+        TEST_ASSERT_EQUAL(i, fires[i].id);
+        TEST_ASSERT_EQUAL(expected[i], fires[i].at_ms);
+    }
+
+    SchedulerStats stats;
+    scheduler_get_stats(&stats);
+    TEST_ASSERT_EQUAL(0, stats.timers_late);
+    TEST_ASSERT_EQUAL(0, stats.timers_armed);
+}
+
+void test_periodic_timer_skips_missed_periods(void) {
+    SchedTimer timer = {0};
+    scheduler_timer_start(&timer, 100000, 100000, record, NULL);
+
+    run_for_ms(300);
+    TEST_ASSERT_EQUAL(3, fire_count);
+    TEST_ASSERT_EQUAL(5300, fires[2].at_ms);
+
+    // A 350 ms stall: one late fire, then back on a 100 ms beat
+    mock_time_advance(350);
+    scheduler_run_once();
+    TEST_ASSERT_EQUAL(4, fire_count);
+    run_for_ms(100);
+    TEST_ASSERT_EQUAL(5, fire_count);
+    TEST_ASSERT_EQUAL(fires[3].at_ms + 100, fires[4].at_ms);
+
+    SchedulerStats stats;
+    scheduler_get_stats(&stats);
+    TEST_ASSERT_EQUAL(1, stats.timers_late);
+    TEST_ASSERT_EQUAL(1, stats.timers_armed);
+
+    scheduler_timer_cancel(&timer);
+    run_for_ms(500);
+    TEST_ASSERT_EQUAL(5, fire_count);
+}
+
+static SchedTimer same_tick[2];
+
+static void cancel_other(void *context) {
+    record(context);
+    scheduler_timer_cancel(&same_tick[1]);
+}
+
+void test_cancel_and_restart(void) {
+    SchedTimer timer = {0};
+    scheduler_timer_start(&timer, 20000, 0, record, (void *)1);
+    run_for_ms(10);
+    scheduler_timer_start(&timer, 20000, 0, record, (void *)2);  // Moves it
+    run_for_ms(15);
+    TEST_ASSERT_EQUAL(0, fire_count);
+    run_for_ms(5);
+    TEST_ASSERT_EQUAL(1, fire_count);
+    TEST_ASSERT_EQUAL(2, fires[0].id);
+
+    // A callback cancels a timer due in the same tick
+    memset(same_tick, 0, sizeof(same_tick));
+    scheduler_timer_start(&same_tick[1], 3000, 0, record, (void *)4);
+    scheduler_timer_start(&same_tick[0], 3000, 0, cancel_other, (void *)3);
+    run_for_ms(5);
+    TEST_ASSERT_EQUAL(2, fire_count);
+    TEST_ASSERT_EQUAL(3, fires[1].id);
+    TEST_ASSERT_FALSE(scheduler_timer_armed(&same_tick[1]));
+}
+
+void test_events_wake_only_their_tasks(void) {
+    int rx = scheduler_task_add("rx", task, (void *)0, SCHED_EVENT_BIT(SCHED_EVENT_USB_RX));
+    int spi = scheduler_task_add("spi", task, (void *)1, SCHED_EVENT_BIT(SCHED_EVENT_SPI_DONE));
+    int poll = scheduler_task_add("poll", task, (void *)2, SCHED_WAKE_ALWAYS);
+    TEST_ASSERT_EQUAL(0, rx);
+    TEST_ASSERT_EQUAL(2, poll);
+
+    TEST_ASSERT_FALSE(scheduler_run_once());
+    TEST_ASSERT_EQUAL(0, task_runs[0]);
+    TEST_ASSERT_EQUAL(1, task_runs[2]);
+
+    scheduler_signal(SCHED_EVENT_USB_RX);
+    scheduler_run_once();
+    TEST_ASSERT_EQUAL(1, task_runs[0]);
+    TEST_ASSERT_EQUAL(0, task_runs[1]);
+
+    // The event was consumed; an explicit wake runs it once more
+    scheduler_run_once();
+    TEST_ASSERT_EQUAL(1, task_runs[0]);
+    scheduler_task_wake(spi);
+    scheduler_run_once();
+    TEST_ASSERT_EQUAL(1, task_runs[1]);
+}
+
+void test_busy_task_stays_runnable(void) {
+    int rx = scheduler_task_add("rx", task, (void *)0, SCHED_EVENT_BIT(SCHED_EVENT_USB_RX));
+    task_more[0] = true;
+    scheduler_task_wake(rx);
+
+    TEST_ASSERT_TRUE(scheduler_run_once());
+    TEST_ASSERT_TRUE(scheduler_run_once());
+    TEST_ASSERT_EQUAL(0, scheduler_idle_budget_us());
+
+    task_more[0] = false;
+    TEST_ASSERT_FALSE(scheduler_run_once());
+    TEST_ASSERT_EQUAL(3, task_runs[0]);
+    scheduler_run_once();
+    TEST_ASSERT_EQUAL(3, task_runs[0]);
+}
+
+void test_idle_budget_runs_to_the_next_timer(void) {
+    TEST_ASSERT_EQUAL_UINT32(UINT32_MAX, scheduler_idle_budget_us());
+
+    SchedTimer soon = {0};
+    scheduler_timer_start(&soon, 8000, 0, record, NULL);
+    TEST_ASSERT_EQUAL_UINT32(8000, scheduler_idle_budget_us());
+
+    // Never past the next cascade, which may hold something sooner
+    SchedTimer later = {0};
+    scheduler_timer_cancel(&soon);
+    scheduler_timer_start(&later, 1000000, 0, record, NULL);
+    uint32_t budget = scheduler_idle_budget_us();
+    TEST_ASSERT_TRUE(budget > 0);
+    TEST_ASSERT_TRUE(budget <= SCHED_WHEEL_SLOTS * SCHED_TICK_US);
+
+    scheduler_signal(SCHED_EVENT_USB_RX);
+    TEST_ASSERT_EQUAL_UINT32(0, scheduler_idle_budget_us());
+}
+
+void test_microsecond_clock_wrap(void) {
+    // The us clock (ms * 1000 here) wraps 2^32 us after boot
+    mock_time_set(4294967);
+    scheduler_init();
+
+    SchedTimer timer = {0};
+    scheduler_timer_start(&timer, 5000, 0, record, NULL);
+    run_for_ms(4);
+    TEST_ASSERT_EQUAL(0, fire_count);
+    run_for_ms(1);
+    TEST_ASSERT_EQUAL(1, fire_count);
+}
+
+int main(void) {
+    UNITY_BEGIN();
+
+    // Timer wheel
+    RUN_TEST(test_timer_fires_at_its_deadline);
+    RUN_TEST(test_timers_on_every_level_fire_in_order);
+    RUN_TEST(test_periodic_timer_skips_missed_periods);
+    RUN_TEST(test_cancel_and_restart);
+
+    // Tasks and idling
+    RUN_TEST(test_events_wake_only_their_tasks);
+    RUN_TEST(test_busy_task_stays_runnable);
+    RUN_TEST(test_idle_budget_runs_to_the_next_timer);
+    RUN_TEST(test_microsecond_clock_wrap);
+
+    return UNITY_END();
+}